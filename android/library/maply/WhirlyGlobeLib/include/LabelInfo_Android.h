@@ -36,6 +36,9 @@ class LabelInfoAndroid : public LabelInfo
 public:
 	LabelInfoAndroid(bool screenObject);
 	LabelInfoAndroid(LabelInfoAndroid &&that) noexcept;
+	// Copy the settings, borrowing the Java references from the original.
+	// The copy has to go away before the original's references are cleared.
+	LabelInfoAndroid(const LabelInfoAndroid &that);
 	~LabelInfoAndroid();
 
 	// Clear any global refs we may be holding
@@ -55,6 +58,9 @@ public:
 
 	// Global object pointing to labelInfo on Java side
 	jobject labelInfoObj;
+
+	// False for copies, which borrow the references from their original
+	bool ownsRefs;
 };
 typedef std::shared_ptr<LabelInfoAndroid> LabelInfoAndroidRef;
 
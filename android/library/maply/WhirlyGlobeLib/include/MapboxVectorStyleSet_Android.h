@@ -19,6 +19,7 @@
 #import <jni.h>
 #import "WhirlyGlobeLib.h"
 #import "LabelInfo_Android.h"
+#import <mutex>
 
 namespace WhirlyKit
 {
@@ -44,7 +45,8 @@ public:
     /// Local platform implementation for generating a repeating line texture
     virtual SimpleIdentity makeLineTexture(PlatformThreadInfo *inst,const std::vector<double> &dashComponents) override;
 
-    /// Create a local platform LabelInfo (since fonts are local)
+    /// Create a local platform LabelInfo (since fonts are local).
+    /// The Java side ones are cached by font and size, each caller gets its own copy of the settings.
     virtual LabelInfoRef makeLabelInfo(PlatformThreadInfo *,
                                        const std::vector<std::string> &fontName,
                                        float fontSize,
@@ -62,6 +64,9 @@ public:
     /// Associate the given selection ID with a vector object
     virtual void addSelectionObject(SimpleIdentity selectID,const VectorObjectRef &vecObj,const ComponentObjectRef &compObj) override;
 
+    /// The Java side is fine with being called from several threads, and we lock the label info cache
+    virtual bool platformIsThreadSafe() const override { return true; }
+
     /// Set up the Java side method references
     void setupMethods(JNIEnv *env);
 
@@ -74,9 +79,11 @@ public:
     jmethodID calculateTextWidthMethod = nullptr;
     jmethodID makeCircleTextureMethod = nullptr;
     jmethodID makeLineTextureMethod = nullptr;
+    std::once_flag setupMethodsOnce;
 
     // Map fontName/size to Java-side labelInfo objects
     std::map<std::pair<std::string, float>, LabelInfoAndroidRef> labelInfos;
+    std::mutex labelInfoLock;
 };
 typedef std::shared_ptr<MapboxVectorStyleSetImpl_Android> MapboxVectorStyleSetImpl_AndroidRef;
 
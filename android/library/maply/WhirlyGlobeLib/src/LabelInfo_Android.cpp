@@ -26,7 +26,8 @@ namespace WhirlyKit
 LabelInfoAndroid::LabelInfoAndroid(bool screenObject) :
 	LabelInfo(screenObject),
 	typefaceObj(nullptr),
-	labelInfoObj(nullptr)
+	labelInfoObj(nullptr),
+	ownsRefs(true)
 {
 }
 
@@ -34,16 +35,26 @@ LabelInfoAndroid::LabelInfoAndroid(LabelInfoAndroid &&that) noexcept :
 	LabelInfo(that),
 	typefaceObj(that.typefaceObj),
 	fontSize(that.fontSize),
-	labelInfoObj(that.labelInfoObj)
+	labelInfoObj(that.labelInfoObj),
+	ownsRefs(that.ownsRefs)
 {
 	// ensure that the reference isn't released twice
 	that.typefaceObj = nullptr;
 }
 
+LabelInfoAndroid::LabelInfoAndroid(const LabelInfoAndroid &that) :
+	LabelInfo(that),
+	typefaceObj(that.typefaceObj),
+	fontSize(that.fontSize),
+	labelInfoObj(that.labelInfoObj),
+	ownsRefs(false)
+{
+}
+
 LabelInfoAndroid::~LabelInfoAndroid()
 {
 	// should have been cleaned up through clearRefs()
-	if (labelInfoObj) {
+	if (labelInfoObj && ownsRefs) {
 		wkLogLevel(Warn, "LabelInfoAndroid not cleaned up");
 	}
 }
@@ -52,7 +63,10 @@ void LabelInfoAndroid::clearRefs(PlatformInfo_Android *threadInfo)
 {
 	if (typefaceObj)
 	{
-		threadInfo->env->DeleteGlobalRef(typefaceObj);
+		if (ownsRefs)
+		{
+			threadInfo->env->DeleteGlobalRef(typefaceObj);
+		}
 		typefaceObj = nullptr;
 	}
 }
@@ -37,18 +37,19 @@ MapboxVectorStyleSetImpl_Android::MapboxVectorStyleSetImpl_Android(Scene *scene,
 
 void MapboxVectorStyleSetImpl_Android::setupMethods(JNIEnv *env)
 {
-    if (!makeLabelInfoMethod)
-    {
+    // Tiles may be building on several threads at once
+    std::call_once(setupMethodsOnce, [this,env]{
         const jclass thisClass = MapboxVectorStyleSetClassInfo::getClassInfo()->getClass();
         makeLabelInfoMethod      = env->GetMethodID(thisClass,"labelInfoForFont",  "(Ljava/lang/String;F)Lcom/mousebird/maply/LabelInfo;");
         calculateTextWidthMethod = env->GetMethodID(thisClass,"calculateTextWidth","(Ljava/lang/String;Lcom/mousebird/maply/LabelInfo;)D");
         makeCircleTextureMethod  = env->GetMethodID(thisClass,"makeCircleTexture", "(DIIFLcom/mousebird/maply/Point2d;)J");
         makeLineTextureMethod    = env->GetMethodID(thisClass,"makeLineTexture",   "([D)J");
-    }
+    });
 }
 
 void MapboxVectorStyleSetImpl_Android::cleanup(JNIEnv *env)
 {
+    std::lock_guard<std::mutex> guardLock(labelInfoLock);
     for (auto &labelInfo : labelInfos)
     {
         env->DeleteGlobalRef(labelInfo.second->labelInfoObj);
@@ -150,12 +151,15 @@ LabelInfoRef MapboxVectorStyleSetImpl_Android::makeLabelInfo(PlatformThreadInfo
     {
         setupMethods(inst->env);
 
+        // Hold the lock through the Java call, so nobody gets the entry before it's filled in
+        std::lock_guard<std::mutex> guardLock(labelInfoLock);
+
         const auto key = std::make_pair(fontNames[0],fontSize);
         const auto result = labelInfos.insert(std::make_pair(key, LabelInfoAndroidRef()));
         if (!result.second)
         {
-            // Already present, return it
-            return result.first->second;
+            // Already present, return a copy the caller can change
+            return result.first->second ? std::make_shared<LabelInfoAndroid>(*result.first->second) : LabelInfoRef();
         }
 
         if (auto obj = inst->env->NewLocalRef(thisObj))
@@ -180,7 +184,7 @@ LabelInfoRef MapboxVectorStyleSetImpl_Android::makeLabelInfo(PlatformThreadInfo
 
                 inst->env->DeleteLocalRef(obj);
 
-                return refLabelInfo;
+                return std::make_shared<LabelInfoAndroid>(*refLabelInfo);
             }
         }
     }
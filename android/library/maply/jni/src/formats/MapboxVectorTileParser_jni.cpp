@@ -34,6 +34,40 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_MapboxVectorTileParser_nativeIni
     MapboxVectorTileParserClassInfo::getClassInfo(env,cls);
 }
 
+// Shared by all the parsers for building styles in parallel.
+// Each worker attaches to the VM for its own JNIEnv and detaches on the way out.
+static TaskPoolRef buildPool(JNIEnv *env)
+{
+    static std::once_flag poolOnce;
+    static TaskPoolRef pool;
+    std::call_once(poolOnce, [env]{
+        JavaVM *vm = nullptr;
+        if (env->GetJavaVM(&vm) != JNI_OK || !vm)
+        {
+            return;
+        }
+        const int numThreads = std::max((int)std::thread::hardware_concurrency() - 1,0);
+        pool = std::make_shared<TaskPool>(numThreads,
+            [vm]() -> PlatformThreadInfo * {
+                JNIEnv *workerEnv = nullptr;
+                if (vm->AttachCurrentThread(&workerEnv,nullptr) != JNI_OK || !workerEnv)
+                {
+                    __android_log_print(ANDROID_LOG_WARN, "Maply", "MapboxVectorTileParser: Failed to attach build thread");
+                    return nullptr;
+                }
+                return new PlatformInfo_Android(workerEnv);
+            },
+            [vm](PlatformThreadInfo *info) {
+                if (info)
+                {
+                    delete (PlatformInfo_Android *)info;
+                    vm->DetachCurrentThread();
+                }
+            });
+    });
+    return pool;
+}
+
 extern "C"
 JNIEXPORT void JNICALL Java_com_mousebird_maply_MapboxVectorTileParser_initialise
     (JNIEnv *env, jobject obj, jobject vecStyleObj, jboolean isMapboxStyle)
@@ -48,6 +82,8 @@ JNIEXPORT void JNICALL Java_com_mousebird_maply_MapboxVectorTileParser_initialis
                 return;
 
             MapboxVectorTileParser *inst = new MapboxVectorTileParser(&platformInfo, *style);
+            // The styles decide which of them can use it
+            inst->setBuildPool(buildPool(env));
             MapboxVectorTileParserClassInfo::getClassInfo()->setHandle(env,obj,inst);
         } else {
             VectorStyleSetWrapper_AndroidRef *style = VectorStyleSetWrapperClassInfo::getClassInfo()->getObject(env,vecStyleObj);
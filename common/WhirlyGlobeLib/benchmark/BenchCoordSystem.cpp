@@ -0,0 +1,140 @@
+/*  BenchCoordSystem.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "SphericalMercator.h"
+#import "GlobeMath.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+// Largest difference between two runs of points
+template<typename T> static double MaxDiff(const T &a,const T &b)
+{
+    double maxDiff = 0.0;
+    for (size_t ii=0;ii<a.size();ii++)
+        maxDiff = std::max(maxDiff,(a[ii] - b[ii]).norm());
+    return maxDiff;
+}
+
+// Time the single point and batch display conversions for one adapter and check they agree
+static void CompareDisplay(Runner &runner,const std::string &name,const CoordSystemDisplayAdapter &adapter,
+                           const Point3dVector &localPts,const Point3dVector &dispPts)
+{
+    const size_t numPts = localPts.size();
+    {
+        Point3dVector single(numPts), batch(numPts);
+        runner.run("coordsys",name + "/localToDisplay/single",numPts,"pts",[&]{
+            for (size_t ii=0;ii<numPts;ii++)
+                single[ii] = adapter.localToDisplay(localPts[ii]);
+        });
+        Result *result = runner.run("coordsys",name + "/localToDisplay/batch",numPts,"pts",[&]{
+            adapter.localToDisplayBatch(localPts.data(),batch.data(),numPts);
+        });
+        if (result)
+            runner.metric(result,"max_diff",MaxDiff(single,batch));
+    }
+    {
+        Point3dVector single(numPts), batch(numPts);
+        runner.run("coordsys",name + "/displayToLocal/single",numPts,"pts",[&]{
+            for (size_t ii=0;ii<numPts;ii++)
+                single[ii] = adapter.displayToLocal(dispPts[ii]);
+        });
+        Result *result = runner.run("coordsys",name + "/displayToLocal/batch",numPts,"pts",[&]{
+            adapter.displayToLocalBatch(dispPts.data(),batch.data(),numPts);
+        });
+        if (result)
+            runner.metric(result,"max_diff",MaxDiff(single,batch));
+    }
+}
+
+WGBENCH_SUITE(coordsys)
+{
+    const int numPts = runner.size(200000,2000);
+    FixtureRandom rand(10);
+
+    SphericalMercatorCoordSystem merc;
+    SphericalMercatorDisplayAdapter flatAdapter(0.0,GeoCoord::CoordFromDegrees(-180,-85),GeoCoord::CoordFromDegrees(180,85));
+    FakeGeocentricDisplayAdapter globeAdapter;
+    const CoordSystem *geoSys = globeAdapter.getCoordSystem();
+
+    Point2dVector geoPts(numPts);
+    for (auto &pt : geoPts)
+        pt = Point2d(rand.uniform(-M_PI,M_PI),rand.uniform(-1.4,1.4));
+    Point3dVector localPts(numPts);
+    merc.geographicToLocalBatch(geoPts.data(),localPts.data(),numPts);
+
+    // Geographic to local
+    {
+        Point3dVector single(numPts), batch(numPts);
+        runner.run("coordsys","geographicToLocal/single",numPts,"pts",[&]{
+            for (int ii=0;ii<numPts;ii++)
+                single[ii] = merc.geographicToLocal(geoPts[ii]);
+        });
+        Result *result = runner.run("coordsys","geographicToLocal/batch",numPts,"pts",[&]{
+            merc.geographicToLocalBatch(geoPts.data(),batch.data(),numPts);
+        });
+        if (result)
+            runner.metric(result,"max_diff",MaxDiff(single,batch));
+    }
+
+    // Local to geographic
+    {
+        Point2dVector single(numPts), batch(numPts);
+        runner.run("coordsys","localToGeographic/single",numPts,"pts",[&]{
+            for (int ii=0;ii<numPts;ii++)
+                single[ii] = merc.localToGeographicD(localPts[ii]);
+        });
+        Result *result = runner.run("coordsys","localToGeographic/batch",numPts,"pts",[&]{
+            merc.localToGeographicBatch(localPts.data(),batch.data(),numPts);
+        });
+        if (result)
+            runner.metric(result,"max_diff",MaxDiff(single,batch));
+    }
+
+    // Local to display and back for each kind of adapter
+    GeneralCoordSystemDisplayAdapter generalAdapter(&merc,Point3d(-M_PI,-M_PI,0.0),Point3d(M_PI,M_PI,0.0),
+                                                    Point3d(0.1,0.2,0.0),Point3d(2.0,2.0,1.0));
+    {
+        Point3dVector flatDisp(numPts);
+        flatAdapter.localToDisplayBatch(localPts.data(),flatDisp.data(),numPts);
+        CompareDisplay(runner,"flat",flatAdapter,localPts,flatDisp);
+        CompareDisplay(runner,"general",generalAdapter,localPts,flatDisp);
+    }
+    {
+        Point3dVector geoLocal(numPts);
+        for (int ii=0;ii<numPts;ii++)
+            geoLocal[ii] = Point3d(geoPts[ii].x(),geoPts[ii].y(),rand.uniform(0.0,1000.0));
+        Point3dVector globeDisp(numPts);
+        globeAdapter.localToDisplayBatch(geoLocal.data(),globeDisp.data(),numPts);
+        CompareDisplay(runner,"globe",globeAdapter,geoLocal,globeDisp);
+    }
+
+    // Mercator to geographic, as the tile builders do
+    {
+        Point3dVector single(numPts), batch(numPts);
+        runner.run("coordsys","convert/single",numPts,"pts",[&]{
+            for (int ii=0;ii<numPts;ii++)
+                single[ii] = CoordSystemConvert3d(&merc,geoSys,localPts[ii]);
+        });
+        runner.run("coordsys","convert/batch",numPts,"pts",[&]{
+            CoordSystemConvert3d(&merc,geoSys,localPts.data(),batch.data(),numPts);
+        });
+    }
+}
@@ -0,0 +1,128 @@
+/*  BenchDictionary.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "DictionaryC.h"
+#import "FlatDictionaryC.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+WGBENCH_SUITE(dictionary)
+{
+    // Feature attributes: a handful of keys shared by every feature in a layer
+    const int numDicts = runner.size(100000,1000);
+    const std::vector<std::string> keys = {"class","subclass","name","name_en","rank","admin_level","oneway","layer"};
+    const auto keyTable = std::make_shared<DictionaryKeyTable>(keys);
+    const char *classes[] = {"primary","secondary","tertiary","minor","path","service"};
+
+    const auto fill = [&](MutableDictionary &dict,int which)
+    {
+        dict.setString("class",classes[which % 6]);
+        dict.setString("subclass",classes[(which / 6) % 6]);
+        dict.setString("name","Some Street Name " + std::to_string(which % 500));
+        dict.setString("name_en","Some Street Name " + std::to_string(which % 500));
+        dict.setInt("rank",which % 20);
+        dict.setInt("admin_level",which % 10);
+        dict.setInt("oneway",which % 2);
+        dict.setInt("layer",0);
+    };
+
+    std::vector<MutableDictionaryC> classicDicts;
+    std::vector<FlatDictionaryC> flatDicts;
+
+    runner.run("dictionary","build/MutableDictionaryC",numDicts,"dicts",[&]{
+        classicDicts.clear();
+        classicDicts.resize(numDicts);
+        for (int ii=0;ii<numDicts;ii++)
+            fill(classicDicts[ii],ii);
+    });
+    if (classicDicts.empty())
+    {
+        classicDicts.resize(numDicts);
+        for (int ii=0;ii<numDicts;ii++)
+            fill(classicDicts[ii],ii);
+    }
+
+    Result *flatBuild = runner.run("dictionary","build/FlatDictionaryC",numDicts,"dicts",[&]{
+        flatDicts.clear();
+        flatDicts.reserve(numDicts);
+        for (int ii=0;ii<numDicts;ii++)
+        {
+            flatDicts.emplace_back(keyTable);
+            fill(flatDicts.back(),ii);
+        }
+    });
+    if (flatDicts.empty())
+    {
+        flatDicts.reserve(numDicts);
+        for (int ii=0;ii<numDicts;ii++)
+        {
+            flatDicts.emplace_back(keyTable);
+            fill(flatDicts.back(),ii);
+        }
+    }
+    if (flatBuild)
+    {
+        size_t flatBytes = 0;
+        for (const auto &dict : flatDicts)
+            flatBytes += dict.getMemorySize();
+        runner.metric(flatBuild,"bytes_per_dict",(double)flatBytes / numDicts);
+    }
+
+    // Same answers from both
+    int mismatches = 0;
+    for (int ii=0;ii<numDicts;ii+=97)
+    {
+        if (classicDicts[ii].getString("class") != flatDicts[ii].getString("class") ||
+            classicDicts[ii].getInt("rank",0) != flatDicts[ii].getInt("rank",0) ||
+            classicDicts[ii].getString("name") != flatDicts[ii].getString("name"))
+            mismatches++;
+    }
+    if (mismatches)
+        runner.fail("dictionary",std::to_string(mismatches) + " flat dictionaries differ");
+
+    // The lookups a style filter does per feature
+    const auto lookup = [&](const auto &dicts)
+    {
+        double sum = 0.0;
+        for (const auto &dict : dicts)
+        {
+            sum += dict.getInt("rank",0);
+            sum += dict.getString("class").size();
+            sum += dict.getDouble("admin_level",0.0);
+        }
+        DoNotOptimize(sum);
+    };
+    runner.run("dictionary","lookup/MutableDictionaryC",numDicts,"dicts",[&]{ lookup(classicDicts); });
+    runner.run("dictionary","lookup/FlatDictionaryC",numDicts,"dicts",[&]{ lookup(flatDicts); });
+
+    const int rankIndex = keyTable->find("rank"), classIndex = keyTable->find("class"), adminIndex = keyTable->find("admin_level");
+    runner.run("dictionary","lookup/FlatDictionaryC-by-index",numDicts,"dicts",[&]{
+        double sum = 0.0;
+        const std::string empty;
+        for (const auto &dict : flatDicts)
+        {
+            sum += dict.getDouble(rankIndex,0.0);
+            sum += dict.getString(classIndex,empty).size();
+            sum += dict.getDouble(adminIndex,0.0);
+        }
+        DoNotOptimize(sum);
+    });
+}
@@ -0,0 +1,164 @@
+/*  BenchDynamicTexture.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "DynamicTextureAtlas.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// Just the packing, no texture behind it
+class BenchDynamicTexture : public DynamicTexture
+{
+public:
+    BenchDynamicTexture() : TextureBase("Bench Dynamic Texture"), DynamicTexture("Bench Dynamic Texture") { }
+    virtual bool createInRenderer(const RenderSetupInfo *) override { return true; }
+    virtual void destroyInRenderer(const RenderSetupInfo *,Scene *) override { }
+    virtual void addTextureData(int,int,int,int,RawDataRef) override { }
+    virtual void clearTextureData(int,int,int,int,ChangeSet &,bool,unsigned char *) override { }
+};
+
+// The cell by cell search DynamicTexture used to do, for comparison
+class GridPacker
+{
+public:
+    GridPacker(int numCell) : numCell(numCell), grid(numCell*numCell,false) { }
+
+    void setRegion(const DynamicTexture::Region &region,bool enable)
+    {
+        for (int iy=region.sy;iy<=region.ey;iy++)
+            for (int ix=region.sx;ix<=region.ex;ix++)
+                grid[iy*numCell+ix] = enable;
+    }
+
+    bool findRegion(int sizeX,int sizeY,DynamicTexture::Region &region)
+    {
+        for (int iy=0;iy<=numCell-sizeY;iy++)
+            for (int ix=0;ix<=numCell-sizeX;ix++)
+            {
+                bool clear = true;
+                for (int testY=0;testY<sizeY && clear;testY++)
+                    for (int testX=0;testX<sizeX && clear;testX++)
+                        if (grid[(testY+iy)*numCell+(testX+ix)])
+                            clear = false;
+                if (clear)
+                {
+                    region.sx = ix;  region.sy = iy;
+                    region.ex = ix+sizeX-1;  region.ey = iy+sizeY-1;
+                    return true;
+                }
+            }
+        return false;
+    }
+
+protected:
+    int numCell;
+    std::vector<bool> grid;
+};
+
+// Glyph and icon sized requests, in cells
+struct PackRequest
+{
+    int sx,sy;
+};
+
+// Fill the texture, then repeatedly free some of it and fill it back up, the way labels come and go.
+// Returns the regions handed out, in order.
+template<typename Packer> static std::vector<DynamicTexture::Region> RunPacking(Packer &packer,const std::vector<PackRequest> &requests,int rounds,uint32_t seed)
+{
+    FixtureRandom rand(seed);
+    std::vector<DynamicTexture::Region> placed,live;
+    size_t next = 0;
+    for (int round=0;round<rounds;round++)
+    {
+        // Fill until something doesn't fit
+        while (true)
+        {
+            const PackRequest &req = requests[next++ % requests.size()];
+            DynamicTexture::Region region;
+            if (!packer.findRegion(req.sx,req.sy,region))
+                break;
+            packer.setRegion(region,true);
+            placed.push_back(region);
+            live.push_back(region);
+        }
+
+        // Let a third of it go
+        for (size_t ii=0;ii<live.size();)
+        {
+            if (rand.index(3) == 0)
+            {
+                packer.setRegion(live[ii],false);
+                live[ii] = live.back();
+                live.pop_back();
+            }
+            else
+                ii++;
+        }
+    }
+
+    return placed;
+}
+
+}
+
+WGBENCH_SUITE(dyntexture)
+{
+    const int texSize = 2048, cellSize = 16;
+    const int numCell = texSize / cellSize;
+    const int rounds = runner.size(8,2);
+
+    FixtureRandom rand(11);
+    std::vector<PackRequest> requests(4096);
+    for (auto &req : requests)
+    {
+        req.sx = 1 + rand.index(4);
+        req.sy = 1 + rand.index(3);
+    }
+
+    std::vector<DynamicTexture::Region> gridPlaced,maskPlaced;
+    runner.run("dyntexture","pack/cell-grid",rounds,"rounds",[&]{
+        GridPacker packer(numCell);
+        gridPlaced = RunPacking(packer,requests,rounds,5);
+    });
+    Result *maskResult = runner.run("dyntexture","pack/bitmask",rounds,"rounds",[&]{
+        BenchDynamicTexture tex;
+        tex.setup(texSize,cellSize,TexTypeUnsignedByte,false);
+        maskPlaced = RunPacking(tex,requests,rounds,5);
+    });
+    runner.metric(maskResult,"regions",(double)maskPlaced.size());
+
+    // Both search lowest row first, then leftmost, so they should agree exactly
+    if (!gridPlaced.empty() && !maskPlaced.empty())
+    {
+        int mismatches = gridPlaced.size() != maskPlaced.size() ? 1 : 0;
+        for (size_t ii=0;ii<std::min(gridPlaced.size(),maskPlaced.size());ii++)
+        {
+            const auto &a = gridPlaced[ii], &b = maskPlaced[ii];
+            if (a.sx != b.sx || a.sy != b.sy || a.ex != b.ex || a.ey != b.ey)
+                mismatches++;
+        }
+        runner.metric(maskResult,"mismatches",mismatches);
+        if (mismatches)
+            runner.fail("dyntexture",std::to_string(mismatches) + " regions placed differently");
+    }
+}
@@ -0,0 +1,182 @@
+/*  BenchFeatureStore.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdio>
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "DictionaryC.h"
+#import "VectorFeatureStore.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+WGBENCH_SUITE(featurestore)
+{
+    const int numFeatures = runner.size(200000,5000);
+
+    // Roads, buildings and places scattered over a region, like an offline cache
+    FixtureRandom rand(41);
+    static const char *kinds[] = {"residential","primary","secondary","footway","building","park"};
+    ShapeSet shapes;
+    size_t totalPoints = 0;
+    for (int ii=0;ii<numFeatures;ii++)
+    {
+        const Point2f center(rand.uniform(-0.5,0.5),rand.uniform(0.5,1.0));
+        auto attrs = std::make_shared<MutableDictionaryC>();
+        attrs->setString("kind",kinds[rand.index(6)]);
+        attrs->setString("name","Feature " + std::to_string(rand.index(1000)));
+        attrs->setInt("rank",rand.index(20));
+        attrs->setDouble("height",rand.uniform(0.0,50.0));
+
+        VectorShapeRef shape;
+        switch (rand.index(3))
+        {
+            case 0:
+            {
+                auto pts = VectorPoints::createPoints();
+                pts->pts.push_back(center);
+                shape = pts;
+            }
+                break;
+            case 1:
+            {
+                auto lin = VectorLinear::createLinear();
+                Point2f pt = center;
+                for (int ip=0;ip<2+rand.index(30);ip++)
+                {
+                    lin->pts.push_back(pt);
+                    pt += Point2f(rand.uniform(-0.0005,0.0005),rand.uniform(-0.0005,0.0005));
+                }
+                shape = lin;
+            }
+                break;
+            default:
+            {
+                auto ar = VectorAreal::createAreal();
+                const float size = (float)rand.uniform(0.00005,0.0005);
+                ar->loops.push_back(VectorRing { center + Point2f(-size,-size), center + Point2f(size,-size),
+                                                 center + Point2f(size,size), center + Point2f(-size,size) });
+                shape = ar;
+            }
+                break;
+        }
+        shape->setAttrDict(attrs);
+        shapes.insert(shape);
+    }
+    for (const auto &shape : shapes)
+    {
+        if (auto pts = std::dynamic_pointer_cast<VectorPoints>(shape))
+            totalPoints += pts->pts.size();
+        else if (auto lin = std::dynamic_pointer_cast<VectorLinear>(shape))
+            totalPoints += lin->pts.size();
+        else if (auto ar = std::dynamic_pointer_cast<VectorAreal>(shape))
+            totalPoints += ar->loops[0].size();
+    }
+
+    const std::string fileName = std::string(P_tmpdir) + "/wgbench_features.wkfs";
+    bool written = false;
+    runner.run("featurestore","write",numFeatures,"features",[&]{
+        written = VectorWriteFile(fileName,shapes);
+    });
+    if (!written && !VectorWriteFile(fileName,shapes))
+    {
+        runner.fail("featurestore","couldn't write " + fileName);
+        return;
+    }
+
+    // The old way, everything becomes a shape with its own dictionary
+    runner.run("featurestore","read/all-shapes",numFeatures,"features",[&]{
+        ShapeSet readShapes;
+        VectorReadFile(fileName,readShapes);
+        DoNotOptimize(readShapes.size());
+    });
+
+    VectorFeatureStoreRef store;
+    runner.run("featurestore","open",numFeatures,"features",[&]{
+        store = VectorFeatureStore::open(fileName);
+    });
+    if (!store)
+        store = VectorFeatureStore::open(fileName);
+    if (!store || store->getNumFeatures() != (unsigned int)numFeatures)
+    {
+        runner.fail("featurestore","couldn't read back " + fileName);
+        remove(fileName.c_str());
+        return;
+    }
+
+    // Every point should come back
+    size_t readPoints = 0;
+    for (unsigned int ii=0;ii<store->getNumFeatures();ii++)
+        for (unsigned int part=0;part<store->getNumParts(ii);part++)
+        {
+            unsigned int numPts = 0;
+            store->getPoints(ii,part,numPts);
+            readPoints += numPts;
+        }
+    if (readPoints != totalPoints)
+        runner.fail("featurestore","wrote " + std::to_string(totalPoints) + " points, read " + std::to_string(readPoints));
+
+    // Small areas, about what a screen of map covers zoomed in
+    const int numQueries = runner.size(1000,100);
+    std::vector<Mbr> queries;
+    for (int ii=0;ii<numQueries;ii++)
+    {
+        const Point2f ll(rand.uniform(-0.5,0.49),rand.uniform(0.5,0.99));
+        queries.emplace_back(ll,ll + Point2f(0.01,0.01));
+    }
+
+    size_t indexHits = 0, scanHits = 0;
+    Result *indexResult = runner.run("featurestore","query/zero-copy",numQueries,"queries",[&]{
+        indexHits = 0;
+        std::vector<unsigned int> features;
+        for (const auto &mbr : queries)
+        {
+            features.clear();
+            store->query(mbr,features);
+            for (const auto which : features)
+            {
+                unsigned int numPts = 0;
+                DoNotOptimize(store->getPoints(which,0,numPts));
+                indexHits++;
+            }
+        }
+    });
+    runner.metric(indexResult,"hits",(double)indexHits);
+
+    Result *scanResult = runner.run("featurestore","query/scan",numQueries,"queries",[&]{
+        scanHits = 0;
+        for (const auto &mbr : queries)
+            for (unsigned int ii=0;ii<store->getNumFeatures();ii++)
+                if (store->getBounds(ii).overlaps(mbr))
+                    scanHits++;
+    });
+    if (indexResult && scanResult && indexHits != scanHits)
+        runner.fail("featurestore","index found " + std::to_string(indexHits) + " features, scan found " + std::to_string(scanHits));
+
+    runner.run("featurestore","query/shapes",numQueries,"queries",[&]{
+        for (const auto &mbr : queries)
+        {
+            ShapeSet found;
+            store->getShapes(mbr,found);
+            DoNotOptimize(found.size());
+        }
+    });
+
+    store.reset();
+    remove(fileName.c_str());
+}
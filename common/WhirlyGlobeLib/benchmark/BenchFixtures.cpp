@@ -0,0 +1,450 @@
+/*  BenchFixtures.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cmath>
+#import <cstdio>
+#import "BenchFixtures.h"
+#import "LabelManager.h"
+#import "VectorTilePBFParser.h"
+#import "libjson.h"
+
+namespace WhirlyKit
+{
+namespace Bench
+{
+
+std::string LoadFixture(const std::string &name)
+{
+    const std::string path = std::string(WGBENCH_FIXTURE_DIR) + "/" + name;
+    FILE *fp = fopen(path.c_str(),"rb");
+    if (!fp)
+    {
+        fprintf(stderr,"Missing fixture %s\n",path.c_str());
+        return std::string();
+    }
+    std::string data;
+    char buf[16384];
+    size_t len;
+    while ((len = fread(buf,1,sizeof(buf),fp)) > 0)
+        data.append(buf,len);
+    fclose(fp);
+
+    return data;
+}
+
+static void SetJSONEntry(MutableDictionaryC &dict,const std::string &name,const DictionaryEntryCRef &entry)
+{
+    switch (entry->getType())
+    {
+        case DictTypeString:      dict.setString(name,entry->getString());  break;
+        case DictTypeInt:         dict.setInt(name,entry->getInt());  break;
+        case DictTypeDouble:      dict.setDouble(name,entry->getDouble());  break;
+        case DictTypeArray:       dict.setArray(name,entry->getArray());  break;
+        case DictTypeDictionary:  dict.setDict(name,std::dynamic_pointer_cast<MutableDictionaryC>(entry->getDict()));  break;
+        default:                  break;
+    }
+}
+
+static DictionaryEntryCRef ParseJSONValue(const JSONNode &node)
+{
+    switch (node.type())
+    {
+        case JSON_STRING:
+            return std::make_shared<DictionaryEntryCString>(node.as_string());
+        case JSON_NUMBER:
+            return std::make_shared<DictionaryEntryCBasic>((double)node.as_float());
+        case JSON_BOOL:
+            return std::make_shared<DictionaryEntryCBasic>((int)node.as_bool());
+        case JSON_ARRAY:
+        {
+            std::vector<DictionaryEntryCRef> vals;
+            for (const auto &child : node)
+                if (auto val = ParseJSONValue(child))
+                    vals.push_back(val);
+            return std::make_shared<DictionaryEntryCArray>(std::move(vals));
+        }
+        case JSON_NODE:
+        {
+            auto dict = std::make_shared<MutableDictionaryC>();
+            for (const auto &child : node)
+                if (auto val = ParseJSONValue(child))
+                    SetJSONEntry(*dict,child.name(),val);
+            return std::make_shared<DictionaryEntryCDict>(dict);
+        }
+        default:
+            return DictionaryEntryCRef();
+    }
+}
+
+MutableDictionaryCRef ParseJSONDictionary(const std::string &json)
+{
+    try
+    {
+        const JSONNode top = libjson::parse(json);
+        if (const auto entry = ParseJSONValue(top))
+            if (entry->getType() == DictTypeDictionary)
+                return std::dynamic_pointer_cast<MutableDictionaryC>(entry->getDict());
+    }
+    catch (const std::exception &)
+    {
+    }
+    return MutableDictionaryCRef();
+}
+
+HeadlessDrawable::HeadlessDrawable(const std::string &name) :
+    Drawable(name), BasicDrawable(name)
+{
+    on = true;
+    minVisible = maxVisible = DrawVisibleInvalid;
+    minViewerDist = maxViewerDist = DrawVisibleInvalid;
+    viewerCenter = Point3d(DrawVisibleInvalid,DrawVisibleInvalid,DrawVisibleInvalid);
+    zoomSlot = -1;
+    minZoomVis = maxZoomVis = DrawVisibleInvalid;
+}
+
+HeadlessDrawableBuilder::HeadlessDrawableBuilder(const std::string &name,Scene *scene) :
+    BasicDrawableBuilder(name,scene)
+{
+    basicDraw = std::make_shared<HeadlessDrawable>(name);
+    BasicDrawableBuilder::Init();
+    setupStandardAttributes();  // NOLINT: derived virtual not called here
+}
+
+// NOLINTNEXTLINE(google-default-arguments)
+int HeadlessDrawableBuilder::addAttribute(BDAttributeDataType dataType,StringIdentity nameID,int slot,int numThings)
+{
+    auto attr = new VertexAttribute(dataType,slot,nameID);
+    attr->setArena(attrArena);
+    if (numThings > 0)
+        attr->reserve(numThings);
+    basicDraw->vertexAttributes.push_back(attr);
+
+    return (int)(basicDraw->vertexAttributes.size()-1);
+}
+
+BasicDrawableRef HeadlessDrawableBuilder::getDrawable()
+{
+    if (const auto draw = std::dynamic_pointer_cast<HeadlessDrawable>(basicDraw))
+    {
+        draw->points = points;
+        draw->tris = tris;
+    }
+    return basicDraw;
+}
+
+HeadlessRenderer::HeadlessRenderer(int width,int height)
+{
+    init();
+    setFramebufferSize(width,height);
+}
+
+BasicDrawableBuilderRef HeadlessRenderer::makeBasicDrawableBuilder(const std::string &name) const
+{
+    return std::make_shared<HeadlessDrawableBuilder>(name,scene);
+}
+
+HeadlessStyleSet::HeadlessStyleSet(Scene *scene,CoordSystem *coordSys,VectorStyleSettingsImplRef settings) :
+    MapboxVectorStyleSetImpl(scene,coordSys,std::move(settings))
+{
+}
+
+SimpleIdentity HeadlessStyleSet::makeCircleTexture(PlatformThreadInfo *,double radius,const RGBAColor &,
+                                                   const RGBAColor &,float strokeWidth,Point2f *circleSize)
+{
+    if (circleSize)
+        *circleSize = Point2f(2*(radius+strokeWidth),2*(radius+strokeWidth));
+    return EmptyIdentity;
+}
+
+SimpleIdentity HeadlessStyleSet::makeLineTexture(PlatformThreadInfo *,const std::vector<double> &)
+{
+    return EmptyIdentity;
+}
+
+LabelInfoRef HeadlessStyleSet::makeLabelInfo(PlatformThreadInfo *,const std::vector<std::string> &,float fontHeight,bool)
+{
+    auto labelInfo = std::make_shared<LabelInfo>(true);
+    labelInfo->fontPointSize = fontHeight;
+    return labelInfo;
+}
+
+SingleLabelRef HeadlessStyleSet::makeSingleLabel(PlatformThreadInfo *,const std::string &)
+{
+    // Labels need the platform's fonts
+    return SingleLabelRef();
+}
+
+void HeadlessStyleSet::addSelectionObject(SimpleIdentity,const VectorObjectRef &,const ComponentObjectRef &)
+{
+}
+
+double HeadlessStyleSet::calculateTextWidth(PlatformThreadInfo *,const LabelInfoRef &labelInfo,const std::string &testStr)
+{
+    // Roughly what a proportional font does
+    return testStr.size() * labelInfo->fontPointSize * 0.55;
+}
+
+ComponentObjectRef HeadlessStyleSet::makeComponentObject(PlatformThreadInfo *,const Dictionary *)
+{
+    return std::make_shared<ComponentObject>();
+}
+
+std::vector<VectorRing> MakeRings(RingKind kind,int numRings,int maxPoints,uint32_t seed)
+{
+    FixtureRandom rand(seed);
+
+    std::vector<VectorRing> rings;
+    rings.reserve(numRings);
+    for (int ii=0;ii<numRings;ii++)
+    {
+        VectorRing ring;
+        const int numPts = 3 + rand.index(std::max(1,maxPoints-2));
+        const bool clockwise = rand.index(2);
+        const double cx = rand.uniform(0.0,0.01), cy = rand.uniform(0.0,0.01);
+        for (int ip=0;ip<numPts;ip++)
+        {
+            double ang = 2*M_PI*ip/numPts * (clockwise ? -1 : 1);
+            const double rad = (kind == RingConvex) ? 1e-4 : 1e-4*(0.3+0.7*rand.uniform());
+            if (kind == RingSelfIntersecting && ip % 5 == 0)
+                ang += 2*M_PI*0.7*(clockwise ? -1 : 1);
+            ring.push_back(Point2f(cx+rad*cos(ang),cy+rad*sin(ang)));
+            if (kind == RingDuplicatePoints && ip % 4 == 0)
+                ring.push_back(ring.back());
+        }
+        // About half of real data repeats the first point at the end
+        if (rand.index(2))
+            ring.push_back(ring[0]);
+        rings.push_back(ring);
+    }
+
+    return rings;
+}
+
+// Just enough of a protobuf writer for vector tiles
+class PBFWriter
+{
+public:
+    void varint(uint64_t val)
+    {
+        while (val >= 0x80)
+        {
+            data.push_back((char)((val & 0x7f) | 0x80));
+            val >>= 7;
+        }
+        data.push_back((char)val);
+    }
+    void key(int field,int wireType) { varint((field << 3) | wireType); }
+    void uintField(int field,uint64_t val) { key(field,0); varint(val); }
+    void bytesField(int field,const std::string &bytes)
+    {
+        key(field,2);
+        varint(bytes.size());
+        data += bytes;
+    }
+    void packedField(int field,const std::vector<uint32_t> &vals)
+    {
+        PBFWriter packed;
+        for (auto val : vals)
+            packed.varint(val);
+        bytesField(field,packed.data);
+    }
+
+    std::string data;
+};
+
+static uint32_t ZigZag(int32_t val)
+{
+    return (uint32_t)((val << 1) ^ (val >> 31));
+}
+
+static uint32_t Command(int cmd,int count)
+{
+    return (cmd & 0x7) | (count << 3);
+}
+
+// Encode a sequence of points as MoveTo plus LineTo, optionally closing it
+static void EncodePath(std::vector<uint32_t> &geom,const std::vector<std::pair<int,int>> &pts,bool close,int &curX,int &curY)
+{
+    geom.push_back(Command(1,1));
+    geom.push_back(ZigZag(pts[0].first - curX));
+    geom.push_back(ZigZag(pts[0].second - curY));
+    curX = pts[0].first;  curY = pts[0].second;
+    if (pts.size() > 1)
+        geom.push_back(Command(2,(int)pts.size()-1));
+    for (size_t ii=1;ii<pts.size();ii++)
+    {
+        geom.push_back(ZigZag(pts[ii].first - curX));
+        geom.push_back(ZigZag(pts[ii].second - curY));
+        curX = pts[ii].first;  curY = pts[ii].second;
+    }
+    if (close)
+        geom.push_back(Command(7,1));
+}
+
+// Attribute names and values the bundled style looks for
+static const char *ClassValues[] = {"motorway","primary","secondary","tertiary","minor","service","path","track",
+                                    "residential","park","wood","grass","ocean","lake","river","city","town","village"};
+static const int NumClassValues = sizeof(ClassValues)/sizeof(ClassValues[0]);
+
+std::string MakeVectorTile(const std::vector<MVTLayerSpec> &layers,uint32_t seed)
+{
+    FixtureRandom rand(seed);
+    const int extent = 4096;
+
+    PBFWriter tile;
+    for (const auto &spec : layers)
+    {
+        PBFWriter layer;
+        layer.uintField(15,2);
+        layer.bytesField(1,spec.name);
+
+        // Keys are class, rank, name, then generic ones
+        std::vector<std::string> keys = {"class","rank","name"};
+        for (int ik=(int)keys.size();ik<spec.numAttrs;ik++)
+            keys.push_back("attr" + std::to_string(ik));
+        keys.resize(std::max(1,spec.numAttrs));
+
+        // Values are laid out per key: numValues of each
+        std::vector<std::string> values;
+        for (int ik=0;ik<(int)keys.size();ik++)
+        {
+            for (int iv=0;iv<spec.numValues;iv++)
+            {
+                PBFWriter value;
+                if (keys[ik] == "rank")
+                    value.uintField(4,iv+1);
+                else if (keys[ik] == "class")
+                    value.bytesField(1,ClassValues[(iv * 7 + spec.name.size()) % NumClassValues]);
+                else
+                    value.bytesField(1,keys[ik] + " value " + std::to_string(iv));
+                values.push_back(value.data);
+            }
+        }
+
+        const int numFeatures = spec.numPoints + spec.numLines + spec.numPolygons;
+        for (int ii=0;ii<numFeatures;ii++)
+        {
+            const int geomType = (ii < spec.numPoints) ? 1 : (ii < spec.numPoints + spec.numLines) ? 2 : 3;
+
+            std::vector<uint32_t> tags;
+            for (int ik=0;ik<(int)keys.size();ik++)
+            {
+                tags.push_back(ik);
+                tags.push_back(ik * spec.numValues + rand.index(spec.numValues));
+            }
+
+            std::vector<uint32_t> geom;
+            int curX = 0, curY = 0;
+            const int cx = 64 + rand.index(extent-128), cy = 64 + rand.index(extent-128);
+            if (geomType == 1)
+            {
+                EncodePath(geom,{{cx,cy}},false,curX,curY);
+            }
+            else if (geomType == 2)
+            {
+                std::vector<std::pair<int,int>> pts;
+                int x = cx, y = cy;
+                const int numPts = 2 + rand.index(30);
+                for (int ip=0;ip<numPts;ip++)
+                {
+                    pts.emplace_back(x,y);
+                    x = std::min(extent,std::max(0,x + rand.index(129) - 64));
+                    y = std::min(extent,std::max(0,y + rand.index(129) - 64));
+                }
+                EncodePath(geom,pts,false,curX,curY);
+            }
+            else
+            {
+                // Star shaped, clockwise in tile coordinates as the spec wants for outer rings
+                std::vector<std::pair<int,int>> pts;
+                const int numPts = 4 + rand.index(40);
+                const double rad = 8 + rand.index(56);
+                for (int ip=0;ip<numPts;ip++)
+                {
+                    const double ang = 2*M_PI*ip/numPts;
+                    const double r = rad * (0.4 + 0.6*rand.uniform());
+                    pts.emplace_back(cx + (int)(r*cos(ang)),cy + (int)(r*sin(ang)));
+                }
+                EncodePath(geom,pts,true,curX,curY);
+
+                // Holes go the other way.  The star's edges stay outside 0.28 of the radius.
+                if (spec.holes && ii % 2 == 0 && rad >= 24)
+                {
+                    std::vector<std::pair<int,int>> holePts;
+                    const int numHolePts = 4 + ii % 5;
+                    for (int ip=0;ip<numHolePts;ip++)
+                    {
+                        const double ang = -2*M_PI*ip/numHolePts;
+                        holePts.emplace_back(cx + (int)(0.2*rad*cos(ang)),cy + (int)(0.2*rad*sin(ang)));
+                    }
+                    EncodePath(geom,holePts,true,curX,curY);
+                }
+            }
+
+            PBFWriter feature;
+            feature.uintField(1,ii+1);
+            feature.packedField(2,tags);
+            feature.uintField(3,geomType);
+            feature.packedField(4,geom);
+            layer.bytesField(2,feature.data);
+        }
+
+        for (const auto &key : keys)
+            layer.bytesField(3,key);
+        for (const auto &value : values)
+            layer.bytesField(4,value);
+        layer.uintField(5,extent);
+
+        tile.bytesField(3,layer.data);
+    }
+
+    return tile.data;
+}
+
+std::string MakeStandardVectorTile(int scale)
+{
+    std::vector<MVTLayerSpec> layers(5);
+    layers[0].name = "water";           layers[0].numPolygons = 20*scale;  layers[0].holes = true;
+    layers[1].name = "landuse";         layers[1].numPolygons = 60*scale;  layers[1].holes = true;
+    layers[2].name = "transportation";  layers[2].numLines = 200*scale;  layers[2].numAttrs = 6;
+    layers[3].name = "building";        layers[3].numPolygons = 200*scale;  layers[3].numAttrs = 3;
+    layers[4].name = "place";           layers[4].numPoints = 60*scale;  layers[4].numValues = 32;
+
+    return MakeVectorTile(layers,1234);
+}
+
+std::vector<VectorObjectRef> DecodeVectorTile(const std::string &tileBytes,const QuadTreeIdentifier &tileID)
+{
+    const double tileSpan = 2.0*M_PI / (1<<tileID.level);
+    VectorTileData tileData;
+    tileData.ident = tileID;
+    tileData.bbox = MbrD(Point2d(-M_PI + tileID.x*tileSpan,-M_PI + tileID.y*tileSpan),
+                         Point2d(-M_PI + (tileID.x+1)*tileSpan,-M_PI + (tileID.y+1)*tileSpan));
+
+    AcceptAllDelegate acceptAll;
+    std::vector<VectorObjectRef> features;
+    VectorTilePBFParser parser(&tileData,&acceptAll,nullptr,std::string(),std::set<std::string>(),tileData.vecObjsByStyle,
+                               false,false,&features);
+    if (!parser.parse((const uint8_t *)tileBytes.data(),tileBytes.size()))
+        features.clear();
+
+    return features;
+}
+
+}
+}
@@ -0,0 +1,195 @@
+/*  BenchFixtures.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdint>
+#import <random>
+#import <string>
+#import <vector>
+#import "WhirlyVector.h"
+#import "VectorData.h"
+#import "DictionaryC.h"
+#import "MapboxVectorStyleSetC.h"
+#import "SceneRenderer.h"
+#import "BasicDrawableBuilder.h"
+
+namespace WhirlyKit
+{
+namespace Bench
+{
+
+/// Random numbers that come out the same on every platform
+class FixtureRandom
+{
+public:
+    FixtureRandom(uint32_t seed) : gen(seed) { }
+
+    /// Uniform in [0,1)
+    double uniform() { return (gen() >> 5) * (1.0 / 134217728.0); }
+    /// Uniform in [minVal,maxVal)
+    double uniform(double minVal,double maxVal) { return minVal + (maxVal - minVal) * uniform(); }
+    /// Integer in [0,num)
+    int index(int num) { return (int)(gen() % (uint32_t)num); }
+
+protected:
+    std::mt19937 gen;
+};
+
+/// Contents of a file in the fixtures directory
+std::string LoadFixture(const std::string &name);
+
+/// Parse a JSON object into a dictionary, the way the platforms hand styles to the core
+MutableDictionaryCRef ParseJSONDictionary(const std::string &json);
+
+/** A drawable that never touches a renderer.
+    Starts out the way BasicDrawableBuilder sets them up.
+  */
+class HeadlessDrawable : public BasicDrawable
+{
+public:
+    HeadlessDrawable(const std::string &name);
+
+    virtual void setupForRenderer(const RenderSetupInfo *,Scene *) override { }
+    virtual void teardownForRenderer(const RenderSetupInfo *,Scene *,RenderTeardownInfoRef) override { }
+
+    // What the builder made, kept where the renderers keep it
+    std::vector<Eigen::Vector3f> points;
+    std::vector<Triangle> tris;
+};
+
+/// Builds headless drawables, so the geometry code runs all the way through
+class HeadlessDrawableBuilder : public BasicDrawableBuilder
+{
+public:
+    HeadlessDrawableBuilder(const std::string &name,Scene *scene);
+
+    virtual int addAttribute(BDAttributeDataType dataType,StringIdentity nameID,int slot=-1,int numThings=-1) override;
+    virtual BasicDrawableRef getDrawable() override;
+};
+
+/** Renderer with nothing behind it.
+    It has a framebuffer size and scale for the layout and selection code,
+    and makes headless basic drawables.  Everything else it can't make.
+  */
+class HeadlessRenderer : public SceneRenderer
+{
+public:
+    HeadlessRenderer(int width,int height);
+
+    virtual Type getType() override { return RenderGLES; }
+    virtual const RenderSetupInfo *getRenderSetupInfo() const override { return &setupInfo; }
+    virtual BasicDrawableBuilderRef makeBasicDrawableBuilder(const std::string &name) const override;
+    virtual BasicDrawableInstanceBuilderRef makeBasicDrawableInstanceBuilder(const std::string &) const override { return nullptr; }
+    virtual BillboardDrawableBuilderRef makeBillboardDrawableBuilder(const std::string &) const override { return nullptr; }
+    virtual ScreenSpaceDrawableBuilderRef makeScreenSpaceDrawableBuilder(const std::string &) const override { return nullptr; }
+    virtual ParticleSystemDrawableBuilderRef makeParticleSystemDrawableBuilder(const std::string &) const override { return nullptr; }
+    virtual WideVectorDrawableBuilderRef makeWideVectorDrawableBuilder(const std::string &) const override { return nullptr; }
+    virtual RenderTargetRef makeRenderTarget() const override { return nullptr; }
+    virtual DynamicTextureRef makeDynamicTexture(const std::string &) const override { return nullptr; }
+
+protected:
+    RenderSetupInfo setupInfo;
+};
+
+/** Mapbox style set with the platform parts stubbed out.
+    Good enough to parse a style and run its filters, but it won't render text or textures.
+  */
+class HeadlessStyleSet : public MapboxVectorStyleSetImpl
+{
+public:
+    HeadlessStyleSet(Scene *scene,CoordSystem *coordSys,VectorStyleSettingsImplRef settings);
+
+    virtual SimpleIdentity makeCircleTexture(PlatformThreadInfo *inst,double radius,const RGBAColor &fillColor,
+                                             const RGBAColor &strokeColor,float strokeWidth,Point2f *circleSize) override;
+    virtual SimpleIdentity makeLineTexture(PlatformThreadInfo *inst,const std::vector<double> &dashComponents) override;
+    virtual LabelInfoRef makeLabelInfo(PlatformThreadInfo *inst,const std::vector<std::string> &fontNames,
+                                       float fontHeight,bool mergedSymbol) override;
+    virtual SingleLabelRef makeSingleLabel(PlatformThreadInfo *inst,const std::string &text) override;
+    virtual void addSelectionObject(SimpleIdentity selectID,const VectorObjectRef &vecObj,const ComponentObjectRef &compObj) override;
+    virtual double calculateTextWidth(PlatformThreadInfo *inInst,const LabelInfoRef &labelInfo,const std::string &testStr) override;
+    virtual ComponentObjectRef makeComponentObject(PlatformThreadInfo *inst,const Dictionary *desc) override;
+
+    /// The stubs don't keep any state
+    virtual bool platformIsThreadSafe() const override { return true; }
+};
+typedef std::shared_ptr<HeadlessStyleSet> HeadlessStyleSetRef;
+
+/// Kinds of polygon ring found in vector tiles
+typedef enum {RingConvex,RingStar,RingSelfIntersecting,RingDuplicatePoints} RingKind;
+
+/// Rings of the given kind with 3 to maxPoints points, about tile sized features in local coordinates
+std::vector<VectorRing> MakeRings(RingKind kind,int numRings,int maxPoints,uint32_t seed);
+
+/// One Mapbox Vector Tile layer to encode
+struct MVTLayerSpec
+{
+    std::string name;
+    int numPoints = 0;
+    int numLines = 0;
+    int numPolygons = 0;
+    // Attributes on each feature, with this many distinct values each
+    int numAttrs = 4;
+    int numValues = 8;
+    // Give every other big enough polygon a hole
+    bool holes = false;
+};
+
+/** Encode a synthetic Mapbox Vector Tile.
+    The layers follow the OpenMapTiles names the bundled style filters on.
+  */
+std::string MakeVectorTile(const std::vector<MVTLayerSpec> &layers,uint32_t seed);
+
+/// The standard tile used by the parse, filter and style benchmarks
+std::string MakeStandardVectorTile(int scale);
+
+/// A style that takes everything and builds nothing
+class AcceptStyle : public VectorStyleImpl
+{
+public:
+    virtual long long getUuid(PlatformThreadInfo *) override { return 1; }
+    virtual std::string getCategory(PlatformThreadInfo *) override { return std::string(); }
+    virtual bool geomAdditive(PlatformThreadInfo *) override { return false; }
+    virtual void buildObjects(PlatformThreadInfo *,const std::vector<VectorObjectRef> &,const VectorTileDataRef &,
+                              const Dictionary *,const CancelFunction &) override { }
+};
+
+/// Every feature in every layer goes to the one style, good for timing the parser alone
+class AcceptAllDelegate : public VectorStyleDelegateImpl
+{
+public:
+    AcceptAllDelegate() : style(std::make_shared<AcceptStyle>()) { }
+
+    virtual std::vector<VectorStyleImplRef> stylesForFeature(PlatformThreadInfo *,const Dictionary &,
+                                                             const QuadTreeIdentifier &,const std::string &) override
+    {
+        return std::vector<VectorStyleImplRef> { style };
+    }
+    virtual bool layerShouldDisplay(PlatformThreadInfo *,const std::string &,const QuadTreeNew::Node &) override { return true; }
+    virtual VectorStyleImplRef styleForUUID(PlatformThreadInfo *,long long) override { return style; }
+    virtual std::vector<VectorStyleImplRef> allStyles(PlatformThreadInfo *) override { return { style }; }
+    virtual VectorStyleImplRef backgroundStyle(PlatformThreadInfo *) const override { return VectorStyleImplRef(); }
+    virtual RGBAColorRef backgroundColor(PlatformThreadInfo *,double) override { return RGBAColorRef(); }
+
+protected:
+    VectorStyleImplRef style;
+};
+
+/// Decode every feature in a tile, without any styles involved
+std::vector<VectorObjectRef> DecodeVectorTile(const std::string &tileBytes,const QuadTreeIdentifier &tileID);
+
+}
+}
@@ -0,0 +1,571 @@
+/*  BenchGeoJSON.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdio>
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "GeoJSONStreamParser.h"
+#import "libjson.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// The libjson based parser VectorParseGeoJSON used to be, kept as a baseline
+namespace LibJSONBaseline
+{
+
+using namespace libjson;
+
+// Parse properties out of a node
+bool VectorParseProperties(JSONNode node,const MutableDictionaryRef &dict)
+{
+    for (JSONNode::const_iterator it = node.begin();
+         it != node.end(); ++it)
+    {
+        json_string name = it->name();
+        if (!name.empty())
+        {
+            switch (it->type())
+            {
+                case JSON_STRING:
+                {
+                    json_string val = it->as_string();
+                    dict->setString(name,val);
+                }
+                    break;
+                case JSON_NUMBER:
+                {
+                    double val = it->as_float();
+                    dict->setDouble(name, val);
+                }
+                    break;
+                case JSON_BOOL:
+                {
+                    bool val = it->as_bool();
+                    dict->setInt(name, (int)val);
+                }
+                    break;
+            }
+        }
+    }
+    
+    return true;
+}
+    
+// Parse coordinate list out of a node
+bool VectorParseCoordinates(JSONNode node,VectorRing &pts, bool subCall=false)
+{
+    for (JSONNode::const_iterator it = node.begin();
+         it != node.end(); ++it)
+    {
+        if (it->type() == JSON_ARRAY)
+        {
+            if (!VectorParseCoordinates(*it, pts, true))
+                return false;
+            continue;
+        }
+        
+        // We're expecting two numbers here
+        if (it->type() == JSON_NUMBER)
+        {
+            if (node.size() < 2)
+                return false;
+            
+            const auto lon = (float)it->as_float();  ++it;
+            const auto lat = (float)it->as_float();
+            pts.push_back(GeoCoord::CoordFromDegrees(lon,lat));
+            
+            // There might be a Z value or even other junk.  We just want the first two coordinates
+            //  in this particular case.
+            if (subCall)
+                return true;
+            
+            continue;
+        }
+        
+        // Got something unexpected
+        return false;
+    }
+    
+    return true;
+}
+
+// Parse geometry out of a node
+bool VectorParseGeometry(JSONNode node,ShapeSet &shapes)
+{
+    // Let's look for type and coordinates
+    JSONNode::const_iterator typeIt = node.end();
+    JSONNode::const_iterator coordIt = node.end();
+    JSONNode::const_iterator geomCollectIt = node.end();
+    for (JSONNode::const_iterator it = node.begin();
+         it != node.end(); ++it)
+    {
+        if (!it->name().compare("type"))
+            typeIt = it;
+        else if (!it->name().compare("coordinates"))
+            coordIt = it;
+        else if (!it->name().compare("geometries"))
+            geomCollectIt = it;
+    }
+    
+    if (typeIt == node.end())
+        return false;
+    
+    json_string type = typeIt->as_string();
+    if (!type.compare("Point"))
+    {
+        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
+            return false;
+
+        VectorPointsRef pts = VectorPoints::createPoints();
+        if (!VectorParseCoordinates(*coordIt,pts->pts))
+            return false;
+        pts->initGeoMbr();
+        shapes.insert(pts);
+        
+        return true;
+    } else if (!type.compare("LineString"))
+    {
+        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
+            return false;
+        
+        VectorLinearRef lin = VectorLinear::createLinear();
+        if (!VectorParseCoordinates(*coordIt,lin->pts))
+            return false;
+        lin->initGeoMbr();
+        shapes.insert(lin);
+
+        return true;
+    } else if (!type.compare("Polygon"))
+    {
+        // This should be an array of array of coordinates
+        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
+            return false;
+        VectorArealRef ar = VectorAreal::createAreal();
+        int numLoops = 0;
+        for (JSONNode::const_iterator coordEntryIt = coordIt->begin();
+             coordEntryIt != coordIt->end(); ++coordEntryIt, numLoops++)
+        {
+            if (coordEntryIt->type() != JSON_ARRAY)
+                return false;
+        
+            ar->loops.resize(numLoops+1);
+            if (!VectorParseCoordinates(*coordEntryIt,ar->loops[numLoops]))
+                return false;
+        }
+        
+        ar->initGeoMbr();
+        shapes.insert(ar);
+        
+        return true;
+    } else if (!type.compare("MultiPoint"))
+    {
+        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
+            return false;
+        
+        VectorPointsRef pts = VectorPoints::createPoints();
+        if (!VectorParseCoordinates(*coordIt,pts->pts))
+            return false;
+        pts->initGeoMbr();
+        shapes.insert(pts);
+        
+        return true;        
+    } else if (!type.compare("MultiLineString"))
+    {
+        // This should be an array of array of coordinates
+        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
+            return false;
+        for (JSONNode::const_iterator coordEntryIt = coordIt->begin();
+             coordEntryIt != coordIt->end(); ++coordEntryIt)
+        {
+            if (coordEntryIt->type() != JSON_ARRAY)
+                return false;
+            
+            VectorLinearRef lin = VectorLinear::createLinear();
+            if (!VectorParseCoordinates(*coordEntryIt, lin->pts))
+                return false;
+            lin->initGeoMbr();
+            shapes.insert(lin);
+        }
+        
+        return true;
+    } else if (!type.compare("MultiPolygon"))
+    {
+        // This should be an array of array of coordinates
+        if (coordIt == node.end() ||  coordIt->type() != JSON_ARRAY)
+            return false;
+
+        for (JSONNode::const_iterator polyIt = coordIt->begin();
+             polyIt != coordIt->end(); ++polyIt)
+        {
+            VectorArealRef ar = VectorAreal::createAreal();
+            int numLoops = 0;
+            for (JSONNode::const_iterator coordEntryIt = polyIt->begin();
+                 coordEntryIt != polyIt->end(); ++coordEntryIt, numLoops++)
+            {
+                if (coordEntryIt->type() != JSON_ARRAY)
+                    return false;
+                
+                ar->loops.resize(numLoops+1);
+                if (!VectorParseCoordinates(*coordEntryIt,ar->loops[numLoops]))
+                    return false;
+            }
+            
+            ar->initGeoMbr();
+            shapes.insert(ar);
+        }
+        
+        return true;        
+    } else if (!type.compare("GeometryCollection"))
+    {
+        if (geomCollectIt == node.end() || geomCollectIt->type() != JSON_ARRAY)
+            return false;
+        for (JSONNode::const_iterator geomIt = geomCollectIt->begin();
+             geomIt != geomCollectIt->end(); ++geomIt)
+            if (!VectorParseGeometry(*geomIt,shapes))
+                return false;
+        
+        return true;
+    }
+    
+    return false;
+}
+    
+// Parse a single feature
+bool VectorParseFeature(JSONNode node,ShapeSet &shapes)
+{
+    JSONNode::const_iterator typeIt = node.end();
+    JSONNode::const_iterator geomIt = node.end();
+    JSONNode::const_iterator propIt = node.end();
+    
+    for (JSONNode::const_iterator it = node.begin();
+         it != node.end(); ++it)
+    {
+        if (!it->name().compare("type"))
+            typeIt = it;
+        else if (!it->name().compare("geometry"))
+            geomIt = it;
+        else if (!it->name().compare("properties"))
+            propIt = it;
+    }
+    if (geomIt == node.end())
+        return false;
+    
+    // Parse the geometry
+    ShapeSet newShapes;
+    if (!VectorParseGeometry(*geomIt, newShapes))
+        return false;
+
+    // Properties are optional
+    if (propIt != node.end()) {
+        MutableDictionaryRef properties = MutableDictionaryMake();
+        VectorParseProperties(*propIt, properties);
+        // Apply the properties to the geometry
+        for (const auto & newShape : newShapes)
+            newShape->setAttrDict(properties);
+    }
+    
+    shapes.insert(newShapes.begin(), newShapes.end());
+    return true;
+}
+
+// Parse an array of features
+bool VectorParseFeatures(JSONNode node,ShapeSet &shapes)
+{
+    for (JSONNode::const_iterator it = node.begin();it != node.end(); ++it) {
+        // Not sure what this would be
+        if (it->type() != JSON_NODE)
+            return false;
+        if (!VectorParseFeature(*it, shapes)) {
+            return false;
+        }
+    }
+    
+    return true;
+}
+
+// Recursively parse a feature collection
+bool VectorParseTopNode(JSONNode node,ShapeSet &shapes,JSONNode &crs)
+{
+    JSONNode::const_iterator typeIt = node.end();
+    JSONNode::const_iterator featIt = node.end();
+    
+    for (JSONNode::const_iterator it = node.begin();
+         it != node.end(); ++it)
+    {
+        if (!it->name().compare("type"))
+            typeIt = it;
+        else if (!it->name().compare("features"))
+            featIt = it;
+        else if (!it->name().compare("crs"))
+            crs = *it;
+    }
+    if (typeIt == node.end())
+        return false;
+    
+    json_string type;
+    type = typeIt->as_string();
+    if (!type.compare("FeatureCollection"))
+    {
+        // Expecting a features node
+        if (featIt == node.end() || featIt->type() != JSON_ARRAY)
+            return false;
+        return VectorParseFeatures(*featIt,shapes);
+    } else if (!type.compare("Feature"))
+    {
+        return VectorParseFeature(node,shapes);
+    } else {
+        // Only last try to do raw geometry
+        return VectorParseGeometry(node, shapes);
+    }
+
+    return false;
+}
+
+// Parse the name out of a CRS in a GeoJSON file
+bool VectorParseGeoJSONCRS(JSONNode node,std::string &crsName)
+{
+    JSONNode::const_iterator typeIt = node.end();
+    JSONNode::const_iterator propIt = node.end();
+    
+    for (JSONNode::const_iterator it = node.begin();
+         it != node.end(); ++it)
+    {
+        if (!it->name().compare("type"))
+            typeIt = it;
+        else if (!it->name().compare("properties"))
+            propIt = it;
+    }
+    if (typeIt == node.end())
+        return false;
+    
+    json_string type;
+    type = typeIt->as_string();
+    if (!type.compare("name"))
+    {
+        // Expecting a features node
+        if (propIt == node.end() || propIt->type() != JSON_NODE)
+            return false;
+        
+        for (JSONNode::const_iterator it = propIt->begin(); it != propIt->end(); ++it)
+        {
+            if (!it->name().compare("name"))
+            {
+                if (it->type() != JSON_STRING)
+                    return false;
+                crsName = it->as_string();
+                return true;
+            }
+        }
+    } else
+        return false;
+    
+    return false;
+}
+    
+// The whole of the old path: build the tree, then walk it
+bool VectorParseGeoJSON(ShapeSet &shapes,const std::string &str,std::string &crs)
+{
+    json_string json = str;
+    JSONNode topNode = libjson::parse(json);
+
+    JSONNode crsNode;
+    if (!VectorParseTopNode(topNode,shapes,crsNode))
+    {
+//        NSLog(@"Failed to parse JSON in VectorParseGeoJSON");
+        return false;
+    }
+
+    std::string crsName;
+    if (VectorParseGeoJSONCRS(crsNode,crsName))
+    {
+        if (!crsName.empty())
+            crs = crsName;
+    }
+    
+    return true;
+}
+
+}
+
+void AppendCoord(std::string &json,FixtureRandom &rand,double lon,double lat)
+{
+    char buf[64];
+    snprintf(buf,sizeof(buf),"[%.6f,%.6f]",lon + rand.uniform(-0.01,0.01),lat + rand.uniform(-0.01,0.01));
+    json += buf;
+}
+
+void AppendRing(std::string &json,FixtureRandom &rand,double lon,double lat,int numPts)
+{
+    json += "[";
+    for (int ii=0;ii<numPts;ii++)
+    {
+        if (ii > 0)
+            json += ",";
+        AppendCoord(json,rand,lon,lat);
+    }
+    json += "]";
+}
+
+// A feature collection that looks like an export from a GIS, returns the number of shapes we should get
+int MakeGeoJSON(std::string &json,int numFeatures,uint32_t seed)
+{
+    FixtureRandom rand(seed);
+    int numShapes = 0;
+    json = "{\"type\":\"FeatureCollection\",\"crs\":{\"type\":\"name\",\"properties\":{\"name\":\"urn:ogc:def:crs:OGC:1.3:CRS84\"}},\n\"features\":[\n";
+    for (int ii=0;ii<numFeatures;ii++)
+    {
+        const double lon = rand.uniform(-170.0,170.0), lat = rand.uniform(-80.0,80.0);
+        if (ii > 0)
+            json += ",\n";
+        json += "{\"type\":\"Feature\",\"id\":" + std::to_string(ii) + ",\"properties\":{\"name\":\"Feature \\\"" +
+                std::to_string(ii) + "\\\" caf\\u00e9\",\"rank\":" + std::to_string(rand.index(20)) +
+                ",\"area\":" + std::to_string(rand.uniform(0.0,1e6)) + ",\"visible\":true,\"note\":null," +
+                "\"tags\":{\"source\":\"survey\",\"levels\":[1,2,3]}},\"geometry\":{";
+        switch (rand.index(4))
+        {
+            case 0:
+                json += "\"type\":\"Point\",\"coordinates\":";
+                AppendCoord(json,rand,lon,lat);
+                numShapes++;
+                break;
+            case 1:
+                json += "\"type\":\"LineString\",\"coordinates\":";
+                AppendRing(json,rand,lon,lat,2 + rand.index(40));
+                numShapes++;
+                break;
+            case 2:
+                json += "\"type\":\"Polygon\",\"coordinates\":[";
+                AppendRing(json,rand,lon,lat,5 + rand.index(60));
+                json += "]";
+                numShapes++;
+                break;
+            default:
+            {
+                // Coordinates first, which is legal and happens
+                const int numPolys = 1 + rand.index(3);
+                json += "\"coordinates\":[";
+                for (int ip=0;ip<numPolys;ip++)
+                {
+                    json += ip > 0 ? ",[" : "[";
+                    AppendRing(json,rand,lon,lat,5 + rand.index(30));
+                    json += ",";
+                    AppendRing(json,rand,lon,lat,4);
+                    json += "]";
+                }
+                json += "],\"type\":\"MultiPolygon\"";
+                numShapes += numPolys;
+            }
+                break;
+        }
+        json += "}}";
+    }
+    json += "\n]}\n";
+
+    return numShapes;
+}
+
+}
+
+WGBENCH_SUITE(geojson)
+{
+    std::string json;
+    const int numFeatures = runner.size(100000,3000);
+    const int expectShapes = MakeGeoJSON(json,numFeatures,53);
+    const double megabytes = json.size() / (1024.0 * 1024.0);
+
+    // What the old parser did before it even looked at a feature
+    runner.run("geojson","libjson/tree-only",megabytes,"MB",[&]{
+        const JSONNode top = libjson::parse(json);
+        DoNotOptimize(top.size());
+    });
+
+    // The whole old path, tree and walk, which in-memory parsing has to beat
+    int libjsonShapes = 0;
+    Result *libjsonResult = runner.run("geojson","libjson/full",megabytes,"MB",[&]{
+        ShapeSet shapes;
+        std::string libjsonCRS;
+        LibJSONBaseline::VectorParseGeoJSON(shapes,json,libjsonCRS);
+        libjsonShapes = (int)shapes.size();
+    });
+    if (libjsonResult && libjsonShapes != expectShapes)
+        runner.fail("geojson","libjson parse made " + std::to_string(libjsonShapes) + " shapes, expected " + std::to_string(expectShapes));
+
+    int serialShapes = 0;
+    std::string crs;
+    Result *serialResult = runner.run("geojson","stream/serial",megabytes,"MB",[&]{
+        ShapeSet shapes;
+        crs.clear();
+        VectorParseGeoJSON(shapes,json,crs);
+        serialShapes = (int)shapes.size();
+    });
+    runner.metric(serialResult,"shapes",serialShapes);
+    if (serialResult && serialShapes != expectShapes)
+        runner.fail("geojson","parsed " + std::to_string(serialShapes) + " shapes, expected " + std::to_string(expectShapes));
+    if (serialResult && crs != "urn:ogc:def:crs:OGC:1.3:CRS84")
+        runner.fail("geojson","didn't pick up the crs, got '" + crs + "'");
+    if (libjsonResult && serialResult)
+        runner.metric(serialResult,"vs-libjson",libjsonResult->secPerIter / serialResult->secPerIter);
+
+    // The same thing with the features parsed on a pool
+    int parallelShapes = 0;
+    const auto pool = std::make_shared<TaskPool>(runner.numThreads);
+    Result *parallelResult = runner.run("geojson","stream/parallel",megabytes,"MB",[&]{
+        ShapeSet shapes;
+        GeoJSONStreamParser parser([&](const VectorObjectRef &batch)
+        {
+            shapes.insert(batch->shapes.begin(),batch->shapes.end());
+            return true;
+        });
+        parser.setPool(pool);
+        parser.parse(json);
+        parallelShapes = (int)shapes.size();
+    });
+    if (parallelResult && parallelShapes != expectShapes)
+        runner.fail("geojson","parallel parse made " + std::to_string(parallelShapes) + " shapes, expected " + std::to_string(expectShapes));
+
+    // Straight from a file, looking at one batch at a time like a loader would
+    const std::string fileName = std::string(P_tmpdir) + "/wgbench_features.geojson";
+    if (FILE *fp = fopen(fileName.c_str(),"wb"))
+    {
+        fwrite(json.data(),1,json.size(),fp);
+        fclose(fp);
+
+        size_t maxBatch = 0;
+        int fileShapes = 0;
+        Result *fileResult = runner.run("geojson","stream/file-batches",megabytes,"MB",[&]{
+            fileShapes = 0;
+            GeoJSONStreamParser parser([&](const VectorObjectRef &batch)
+            {
+                maxBatch = std::max(maxBatch,batch->shapes.size());
+                fileShapes += (int)batch->shapes.size();
+                return true;
+            });
+            parser.setBatchSize(500);
+            parser.parseFile(fileName);
+        });
+        runner.metric(fileResult,"max-batch-shapes",(double)maxBatch);
+        if (fileResult && fileShapes != expectShapes)
+            runner.fail("geojson","file parse made " + std::to_string(fileShapes) + " shapes, expected " + std::to_string(expectShapes));
+
+        remove(fileName.c_str());
+    }
+}
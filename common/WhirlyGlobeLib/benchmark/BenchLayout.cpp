@@ -0,0 +1,263 @@
+/*  BenchLayout.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "LayoutManager.h"
+#import "OverlapHelper.h"
+#import "MaplyView.h"
+#import "SphericalMercator.h"
+#import "Scene.h"
+#import "TaskPool.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// Runs the placement rules without building drawables, which needs a real renderer
+class BenchLayoutManager : public LayoutManager
+{
+public:
+    // Lay everything out for the view and return how many objects made it
+    int runRules(const ViewStateRef &viewState)
+    {
+        std::vector<ClusterEntry> clusterEntries;
+        std::vector<ClusterGenerator::ClusterClassParams> clusterParams;
+        ChangeSet changes;
+        runLayoutRules(nullptr,viewState,layoutObjects,std::unordered_set<std::string>(),clusterEntries,clusterParams,changes);
+        discardChanges(changes);
+
+        // This is what building the drawables does to the entries
+        int placed = 0;
+        for (const auto &entry : layoutObjects)
+        {
+            placed += entry->newEnable ? 1 : 0;
+            entry->currentEnable = entry->newEnable;
+            entry->currentCluster = entry->newCluster;
+            entry->changed = false;
+        }
+        return placed;
+    }
+
+    // Where a placed object is, for dropping something else on top of it
+    bool findPlaced(Point3d &worldLoc) const
+    {
+        for (const auto &entry : layoutObjects)
+            if (entry->currentEnable)
+            {
+                worldLoc = entry->obj.getWorldLoc();
+                return true;
+            }
+        return false;
+    }
+
+    // True if the most important object made it
+    bool mostImportantPlaced() const
+    {
+        const LayoutObjectEntry *best = nullptr;
+        for (const auto &entry : layoutObjects)
+            if (!best || entry->obj.importance > best->obj.importance)
+                best = entry.get();
+        return best && best->currentEnable;
+    }
+};
+
+}
+
+WGBENCH_SUITE(layout)
+{
+    const int frameWidth = 2048, frameHeight = 1536;
+    SphericalMercatorDisplayAdapter coordAdapter(0.0,GeoCoord::CoordFromDegrees(-180.0,-85.05113),GeoCoord::CoordFromDegrees(180.0,85.05113));
+    Scene scene(&coordAdapter);
+    HeadlessRenderer renderer(frameWidth,frameHeight);
+    renderer.setScene(&scene);
+    Maply::MapView mapView(&coordAdapter);
+
+    // Labels scattered around the view, more than will fit
+    {
+        const int numLabels = runner.size(50000,2000);
+        const int numFrames = 40;
+        const double viewHeight = 0.01, spread = 0.02;
+
+        const auto makeLabels = [&](BenchLayoutManager &layoutManager)
+        {
+            layoutManager.setScene(&scene);
+            layoutManager.setRenderer(&renderer);
+            FixtureRandom rand(17);
+            std::vector<LayoutObject> labels(numLabels);
+            for (auto &label : labels)
+            {
+                label.setWorldLoc(coordAdapter.localToDisplay(Point3d(rand.uniform(-spread,spread),rand.uniform(-spread,spread),0.0)));
+                label.setLayoutSize(Point2d(rand.uniform(40.0,160.0),rand.uniform(12.0,20.0)),Point2d(0.0,0.0));
+                label.importance = (float)rand.uniform(0.0,1000.0);
+            }
+            layoutManager.addLayoutObjects(std::move(labels));
+        };
+
+        // Pan slowly across, about a pixel a frame, the way a user drags the map
+        const auto viewForFrame = [&](int frame)
+        {
+            mapView.setLoc(Point3d(-0.002 + (frame % numFrames) * 0.000005,0.0,viewHeight));
+            return std::make_shared<Maply::MapViewState>(&mapView,&renderer);
+        };
+
+        int fullPlaced = 0, incPlaced = 0;
+        BenchLayoutManager fullLayout;
+        makeLabels(fullLayout);
+        int frame = 0;
+        Result *fullResult = runner.run("layout","labels/full",numLabels,"labels",[&]{
+            fullPlaced = fullLayout.runRules(viewForFrame(frame++));
+        });
+        runner.metric(fullResult,"placed",fullPlaced);
+
+        BenchLayoutManager incLayout;
+        makeLabels(incLayout);
+        incLayout.setIncrementalLayout(true);
+        frame = 0;
+        incLayout.runRules(viewForFrame(frame++));
+        Result *incResult = runner.run("layout","labels/incremental",numLabels,"labels",[&]{
+            incPlaced = incLayout.runRules(viewForFrame(frame++));
+        });
+        runner.metric(incResult,"placed",incPlaced);
+
+        if (fullResult && fullPlaced == 0)
+            runner.fail("layout","no labels were placed");
+
+        // Something more important showing up on top of a kept label has to win
+        Point3d keptLoc;
+        if (incResult && incLayout.findPlaced(keptLoc))
+        {
+            LayoutObject label;
+            label.setWorldLoc(keptLoc);
+            label.setLayoutSize(Point2d(400.0,100.0),Point2d(0.0,0.0));
+            label.acceptablePlacement = WhirlyKitLayoutPlacementCenter;
+            label.importance = 10000.0;
+            std::vector<LayoutObject> labels { label };
+            incLayout.addLayoutObjects(std::move(labels));
+            incLayout.runRules(viewForFrame(frame));
+            if (!incLayout.mostImportantPlaced())
+                runner.fail("layout","incremental layout kept a label over a more important one");
+        }
+
+        fullLayout.teardown();
+        incLayout.teardown();
+    }
+
+    // Synthetic marker layers, clustered serially and in tiles on a pool
+    {
+        const int numMarkers = runner.size(20000,2000);
+        const Mbr screenMbr(Point2f(0.0,0.0),Point2f(frameWidth,frameHeight));
+        const Point2d markerSize(32.0,32.0);
+        const auto pool = std::make_shared<TaskPool>(runner.numThreads);
+
+        // Where the markers go: spread out, in a dozen clumps, or mostly on one spot
+        enum Distribution { Uniform, Clumped, HotSpot };
+        const auto makeMarkers = [&](Distribution dist,std::vector<LayoutObjectEntryRef> &entries,std::vector<Point2dVector> &pts)
+        {
+            FixtureRandom rand(23);
+            std::vector<Point2d> clumps;
+            for (int ii=0;ii<12;ii++)
+                clumps.push_back(Point2d(rand.uniform(0.0,frameWidth),rand.uniform(0.0,frameHeight)));
+            for (int ii=0;ii<numMarkers;ii++)
+            {
+                Point2d center;
+                if (dist == Uniform || (dist == HotSpot && rand.uniform() < 0.1))
+                    center = Point2d(rand.uniform(0.0,frameWidth),rand.uniform(0.0,frameHeight));
+                else
+                {
+                    const Point2d &clump = dist == HotSpot ? clumps[0] : clumps[rand.index(clumps.size())];
+                    const double radius = 300.0 * rand.uniform() * rand.uniform(), angle = rand.uniform(0.0,2*M_PI);
+                    center = clump + Point2d(radius*cos(angle),radius*sin(angle));
+                }
+                // The layout manager only clusters what's on screen
+                center = Point2d(std::min(std::max(center.x(),16.0),frameWidth-16.0),
+                                 std::min(std::max(center.y(),16.0),frameHeight-16.0));
+                entries.push_back(std::make_shared<LayoutObjectEntry>(Identifiable::genId()));
+                pts.push_back(Point2dVector { center + Point2d(-16,-16), center + Point2d(16,-16),
+                                              center + Point2d(16,16), center + Point2d(-16,16) });
+            }
+        };
+
+        // Each marker's cluster, or -1, after resolving.  Empty if a marker got lost along the way.
+        const auto cluster = [&](const std::vector<LayoutObjectEntryRef> &entries,const std::vector<Point2dVector> &pts,
+                                 bool tiled,TaskPool *clusterPool,int &numClusters)
+        {
+            volatile bool cancel = false;
+            ClusterHelper helper(screenMbr,10,60,1.0,markerSize);
+            helper.addObjects(entries,pts,tiled,clusterPool,cancel);
+            helper.resolveClusters(cancel);
+
+            std::vector<int> owner(helper.simpleObjects.size(),-1);
+            std::vector<int> uses(helper.simpleObjects.size(),0);
+            numClusters = 0;
+            for (unsigned int ci=0;ci<helper.clusterObjects.size();ci++)
+            {
+                const auto &clusterObj = helper.clusterObjects[ci];
+                if (!clusterObj.children.empty())
+                    numClusters++;
+                for (int child : clusterObj.children)
+                {
+                    owner[child] = ci;
+                    uses[child]++;
+                }
+            }
+            bool consistent = helper.simpleObjects.size() == entries.size();
+            for (unsigned int ii=0;ii<uses.size() && consistent;ii++)
+                if (uses[ii] != (helper.simpleObjects[ii].parentObject < 0 ? 0 : 1) ||
+                    helper.simpleObjects[ii].objEntry != entries[ii])
+                    consistent = false;
+            return consistent ? owner : std::vector<int>();
+        };
+
+        const std::pair<Distribution,std::string> dists[] = { {Uniform,"uniform"}, {Clumped,"clumped"}, {HotSpot,"hotspot"} };
+        for (const auto &dist : dists)
+        {
+            std::vector<LayoutObjectEntryRef> entries;
+            std::vector<Point2dVector> pts;
+            makeMarkers(dist.first,entries,pts);
+
+            int serialClusters = 0, tiledClusters = 0;
+            std::vector<int> serialOwners, tiledOwners;
+            Result *serialResult = runner.run("layout","cluster/" + dist.second + "/serial",numMarkers,"markers",[&]{
+                serialOwners = cluster(entries,pts,false,nullptr,serialClusters);
+            });
+            runner.metric(serialResult,"clusters",serialClusters);
+            if (serialResult && serialOwners.empty())
+                runner.fail("layout","serial clustering lost track of a marker (" + dist.second + ")");
+
+            Result *tiledResult = runner.run("layout","cluster/" + dist.second + "/tiled",numMarkers,"markers",[&]{
+                tiledOwners = cluster(entries,pts,true,pool.get(),tiledClusters);
+            });
+            runner.metric(tiledResult,"clusters",tiledClusters);
+            if (tiledResult)
+            {
+                if (tiledOwners.empty())
+                    runner.fail("layout","tiled clustering lost track of a marker (" + dist.second + ")");
+
+                // The groups can't depend on how many threads did the work, or whether there were any
+                int inlineClusters = 0;
+                if (cluster(entries,pts,true,nullptr,inlineClusters) != tiledOwners)
+                    runner.fail("layout","tiled clustering isn't deterministic (" + dist.second + ")");
+            }
+        }
+    }
+
+    scene.teardown(nullptr);
+}
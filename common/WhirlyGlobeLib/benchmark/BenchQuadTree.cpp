@@ -0,0 +1,256 @@
+/*  BenchQuadTree.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "QuadTreeNew.h"
+#import "TaskPool.h"
+#import <sstream>
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+/** Quad tree over the unit square, seen by a tilted camera.
+    Importance is the screen area of the node in pixels, which is
+    roughly what the display controller does with real view matrices.
+  */
+class BenchQuadTree : public QuadTreeNew
+{
+public:
+    BenchQuadTree(int maxLevel) : QuadTreeNew(MbrD(Point2d(0.0,0.0),Point2d(1.0,1.0)),0,maxLevel) { }
+
+    void setView(double inEyeX,double inEyeY,double inHeight)
+    {
+        eyeX = inEyeX;  eyeY = inEyeY;  height = inHeight;
+    }
+
+    virtual double importance(const Node &node) override
+    {
+        Point2d pts[4];
+        if (!project(node,pts))
+            return 0.0;
+
+        double area = 0.0;
+        for (int ii=0;ii<4;ii++)
+        {
+            const Point2d &a = pts[ii], &b = pts[(ii+1)%4];
+            area += a.x()*b.y() - b.x()*a.y();
+        }
+        return std::abs(area) / 2.0;
+    }
+
+    virtual bool visible(const Node &node) override
+    {
+        Point2d pts[4];
+        return project(node,pts);
+    }
+
+    // Nothing but math on the view parameters
+    virtual bool importanceIsThreadSafe() const override { return true; }
+
+    // Incremental mode needs a sphere and where it lands on the screen
+    virtual bool nodeBounds(const Node &node,Point3d &center,double &radius) override
+    {
+        const MbrD mbr = generateMbrForNode(node);
+        const Point2d mid = mbr.mid();
+        center = Point3d(mid.x(),mid.y(),0.0);
+        radius = mbr.span().norm() / 2.0;
+        return true;
+    }
+
+    virtual bool nodeFootprint(const Point3d &center,double radius,Footprint &footprint) override
+    {
+        const double dx = center.x() - eyeX, dy = center.y() - eyeY;
+        const double depth = std::max(height * 0.1,height + tilt * dy);
+        footprint.numCopies = 0;
+        return footprint.addCopy(Point3d(dx / depth * focal,dy / depth * focal,radius / depth * focal));
+    }
+
+protected:
+    // Project the corners to the screen.  False if it's entirely off screen.
+    bool project(const Node &node,Point2d pts[4]) const
+    {
+        const MbrD mbr = generateMbrForNode(node);
+        const Point2d corners[4] = {mbr.ll(),Point2d(mbr.ur().x(),mbr.ll().y()),mbr.ur(),Point2d(mbr.ll().x(),mbr.ur().y())};
+        Mbr screenMbr;
+        for (int ii=0;ii<4;ii++)
+        {
+            const double dx = corners[ii].x() - eyeX, dy = corners[ii].y() - eyeY;
+            // Tilted, so things further up the screen are further away
+            const double depth = std::max(height * 0.1,height + tilt * dy);
+            pts[ii] = Point2d(dx / depth * focal,dy / depth * focal);
+            screenMbr.addPoint(Point2f(pts[ii].x(),pts[ii].y()));
+        }
+        return screenMbr.overlaps(Mbr(Point2f(-screenX/2,-screenY/2),Point2f(screenX/2,screenY/2)));
+    }
+
+    double eyeX = 0.5, eyeY = 0.5, height = 0.01;
+    const double tilt = 0.5, focal = 1024.0;
+    const float screenX = 2048, screenY = 1536;
+};
+
+}
+
+// Camera path from the fixtures, one view update per line
+static std::vector<Point3d> LoadCameraPath(const std::string &name)
+{
+    std::vector<Point3d> path;
+    std::istringstream lines(LoadFixture(name));
+    std::string line;
+    while (std::getline(lines,line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        double t,x,y,height;
+        if (sscanf(line.c_str(),"%lf %lf %lf %lf",&t,&x,&y,&height) == 4)
+            path.push_back(Point3d(x,y,height));
+    }
+    return path;
+}
+
+WGBENCH_SUITE(quadtree)
+{
+    const int maxLevel = 18;
+    const int maxNodes = runner.size(512,128);
+    const int numViews = runner.size(16,4);
+    // A tile is worth loading when it covers about 256x256 pixels
+    const std::vector<double> minImportance(maxLevel+1,256.0*256.0);
+
+    // Camera positions zooming in across the square
+    FixtureRandom rand(3);
+    std::vector<Point3d> views;
+    for (int ii=0;ii<numViews;ii++)
+        views.push_back(Point3d(rand.uniform(0.2,0.8),rand.uniform(0.2,0.8),std::pow(0.5,1.0 + ii % 12)));
+
+    const auto runCoverage = [&](BenchQuadTree &tree,std::vector<QuadTreeNew::ImportantNodeSet> &results)
+    {
+        results.clear();
+        for (const auto &view : views)
+        {
+            tree.setView(view.x(),view.y(),view.z());
+            std::vector<double> maxRejected(maxLevel+1,0.0);
+            results.push_back(tree.calcCoverageImportance(minImportance,maxNodes,true,maxRejected));
+        }
+    };
+
+    std::vector<QuadTreeNew::ImportantNodeSet> serialNodes,parallelNodes;
+    BenchQuadTree serialTree(maxLevel);
+    Result *serialResult = runner.run("quadtree","coverage/serial",numViews,"views",[&]{
+        runCoverage(serialTree,serialNodes);
+    });
+
+    BenchQuadTree parallelTree(maxLevel);
+    parallelTree.setParallel(std::make_shared<TaskPool>(runner.numThreads),4);
+    runner.run("quadtree","coverage/parallel",numViews,"views",[&]{
+        runCoverage(parallelTree,parallelNodes);
+    });
+
+    if (!serialNodes.empty())
+    {
+        size_t total = 0;
+        for (const auto &nodes : serialNodes)
+            total += nodes.size();
+        runner.metric(serialResult,"nodes_per_view",(double)total / serialNodes.size());
+    }
+    if (!serialNodes.empty() && !parallelNodes.empty() && serialNodes != parallelNodes)
+        runner.fail("quadtree","parallel coverage differs from serial");
+
+    // The view updates a session actually produces, the case incremental mode is for
+    std::vector<Point3d> path = LoadCameraPath("camera_path.txt");
+    if (path.empty())
+    {
+        runner.fail("quadtree","couldn't read camera_path.txt");
+        return;
+    }
+    if (runner.quick)
+        path.resize(std::min(path.size(),(size_t)60));
+
+    // Each update works out what to load and unload, like the display controller does.
+    // We keep the tile set the deltas produce so the two modes can be compared.
+    std::vector<int> levelLoads;
+    const auto runReplay = [&](BenchQuadTree &tree,bool visibleMode,std::vector<QuadTreeNew::NodeSet> &tileSets)
+    {
+        tileSets.clear();
+        QuadTreeNew::ImportantNodeSet lastNodes;
+        QuadTreeNew::NodeSet tiles;
+        for (const auto &view : path)
+        {
+            tree.setView(view.x(),view.y(),view.z());
+            std::vector<double> maxRejected(maxLevel+1,0.0);
+            QuadTreeNew::ImportantNodeSet nodes;
+            if (visibleMode)
+                nodes = std::get<1>(tree.calcCoverageVisible(minImportance,maxNodes,levelLoads,false,maxRejected));
+            else
+                nodes = tree.calcCoverageImportance(minImportance,maxNodes,true,maxRejected);
+
+            QuadTreeNew::ImportantNodeSet toAdd,toUpdate;
+            QuadTreeNew::NodeSet toRemove;
+            QuadTreeNew::calcCoverageDelta(lastNodes,nodes,tree.getIncremental(),toAdd,toRemove,toUpdate);
+            for (const auto &node : toRemove)
+                tiles.erase(node);
+            for (const auto &node : toAdd)
+                tiles.insert(node);
+            tileSets.push_back(tiles);
+            lastNodes = std::move(nodes);
+        }
+    };
+
+    for (const bool visibleMode : {false,true})
+    {
+        const std::string prefix = visibleMode ? "replay-visible/" : "replay/";
+
+        std::vector<QuadTreeNew::NodeSet> fullTiles,incrementalTiles;
+        BenchQuadTree fullTree(maxLevel);
+        runner.run("quadtree",prefix + "full",path.size(),"updates",[&]{
+            runReplay(fullTree,visibleMode,fullTiles);
+        });
+
+        BenchQuadTree incrementalTree(maxLevel);
+        incrementalTree.setIncremental(true);
+        Result *incrementalResult = runner.run("quadtree",prefix + "incremental",path.size(),"updates",[&]{
+            // Start each run cold, the first update evaluates everything
+            incrementalTree.resetIncremental();
+            runReplay(incrementalTree,visibleMode,incrementalTiles);
+        });
+
+        if (!fullTiles.empty() && !incrementalTiles.empty())
+        {
+            int badFrames = 0;
+            for (unsigned int ii=0;ii<fullTiles.size();ii++)
+                if (fullTiles[ii] != incrementalTiles[ii])
+                    badFrames++;
+            runner.metric(incrementalResult,"updates_differ",badFrames);
+            if (badFrames > 0)
+                runner.fail("quadtree",prefix + "incremental tiles differ from full coverage in " + std::to_string(badFrames) + " updates");
+        }
+    }
+
+    // Visible coverage, the other mode the display controller uses
+    runner.run("quadtree","coverage/visible",numViews,"views",[&]{
+        for (const auto &view : views)
+        {
+            serialTree.setView(view.x(),view.y(),view.z());
+            std::vector<double> maxRejected(maxLevel+1,0.0);
+            auto result = serialTree.calcCoverageVisible(minImportance,maxNodes,levelLoads,false,maxRejected);
+            DoNotOptimize(std::get<1>(result).size());
+        }
+    });
+}
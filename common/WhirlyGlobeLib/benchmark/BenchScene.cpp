@@ -0,0 +1,304 @@
+/*  BenchScene.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <algorithm>
+#import <chrono>
+#import <thread>
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "ChangeRequest.h"
+#import "BasicDrawable.h"
+#import "DrawListBuilder.h"
+#import "MaplyView.h"
+#import "Scene.h"
+#import "SphericalMercator.h"
+#import "TaskPool.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// Does nothing, we're only timing the hand off
+class NoopChange : public ChangeRequest
+{
+public:
+    virtual void execute(Scene *,SceneRenderer *,View *) override { }
+};
+
+// The way Scene used to take changes: producers sort them into the lists under the
+//  same lock the renderer takes to pull them out
+class LockedChangeLists
+{
+public:
+    ~LockedChangeLists()
+    {
+        for (auto change : changeRequests)
+            delete change;
+        for (auto change : timedChangeRequests)
+            delete change;
+    }
+
+    void addChangeRequests(ChangeSet &newChanges)
+    {
+        std::lock_guard<std::mutex> guardLock(changeRequestLock);
+        for (ChangeRequest *change : newChanges) {
+            if (change && change->when > 0.0)
+                timedChangeRequests.insert(change);
+            else
+                changeRequests.push_back(change);
+        }
+        newChanges.clear();
+    }
+
+    int processChanges(TimeInterval now)
+    {
+        ChangeSet localChanges;
+        {
+            std::lock_guard<std::mutex> guardLock(changeRequestLock);
+            if (!timedChangeRequests.empty())
+            {
+                const auto beg = timedChangeRequests.begin();
+                auto end = beg;
+                while (end != timedChangeRequests.end() && (*end)->when <= now)
+                    ++end;
+                changeRequests.insert(changeRequests.end(),beg,end);
+                timedChangeRequests.erase(beg,end);
+            }
+            localChanges.swap(changeRequests);
+        }
+        for (auto change : localChanges)
+        {
+            if (change)
+                change->execute(nullptr,nullptr,nullptr);
+            delete change;
+        }
+        return (int)localChanges.size();
+    }
+
+protected:
+    std::mutex changeRequestLock;
+    ChangeSet changeRequests;
+    SortedChangeSet timedChangeRequests;
+};
+
+// Producers submit small batches while one thread processes them, like layer threads feeding the renderer.
+// Returns how long each submission took in microseconds, and the number of changes processed in received.
+template<typename Lists> static std::vector<double> TimeSubmissions(Lists &lists,int numProducers,int batchesPerProducer,
+                                                                    int batchSize,int &received)
+{
+    std::atomic<int> producersLeft(numProducers);
+    std::vector<std::vector<double>> latencies(numProducers);
+    received = 0;
+
+    std::vector<std::thread> producers;
+    for (int pp=0;pp<numProducers;pp++)
+    {
+        producers.emplace_back([&,pp]{
+            auto &times = latencies[pp];
+            times.reserve(batchesPerProducer);
+            ChangeSet changes;
+            for (int bb=0;bb<batchesPerProducer;bb++)
+            {
+                for (int ii=0;ii<batchSize;ii++)
+                {
+                    auto change = new NoopChange();
+                    // Some of them are timed, which the old path sorted on the way in
+                    if (ii == 0 && bb % 4 == 0)
+                        change->when = 1.0;
+                    changes.push_back(change);
+                }
+                const auto t0 = std::chrono::steady_clock::now();
+                lists.addChangeRequests(changes);
+                const auto t1 = std::chrono::steady_clock::now();
+                times.push_back(std::chrono::duration<double,std::micro>(t1 - t0).count());
+            }
+            producersLeft--;
+        });
+    }
+
+    // The "render thread"
+    while (true)
+    {
+        const bool done = producersLeft == 0;
+        received += lists.processChanges(TimeGetCurrent());
+        if (done)
+            break;
+        std::this_thread::yield();
+    }
+
+    for (auto &producer : producers)
+        producer.join();
+
+    std::vector<double> all;
+    for (const auto &times : latencies)
+        all.insert(all.end(),times.begin(),times.end());
+    return all;
+}
+
+static void ReportLatency(Runner &runner,Result *result,std::vector<double> &latencies)
+{
+    if (!result || latencies.empty())
+        return;
+    std::sort(latencies.begin(),latencies.end());
+    const size_t last = latencies.size() - 1;
+    runner.metric(result,"p50_us",latencies[last / 2]);
+    runner.metric(result,"p99_us",latencies[std::min(last,latencies.size() * 99 / 100)]);
+    runner.metric(result,"max_us",latencies[last]);
+}
+
+// Scene::processChanges with no renderer or view, which the no-op changes don't need
+class SceneChangeLists
+{
+public:
+    SceneChangeLists(Scene *scene) : scene(scene) { }
+    void addChangeRequests(ChangeSet &changes) { scene->addChangeRequests(changes); }
+    int processChanges(TimeInterval now) { return scene->processChanges(nullptr,nullptr,now); }
+
+    Scene *scene;
+};
+
+}
+
+WGBENCH_SUITE(scene)
+{
+    // Time each change submission from 8 threads while another processes them
+    {
+        const int numProducers = 8;
+        const int batches = runner.size(20000,500);
+        const int batchSize = 4;
+        const int numSubmits = numProducers * batches;
+        const int total = numSubmits * batchSize;
+
+        int lockedReceived = total, sceneReceived = total;
+        std::vector<double> lockedLatency,sceneLatency;
+        Result *lockedResult = runner.run("scene","changes/mutex-lists-8-threads",numSubmits,"submits",[&]{
+            LockedChangeLists lists;
+            lockedLatency = TimeSubmissions(lists,numProducers,batches,batchSize,lockedReceived);
+        });
+        ReportLatency(runner,lockedResult,lockedLatency);
+
+        SphericalMercatorDisplayAdapter coordAdapter(0.0,GeoCoord::CoordFromDegrees(-180.0,-85.05113),GeoCoord::CoordFromDegrees(180.0,85.05113));
+        Result *sceneResult = runner.run("scene","changes/Scene-8-threads",numSubmits,"submits",[&]{
+            Scene scene(&coordAdapter);
+            SceneChangeLists lists(&scene);
+            sceneLatency = TimeSubmissions(lists,numProducers,batches,batchSize,sceneReceived);
+            scene.teardown(nullptr);
+        });
+        ReportLatency(runner,sceneResult,sceneLatency);
+
+        if (lockedReceived != total || sceneReceived != total)
+            runner.fail("scene","lost changes: mutex lists got " + std::to_string(lockedReceived) + ", Scene got " +
+                        std::to_string(sceneReceived) + " of " + std::to_string(total));
+    }
+
+    // Draw list cull and sort over a pile of drawables
+    {
+        const int numDrawables = runner.size(50000,2000);
+        SphericalMercatorDisplayAdapter coordAdapter(0.0,GeoCoord::CoordFromDegrees(-180.0,-85.05113),GeoCoord::CoordFromDegrees(180.0,85.05113));
+        Maply::MapView mapView(&coordAdapter);
+        mapView.setLoc(Point3d(0.0,0.0,0.5));
+
+        FixtureRandom rand(81);
+        std::vector<std::unique_ptr<HeadlessDrawable>> owned;
+        std::vector<Drawable *> drawables;
+        for (int ii=0;ii<numDrawables;ii++)
+        {
+            auto draw = std::make_unique<HeadlessDrawable>("Bench Drawable");
+            draw->setDrawPriority(rand.index(100));
+            draw->setRequestZBuffer(rand.index(2) == 0);
+            draw->setOnOff(rand.index(10) != 0);
+            // Some of them only show up at certain heights
+            if (rand.index(4) == 0)
+            {
+                const double minVis = rand.uniform(0.0,1.0);
+                draw->setVisibleRange(minVis,minVis + rand.uniform(0.0,1.0));
+            }
+            drawables.push_back(draw.get());
+            owned.push_back(std::move(draw));
+        }
+
+        const Point2f frameSize(2048.0,1536.0);
+        RendererFrameInfo frameInfo;
+        const auto setupFrame = [&](double height)
+        {
+            mapView.setLoc(Point3d(0.0,0.0,height));
+            frameInfo.theView = &mapView;
+            frameInfo.modelTrans4d = mapView.calcModelMatrix();
+            frameInfo.viewTrans4d = mapView.calcViewMatrix();
+            frameInfo.projMat4d = mapView.calcProjectionMatrix(frameSize,0.0);
+            frameInfo.modelTrans = Matrix4dToMatrix4f(frameInfo.modelTrans4d);
+            frameInfo.viewTrans = Matrix4dToMatrix4f(frameInfo.viewTrans4d);
+            frameInfo.projMat = Matrix4dToMatrix4f(frameInfo.projMat4d);
+            frameInfo.offsetMatrices.clear();
+            mapView.getOffsetMatrices(frameInfo.offsetMatrices,frameSize,0.0);
+        };
+
+        // On a single core the pool is all overhead, so task-pool will trail serial there
+        DrawListBuilder serial,parallel;
+        parallel.setTaskPool(std::make_shared<TaskPool>(runner.numThreads));
+
+        // Move a bit every frame so nothing gets reused
+        int frame = 0;
+        size_t serialSize = 0,parallelSize = 0;
+        runner.run("scene","drawlist/serial",numDrawables,"drawables",[&]{
+            setupFrame(0.5 + (frame++ % 100) * 0.001);
+            serialSize = serial.build(&frameInfo,drawables).size();
+        });
+        frame = 0;
+        runner.run("scene","drawlist/task-pool",numDrawables,"drawables",[&]{
+            setupFrame(0.5 + (frame++ % 100) * 0.001);
+            parallelSize = parallel.build(&frameInfo,drawables).size();
+        });
+
+        // Both should come up with the same list
+        setupFrame(0.6);
+        serialSize = serial.build(&frameInfo,drawables).size();
+        parallelSize = parallel.build(&frameInfo,drawables).size();
+        if (serialSize != parallelSize)
+            runner.fail("scene","serial and task pool draw lists differ");
+
+        // Nothing moved, so the last list should come right back
+        Result *reuse = runner.run("scene","drawlist/reused",numDrawables,"drawables",[&]{
+            serial.build(&frameInfo,drawables);
+        });
+        runner.metric(reuse,"reused",serial.wasReused() ? 1.0 : 0.0);
+        runner.metric(reuse,"visible",(double)serialSize);
+
+        // Moving a drawable has to show up, even when the view doesn't
+        if (reuse && !serial.getDrawList().empty())
+        {
+            const DrawListEntry before = serial.getDrawList()[0];
+            auto *moved = dynamic_cast<HeadlessDrawable *>(before.drawable);
+            const Eigen::Matrix4d localMat = Eigen::Affine3d(Eigen::Translation3d(0.0,0.0,0.01)).matrix();
+            moved->setMatrix(&localMat);
+            const DrawList &movedList = serial.build(&frameInfo,drawables);
+            const auto movedIt = std::find_if(movedList.begin(),movedList.end(),
+                                              [&](const DrawListEntry &entry) { return entry.drawable == moved && entry.offset == before.offset; });
+            if (serial.wasReused() || movedIt == movedList.end() || !movedIt->mvpMat.isApprox(before.mvpMat * localMat))
+                runner.fail("scene","draw list missed a drawable's new local matrix");
+
+            // Same for a new priority
+            moved->setDrawPriority(moved->getDrawPriority() + 1);
+            serial.build(&frameInfo,drawables);
+            if (serial.wasReused())
+                runner.fail("scene","draw list missed a drawable's new priority");
+        }
+    }
+}
@@ -0,0 +1,174 @@
+/*  BenchSelection.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "ComponentManager.h"
+#import "SelectionManager.h"
+#import "MaplyView.h"
+#import "SphericalMercator.h"
+#import "Scene.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+WGBENCH_SUITE(selection)
+{
+    const int frameWidth = 2048, frameHeight = 1536;
+    const Point2f frameSize(frameWidth,frameHeight);
+    SphericalMercatorDisplayAdapter coordAdapter(0.0,GeoCoord::CoordFromDegrees(-180.0,-85.05113),GeoCoord::CoordFromDegrees(180.0,85.05113));
+    CoordSystem *coordSys = coordAdapter.getCoordSystem();
+    Scene scene(&coordAdapter);
+    HeadlessRenderer renderer(frameWidth,frameHeight);
+    renderer.setScene(&scene);
+
+    Maply::MapView mapView(&coordAdapter);
+    mapView.setLoc(Point3d(0.0,0.0,1.0));
+    const ViewStateRef viewState = std::make_shared<Maply::MapViewState>(&mapView,&renderer);
+
+    // Everything lives in this part of the world, a bit more than the view covers
+    const double spanX = 1.2, spanY = 0.9;
+    const int numPicks = runner.size(200,50);
+
+    // Markers and 3D rectangles, the usual things people tap on
+    {
+        const auto selectManager = scene.getManager<SelectionManager>(kWKSelectionManager);
+        const int numSelectables = runner.size(100000,5000);
+
+        FixtureRandom rand(31);
+        for (int ii=0;ii<numSelectables;ii++)
+        {
+            const Point3d loc = coordAdapter.localToDisplay(coordSys->geographicToLocal(
+                    Point2d(rand.uniform(-spanX,spanX),rand.uniform(-spanY,spanY))));
+            if (rand.index(4) != 0)
+            {
+                const float size = (float)rand.uniform(8.0,32.0);
+                const Point2f pts[4] = { Point2f(-size,-size), Point2f(size,-size), Point2f(size,size), Point2f(-size,size) };
+                selectManager->addSelectableScreenRect(Identifiable::genId(),loc,pts,DrawVisibleInvalid,DrawVisibleInvalid,true);
+            }
+            else
+            {
+                const float size = (float)rand.uniform(0.0005,0.005);
+                const Point3f pts[4] = { Point3f(loc.x()-size,loc.y()-size,0.0), Point3f(loc.x()+size,loc.y()-size,0.0),
+                                         Point3f(loc.x()+size,loc.y()+size,0.0), Point3f(loc.x()-size,loc.y()+size,0.0) };
+                selectManager->addSelectableRect(Identifiable::genId(),pts,true);
+            }
+        }
+
+        std::vector<Point2f> touches(numPicks);
+        for (auto &touch : touches)
+            touch = Point2f(rand.uniform(0.0,frameWidth),rand.uniform(0.0,frameHeight));
+
+        const auto pickAll = [&]
+        {
+            int hits = 0;
+            std::vector<SelectionManager::SelectedObject> selObjs;
+            for (const auto &touch : touches)
+            {
+                selObjs.clear();
+                selectManager->pickObjects(touch,20.0,viewState,selObjs);
+                hits += (int)selObjs.size();
+            }
+            return hits;
+        };
+
+        int scanHits = 0, indexHits = 0;
+        selectManager->setUseSpatialIndex(false);
+        Result *scanResult = runner.run("selection","pick/scan",numPicks,"picks",[&]{ scanHits = pickAll(); });
+        runner.metric(scanResult,"hits",scanHits);
+
+        selectManager->setUseSpatialIndex(true);
+        Result *indexResult = runner.run("selection","pick/spatial-index",numPicks,"picks",[&]{ indexHits = pickAll(); });
+        runner.metric(indexResult,"hits",indexHits);
+
+        if (scanResult && indexResult && scanHits != indexHits)
+            runner.fail("selection","spatial index picked " + std::to_string(indexHits) + " objects, scan picked " + std::to_string(scanHits));
+    }
+
+    // Tapping on vectors, which goes through the component objects
+    {
+        const auto compManager = scene.getManager<ComponentManager>(kWKComponentManager);
+        const int numCompObjs = runner.size(50000,3000);
+
+        FixtureRandom rand(37);
+        std::vector<ComponentObjectRef> compObjs;
+        ChangeSet changes;
+        for (int ii=0;ii<numCompObjs;ii++)
+        {
+            auto vecObj = std::make_shared<VectorObject>();
+            const Point2f center(rand.uniform(-spanX,spanX),rand.uniform(-spanY,spanY));
+            const float size = (float)rand.uniform(0.001,0.02);
+            if (rand.index(2) == 0)
+            {
+                auto areal = VectorAreal::createAreal();
+                areal->loops.push_back(VectorRing { center + Point2f(-size,-size), center + Point2f(size,-size),
+                                                    center + Point2f(size,size), center + Point2f(-size,size) });
+                areal->initGeoMbr();
+                vecObj->shapes.insert(areal);
+            }
+            else
+            {
+                // A short wandering road
+                auto linear = VectorLinear::createLinear();
+                Point2f pt = center;
+                for (int ip=0;ip<8;ip++)
+                {
+                    linear->pts.push_back(pt);
+                    pt += Point2f(rand.uniform(-size,size),rand.uniform(-size,size));
+                }
+                linear->initGeoMbr();
+                vecObj->shapes.insert(linear);
+            }
+
+            auto compObj = std::make_shared<ComponentObject>(true,true);
+            compObj->vecObjs.push_back(vecObj);
+            compManager->addComponentObject(compObj,changes);
+            compObjs.push_back(compObj);
+        }
+        discardChanges(changes);
+
+        std::vector<Point2d> taps(numPicks);
+        for (auto &tap : taps)
+            tap = Point2d(rand.uniform(-spanX,spanX),rand.uniform(-spanY,spanY));
+
+        // The way findVectors used to work, every vector tested every time
+        int scanHits = 0, indexHits = 0;
+        Result *scanResult = runner.run("selection","findVectors/scan",numPicks,"taps",[&]{
+            scanHits = 0;
+            for (const auto &tap : taps)
+                for (const auto &compObj : compObjs)
+                    for (const auto &vecObj : compObj->vecObjs)
+                        if (vecObj->pointInside(tap) ||
+                            vecObj->pointNearLinear(tap - compObj->vectorOffset,20.0f,viewState,frameSize))
+                            scanHits++;
+        });
+        runner.metric(scanResult,"hits",scanHits);
+
+        Result *indexResult = runner.run("selection","findVectors/spatial-index",numPicks,"taps",[&]{
+            indexHits = 0;
+            for (const auto &tap : taps)
+                indexHits += (int)compManager->findVectors(tap,20.0,viewState,frameSize).size();
+        });
+        runner.metric(indexResult,"hits",indexHits);
+
+        if (scanResult && indexResult && scanHits != indexHits)
+            runner.fail("selection","findVectors found " + std::to_string(indexHits) + " vectors, scan found " + std::to_string(scanHits));
+    }
+
+    scene.teardown(nullptr);
+}
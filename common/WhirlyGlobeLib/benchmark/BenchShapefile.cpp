@@ -0,0 +1,220 @@
+/*  BenchShapefile.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdio>
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "ShapeReader.h"
+#import "shapefil.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// Parcels, lots of small polygons with a few attributes each, like a county's worth of property lines
+bool WriteParcels(const std::string &baseName,int numParcels,uint32_t seed)
+{
+    SHPHandle shp = SHPCreate(baseName.c_str(),SHPT_POLYGON);
+    DBFHandle dbf = DBFCreate(baseName.c_str());
+    if (!shp || !dbf)
+    {
+        if (shp)
+            SHPClose(shp);
+        if (dbf)
+            DBFClose(dbf);
+        return false;
+    }
+    const int ownerField = DBFAddField(dbf,"OWNER",FTString,32,0);
+    const int useField = DBFAddField(dbf,"LANDUSE",FTString,12,0);
+    const int yearField = DBFAddField(dbf,"YEAR",FTInteger,6,0);
+    const int valueField = DBFAddField(dbf,"VALUE",FTDouble,14,2);
+
+    static const char *uses[] = {"RES","COM","IND","AG","PARK"};
+    FixtureRandom rand(seed);
+    double xs[7],ys[7];
+    for (int ii=0;ii<numParcels;ii++)
+    {
+        // Everything is in a two degree square
+        const double cx = rand.uniform(-100.0,-98.0), cy = rand.uniform(40.0,42.0);
+        const double sx = rand.uniform(0.0002,0.002), sy = rand.uniform(0.0002,0.002);
+        const double offs[7][2] = {{-1,-1},{-1,1},{0,1.2},{1,1},{1,-1},{0,-1.1},{-1,-1}};
+        for (int ip=0;ip<7;ip++)
+        {
+            xs[ip] = cx + offs[ip][0]*sx;
+            ys[ip] = cy + offs[ip][1]*sy;
+        }
+        SHPObject *obj = SHPCreateSimpleObject(SHPT_POLYGON,7,xs,ys,nullptr);
+        SHPWriteObject(shp,-1,obj);
+        SHPDestroyObject(obj);
+
+        const std::string owner = "Owner " + std::to_string(rand.index(100000));
+        DBFWriteStringAttribute(dbf,ii,ownerField,owner.c_str());
+        DBFWriteStringAttribute(dbf,ii,useField,uses[rand.index(5)]);
+        DBFWriteIntegerAttribute(dbf,ii,yearField,1900 + rand.index(120));
+        DBFWriteDoubleAttribute(dbf,ii,valueField,rand.uniform(1e4,1e6));
+    }
+    SHPClose(shp);
+    DBFClose(dbf);
+
+    return true;
+}
+
+bool SameShape(const VectorShapeRef &a,const VectorShapeRef &b)
+{
+    const auto arA = std::dynamic_pointer_cast<VectorAreal>(a);
+    const auto arB = std::dynamic_pointer_cast<VectorAreal>(b);
+    if (!arA || !arB || arA->loops.size() != arB->loops.size())
+        return false;
+    // Rounding to float can land an ulp apart.  GCC 12's SLP vectorizer skips the float
+    // conversion in DegToRad<float> when it pairs up x and y, so the two decoders can disagree.
+    for (unsigned int ii=0;ii<arA->loops.size();ii++)
+    {
+        const VectorRing &ringA = arA->loops[ii], &ringB = arB->loops[ii];
+        if (ringA.size() != ringB.size())
+            return false;
+        for (unsigned int jj=0;jj<ringA.size();jj++)
+            if ((ringA[jj] - ringB[jj]).norm() > 1e-6)
+                return false;
+    }
+    const auto dictA = a->getAttrDict(), dictB = b->getAttrDict();
+    for (const auto &key : dictA->getKeys())
+        if (dictA->getType(key) != dictB->getType(key) || dictA->getString(key) != dictB->getString(key))
+            return false;
+    return dictA->count() == dictB->count();
+}
+
+}
+
+WGBENCH_SUITE(shapefile)
+{
+    const int numParcels = runner.size(400000,10000);
+    const std::string baseName = std::string(P_tmpdir) + "/wgbench_parcels";
+    if (!WriteParcels(baseName,numParcels,61))
+    {
+        runner.fail("shapefile","couldn't write " + baseName);
+        return;
+    }
+
+    std::vector<unsigned int> allRecords(numParcels);
+    for (int ii=0;ii<numParcels;ii++)
+        allRecords[ii] = ii;
+
+    // The old way, one record at a time through shapelib
+    ShapeSet serialShapes;
+    runner.run("shapefile","read-all/shapelib",numParcels,"records",[&]{
+        ShapeReader reader(baseName + ".shp");
+        serialShapes.clear();
+        for (int ii=0;ii<numParcels;ii++)
+            serialShapes.insert(reader.getObjectByIndex(ii,nullptr));
+    });
+
+    size_t mappedCount = 0;
+    Result *mappedResult = runner.run("shapefile","read-all/mapped",numParcels,"records",[&]{
+        ShapeReader reader(baseName + ".shp");
+        ShapeSet shapes;
+        reader.readObjects(allRecords,nullptr,shapes);
+        mappedCount = shapes.size();
+    });
+    if (mappedResult && mappedCount != (size_t)numParcels)
+        runner.fail("shapefile","mapped read got " + std::to_string(mappedCount) + " shapes");
+
+    const auto pool = std::make_shared<TaskPool>(runner.numThreads);
+    Result *parallelResult = runner.run("shapefile","read-all/mapped-parallel",numParcels,"records",[&]{
+        ShapeReader reader(baseName + ".shp");
+        reader.setPool(pool);
+        ShapeSet shapes;
+        reader.readObjects(allRecords,nullptr,shapes);
+        mappedCount = shapes.size();
+    });
+    if (parallelResult && mappedCount != (size_t)numParcels)
+        runner.fail("shapefile","parallel read got " + std::to_string(mappedCount) + " shapes");
+
+    // Decoding it ourselves should match what shapelib gives us
+    {
+        ShapeReader reader(baseName + ".shp");
+        std::vector<unsigned int> sample;
+        for (int ii=0;ii<numParcels;ii+=std::max(numParcels/100,1))
+            sample.push_back(ii);
+        ShapeSet mapped;
+        reader.readObjects(sample,nullptr,mapped);
+        for (const auto &shape : mapped)
+        {
+            const int which = shape->getAttrDict()->getInt("wgshapefileidx");
+            if (!SameShape(shape,reader.getObjectByIndex(which,nullptr)))
+            {
+                runner.fail("shapefile","record " + std::to_string(which) + " doesn't match shapelib");
+                break;
+            }
+        }
+    }
+
+    runner.run("shapefile","index/build",numParcels,"records",[&]{
+        ShapeReader reader(baseName + ".shp");
+        reader.buildIndex();
+    });
+
+    // Looking at a neighborhood, about a tenth of a degree on a side
+    ShapeReader areaReader(baseName + ".shp");
+    areaReader.setPool(pool);
+    areaReader.buildIndex();
+    const StringSet filter { "LANDUSE", "VALUE" };
+    const int numAreas = runner.size(50,20);
+    FixtureRandom rand(67);
+    std::vector<Mbr> areas;
+    for (int ii=0;ii<numAreas;ii++)
+    {
+        const Point2f ll(DegToRad(rand.uniform(-100.0,-98.1)),DegToRad(rand.uniform(40.0,41.9)));
+        areas.emplace_back(ll,ll + Point2f(DegToRad(0.1),DegToRad(0.1)));
+    }
+
+    size_t indexHits = 0;
+    Result *indexResult = runner.run("shapefile","area/indexed",numAreas,"areas",[&]{
+        indexHits = 0;
+        for (const auto &area : areas)
+            if (const auto vecObj = areaReader.readArea(area,&filter))
+                indexHits += vecObj->shapes.size();
+    });
+    runner.metric(indexResult,"shapes",(double)indexHits);
+
+    // What you'd do without the index, check everything you read.
+    // Scan the same decoded geometry readArea() sees, shapelib's can be an ulp off.
+    ShapeSet allShapes;
+    {
+        ShapeReader reader(baseName + ".shp");
+        reader.setPool(pool);
+        reader.readObjects(allRecords,nullptr,allShapes);
+    }
+    size_t scanHits = 0;
+    Result *scanResult = runner.run("shapefile","area/scan",numAreas,"areas",[&]{
+        scanHits = 0;
+        for (const auto &area : areas)
+            for (const auto &shape : allShapes)
+            {
+                const GeoMbr geoMbr = shape->calcGeoMbr();
+                if (Mbr(geoMbr.ll(),geoMbr.ur()).overlaps(area))
+                    scanHits++;
+            }
+    });
+    if (indexResult && scanResult && indexHits != scanHits)
+        runner.fail("shapefile","index found " + std::to_string(indexHits) + " shapes, scan found " + std::to_string(scanHits));
+
+    for (const char *ext : {".shp",".shx",".dbf"})
+        remove((baseName + ext).c_str());
+}
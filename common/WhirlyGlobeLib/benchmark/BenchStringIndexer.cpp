@@ -0,0 +1,88 @@
+/*  BenchStringIndexer.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <thread>
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "StringIndexer.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+WGBENCH_SUITE(stringindexer)
+{
+    const int numStrings = 2000;
+    const int lookupsPerThread = runner.size(400000,4000);
+
+    // Attribute and uniform names are looked up far more than they're added
+    std::vector<std::string> strs;
+    for (int ii=0;ii<numStrings;ii++)
+        strs.push_back("u_attribute_" + std::to_string(ii));
+    std::vector<StringIdentity> ids;
+    for (const auto &str : strs)
+        ids.push_back(StringIndexer::getStringID(str));
+
+    int wrong = 0;
+    for (int ii=0;ii<numStrings;ii++)
+        if (StringIndexer::getString(ids[ii]) != strs[ii])
+            wrong++;
+    if (wrong)
+        runner.fail("stringindexer",std::to_string(wrong) + " strings don't round trip");
+
+    const auto lookups = [&](int seed,int num)
+    {
+        FixtureRandom rand(seed);
+        StringIdentity sum = 0;
+        for (int ii=0;ii<num;ii++)
+            sum += StringIndexer::getStringID(strs[rand.index(numStrings)]);
+        DoNotOptimize(sum);
+    };
+
+    runner.run("stringindexer","lookup/1-thread",lookupsPerThread,"lookups",[&]{
+        lookups(1,lookupsPerThread);
+    });
+
+    const int numThreads = runner.numThreads;
+    runner.run("stringindexer","lookup/" + std::to_string(numThreads) + "-threads",
+               (double)lookupsPerThread*numThreads,"lookups",[&]{
+        std::vector<std::thread> threads;
+        for (int it=0;it<numThreads;it++)
+            threads.emplace_back(lookups,it+1,lookupsPerThread);
+        for (auto &thread : threads)
+            thread.join();
+    });
+
+    // Lookups while another thread keeps adding new strings
+    int round = 0;
+    runner.run("stringindexer","lookup/with-writer",(double)lookupsPerThread*numThreads,"lookups",[&]{
+        std::atomic<bool> done(false);
+        std::thread writer([&]{
+            int which = 0;
+            while (!done.load(std::memory_order_relaxed) && which < 1000)
+                StringIndexer::getStringID("added_" + std::to_string(round) + "_" + std::to_string(which++));
+        });
+        std::vector<std::thread> threads;
+        for (int it=0;it<numThreads;it++)
+            threads.emplace_back(lookups,it+1,lookupsPerThread);
+        for (auto &thread : threads)
+            thread.join();
+        done = true;
+        writer.join();
+        round++;
+    });
+}
@@ -0,0 +1,130 @@
+/*  BenchTesselator.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "Tesselator.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+// Signed area of the triangles, which should match between the two paths
+static double TriangleArea(const VectorTriangles &tris)
+{
+    double area = 0.0;
+    for (const auto &tri : tris.tris)
+    {
+        const Point3f &p0 = tris.pts[tri.pts[0]], &p1 = tris.pts[tri.pts[1]], &p2 = tris.pts[tri.pts[2]];
+        area += (((double)p1.x()-p0.x())*((double)p2.y()-p0.y()) - ((double)p1.y()-p0.y())*((double)p2.x()-p0.x())) / 2.0;
+    }
+    return area;
+}
+
+WGBENCH_SUITE(tesselator)
+{
+    const char *kindNames[] = {"convex","star","self-intersecting","duplicate-points"};
+    const int numRings = runner.size(4000,200);
+
+    for (int kind = RingConvex; kind <= RingDuplicatePoints; kind++)
+    {
+        const auto rings = MakeRings((RingKind)kind,numRings,40,100+kind);
+
+        // Check the fast path against libtess before timing anything
+        int numTris = 0, mismatches = 0;
+        for (const auto &ring : rings)
+        {
+            const std::vector<VectorRing> loops = {ring};
+            auto fast = VectorTriangles::createTriangles();
+            auto general = VectorTriangles::createTriangles();
+            TesselateLoops(loops,fast);
+            TesselateLoopsGeneral(loops,general);
+            numTris += (int)fast->tris.size();
+            const double fastArea = TriangleArea(*fast), generalArea = TriangleArea(*general);
+            if (std::abs(fastArea - generalArea) > 1e-3 * std::abs(generalArea) + 1e-14)
+                mismatches++;
+        }
+        if (mismatches > 0)
+            runner.fail("tesselator",std::string(kindNames[kind]) + ": " + std::to_string(mismatches) + " rings differ from libtess");
+
+        const auto tessAll = [&](void (*tessFunc)(const std::vector<VectorRing> &,VectorTrianglesRef))
+        {
+            std::vector<VectorRing> loops(1);
+            for (const auto &ring : rings)
+            {
+                loops[0] = ring;
+                auto tris = VectorTriangles::createTriangles();
+                tessFunc(loops,tris);
+                DoNotOptimize(tris->tris.size());
+            }
+        };
+
+        Result *fastResult = runner.run("tesselator",std::string("fast/") + kindNames[kind],numTris,"tris",
+                                        [&]{ tessAll(TesselateLoops); });
+        runner.metric(fastResult,"mismatches",mismatches);
+        runner.metric(fastResult,"rings",rings.size());
+        runner.run("tesselator",std::string("general/") + kindNames[kind],numTris,"tris",
+                   [&]{ tessAll(TesselateLoopsGeneral); });
+    }
+
+    // Polygons decoded from the standard vector tile, holes and all
+    std::vector<const std::vector<VectorRing> *> polys;
+    const auto features = DecodeVectorTile(MakeStandardVectorTile(runner.size(8,1)),QuadTreeIdentifier(8192,5461,14));
+    for (const auto &feature : features)
+        for (const auto &shape : feature->shapes)
+            if (const auto areal = std::dynamic_pointer_cast<VectorAreal>(shape))
+                polys.push_back(&areal->loops);
+    if (polys.empty())
+    {
+        runner.fail("tesselator","no polygons in the vector tile fixture");
+        return;
+    }
+
+    int numTris = 0, mismatches = 0, multiRing = 0;
+    for (const auto *loops : polys)
+    {
+        auto fast = VectorTriangles::createTriangles();
+        auto general = VectorTriangles::createTriangles();
+        TesselateLoops(*loops,fast);
+        TesselateLoopsGeneral(*loops,general);
+        numTris += (int)fast->tris.size();
+        multiRing += loops->size() > 1;
+        const double fastArea = TriangleArea(*fast), generalArea = TriangleArea(*general);
+        if (std::abs(fastArea - generalArea) > 1e-3 * std::abs(generalArea) + 1e-14)
+            mismatches++;
+    }
+    if (mismatches > 0)
+        runner.fail("tesselator","tile: " + std::to_string(mismatches) + " polygons differ from libtess");
+    if (multiRing == 0)
+        runner.fail("tesselator","tile: no polygons with holes to check");
+
+    const auto tessTile = [&](void (*tessFunc)(const std::vector<VectorRing> &,VectorTrianglesRef))
+    {
+        for (const auto *loops : polys)
+        {
+            auto tris = VectorTriangles::createTriangles();
+            tessFunc(*loops,tris);
+            DoNotOptimize(tris->tris.size());
+        }
+    };
+
+    Result *fastResult = runner.run("tesselator","fast/tile",numTris,"tris",[&]{ tessTile(TesselateLoops); });
+    runner.metric(fastResult,"mismatches",mismatches);
+    runner.metric(fastResult,"polygons",polys.size());
+    runner.metric(fastResult,"with-holes",multiRing);
+    runner.run("tesselator","general/tile",numTris,"tris",[&]{ tessTile(TesselateLoopsGeneral); });
+}
@@ -0,0 +1,182 @@
+/*  BenchTileBuilder.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "LoadedTileNew.h"
+#import "SphericalMercator.h"
+#import "Scene.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// The tile builder only wants the tree for the node bounds
+class BoundsQuadTree : public QuadTreeNew
+{
+public:
+    BoundsQuadTree(const MbrD &mbr,int maxLevel) : QuadTreeNew(mbr,0,maxLevel) { }
+
+    virtual double importance(const Node &) override { return 1.0; }
+    virtual bool visible(const Node &) override { return true; }
+};
+
+// Hangs on to the builders it makes when asked, since the change requests don't hand back their drawables
+class RecordingRenderer : public HeadlessRenderer
+{
+public:
+    RecordingRenderer(int width,int height) : HeadlessRenderer(width,height) { }
+
+    virtual BasicDrawableBuilderRef makeBasicDrawableBuilder(const std::string &name) const override
+    {
+        auto builder = HeadlessRenderer::makeBasicDrawableBuilder(name);
+        if (builders)
+            builders->push_back(builder);
+        return builder;
+    }
+
+    std::vector<BasicDrawableBuilderRef> *builders = nullptr;
+};
+
+typedef std::shared_ptr<HeadlessDrawable> HeadlessDrawableRef;
+
+// What's different between two tile drawables, or empty if they match
+static std::string CompareTileGeometry(const HeadlessDrawable &perTile,const HeadlessDrawable &fromTemplate,double tileSpan)
+{
+    if (perTile.points.size() != fromTemplate.points.size())
+        return std::to_string(fromTemplate.points.size()) + " points, not " + std::to_string(perTile.points.size());
+    // The points are relative to the tile center, so they only need to be close compared to the tile
+    const double posTol = 1e-5 * tileSpan;
+    for (size_t ii=0;ii<perTile.points.size();ii++)
+        if ((perTile.points[ii] - fromTemplate.points[ii]).cast<double>().norm() > posTol)
+            return "point " + std::to_string(ii) + " moved";
+
+    if (perTile.tris.size() != fromTemplate.tris.size())
+        return std::to_string(fromTemplate.tris.size()) + " triangles, not " + std::to_string(perTile.tris.size());
+    for (size_t ii=0;ii<perTile.tris.size();ii++)
+        for (unsigned int iv=0;iv<3;iv++)
+            if (perTile.tris[ii].verts[iv] != fromTemplate.tris[ii].verts[iv])
+                return "triangle " + std::to_string(ii) + " has different vertices";
+
+    if (perTile.texInfo.empty() || fromTemplate.texInfo.empty())
+        return "no texture coordinates";
+    const VertexAttribute *perTileTex = perTile.vertexAttributes[perTile.texInfo[0].texCoordEntry];
+    const VertexAttribute *templateTex = fromTemplate.vertexAttributes[fromTemplate.texInfo[0].texCoordEntry];
+    if (perTileTex->numElements() != (int)perTile.points.size() || templateTex->numElements() != perTileTex->numElements())
+        return std::to_string(templateTex->numElements()) + " texture coordinates, not " + std::to_string(perTileTex->numElements());
+    const TexCoord *perTileCoords = perTileTex->getData<TexCoord>();
+    const TexCoord *templateCoords = templateTex->getData<TexCoord>();
+    for (int ii=0;ii<perTileTex->numElements();ii++)
+        if ((perTileCoords[ii] - templateCoords[ii]).norm() > 1e-5)
+            return "texture coordinate " + std::to_string(ii) + " differs";
+
+    // The template only stores the one normal, every one of the per tile ones has to match it
+    const VertexAttribute *perTileNorms = perTile.vertexAttributes[perTile.normalEntry];
+    const VertexAttribute *templateNorms = fromTemplate.vertexAttributes[fromTemplate.normalEntry];
+    const Eigen::Vector3f templateNorm(templateNorms->defaultData.vec3[0],templateNorms->defaultData.vec3[1],templateNorms->defaultData.vec3[2]);
+    if (const Eigen::Vector3f *norms = perTileNorms->getData<Eigen::Vector3f>())
+        for (int ii=0;ii<perTileNorms->numElements();ii++)
+            if ((norms[ii] - templateNorm).norm() > 1e-5)
+                return "normal " + std::to_string(ii) + " differs";
+
+    return std::string();
+}
+
+}
+
+WGBENCH_SUITE(tilebuilder)
+{
+    SphericalMercatorDisplayAdapter coordAdapter(0.0,GeoCoord::CoordFromDegrees(-180.0,-85.05113),GeoCoord::CoordFromDegrees(180.0,85.05113));
+    Scene scene(&coordAdapter);
+    RecordingRenderer renderer(2048,1536);
+    renderer.setScene(&scene);
+
+    // The usual flat map setup, tiles in spherical mercator
+    const auto coordSys = std::make_shared<SphericalMercatorCoordSystem>();
+    const Point3d localLL = coordSys->geographicToLocal3d(GeoCoord::CoordFromDegrees(-180.0,-85.05113));
+    const Point3d localUR = coordSys->geographicToLocal3d(GeoCoord::CoordFromDegrees(180.0,85.05113));
+    const MbrD localMbr(Point2d(localLL.x(),localLL.y()),Point2d(localUR.x(),localUR.y()));
+    BoundsQuadTree quadTree(localMbr,20);
+
+    // A block of tiles at one level, about what a screen full of map needs
+    const int level = 12, blockSize = runner.size(32,8);
+    const int startX = (1<<level)/2, startY = (1<<level)/2;
+    std::vector<QuadTreeNew::ImportantNode> idents;
+    for (int iy=0;iy<blockSize;iy++)
+        for (int ix=0;ix<blockSize;ix++)
+            idents.emplace_back(startX+ix,startY+iy,level);
+
+    const auto buildTiles = [&](bool useMeshTemplates,const MbrD &areaMbr,std::vector<HeadlessDrawableRef> *drawables)
+    {
+        TileGeomSettings settings;
+        settings.sampleX = settings.sampleY = 20;
+        settings.useTileCenters = true;
+        settings.useMeshTemplates = useMeshTemplates;
+        TileGeomManager geomManager;
+        geomManager.setup(&renderer,settings,&quadTree,&coordAdapter,coordSys,areaMbr);
+
+        std::vector<BasicDrawableBuilderRef> builders;
+        renderer.builders = drawables ? &builders : nullptr;
+        ChangeSet changes;
+        for (const auto &ident : idents)
+        {
+            LoadedTileNew tile(ident,quadTree.generateMbrForNode(ident));
+            if (tile.isValidSpatial(&geomManager))
+                tile.makeDrawables(&renderer,&geomManager,settings,changes);
+        }
+        const int numChanges = (int)changes.size();
+        renderer.builders = nullptr;
+        for (const auto &builder : builders)
+            if (const auto draw = std::dynamic_pointer_cast<HeadlessDrawable>(builder->basicDraw))
+                drawables->push_back(draw);
+        discardChanges(changes);
+        return numChanges;
+    };
+
+    int perTileChanges = 0, templateChanges = 0;
+    runner.run("tilebuilder","flat/per-tile",idents.size(),"tiles",[&]{ perTileChanges = buildTiles(false,localMbr,nullptr); });
+    Result *result = runner.run("tilebuilder","flat/mesh-template",idents.size(),"tiles",[&]{ templateChanges = buildTiles(true,localMbr,nullptr); });
+    runner.metric(result,"drawables",templateChanges);
+
+    // Both ways have to make the same geometry, down to the vertex.  Then again with the area cut off partway
+    //  through the block, so the tiles along the edge get clipped and scale their texture coordinates.
+    const double tileSpan = (localMbr.ur().x() - localMbr.ll().x()) / (1<<level);
+    const Point2d clipUR(localMbr.ll().x() + (startX + blockSize/2 + 0.6) * tileSpan,
+                         localMbr.ll().y() + (startY + blockSize/2 + 0.3) * tileSpan);
+    const std::pair<std::string,MbrD> areas[2] = {
+        { "whole", localMbr },
+        { "clipped", MbrD(localMbr.ll(),clipUR) },
+    };
+    for (const auto &area : areas)
+    {
+        std::vector<HeadlessDrawableRef> perTileDraws,templateDraws;
+        buildTiles(false,area.second,&perTileDraws);
+        buildTiles(true,area.second,&templateDraws);
+        std::string problem;
+        if (perTileDraws.empty() || perTileDraws.size() != templateDraws.size())
+            problem = "made " + std::to_string(templateDraws.size()) + " drawables, not " + std::to_string(perTileDraws.size());
+        for (size_t di=0;di<perTileDraws.size() && di<templateDraws.size() && problem.empty();di++)
+            problem = CompareTileGeometry(*perTileDraws[di],*templateDraws[di],tileSpan);
+        if (!problem.empty())
+            runner.fail("tilebuilder","mesh template " + area.first + " tiles: " + problem);
+    }
+
+    scene.teardown(nullptr);
+}
@@ -0,0 +1,191 @@
+/*  BenchTrace.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/17/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <map>
+#import <set>
+#import <thread>
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "TraceEvents.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// What the export holds for each thread
+struct TraceThreadSummary
+{
+    std::string threadName;
+    std::map<std::string,int> counts;
+    int numEvents = 0;
+};
+
+// Parse the Chrome JSON back in and sort the events out by thread
+static bool SummarizeTrace(const std::string &json,std::map<int,TraceThreadSummary> &threads)
+{
+    threads.clear();
+    const auto dict = ParseJSONDictionary(json);
+    if (!dict || !dict->hasField("traceEvents"))
+        return false;
+    for (const auto &entry : dict->getArray("traceEvents"))
+    {
+        const auto event = entry->getDict();
+        if (!event)
+            return false;
+        const std::string phase = event->getString("ph");
+        TraceThreadSummary &thread = threads[(int)event->getDouble("tid")];
+        if (phase == "M")
+        {
+            if (const auto args = event->getDict("args"))
+                thread.threadName = args->getString("name");
+        }
+        else
+        {
+            thread.counts[event->getString("name")]++;
+            thread.numEvents++;
+        }
+    }
+    return true;
+}
+
+}
+
+WGBENCH_SUITE(trace)
+{
+    const int numThreads = std::max(runner.numThreads,3);
+    const int capacity = runner.size(4096,256);
+    // Enough to go around each ring a couple of times
+    const int eventsPerThread = 2*capacity + capacity/3;
+
+    TraceRecorder &recorder = TraceRecorder::get();
+    recorder.clear();
+    recorder.setEventsPerThread(capacity);
+    recorder.setEnabled(true);
+
+    std::vector<std::string> nameStrs;
+    for (int ii=0;ii<numThreads;ii++)
+        nameStrs.push_back("event-" + std::to_string(ii));
+    nameStrs.push_back("reuse-event");
+    std::vector<TraceName> names;
+    for (const auto &nameStr : nameStrs)
+        names.push_back(TraceName{nameStr.c_str(),"bench"});
+
+    // Every thread holds on to its buffer until they've all finished, so none of them are shared
+    const auto recordThreads = [&]
+    {
+        std::atomic<int> numDone(0);
+        std::vector<std::thread> threads;
+        for (int ti=0;ti<numThreads;ti++)
+            threads.emplace_back([&,ti]{
+                recorder.setThreadName("trace-" + std::to_string(ti));
+                for (int ii=0;ii<eventsPerThread;ii++)
+                    recorder.instant(&names[ti]);
+                numDone++;
+                while (numDone < numThreads)
+                    std::this_thread::yield();
+            });
+        for (auto &thread : threads)
+            thread.join();
+    };
+
+    // Later runs pick up the buffers the earlier threads left.  The checks below need one run either way.
+    if (!runner.run("trace","record/threads",numThreads*eventsPerThread,"events",recordThreads))
+        recordThreads();
+
+    std::string json;
+    runner.run("trace","export/chrome-json",numThreads*capacity,"events",[&]{ json = recorder.exportChromeJSON(); });
+    if (json.empty())
+        json = recorder.exportChromeJSON();
+
+    // Each thread should have just its own events, as many as the ring holds
+    std::map<int,TraceThreadSummary> threads;
+    if (!SummarizeTrace(json,threads))
+    {
+        runner.fail("trace","exported trace isn't valid JSON");
+        recorder.setEnabled(false);
+        return;
+    }
+    std::set<int> recordedTIDs;
+    for (const auto &kv : threads)
+    {
+        const TraceThreadSummary &thread = kv.second;
+        if (thread.threadName.compare(0,6,"trace-") != 0)
+            continue;
+        const std::string &eventName = nameStrs[std::stoi(thread.threadName.substr(6))];
+        if (thread.numEvents != capacity || thread.counts.size() != 1 || thread.counts.begin()->first != eventName)
+            runner.fail("trace",thread.threadName + " exported " + std::to_string(thread.numEvents) + " events in " +
+                        std::to_string(thread.counts.size()) + " names, not " + std::to_string(capacity) + " " + eventName);
+        recordedTIDs.insert(kv.first);
+    }
+    if ((int)recordedTIDs.size() != numThreads)
+        runner.fail("trace","exported " + std::to_string(recordedTIDs.size()) + " threads, not " + std::to_string(numThreads));
+
+    // A new thread takes over a dead one's buffer and mustn't inherit its events or name
+    const int numReuse = capacity/4;
+    std::thread([&]{
+        for (int ii=0;ii<numReuse;ii++)
+            recorder.instant(&names[numThreads]);
+    }).join();
+    SummarizeTrace(recorder.exportChromeJSON(),threads);
+    bool foundReuse = false;
+    for (const auto &kv : threads)
+    {
+        const TraceThreadSummary &thread = kv.second;
+        if (thread.counts.find(nameStrs[numThreads]) == thread.counts.end())
+            continue;
+        foundReuse = true;
+        if (recordedTIDs.find(kv.first) == recordedTIDs.end())
+            runner.fail("trace","new thread didn't reuse a buffer");
+        if (thread.numEvents != numReuse || !thread.threadName.empty())
+            runner.fail("trace","reused buffer exported " + std::to_string(thread.numEvents) + " events, not " +
+                        std::to_string(numReuse) + ", as '" + thread.threadName + "'");
+    }
+    if (!foundReuse)
+        runner.fail("trace","new thread's events are missing");
+
+    // Nothing left after a clear, even from the threads that are gone
+    recorder.clear();
+    SummarizeTrace(recorder.exportChromeJSON(),threads);
+    for (const auto &kv : threads)
+        if (kv.second.numEvents)
+            runner.fail("trace","thread " + std::to_string(kv.first) + " still has " +
+                        std::to_string(kv.second.numEvents) + " events after a clear");
+
+    // What it costs when it's off, which is most of the time
+    recorder.setEnabled(false);
+    const int numSpans = runner.size(10000000,100000);
+    runner.run("trace","span/disabled",numSpans,"spans",[&]{
+        for (int ii=0;ii<numSpans;ii++)
+        {
+            WK_TRACE_SCOPE("bench","disabled");
+        }
+    });
+    recorder.setEnabled(true);
+    runner.run("trace","span/enabled",numSpans,"spans",[&]{
+        for (int ii=0;ii<numSpans;ii++)
+        {
+            WK_TRACE_SCOPE("bench","enabled");
+        }
+    });
+
+    recorder.setEnabled(false);
+    recorder.clear();
+    recorder.setEventsPerThread(16384);
+}
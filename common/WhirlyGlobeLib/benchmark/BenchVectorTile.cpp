@@ -0,0 +1,745 @@
+/*  BenchVectorTile.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "MapboxVectorTileParser.h"
+#import "MapboxVectorStyleLayer.h"
+#import "MapboxVectorStyleFill.h"
+#import "MapboxVectorStyleLine.h"
+#import "MapboxVectorStyleSymbol.h"
+#import "VectorTilePBFParser.h"
+#import "SphericalMercator.h"
+#import "Scene.h"
+#import "TaskPool.h"
+#import "Tesselator.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// The recursive filter test the compiled version replaced, for comparison
+static bool TreeTestFeature(const MapboxVectorFilter &filter,const Dictionary &attrs)
+{
+    static const std::string geometryType("geometry_type");
+    if (filter.getGeomType() != MBGeomNone)
+    {
+        const int attrGeomType = attrs.getInt(geometryType,0) - 1;
+        switch (filter.getFilterType())
+        {
+            case MBFilterEqual:    return attrGeomType == filter.getGeomType();
+            case MBFilterNotEqual: return attrGeomType != filter.getGeomType();
+            default: break;
+        }
+    }
+
+    switch (filter.getFilterType())
+    {
+        case MBFilterAll:
+            for (const auto &sub : filter.getSubFilters())
+                if (!TreeTestFeature(*sub,attrs))
+                    return false;
+            return true;
+        case MBFilterAny:
+            for (const auto &sub : filter.getSubFilters())
+                if (TreeTestFeature(*sub,attrs))
+                    return true;
+            return false;
+        case MBFilterIn:
+        case MBFilterNotIn:
+            if (const auto featAttrVal = attrs.getEntry(filter.getAttrName()))
+                for (const auto &match : filter.getAttrVals())
+                    if (match->isEqual(featAttrVal))
+                        return filter.getFilterType() == MBFilterIn;
+            return filter.getFilterType() != MBFilterIn;
+        case MBFilterHas:
+            return attrs.hasField(filter.getAttrName());
+        case MBFilterNotHas:
+            return !attrs.hasField(filter.getAttrName());
+        default:
+            if (const auto featAttrVal = attrs.getEntry(filter.getAttrName()))
+            {
+                switch (featAttrVal->getType())
+                {
+                    case DictTypeString:
+                        switch (filter.getFilterType())
+                        {
+                            case MBFilterEqual:    return  featAttrVal->isEqual(filter.getAttrVal());
+                            case MBFilterNotEqual: return !featAttrVal->isEqual(filter.getAttrVal());
+                            default: return true;
+                        }
+                    case DictTypeInt:
+                    case DictTypeDouble:
+                    {
+                        const double val1 = featAttrVal->getDouble();
+                        const double val2 = filter.getAttrVal()->getDouble();
+                        switch (filter.getFilterType())
+                        {
+                            case MBFilterEqual:            return val1 == val2;
+                            case MBFilterNotEqual:         return val1 != val2;
+                            case MBFilterGreaterThan:      return val1 > val2;
+                            case MBFilterGreaterThanEqual: return val1 >= val2;
+                            case MBFilterLessThan:         return val1 < val2;
+                            case MBFilterLessThanEqual:    return val1 <= val2;
+                            default: return true;
+                        }
+                    }
+                    default:
+                        return true;
+                }
+            }
+            return filter.getFilterType() == MBFilterNotEqual;
+    }
+}
+
+// How function stops were evaluated before they were compiled, for comparison
+static double ScanStopsValue(const MaplyVectorFunctionStops &stops,double zoom)
+{
+    const MaplyVectorFunctionStop *a = &stops.stops[0];
+    const MaplyVectorFunctionStop *b = nullptr;
+    if (zoom <= a->zoom)
+        return a->val;
+    for (unsigned int which = 1;which < stops.stops.size(); which++)
+    {
+        b = &stops.stops[which];
+        if (a->zoom <= zoom && zoom < b->zoom)
+        {
+            const double ratio = (stops.base == 1.0) ? (zoom-a->zoom)/(b->zoom-a->zoom) :
+                    (pow(stops.base,zoom-a->zoom) - 1.0) / (pow(stops.base,b->zoom-a->zoom) - 1.0);
+            return ratio * (b->val-a->val) + a->val;
+        }
+        a = b;
+    }
+    return b ? b->val : 0;
+}
+
+static RGBAColor ScanStopsColor(const MaplyVectorFunctionStops &stops,double zoom)
+{
+    const MaplyVectorFunctionStop *a = &stops.stops[0];
+    const MaplyVectorFunctionStop *b = nullptr;
+    if (zoom <= a->zoom)
+        return *a->color;
+    for (unsigned int which = 1;which < stops.stops.size(); which++)
+    {
+        b = &stops.stops[which];
+        if (a->zoom <= zoom && zoom < b->zoom)
+        {
+            const double ratio = (stops.base == 1.0) ? (zoom-a->zoom)/(b->zoom-a->zoom) :
+                    (pow(stops.base,zoom-a->zoom) - 1.0) / (pow(stops.base,b->zoom-a->zoom) - 1.0);
+            float ac[4],bc[4],res[4];
+            a->color->asUnitFloats(ac);
+            b->color->asUnitFloats(bc);
+            for (unsigned int ii=0;ii<4;ii++)
+                res[ii] = (float)ratio * (bc[ii]-ac[ii]) + ac[ii];
+            return RGBAColor::FromUnitFloats(res);
+        }
+        a = b;
+    }
+    return *b->color;
+}
+
+// Tesselates the polygons it's given into triangles of its own, the work a fill layer does,
+//  but without changing the features the other styles are looking at
+class TessStyle : public VectorStyleImpl
+{
+public:
+    TessStyle(long long uuid,bool threadSafe,std::atomic<int> &numBuilt) : uuid(uuid), threadSafe(threadSafe), numBuilt(numBuilt) { }
+
+    virtual long long getUuid(PlatformThreadInfo *) override { return uuid; }
+    virtual std::string getCategory(PlatformThreadInfo *) override { return std::string(); }
+    virtual bool geomAdditive(PlatformThreadInfo *) override { return false; }
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return threadSafe; }
+    virtual void buildObjects(PlatformThreadInfo *,const std::vector<VectorObjectRef> &vecObjs,const VectorTileDataRef &tileInfo,
+                              const Dictionary *,const CancelFunction &) override
+    {
+        numBuilt++;
+        auto compObj = std::make_shared<ComponentObject>();
+        compObj->uuid = std::to_string(uuid);
+        auto trisObj = std::make_shared<VectorObject>();
+        for (const auto &vecObj : vecObjs)
+            for (const auto &shape : vecObj->shapes)
+                if (const auto areal = dynamic_cast<VectorAreal *>(shape.get()))
+                {
+                    const auto trisRef = VectorTriangles::createTriangles();
+                    TesselateLoops(areal->loops,trisRef);
+                    trisObj->shapes.insert(trisRef);
+                }
+        tileInfo->compObjs.push_back(compObj);
+        tileInfo->vecObjs.push_back(trisObj);
+    }
+
+protected:
+    long long uuid;
+    bool threadSafe;
+    std::atomic<int> &numBuilt;
+};
+
+/// Every feature goes to every style, one in four of which can't build alongside the others
+class TessDelegate : public VectorStyleDelegateImpl
+{
+public:
+    TessDelegate(int numStyles)
+    {
+        for (int ii=0;ii<numStyles;ii++)
+            styles.push_back(std::make_shared<TessStyle>(ii+1,ii % 4 != 3,numBuilt));
+    }
+
+    virtual std::vector<VectorStyleImplRef> stylesForFeature(PlatformThreadInfo *,const Dictionary &,
+                                                             const QuadTreeIdentifier &,const std::string &) override { return styles; }
+    virtual bool layerShouldDisplay(PlatformThreadInfo *,const std::string &,const QuadTreeNew::Node &) override { return true; }
+    virtual VectorStyleImplRef styleForUUID(PlatformThreadInfo *,long long uuid) override
+        { return (uuid >= 1 && uuid <= (long long)styles.size()) ? styles[uuid-1] : VectorStyleImplRef(); }
+    virtual std::vector<VectorStyleImplRef> allStyles(PlatformThreadInfo *) override { return styles; }
+    virtual VectorStyleImplRef backgroundStyle(PlatformThreadInfo *) const override { return VectorStyleImplRef(); }
+    virtual RGBAColorRef backgroundColor(PlatformThreadInfo *,double) override { return RGBAColorRef(); }
+
+    std::vector<VectorStyleImplRef> styles;
+    std::atomic<int> numBuilt { 0 };
+};
+
+/// Just the fill layers of a style sheet.  Lines and symbols need drawables the headless renderer can't make.
+class FillDelegate : public VectorStyleDelegateImpl
+{
+public:
+    FillDelegate(HeadlessStyleSetRef styleSet) : styleSet(std::move(styleSet)) { }
+
+    virtual std::vector<VectorStyleImplRef> stylesForFeature(PlatformThreadInfo *inst,const Dictionary &attrs,
+                                                             const QuadTreeIdentifier &tileID,const std::string &layerName) override
+    {
+        auto styles = styleSet->stylesForFeature(inst,attrs,tileID,layerName);
+        styles.erase(std::remove_if(styles.begin(),styles.end(),[](const VectorStyleImplRef &style)
+                        { return !dynamic_cast<MapboxVectorLayerFill *>(style.get()); }),styles.end());
+        return styles;
+    }
+    virtual bool layerShouldDisplay(PlatformThreadInfo *inst,const std::string &name,const QuadTreeNew::Node &tileID) override
+        { return styleSet->layerShouldDisplay(inst,name,tileID); }
+    // With build off, the features are sorted into styles but nothing gets built
+    virtual VectorStyleImplRef styleForUUID(PlatformThreadInfo *inst,long long uuid) override
+        { return build ? styleSet->styleForUUID(inst,uuid) : VectorStyleImplRef(); }
+    virtual std::vector<VectorStyleImplRef> allStyles(PlatformThreadInfo *inst) override { return styleSet->allStyles(inst); }
+    virtual VectorStyleImplRef backgroundStyle(PlatformThreadInfo *) const override { return VectorStyleImplRef(); }
+    virtual RGBAColorRef backgroundColor(PlatformThreadInfo *,double) override { return RGBAColorRef(); }
+
+    HeadlessStyleSetRef styleSet;
+    bool build = true;
+};
+
+// Sum of the polygon coordinates, to catch a style changing the features in place
+static double SumAreals(const std::vector<VectorObjectRef> &vecObjs)
+{
+    double sum = 0.0;
+    for (const auto &vecObj : vecObjs)
+        for (const auto &shape : vecObj->shapes)
+            if (const auto areal = dynamic_cast<VectorAreal *>(shape.get()))
+                for (const auto &loop : areal->loops)
+                    for (const auto &pt : loop)
+                        sum += pt.x() + pt.y();
+    return sum;
+}
+
+// Which style built each object and how many triangles it came to, in the order they landed in the tile
+static std::vector<std::string> SummarizeTile(const VectorTileData &tileData)
+{
+    std::vector<std::string> summary;
+    for (size_t ii=0;ii<tileData.compObjs.size() && ii<tileData.vecObjs.size();ii++)
+    {
+        size_t numTris = 0;
+        for (const auto &shape : tileData.vecObjs[ii]->shapes)
+            if (const auto tris = dynamic_cast<VectorTriangles *>(shape.get()))
+                numTris += tris->tris.size();
+        summary.push_back(tileData.compObjs[ii]->uuid + ":" + std::to_string(numTris));
+    }
+    return summary;
+}
+
+}
+
+WGBENCH_SUITE(vectortile)
+{
+    const int scale = runner.size(8,1);
+    const std::string tileBytes = MakeStandardVectorTile(scale);
+
+    SphericalMercatorDisplayAdapter coordAdapter(0.0,GeoCoord::CoordFromDegrees(-180.0,-85.05113),GeoCoord::CoordFromDegrees(180.0,85.05113));
+    Scene scene(&coordAdapter);
+    // The fill layers need something to make their drawables
+    HeadlessRenderer renderer(1024,768);
+    renderer.setScene(&scene);
+
+    auto styleDict = ParseJSONDictionary(LoadFixture("style.json"));
+    if (!styleDict)
+    {
+        runner.fail("vectortile","couldn't read style.json");
+        return;
+    }
+    auto styleSet = std::make_shared<HeadlessStyleSet>(&scene,coordAdapter.getCoordSystem(),std::make_shared<VectorStyleSettingsImpl>(1.0));
+    runner.run("vectortile","style/parse",1,"styles",[&]{
+        styleSet = std::make_shared<HeadlessStyleSet>(&scene,coordAdapter.getCoordSystem(),std::make_shared<VectorStyleSettingsImpl>(1.0));
+        styleSet->parse(nullptr,styleDict);
+    });
+    if (styleSet->layers.empty())
+        styleSet->parse(nullptr,styleDict);
+
+    // A tile at level 14, somewhere in the middle
+    const QuadTreeIdentifier tileID(8192,5461,14);
+    const double tileSpan = 2.0*M_PI / (1<<tileID.level);
+    const MbrD tileBox(Point2d(-M_PI + tileID.x*tileSpan,-M_PI + tileID.y*tileSpan),
+                       Point2d(-M_PI + (tileID.x+1)*tileSpan,-M_PI + (tileID.y+1)*tileSpan));
+
+    AcceptAllDelegate acceptAll;
+    const std::set<std::string> noUUIDs;
+    unsigned numFeatures = 0;
+    std::vector<VectorObjectRef> eagerFeatures,lazyFeatures;
+    const auto parseTile = [&](VectorStyleDelegateImpl *delegate,bool lazy,std::vector<VectorObjectRef> *keep)
+    {
+        VectorTileData tileData;
+        tileData.ident = tileID;
+        tileData.bbox = tileBox;
+        VectorTilePBFParser parser(&tileData,delegate,nullptr,std::string(),noUUIDs,tileData.vecObjsByStyle,
+                                   false,false,keep);
+        parser.setLazyAttributes(lazy);
+        if (!parser.parse((const uint8_t *)tileBytes.data(),tileBytes.size()))
+            runner.fail("vectortile",parser.getErrorString("parse failed"));
+        numFeatures = parser.getFeatureCount();
+    };
+
+    // Keys nobody looks up by ID shouldn't end up in the string indexer, it never shrinks
+    const StringIdentity numStrings = StringIndexer::getNumStrings();
+    parseTile(&acceptAll,true,nullptr);
+    if (StringIndexer::getNumStrings() != numStrings)
+        runner.fail("vectortile","lazy parse added " + std::to_string(StringIndexer::getNumStrings() - numStrings) + " strings to the indexer");
+
+    // Parser by itself, then with the style filters deciding what to keep
+    parseTile(&acceptAll,false,nullptr);
+    Result *result = runner.run("vectortile","mvt/parse-eager",numFeatures,"features",[&]{ parseTile(&acceptAll,false,nullptr); });
+    runner.metric(result,"tile_bytes",(double)tileBytes.size());
+    runner.run("vectortile","mvt/parse-lazy",numFeatures,"features",[&]{ parseTile(&acceptAll,true,nullptr); });
+    runner.run("vectortile","mvt/parse-style-eager",numFeatures,"features",[&]{ parseTile(styleSet.get(),false,nullptr); });
+    runner.run("vectortile","mvt/parse-style-lazy",numFeatures,"features",[&]{ parseTile(styleSet.get(),true,nullptr); });
+
+    // Hang on to the features so we can time the filters alone.  Both ways of parsing have to keep the same ones.
+    parseTile(&acceptAll,false,&eagerFeatures);
+    parseTile(&acceptAll,true,&lazyFeatures);
+    if (eagerFeatures.size() != lazyFeatures.size())
+        runner.fail("vectortile","eager and lazy parses kept different features");
+
+    // The lazy features have to copy into a regular dictionary, as they do when a style merges in their attributes
+    for (const auto &feature : lazyFeatures)
+    {
+        const auto attrs = feature->getAttributes();
+        MutableDictionaryC attrsCopy;
+        attrsCopy.addEntries(attrs.get());
+        auto keys = attrs->getKeys();
+        auto copyKeys = attrsCopy.getKeys();
+        std::sort(keys.begin(),keys.end());
+        std::sort(copyKeys.begin(),copyKeys.end());
+        bool same = !keys.empty() && keys == copyKeys;
+        for (const auto &key : keys)
+            same = same && attrsCopy.getType(key) == attrs->getType(key) && attrsCopy.getString(key) == attrs->getString(key);
+        if (!same)
+        {
+            runner.fail("vectortile","copying a lazy feature's attributes lost some of them");
+            break;
+        }
+    }
+
+    std::vector<std::pair<MapboxVectorFilter *,std::string>> filters;
+    for (const auto &layer : styleSet->layers)
+        if (layer->filter)
+            filters.push_back(std::make_pair(layer->filter.get(),layer->sourceLayer));
+
+    // Each feature runs through the filters for its source layer, the same as stylesForFeature
+    static const std::string layerNameKey("layer_name");
+    std::vector<std::pair<MutableDictionaryRef,std::vector<MapboxVectorFilter *>>> eagerTests,lazyTests;
+    const auto setupTests = [&](const std::vector<VectorObjectRef> &features,decltype(eagerTests) &tests)
+    {
+        for (const auto &feature : features)
+        {
+            auto attrs = feature->getAttributes();
+            const std::string layerName = attrs->getString(layerNameKey);
+            std::vector<MapboxVectorFilter *> layerFilters;
+            for (const auto &filter : filters)
+                if (filter.second == layerName)
+                    layerFilters.push_back(filter.first);
+            tests.push_back(std::make_pair(attrs,layerFilters));
+        }
+    };
+    setupTests(eagerFeatures,eagerTests);
+    setupTests(lazyFeatures,lazyTests);
+
+    int treeMatches = 0, compiledMatches = 0, lazyMatches = 0;
+    Result *treeResult = runner.run("vectortile","filter/tree-walk",eagerTests.size(),"features",[&]{
+        treeMatches = 0;
+        for (const auto &test : eagerTests)
+            for (auto filter : test.second)
+                treeMatches += TreeTestFeature(*filter,*test.first);
+    });
+    Result *compiledResult = runner.run("vectortile","filter/compiled",eagerTests.size(),"features",[&]{
+        compiledMatches = 0;
+        for (const auto &test : eagerTests)
+            for (auto filter : test.second)
+                compiledMatches += filter->testFeature(*test.first,tileID);
+    });
+    runner.metric(compiledResult,"matches",compiledMatches);
+    Result *lazyResult = runner.run("vectortile","filter/compiled-lazy-attrs",lazyTests.size(),"features",[&]{
+        lazyMatches = 0;
+        for (const auto &test : lazyTests)
+            for (auto filter : test.second)
+                lazyMatches += filter->testFeature(*test.first,tileID);
+    });
+    if (treeResult && compiledResult && lazyResult && (treeMatches != compiledMatches || compiledMatches != lazyMatches))
+        runner.fail("vectortile","filter results differ: tree " + std::to_string(treeMatches) +
+                    " compiled " + std::to_string(compiledMatches) + " lazy " + std::to_string(lazyMatches));
+
+    // in and !in match across types, the way they did before they were compiled
+    {
+        const auto checkIn = [&](const std::string &filterJSON,const std::string &attrsJSON,bool expect)
+        {
+            auto filterDict = ParseJSONDictionary("{\"filter\":" + filterJSON + "}");
+            auto attrs = ParseJSONDictionary(attrsJSON);
+            MapboxVectorFilter filter;
+            if (!filterDict || !attrs || !filter.parse(filterDict->getArray("filter"),styleSet.get()) ||
+                filter.testFeature(*attrs,tileID) != expect)
+                runner.fail("vectortile","filter " + filterJSON + " on " + attrsJSON + " should be " + (expect ? "true" : "false"));
+        };
+        checkIn("[\"in\",\"rank\",\"1\",\"2\"]","{\"rank\":2}",true);
+        checkIn("[\"in\",\"rank\",1,2.5]","{\"rank\":\"2.5\"}",true);
+        checkIn("[\"in\",\"rank\",1,2]","{\"rank\":\"3\"}",false);
+        checkIn("[\"!in\",\"rank\",\"1\"]","{\"rank\":1}",false);
+        checkIn("[\"in\",\"rank\",\"\"]","{\"rank\":0}",false);
+    }
+
+    // Every zoom function in the style, evaluated the way tile building does
+    std::vector<MaplyVectorFunctionStopsRef> valStops,colorStops;
+    for (const auto &layerEntry : styleDict->getArray("layers"))
+    {
+        const auto layerDict = layerEntry->getDict();
+        for (const char *section : {"paint","layout"})
+        {
+            const auto sectionDict = layerDict->getDict(section);
+            if (!sectionDict)
+                continue;
+            for (const auto &key : sectionDict->getKeys())
+            {
+                const auto entry = sectionDict->getEntry(key);
+                if (entry->getType() != DictTypeDictionary)
+                    continue;
+                auto stops = std::make_shared<MaplyVectorFunctionStops>();
+                if (stops->parse(entry->getDict(),false))
+                    (stops->stops[0].color ? colorStops : valStops).push_back(stops);
+            }
+        }
+    }
+    std::vector<double> zooms;
+    for (double zoom = 0.0;zoom <= 22.0;zoom += 0.125)
+        zooms.push_back(zoom);
+    const int zoomReps = runner.size(200,20);
+    const size_t numEvals = zoomReps * zooms.size() * (valStops.size() + colorStops.size());
+
+    double scanSum = 0.0, compiledSum = 0.0;
+    Result *scanStopsResult = runner.run("vectortile","style/stops-scan",numEvals,"evals",[&]{
+        scanSum = 0.0;
+        for (int rep=0;rep<zoomReps;rep++)
+            for (double zoom : zooms)
+            {
+                for (const auto &stops : valStops)
+                    scanSum += ScanStopsValue(*stops,zoom);
+                for (const auto &stops : colorStops)
+                    scanSum += ScanStopsColor(*stops,zoom).r;
+            }
+    });
+    Result *compiledStopsResult = runner.run("vectortile","style/stops-compiled",numEvals,"evals",[&]{
+        compiledSum = 0.0;
+        for (int rep=0;rep<zoomReps;rep++)
+            for (double zoom : zooms)
+            {
+                for (const auto &stops : valStops)
+                    compiledSum += stops->valueForZoom(zoom);
+                for (const auto &stops : colorStops)
+                    compiledSum += stops->colorValueForZoom(zoom).r;
+            }
+    });
+    if (scanStopsResult && compiledStopsResult && std::abs(scanSum - compiledSum) > 1e-6 * std::abs(scanSum))
+        runner.fail("vectortile","compiled stops sum to " + std::to_string(compiledSum) + ", scanning gives " + std::to_string(scanSum));
+
+    // Tiles are built at whole levels, which come out of the tables
+    const size_t numLevelEvals = zoomReps * 23 * (valStops.size() + colorStops.size());
+    runner.run("vectortile","style/stops-levels",numLevelEvals,"evals",[&]{
+        double sum = 0.0;
+        for (int rep=0;rep<zoomReps;rep++)
+            for (int level=0;level<=22;level++)
+            {
+                for (const auto &stops : valStops)
+                    sum += stops->valueForZoom(level);
+                for (const auto &stops : colorStops)
+                    sum += stops->colorValueForZoom(level).r;
+            }
+        DoNotOptimize(sum);
+    });
+
+    // Compiled evaluation should be the old answer to within rounding
+    for (double zoom : zooms)
+    {
+        for (const auto &stops : valStops)
+            if (std::abs(stops->valueForZoom(zoom) - ScanStopsValue(*stops,zoom)) > 1e-9)
+            {
+                runner.fail("vectortile","compiled stops differ at zoom " + std::to_string(zoom));
+                break;
+            }
+        for (const auto &stops : colorStops)
+        {
+            const RGBAColor a = stops->colorValueForZoom(zoom), b = ScanStopsColor(*stops,zoom);
+            if (std::abs(a.r-b.r) > 1 || std::abs(a.g-b.g) > 1 || std::abs(a.b-b.b) > 1 || std::abs(a.a-b.a) > 1)
+            {
+                runner.fail("vectortile","compiled color stops differ at zoom " + std::to_string(zoom));
+                break;
+            }
+        }
+    }
+
+    // Stops out of order get sorted, so they come out the same as the ones written in order
+    {
+        auto sortedDict = ParseJSONDictionary("{\"base\":1.5,\"stops\":[[5,1],[10,4],[10,6],[15,12]]}");
+        auto unsortedDict = ParseJSONDictionary("{\"base\":1.5,\"stops\":[[10,4],[15,12],[5,1],[10,6]]}");
+        MaplyVectorFunctionStops sortedStops,unsortedStops;
+        if (!sortedDict || !unsortedDict || !sortedStops.parse(sortedDict,false) || !unsortedStops.parse(unsortedDict,false))
+            runner.fail("vectortile","couldn't parse out of order function stops");
+        else
+            for (double zoom : zooms)
+                if (sortedStops.valueForZoom(zoom) != unsortedStops.valueForZoom(zoom))
+                {
+                    runner.fail("vectortile","out of order stops differ at zoom " + std::to_string(zoom));
+                    break;
+                }
+    }
+
+    // Fill and line colors combined with their opacity, once per layer per level
+    std::vector<std::pair<MapboxTransColorRef,MapboxTransDoubleRef>> layerColors;
+    for (const auto &layer : styleSet->layers)
+    {
+        if (const auto fill = std::dynamic_pointer_cast<MapboxVectorLayerFill>(layer))
+            layerColors.emplace_back(fill->paint.color,fill->paint.opacity);
+        else if (const auto line = std::dynamic_pointer_cast<MapboxVectorLayerLine>(layer))
+            layerColors.emplace_back(line->paint.color,line->paint.opacity);
+    }
+    const size_t numResolves = zoomReps * 23 * layerColors.size();
+    runner.run("vectortile","style/resolve-color-ref",numResolves,"colors",[&]{
+        int sum = 0;
+        for (int rep=0;rep<zoomReps;rep++)
+            for (int level=0;level<=22;level++)
+                for (const auto &lc : layerColors)
+                    if (const auto color = MapboxVectorStyleSetImpl::resolveColor(lc.first,lc.second,level,MBResolveColorOpacityComposeAlpha))
+                        sum += color->a;
+        DoNotOptimize(sum);
+    });
+    runner.run("vectortile","style/resolve-color",numResolves,"colors",[&]{
+        int sum = 0;
+        RGBAColor color;
+        for (int rep=0;rep<zoomReps;rep++)
+            for (int level=0;level<=22;level++)
+                for (const auto &lc : layerColors)
+                    if (MapboxVectorStyleSetImpl::resolveColor(lc.first,lc.second,level,MBResolveColorOpacityComposeAlpha,color))
+                        sum += color.a;
+        DoNotOptimize(sum);
+    });
+
+    // Label text for the symbol layers, from the features they'd see
+    std::vector<std::pair<MapboxVectorLayerSymbol *,MapboxRegexField>> textLayers;
+    for (const auto &layer : styleSet->layers)
+        if (const auto symbol = std::dynamic_pointer_cast<MapboxVectorLayerSymbol>(layer))
+            if (symbol->layout.textField)
+                textLayers.emplace_back(symbol.get(),symbol->layout.textField->textForZoom(tileID.level));
+    std::vector<std::pair<MutableDictionaryRef,MutableDictionaryRef>> placeAttrs;
+    for (unsigned int ii=0;ii<eagerFeatures.size() && ii<lazyFeatures.size();ii++)
+    {
+        auto attrs = eagerFeatures[ii]->getAttributes();
+        if (attrs->getString(layerNameKey) == "place")
+            placeAttrs.emplace_back(attrs,lazyFeatures[ii]->getAttributes());
+    }
+    const int textReps = runner.size(50,5);
+    const size_t numTexts = textReps * placeAttrs.size() * textLayers.size();
+
+    size_t nameChars = 0, idChars = 0;
+    runner.run("vectortile","symbol/text-build-name",numTexts,"labels",[&]{
+        nameChars = 0;
+        for (int rep=0;rep<textReps;rep++)
+            for (const auto &attrs : placeAttrs)
+                for (const auto &textLayer : textLayers)
+                    nameChars += textLayer.second.build(attrs.first).size();
+    });
+    Result *idResult = runner.run("vectortile","symbol/text-build-id",numTexts,"labels",[&]{
+        idChars = 0;
+        for (int rep=0;rep<textReps;rep++)
+            for (const auto &attrs : placeAttrs)
+                for (const auto &textLayer : textLayers)
+                    idChars += textLayer.second.build(attrs.second).size();
+    });
+    runner.metric(idResult,"chars",(double)idChars / std::max(textReps,1));
+
+    // Looking up the keys by ID has to build the same text as by name
+    std::vector<std::string> rawTexts;
+    for (const auto &attrs : placeAttrs)
+        for (const auto &textLayer : textLayers)
+        {
+            const std::string byName = textLayer.second.build(attrs.first);
+            if (byName != textLayer.second.build(attrs.second))
+            {
+                runner.fail("vectortile","text built by key ID differs for '" + byName + "'");
+                break;
+            }
+            rawTexts.push_back(byName);
+        }
+
+    // Then the transform and line breaks, once per label or once per distinct label
+    const auto labelInfo = styleSet->makeLabelInfo(nullptr,{"Noto Sans Regular"},14.0,false);
+    if (!textLayers.empty() && !rawTexts.empty())
+    {
+        MapboxVectorLayerSymbol *symbol = textLayers[0].first;
+        const double breakWidth = symbol->layout.textMaxWidth->valForZoom(tileID.level) * labelInfo->fontPointSize;
+        const size_t numLabels = textReps * rawTexts.size();
+
+        size_t directChars = 0, cachedChars = 0, distinct = 0;
+        runner.run("vectortile","symbol/label-text-direct",numLabels,"labels",[&]{
+            directChars = 0;
+            for (int rep=0;rep<textReps;rep++)
+                for (const auto &rawText : rawTexts)
+                    if (!rawText.empty())
+                        directChars += symbol->breakUpText(nullptr,rawText,breakWidth,labelInfo).size();
+        });
+        Result *tileResult = runner.run("vectortile","symbol/label-text-per-tile",numLabels,"labels",[&]{
+            cachedChars = 0;
+            for (int rep=0;rep<textReps;rep++)
+            {
+                // A new tile, with nothing carried over from the last one
+                symbol->textCache = std::make_shared<MapboxLabelTextCache>();
+                MapboxLabelTextMap tileText;
+                for (const auto &rawText : rawTexts)
+                    if (!rawText.empty())
+                        cachedChars += symbol->layoutText(nullptr,rawText,breakWidth,labelInfo,tileText)->text.size();
+                distinct = tileText.size();
+            }
+        });
+        runner.metric(tileResult,"distinct",(double)distinct);
+        runner.run("vectortile","symbol/label-text-shared",numLabels,"labels",[&]{
+            // Later tiles find what the earlier ones laid out
+            for (int rep=0;rep<textReps;rep++)
+            {
+                MapboxLabelTextMap tileText;
+                for (const auto &rawText : rawTexts)
+                    if (!rawText.empty())
+                        DoNotOptimize(symbol->layoutText(nullptr,rawText,breakWidth,labelInfo,tileText)->text.size());
+            }
+        });
+
+        for (const auto &rawText : rawTexts)
+        {
+            if (rawText.empty())
+                continue;
+            MapboxLabelTextMap tileText;
+            if (symbol->layoutText(nullptr,rawText,breakWidth,labelInfo,tileText)->text !=
+                symbol->breakUpText(nullptr,rawText,breakWidth,labelInfo))
+            {
+                runner.fail("vectortile","cached label text differs for '" + rawText + "'");
+                break;
+            }
+        }
+    }
+
+    // Building the styles for a tile one after another, then with the thread safe ones on a pool
+    {
+        const auto tessDelegate = std::make_shared<TessDelegate>(8);
+        std::vector<std::string> serialSummary,parallelSummary;
+        const auto buildTile = [&](MapboxVectorTileParser &tileParser,const MapboxVectorTileParser::CancelFunction &cancelFn,
+                                   std::vector<std::string> &summary)
+        {
+            VectorTileData tileData;
+            tileData.ident = tileID;
+            tileData.bbox = tileBox;
+            RawDataWrapper rawData(tileBytes.data(),tileBytes.size(),false);
+            const bool ret = tileParser.parse(nullptr,&rawData,&tileData,cancelFn);
+            summary = SummarizeTile(tileData);
+            return ret;
+        };
+        const MapboxVectorTileParser::CancelFunction noCancel = [](PlatformThreadInfo *){ return false; };
+
+        MapboxVectorTileParser serialParser(nullptr,tessDelegate);
+        runner.run("vectortile","build/serial",numFeatures,"features",[&]{ buildTile(serialParser,noCancel,serialSummary); });
+
+        MapboxVectorTileParser parallelParser(nullptr,tessDelegate);
+        parallelParser.setBuildPool(std::make_shared<TaskPool>(runner.numThreads));
+        runner.run("vectortile","build/parallel",numFeatures,"features",[&]{ buildTile(parallelParser,noCancel,parallelSummary); });
+
+        if (!serialSummary.empty() && !parallelSummary.empty() && serialSummary != parallelSummary)
+            runner.fail("vectortile","building the styles in parallel gave a different tile than serially");
+
+        // Cancelling partway stops new styles from starting, but whatever was built still lands in the tile
+        tessDelegate->numBuilt = 0;
+        const MapboxVectorTileParser::CancelFunction cancelEarly = [&](PlatformThreadInfo *){ return tessDelegate->numBuilt >= 2; };
+        std::vector<std::string> cancelSummary;
+        if (buildTile(parallelParser,cancelEarly,cancelSummary) ||
+            tessDelegate->numBuilt >= (int)tessDelegate->styles.size() ||
+            (int)cancelSummary.size() != tessDelegate->numBuilt)
+            runner.fail("vectortile","cancelled build ran " + std::to_string(tessDelegate->numBuilt) + " styles and kept " +
+                        std::to_string(cancelSummary.size()));
+    }
+
+    // The real fill layers, which mustn't touch the features they share with the other styles
+    {
+        const auto fillDelegate = std::make_shared<FillDelegate>(styleSet);
+        std::vector<std::string> serialSummary,parallelSummary;
+        double arealSum = 0.0;
+        const auto buildTile = [&](MapboxVectorTileParser &tileParser,std::vector<std::string> &summary)
+        {
+            VectorTileData tileData;
+            tileData.ident = tileID;
+            tileData.bbox = tileBox;
+            RawDataWrapper rawData(tileBytes.data(),tileBytes.size(),false);
+            tileParser.parse(nullptr,&rawData,&tileData,nullptr);
+            summary.clear();
+            for (const auto &compObj : tileData.compObjs)
+                summary.push_back(compObj->uuid + ":" + std::to_string(compObj->vectorIDs.size()));
+            arealSum = SumAreals(tileData.vecObjs);
+        };
+
+        MapboxVectorTileParser serialParser(nullptr,fillDelegate);
+        serialParser.setKeepVectors(true);
+        if (!runner.run("vectortile","build/fill-serial",numFeatures,"features",[&]{ buildTile(serialParser,serialSummary); }))
+            buildTile(serialParser,serialSummary);
+
+        MapboxVectorTileParser parallelParser(nullptr,fillDelegate);
+        parallelParser.setKeepVectors(true);
+        parallelParser.setBuildPool(std::make_shared<TaskPool>(runner.numThreads));
+        if (runner.run("vectortile","build/fill-parallel",numFeatures,"features",[&]{ buildTile(parallelParser,parallelSummary); }))
+        {
+            if (serialSummary.empty() || serialSummary != parallelSummary)
+                runner.fail("vectortile","building the fill layers in parallel gave a different tile than serially");
+
+            // The features should come out of the build just as they went in
+            const double builtSum = arealSum;
+            fillDelegate->build = false;
+            std::vector<std::string> unbuiltSummary;
+            buildTile(parallelParser,unbuiltSummary);
+            fillDelegate->build = true;
+            if (builtSum != arealSum)
+                runner.fail("vectortile","the fill layers changed the features they were given");
+        }
+    }
+
+    scene.teardown(nullptr);
+}
@@ -0,0 +1,154 @@
+/*  BenchVertexAttribute.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "Benchmark.h"
+#import "BenchFixtures.h"
+#import "VertexAttribute.h"
+
+using namespace WhirlyKit;
+using namespace WhirlyKit::Bench;
+
+namespace
+{
+
+// The way attributes used to be stored: a std::vector of the right type behind a void pointer
+class VectorAttribute
+{
+public:
+    VectorAttribute(BDAttributeDataType dataType) : dataType(dataType) { }
+    ~VectorAttribute()
+    {
+        switch (dataType)
+        {
+            case BDFloat3Type: delete (std::vector<Eigen::Vector3f> *)data; break;
+            case BDChar4Type: delete (std::vector<RGBAColor> *)data; break;
+            case BDFloat2Type: delete (std::vector<Eigen::Vector2f> *)data; break;
+            default: break;
+        }
+    }
+
+    template<typename T> void add(BDAttributeDataType type,const T &val)
+    {
+        if (dataType != type)
+            return;
+        if (!data)
+            data = new std::vector<T>();
+        ((std::vector<T> *)data)->push_back(val);
+    }
+    template<typename T> int numElements() const { return data ? (int)((std::vector<T> *)data)->size() : 0; }
+
+    BDAttributeDataType dataType;
+    void *data = nullptr;
+};
+
+}
+
+WGBENCH_SUITE(vertexattribute)
+{
+    // Roughly what a vector tile produces: lots of small drawables
+    const int numDrawables = runner.size(2000,50);
+    const int vertsPerDrawable = 96;
+
+    const StringIdentity normalID = StringIndexer::getStringID("a_normal");
+    const StringIdentity colorID = StringIndexer::getStringID("a_color");
+    const StringIdentity texID = StringIndexer::getStringID("a_texCoord0");
+
+    std::vector<Eigen::Vector3f> normals(vertsPerDrawable,Eigen::Vector3f(0,0,1));
+    std::vector<RGBAColor> colors(vertsPerDrawable,RGBAColor(255,128,0,255));
+    std::vector<TexCoord> texCoords(vertsPerDrawable,TexCoord(0.5,0.5));
+
+    // One attribute set per drawable, the way the builders do it.  They all stick around
+    //  until the build is done, like drawables waiting to be handed to the scene.
+    // With useArena the drawables share one arena, as they do within a builder.
+    const auto build = [&](bool useArena,bool bulk)
+    {
+        VertexAttributeArenaRef arena = useArena ? std::make_shared<VertexAttributeArena>() : nullptr;
+        std::vector<VertexAttribute> attrs;
+        attrs.reserve(3*numDrawables);
+        size_t total = 0;
+        for (int id=0;id<numDrawables;id++)
+        {
+            attrs.emplace_back(BDFloat3Type,0,normalID);
+            attrs.emplace_back(BDChar4Type,1,colorID);
+            attrs.emplace_back(BDFloat2Type,2,texID);
+            VertexAttribute &normAttr = attrs[attrs.size()-3];
+            VertexAttribute &colorAttr = attrs[attrs.size()-2];
+            VertexAttribute &texAttr = attrs[attrs.size()-1];
+            if (arena)
+            {
+                normAttr.setArena(arena);
+                colorAttr.setArena(arena);
+                texAttr.setArena(arena);
+            }
+            if (bulk)
+            {
+                normAttr.append(normals);
+                colorAttr.append(colors);
+                texAttr.append(texCoords);
+            }
+            else
+            {
+                for (int iv=0;iv<vertsPerDrawable;iv++)
+                {
+                    normAttr.addVector3f(normals[iv]);
+                    colorAttr.addColor(colors[iv]);
+                    texAttr.addVector2f(texCoords[iv]);
+                }
+            }
+            total += normAttr.numElements() + colorAttr.numElements() + texAttr.numElements();
+        }
+        DoNotOptimize(total);
+        return total;
+    };
+
+    const auto buildVectors = [&]
+    {
+        std::vector<std::unique_ptr<VectorAttribute>> attrs;
+        attrs.reserve(3*numDrawables);
+        size_t total = 0;
+        for (int id=0;id<numDrawables;id++)
+        {
+            attrs.push_back(std::make_unique<VectorAttribute>(BDFloat3Type));
+            attrs.push_back(std::make_unique<VectorAttribute>(BDChar4Type));
+            attrs.push_back(std::make_unique<VectorAttribute>(BDFloat2Type));
+            VectorAttribute &normAttr = *attrs[attrs.size()-3];
+            VectorAttribute &colorAttr = *attrs[attrs.size()-2];
+            VectorAttribute &texAttr = *attrs[attrs.size()-1];
+            for (int iv=0;iv<vertsPerDrawable;iv++)
+            {
+                normAttr.add(BDFloat3Type,normals[iv]);
+                colorAttr.add(BDChar4Type,colors[iv]);
+                texAttr.add(BDFloat2Type,Eigen::Vector2f(texCoords[iv].x(),texCoords[iv].y()));
+            }
+            total += normAttr.numElements<Eigen::Vector3f>() + colorAttr.numElements<RGBAColor>() +
+                     texAttr.numElements<Eigen::Vector2f>();
+        }
+        DoNotOptimize(total);
+        return total;
+    };
+
+    const size_t expected = buildVectors();
+    if (build(false,false) != expected || build(true,false) != expected || build(true,true) != expected)
+        runner.fail("vertexattribute","arena and heap builds have different sizes");
+
+    const double numVerts = (double)numDrawables * vertsPerDrawable;
+    runner.run("vertexattribute","std-vector/per-vertex",numVerts,"verts",[&]{ buildVectors(); });
+    runner.run("vertexattribute","heap/per-vertex",numVerts,"verts",[&]{ build(false,false); });
+    runner.run("vertexattribute","arena/per-vertex",numVerts,"verts",[&]{ build(true,false); });
+    runner.run("vertexattribute","arena/bulk",numVerts,"verts",[&]{ build(true,true); });
+}
@@ -0,0 +1,187 @@
+/*  Benchmark.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <chrono>
+#import <cstdio>
+#import <thread>
+#import "Benchmark.h"
+
+namespace WhirlyKit
+{
+namespace Bench
+{
+
+static std::map<std::string,SuiteFunc> &SuiteMap()
+{
+    static std::map<std::string,SuiteFunc> suites;
+    return suites;
+}
+
+SuiteRegistrar::SuiteRegistrar(const char *name,SuiteFunc func)
+{
+    SuiteMap()[name] = func;
+}
+
+const std::map<std::string,SuiteFunc> &Suites()
+{
+    return SuiteMap();
+}
+
+Runner::Runner()
+{
+    numThreads = std::max(2,(int)std::thread::hardware_concurrency());
+}
+
+bool Runner::enabled(const std::string &suite,const std::string &name) const
+{
+    return filter.empty() || (suite + "/" + name).find(filter) != std::string::npos;
+}
+
+Result *Runner::run(const std::string &suite,const std::string &name,
+                    double items,const std::string &itemName,
+                    const std::function<void()> &body)
+{
+    if (!enabled(suite,name))
+        return nullptr;
+
+    typedef std::chrono::steady_clock Clock;
+
+    // One untimed run to warm the caches, unless we're only running once
+    if (!quick)
+        body();
+
+    int iterations = 0;
+    const auto start = Clock::now();
+    double elapsed = 0.0;
+    do
+    {
+        body();
+        iterations++;
+        elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+    while (!quick && elapsed < minTime);
+
+    Result result;
+    result.suite = suite;
+    result.name = name;
+    result.iterations = iterations;
+    result.secPerIter = elapsed / iterations;
+    result.items = items;
+    result.itemName = itemName;
+    results.push_back(result);
+
+    return &results.back();
+}
+
+void Runner::metric(Result *result,const std::string &key,double value)
+{
+    if (result)
+        result->metrics[key] = value;
+}
+
+void Runner::fail(const std::string &suite,const std::string &what)
+{
+    failures.push_back(suite + ": " + what);
+    fprintf(stderr,"FAILED %s: %s\n",suite.c_str(),what.c_str());
+}
+
+void Runner::report() const
+{
+    printf("%-16s %-40s %8s %14s %16s\n","suite","benchmark","iters","ms/iter","items/sec");
+    for (const auto &result : results)
+    {
+        char rate[64] = "";
+        if (result.items > 0.0 && result.secPerIter > 0.0)
+            snprintf(rate,sizeof(rate),"%.4g %s",result.items / result.secPerIter,result.itemName.c_str());
+        printf("%-16s %-40s %8d %14.4f %16s",result.suite.c_str(),result.name.c_str(),
+               result.iterations,result.secPerIter*1000.0,rate);
+        for (const auto &metric : result.metrics)
+            printf("  %s=%g",metric.first.c_str(),metric.second);
+        printf("\n");
+    }
+}
+
+static void WriteJSONString(FILE *fp,const std::string &str)
+{
+    fputc('"',fp);
+    for (char c : str)
+    {
+        if (c == '"' || c == '\\')
+            fputc('\\',fp);
+        if ((unsigned char)c >= 0x20)
+            fputc(c,fp);
+    }
+    fputc('"',fp);
+}
+
+bool Runner::writeJSON(const std::string &fileName) const
+{
+    FILE *fp = fopen(fileName.c_str(),"w");
+    if (!fp)
+    {
+        fprintf(stderr,"Unable to write %s\n",fileName.c_str());
+        return false;
+    }
+
+    fprintf(fp,"{\n  \"quick\": %s,\n  \"threads\": %d,\n  \"results\": [",quick ? "true" : "false",numThreads);
+    bool first = true;
+    for (const auto &result : results)
+    {
+        fprintf(fp,"%s\n    {\"suite\": ",first ? "" : ",");
+        first = false;
+        WriteJSONString(fp,result.suite);
+        fprintf(fp,", \"name\": ");
+        WriteJSONString(fp,result.name);
+        fprintf(fp,", \"iterations\": %d, \"sec_per_iter\": %.9g",result.iterations,result.secPerIter);
+        if (result.items > 0.0)
+        {
+            fprintf(fp,", \"items\": %.9g, \"item\": ",result.items);
+            WriteJSONString(fp,result.itemName);
+            fprintf(fp,", \"items_per_sec\": %.9g",result.secPerIter > 0.0 ? result.items / result.secPerIter : 0.0);
+        }
+        if (!result.metrics.empty())
+        {
+            fprintf(fp,", \"metrics\": {");
+            bool firstMetric = true;
+            for (const auto &metric : result.metrics)
+            {
+                fprintf(fp,"%s",firstMetric ? "" : ", ");
+                firstMetric = false;
+                WriteJSONString(fp,metric.first);
+                fprintf(fp,": %.9g",metric.second);
+            }
+            fprintf(fp,"}");
+        }
+        fprintf(fp,"}");
+    }
+    fprintf(fp,"\n  ],\n  \"failures\": [");
+    first = true;
+    for (const auto &failure : failures)
+    {
+        fprintf(fp,"%s\n    ",first ? "" : ",");
+        first = false;
+        WriteJSONString(fp,failure);
+    }
+    fprintf(fp,"\n  ]\n}\n");
+    fclose(fp);
+
+    return true;
+}
+
+}
+}
@@ -0,0 +1,119 @@
+/*  Benchmark.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <deque>
+#import <functional>
+#import <map>
+#import <string>
+#import <vector>
+
+namespace WhirlyKit
+{
+namespace Bench
+{
+
+/// Timing for one benchmark
+struct Result
+{
+    std::string suite;
+    std::string name;
+    // Number of times the body ran
+    int iterations = 0;
+    // Wall time per run
+    double secPerIter = 0.0;
+    // Items per run, when the benchmark has a natural unit (features, labels, points)
+    double items = 0.0;
+    std::string itemName;
+    // Anything else worth tracking, such as equivalence checks or sizes
+    std::map<std::string,double> metrics;
+};
+
+/** Runs benchmarks and collects the results.
+    Each body is run repeatedly until it has taken up minTime, then the
+    per-iteration time is reported.  In quick mode each body runs once,
+    which is what the ctest smoke test uses.
+  */
+class Runner
+{
+public:
+    Runner();
+
+    /// Only run benchmarks whose "suite/name" contains this
+    std::string filter;
+    /// Run each body once
+    bool quick = false;
+    /// Keep running a body at least this long, in seconds
+    double minTime = 0.25;
+    /// Threads to use for the multi-threaded benchmarks
+    int numThreads;
+
+    /// True if the given benchmark passes the filter
+    bool enabled(const std::string &suite,const std::string &name) const;
+
+    /// Time the body and record the result.  Returns the result, or null if it was filtered out.
+    Result *run(const std::string &suite,const std::string &name,
+                double items,const std::string &itemName,
+                const std::function<void()> &body);
+
+    /// Attach an extra value to a result
+    void metric(Result *result,const std::string &key,double value);
+
+    /// Record a failed check.  The process exits non-zero if there are any.
+    void fail(const std::string &suite,const std::string &what);
+
+    /// Pick a size, smaller in quick mode
+    int size(int full,int quickSize) const { return quick ? quickSize : full; }
+
+    /// Print a table to stdout
+    void report() const;
+    /// Write everything out as JSON
+    bool writeJSON(const std::string &fileName) const;
+
+    const std::vector<std::string> &getFailures() const { return failures; }
+
+protected:
+    // A deque so the pointers run() hands back stay good
+    std::deque<Result> results;
+    std::vector<std::string> failures;
+};
+
+typedef void (*SuiteFunc)(Runner &);
+
+/// Registers a suite at startup
+struct SuiteRegistrar
+{
+    SuiteRegistrar(const char *name,SuiteFunc func);
+};
+
+/// All the registered suites, in name order
+const std::map<std::string,SuiteFunc> &Suites();
+
+/// Keep the compiler from optimizing away a value
+template<typename T> inline void DoNotOptimize(const T &value)
+{
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+}
+}
+
+/// Define a benchmark suite.  The body gets a Runner called runner.
+#define WGBENCH_SUITE(suiteName) \
+    static void wgBenchSuite_##suiteName(WhirlyKit::Bench::Runner &runner); \
+    static WhirlyKit::Bench::SuiteRegistrar wgBenchRegistrar_##suiteName(#suiteName,wgBenchSuite_##suiteName); \
+    static void wgBenchSuite_##suiteName(WhirlyKit::Bench::Runner &runner)
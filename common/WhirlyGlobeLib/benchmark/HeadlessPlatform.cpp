@@ -0,0 +1,86 @@
+/*  HeadlessPlatform.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdarg>
+#import <cstdio>
+#import "Platform.h"
+#import "WhirlyKitLog.h"
+#import "DictionaryC.h"
+#import "ComponentManager.h"
+
+// The few platform hooks the core needs, for running without a device.
+// Logging below warnings is dropped so it doesn't skew the timings.
+
+namespace WhirlyKit
+{
+
+TimeInterval TimeGetCurrent()
+{
+    struct timespec tp;
+    clock_gettime(CLOCK_REALTIME, &tp);
+
+    return (double)tp.tv_sec + tp.tv_nsec * (double)1e-9;
+}
+
+float DeviceScreenScale()
+{
+    return 1.0;
+}
+
+MutableDictionaryRef MutableDictionaryMake()
+{
+    return std::make_shared<MutableDictionaryC>();
+}
+
+// Plain component objects, there's no platform side to tell about removals
+class ComponentManager_Headless : public ComponentManager
+{
+public:
+    virtual ComponentObjectRef makeComponentObject(__unused const Dictionary *desc) override
+    {
+        return std::make_shared<ComponentObject>();
+    }
+};
+
+ComponentManagerRef MakeComponentManager()
+{
+    return std::make_shared<ComponentManager_Headless>();
+}
+
+}
+
+void wkLog(const char *formatStr,...)
+{
+    va_list args;
+    va_start(args, formatStr);
+    vfprintf(stderr, formatStr, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
+
+void wkLogLevel_(WKLogLevel level,const char *formatStr,...)
+{
+    if (level < Warn)
+        return;
+
+    va_list args;
+    va_start(args, formatStr);
+    vfprintf(stderr, formatStr, args);
+    fputc('\n', stderr);
+    va_end(args);
+}
@@ -0,0 +1,52 @@
+/*  HeadlessPrefix.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+// Prefix header for the headless build.
+// The core is written against libc++ on iOS and Android, which pulls in
+// more of the standard library transitively than libstdc++ does.
+
+#ifndef __unused
+#define __unused __attribute__((unused))
+#endif
+
+#ifdef __cplusplus
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+
+// libc++ has string_view in C++14 mode, libstdc++ only has it as experimental
+#if __cplusplus < 201703L && !defined(_LIBCPP_VERSION)
+#include <experimental/string_view>
+namespace std
+{
+    using std::experimental::string_view;
+}
+#endif
+#endif
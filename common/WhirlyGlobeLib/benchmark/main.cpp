@@ -0,0 +1,78 @@
+/*  main.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <algorithm>
+#import <cstdio>
+#import <cstdlib>
+#import <cstring>
+#import "Benchmark.h"
+
+using namespace WhirlyKit::Bench;
+
+static void Usage()
+{
+    printf("wgbench [--quick] [--filter <text>] [--min-time <sec>] [--threads <n>] [--json <file>] [--list]\n");
+    printf("  --quick      Run each benchmark once on small inputs\n");
+    printf("  --filter     Only run benchmarks whose suite/name contains the text\n");
+    printf("  --min-time   Minimum time to spend on each benchmark\n");
+    printf("  --threads    Threads for the multi-threaded benchmarks\n");
+    printf("  --json       Write the results to a file as JSON\n");
+    printf("  --list       List the suites\n");
+}
+
+int main(int argc,char *argv[])
+{
+    Runner runner;
+    std::string jsonFile;
+
+    for (int ii=1;ii<argc;ii++)
+    {
+        const char *arg = argv[ii];
+        const bool hasValue = ii+1 < argc;
+        if (!strcmp(arg,"--quick"))
+            runner.quick = true;
+        else if (!strcmp(arg,"--filter") && hasValue)
+            runner.filter = argv[++ii];
+        else if (!strcmp(arg,"--min-time") && hasValue)
+            runner.minTime = atof(argv[++ii]);
+        else if (!strcmp(arg,"--threads") && hasValue)
+            runner.numThreads = std::max(1,atoi(argv[++ii]));
+        else if (!strcmp(arg,"--json") && hasValue)
+            jsonFile = argv[++ii];
+        else if (!strcmp(arg,"--list"))
+        {
+            for (const auto &suite : Suites())
+                printf("%s\n",suite.first.c_str());
+            return 0;
+        }
+        else
+        {
+            Usage();
+            return !strcmp(arg,"--help") ? 0 : 1;
+        }
+    }
+
+    for (const auto &suite : Suites())
+        suite.second(runner);
+
+    runner.report();
+    if (!jsonFile.empty() && !runner.writeJSON(jsonFile))
+        return 1;
+
+    return runner.getFailures().empty() ? 0 : 2;
+}
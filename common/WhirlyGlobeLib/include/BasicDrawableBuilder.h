@@ -174,6 +174,9 @@ public:
     /// Add a point when building up geometry.  Returns the index.
     virtual unsigned int addPoint(const Point3f &pt);
     virtual unsigned int addPoint(const Point3d &pt);
+
+    /// Add a run of points.  Returns the index of the first one.
+    virtual unsigned int addPoints(const Point3f *pts,size_t num);
     
     /// Number of points added so far
     virtual unsigned int getNumPoints() const;
@@ -194,6 +197,15 @@ public:
     /// Add a normal
     virtual void addNormal(const Point3f &norm);
     virtual void addNormal(const Point3d &norm);
+
+    /// Add a run of texture coordinates.  -1 adds them to all the texture coordinate sets.
+    virtual void addTexCoords(int which,const TexCoord *coords,size_t num);
+
+    /// Add a run of colors
+    virtual void addColors(const RGBAColor *colors,size_t num);
+
+    /// Add a run of normals
+    virtual void addNormals(const Point3f *norms,size_t num);
     
     /// If there's a calculation pass, this is the data we'll pass in.
     /// This is just for Metal at the moment.
@@ -231,6 +243,10 @@ public:
     
     /// Add an identity-type value to the given attribute array
     virtual void addAttributeValue(int attrId,int64_t val);
+
+    /// Add a run of values to the given attribute array.  The type has to match the attribute's.
+    template<typename T> void addAttributeValues(int attrId,const T *vals,size_t num)
+        { basicDraw->vertexAttributes[attrId]->append(vals,num); }
     
     /// Find the index of a given attribute
     virtual int findAttribute(int nameID);
@@ -276,6 +292,9 @@ public:
     // The basic drawable we're building up
     BasicDrawableRef basicDraw;
 
+    // Vertex attribute data for this drawable comes from here
+    VertexAttributeArenaRef attrArena;
+
     // Used by subclasses to do the standard init
     virtual void Init();
     // Set up the standard vertex attributes we use
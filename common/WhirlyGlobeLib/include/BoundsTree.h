@@ -0,0 +1,144 @@
+/*  BoundsTree.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdint>
+#import <vector>
+
+namespace WhirlyKit
+{
+
+/** Axis aligned bounding box tree that's updated one object at a time.
+
+    This is a balanced binary tree of boxes, like the ones physics engines
+    use for broad phase collision.  Inserts pick the sibling that grows the
+    tree the least and removes rotate to keep the height down, so both are
+    O(log n).  Queries take a box test, so you can search with a rectangle,
+    a frustum or whatever else.
+
+    Objects are identified by a 64 bit value of your choosing.  Insert hands
+    back a handle you'll need to remove the object later.
+  */
+template <int Dim>
+class BoundsTree
+{
+public:
+    BoundsTree() = default;
+
+    /// Add an object with the given bounds.  Returns the handle for removal.
+    int insert(const double *ll,const double *ur,uint64_t data);
+
+    /// Remove the object with the given handle
+    void remove(int handle);
+
+    /// Data for the given handle
+    uint64_t getData(int handle) const { return nodes[handle].data; }
+
+    /// Number of objects in the tree
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    /// Clear everything out
+    void clear();
+
+    /** Visit every object whose bounds pass the test.
+        boxTest(ll,ur) returns false to skip a box and everything under it.
+        visit(data) is called for each object that passed.
+      */
+    template <typename TBoxTest,typename TVisit>
+    void query(const TBoxTest &boxTest,const TVisit &visit) const
+    {
+        if (root < 0)
+        {
+            return;
+        }
+
+        std::vector<int> &stack = queryStack;
+        stack.clear();
+        stack.push_back(root);
+        while (!stack.empty())
+        {
+            const Node &node = nodes[stack.back()];
+            stack.pop_back();
+
+            if (!boxTest(node.ll,node.ur))
+            {
+                continue;
+            }
+
+            if (node.isLeaf())
+            {
+                visit(node.data);
+            }
+            else
+            {
+                stack.push_back(node.child1);
+                stack.push_back(node.child2);
+            }
+        }
+    }
+
+    /// Visit every object overlapping the given box
+    template <typename TVisit>
+    void queryBox(const double *ll,const double *ur,const TVisit &visit) const
+    {
+        query([ll,ur](const double *nodeLL,const double *nodeUR)
+              {
+                  for (int ii=0;ii<Dim;ii++)
+                  {
+                      if (nodeUR[ii] < ll[ii] || nodeLL[ii] > ur[ii])
+                          return false;
+                  }
+                  return true;
+              },visit);
+    }
+
+protected:
+    struct Node
+    {
+        double ll[Dim];
+        double ur[Dim];
+        uint64_t data = 0;
+        // Doubles as the free list link
+        int parent = -1;
+        int child1 = -1;
+        int child2 = -1;
+        // Leaves are 0, free nodes are -1
+        int height = -1;
+
+        bool isLeaf() const { return child1 < 0; }
+    };
+
+    int allocNode();
+    void freeNode(int which);
+    void insertLeaf(int leaf);
+    void removeLeaf(int leaf);
+    int balance(int which);
+    void refit(int which);
+
+    std::vector<Node> nodes;
+    int root = -1;
+    int freeList = -1;
+    int count = 0;
+    // Reused between queries.  Queries aren't thread safe for the same tree.
+    mutable std::vector<int> queryStack;
+};
+
+extern template class BoundsTree<2>;
+extern template class BoundsTree<3>;
+
+}
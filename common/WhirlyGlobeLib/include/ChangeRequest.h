@@ -16,6 +16,7 @@
  *  limitations under the License.
  */
 
+#import <atomic>
 #import <vector>
 #import <set>
 #import <map>
@@ -101,5 +102,52 @@ typedef struct ChangeSorter
 } ChangeSorter;
 /// This version is sorted by when to run it
 typedef std::set<ChangeRequest *,ChangeSorter> SortedChangeSet;
+
+/** Lock free queue for handing change requests to the renderer.
+    Any number of threads can push, but only one should drain.
+    Pushes are a single compare and swap, so producers never wait on each other
+    or on the renderer.  Changes come out in the order they went in.
+  */
+class ChangeRequestQueue
+{
+public:
+    ChangeRequestQueue();
+    /// Deletes anything still in the queue
+    ~ChangeRequestQueue();
+
+    ChangeRequestQueue(const ChangeRequestQueue &) = delete;
+    ChangeRequestQueue &operator=(const ChangeRequestQueue &) = delete;
+
+    /// Add a single change.  Null is allowed, it just takes up a slot.
+    void push(ChangeRequest *change);
+
+    /// Take over the contents of the change set, leaving it empty
+    void push(ChangeSet &changes);
+
+    /// True if there's nothing waiting.  Only a hint if others are pushing.
+    bool empty() const { return head.load(std::memory_order_acquire) == nullptr; }
+
+    /// Number of changes waiting.  Only a hint if others are pushing.
+    int size() const { return count.load(std::memory_order_relaxed); }
+
+    /// Append everything that's been pushed to the change set, oldest first.
+    /// Returns the number of changes added.  Consumer thread only.
+    int drain(ChangeSet &changes);
+
+protected:
+    // Changes from one push call
+    struct Node
+    {
+        ChangeRequest *change = nullptr;
+        ChangeSet changes;
+        Node *next = nullptr;
+    };
+
+    void pushNode(Node *node,int num);
+
+    // Most recent push first
+    std::atomic<Node *> head;
+    std::atomic<int> count;
+};
     
 }
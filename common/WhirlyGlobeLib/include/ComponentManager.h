@@ -33,6 +33,7 @@
 #import "VectorObject.h"
 #import "WideVectorManager.h"
 #import "SelectionManager.h"
+#import "BoundsTree.h"
 
 namespace WhirlyKit
 {
@@ -59,7 +60,8 @@ public:
     SimpleIDSet selectIDs;
     SimpleIDSet drawStringIDs;
     
-    // Vectors objects associated with this component object
+    // Vectors objects associated with this component object.
+    // These are indexed for findVectors() when the object is added, so fill them in before that.
     std::vector<VectorObjectRef> vecObjs;
     
     Point2d vectorOffset;
@@ -76,7 +78,11 @@ public:
     
     // Empty out references
     void clear();
-    
+
+protected:
+    // Where the vectors are in the component manager's index, if they are
+    int vecIndexHandle = -1;
+
 public:
     // Don't call this
     ComponentObject(bool enable = false, bool selectable = false);
@@ -212,8 +218,15 @@ protected:
                            TIter beg, TIter end,
                            ChangeSet &changes);
 
+    // Add or remove the object's vectors from the spatial index.  Call with the lock held.
+    void indexVectors_NoLock(const ComponentObjectRef &compObj,const Point2d *ll,const Point2d *ur);
+    void unindexVectors_NoLock(const ComponentObjectRef &compObj);
+
     ComponentObjectMap compObjsById;
 
+    // Geographic bounds of the component objects with vectors, keyed by ID
+    BoundsTree<2> vecIndex;
+
     std::unordered_multimap<std::string, ComponentObjectRef> compObjsByUUID;
 
     std::unordered_map<std::string, std::string> representations;
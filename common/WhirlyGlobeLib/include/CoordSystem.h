@@ -70,6 +70,16 @@ public:
     /// Convert from display coordinates to geocentric
     virtual Point3f geocentricToLocal(Point3f) const = 0;
     virtual Point3d geocentricToLocal(Point3d) const = 0;
+
+    /** Batch versions of the conversions above.
+        These convert a run of points with a single virtual call.  The defaults
+        just call the single point versions, subclasses do better where they can.
+        For the 3d to 3d versions the input and output may be the same array.
+      */
+    virtual void localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const;
+    virtual void geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const;
+    virtual void localToGeocentricBatch(const Point3d *in,Point3d *out,size_t count) const;
+    virtual void geocentricToLocalBatch(const Point3d *in,Point3d *out,size_t count) const;
     
     /// Return true if the given coordinate system is the same as the one passed in
     virtual bool isSameAs(const CoordSystem *coordSys) const { return false; }
@@ -80,6 +90,8 @@ typedef std::shared_ptr<CoordSystem> CoordSystemRef;
 /// Convert a point from one coordinate system to another
 Point3f CoordSystemConvert(const CoordSystem *inSystem,const CoordSystem *outSystem,const Point3f &inCoord);
 Point3d CoordSystemConvert3d(const CoordSystem *inSystem,const CoordSystem *outSystem,const Point3d &inCoord);
+/// Convert a run of points from one coordinate system to another.  Input and output may be the same.
+void CoordSystemConvert3d(const CoordSystem *inSystem,const CoordSystem *outSystem,const Point3d *inCoords,Point3d *outCoords,size_t count);
     
 /** The Coordinate System Display Adapter handles the task of
     converting coordinates in the native system to data values we
@@ -147,12 +159,24 @@ public:
     virtual Point3f normalForLocal(Point3f) const = 0;
     virtual Point3d normalForLocal(Point3d) const = 0;
 
+    /// Batch versions of the above.  One virtual call for the lot.  Input and output may be the same.
+    virtual void localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const;
+    virtual void displayToLocalBatch(const Point3d *in,Point3d *out,size_t count) const;
+    virtual void normalForLocalBatch(const Point3d *in,Point3d *out,size_t count) const;
+
+    /// Convert geographic (radians) to display coordinates by way of the coordinate system
+    void geographicToDisplayBatch(const Point2d *in,Point3d *out,size_t count) const;
+
     /// Get a reference to the coordinate system
     virtual CoordSystem *getCoordSystem() const = 0;
     
     /// Return true if this is a projected coordinate system.
     /// False for others, like geographic.
     virtual bool isFlat() const = 0;
+
+    /// Return true if localToDisplay() and displayToLocal() can be called from several threads at once.
+    /// Anything that goes through Proj-4 can't, since it shares one context between threads.
+    virtual bool isThreadSafe() const { return false; }
     
 protected:
     Point3d center;
@@ -177,6 +201,9 @@ public:
 
     /// Return the valid area of the source coordinate system in display coordinates
     virtual bool getDisplayBounds(Point3d &ll,Point3d &ur) const override;
+
+    /// Just a scale and offset
+    virtual bool isThreadSafe() const override { return true; }
     
     /// Return the valid area of the coordinate system in lon/lat radians
     virtual bool getGeoBounds(Point2d &ll,Point2d &ur) const override;
@@ -192,6 +219,11 @@ public:
     /// For flat systems the normal is Z up.
     virtual Point3f normalForLocal(Point3f) const override { return Point3f(0,0,1); }
     virtual Point3d normalForLocal(Point3d) const override { return Point3d(0,0,1); }
+
+    /// Batch versions of the above
+    virtual void localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const override;
+    virtual void displayToLocalBatch(const Point3d *in,Point3d *out,size_t count) const override;
+    virtual void normalForLocalBatch(const Point3d *in,Point3d *out,size_t count) const override;
     
     /// Get a reference to the coordinate system
     virtual CoordSystem *getCoordSystem() const override { return coordSys; }
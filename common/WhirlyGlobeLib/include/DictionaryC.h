@@ -35,6 +35,11 @@ typedef std::shared_ptr<MutableDictionaryC> MutableDictionaryCRef;
 class DictionaryEntryC;
 typedef std::shared_ptr<DictionaryEntryC> DictionaryEntryCRef;
 
+/// Convert a packed ARGB value to a color
+RGBAColor ARGBtoRGBAColor(uint32_t v);
+/// Parse a hex color (RRGGBBAA, RRGGBB, RGBA or RGB) without the leading '#'
+RGBAColor parseColor(const char* p, RGBAColor defVal);
+
 /// The Dictionary is my cross platform replacement for NSDictionary
 /// TODO: Removing & adding things repeatedly will just cause this to grow
 class MutableDictionaryC : public MutableDictionary
@@ -118,6 +123,17 @@ public:
     // Return an array of keys
     virtual std::vector<std::string> getKeys() const override;
 
+    /// A top level value without any conversions or copies.  Strings point into the dictionary.
+    struct ValueRef
+    {
+        DictionaryType type = DictTypeNone;
+        double num = 0.0;
+        const std::string *str = nullptr;
+    };
+
+    /// Look up a value and its type with a single search.  False if it's missing.
+    bool findValue(const std::string &name,ValueRef &val) const;
+
     /// Get the key for the given string
     int getKeyID(const std::string &name);
     
@@ -0,0 +1,141 @@
+/*  DrawListBuilder.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <vector>
+#import "WhirlyVector.h"
+#import "Drawable.h"
+#import "SceneRenderer.h"
+#import "TaskPool.h"
+
+namespace WhirlyKit
+{
+
+/// A drawable to render, along with the matrices to render it with
+struct DrawListEntry
+{
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+    Drawable *drawable = nullptr;
+    /// Which of the frame's offset matrices this is for
+    int offset = 0;
+    /// Model/view/projection, including the drawable's local matrix
+    Eigen::Matrix4d mvpMat;
+    Eigen::Matrix4d mvpInvMat;
+    /// Model/view, including the drawable's local matrix
+    Eigen::Matrix4d mvMat;
+    Eigen::Matrix4d mvNormalMat;
+};
+typedef std::vector<DrawListEntry,Eigen::aligned_allocator<DrawListEntry>> DrawList;
+
+/** Works out what's visible and what order to draw it in.
+
+    This is the CPU side of rendering a frame, pulled out of the renderer so
+    it doesn't need a graphics context.  Give it the frame info and the
+    drawables and it hands back one entry per visible drawable per offset
+    matrix, sorted by draw priority (and z buffer request, if asked), then ID.
+
+    Culling and the matrix math can be spread over a TaskPool.  If nothing
+    has changed since the last frame the previous list is handed back as is.
+    That includes the drawables' local matrices, priorities and z buffer requests,
+    which are checked every frame.
+  */
+class DrawListBuilder
+{
+public:
+    DrawListBuilder() = default;
+
+    /// Cull and build matrices on the given pool.  Null, the default, does it all on the caller.
+    /// Drawable::isOn() is called from the pool's threads when this is set.
+    void setTaskPool(TaskPoolRef pool) { taskPool = std::move(pool); }
+
+    /// If set, drawables that don't want the z buffer sort ahead of those that do at the same priority
+    void setSortZBuffer(bool newVal);
+
+    /// Build the draw list from the given drawables.
+    /// The frame info needs the view, projection and model matrices plus the offset matrices filled in.
+    const DrawList &build(RendererFrameInfo *frameInfo,const std::vector<Drawable *> &drawables);
+
+    /// Build the draw list from everything in the given work groups
+    const DrawList &build(RendererFrameInfo *frameInfo,const std::vector<WorkGroupRef> &workGroups);
+
+    /// The list from the last build
+    const DrawList &getDrawList() const { return drawList; }
+
+    /// True if the last build reused the list from the one before
+    bool wasReused() const { return reused; }
+
+    /// Don't reuse the current list next time.
+    /// Call this when drawables have changed in ways we can't see, like a subclass with its own sort rules.
+    void invalidate() { valid = false; }
+
+    /// Clear out the list and anything cached
+    void clear();
+
+protected:
+    // Stand-in for the drawable when sorting, so we're not making virtual calls
+    struct SortKey
+    {
+        unsigned int priority;
+        bool zBuffer;
+        SimpleIdentity drawID;
+        int offset;
+        Drawable *drawable;
+    };
+
+    // The parts of a drawable that go into its entries, so we can tell if they've changed
+    struct DrawState
+    {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW;
+
+        Eigen::Matrix4d localMat;
+        bool hasLocalMat;
+        unsigned int priority;
+        bool zBuffer;
+
+        bool operator == (const DrawState &that) const;
+    };
+    typedef std::vector<DrawState,Eigen::aligned_allocator<DrawState>> DrawStateVec;
+
+    void cull(RendererFrameInfo *frameInfo,const std::vector<Drawable *> &drawables);
+    bool sameView(const RendererFrameInfo *frameInfo) const;
+    void buildMatrices();
+
+    TaskPoolRef taskPool;
+    bool sortZBuffer = false;
+
+    // What we built the last list from
+    bool valid = false;
+    bool reused = false;
+    std::vector<Drawable *> lastDrawables;
+    Eigen::Matrix4d lastModelMat,lastViewMat,lastProjMat;
+    std::vector<Eigen::Matrix4d> lastOffsetMats;
+
+    // Visibility for each drawable for each offset, drawable major
+    std::vector<char> visible;
+    std::vector<char> lastVisible;
+    // Local matrix and sort state for each drawable
+    DrawStateVec drawStates;
+    DrawStateVec lastDrawStates;
+    // Per offset frame info
+    std::vector<RendererFrameInfo,Eigen::aligned_allocator<RendererFrameInfo>> offFrameInfos;
+    std::vector<Drawable *> gathered;
+    std::vector<SortKey> sortKeys;
+    DrawList drawList;
+};
+
+}
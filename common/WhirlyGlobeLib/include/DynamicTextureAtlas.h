@@ -37,7 +37,7 @@ class DynamicTexture : virtual public TextureBase
 public:
     /// Constructor for sorting
     DynamicTexture(const std::string &name);
-    DynamicTexture(SimpleIdentity myId) : TextureBase(myId), layoutGrid(NULL) { }
+    DynamicTexture(SimpleIdentity myId) : TextureBase(myId) { }
     virtual void setup(int texSize,int cellSize,TextureType type,bool clearTextures);
     virtual ~DynamicTexture();
     
@@ -71,7 +71,8 @@ public:
     /// Set or clear a given region
     void setRegion(const Region &region,bool enable);
     
-    /// Look for an open region of the given cell extents
+    /// Look for an open region of the given cell extents.
+    /// This is the lowest, then leftmost spot that fits.  Call setRegion() to claim it.
     bool findRegion(int cellsX,int cellsY,Region &region);
     
     /// Return a list of released regions
@@ -90,6 +91,10 @@ public:
     
     /// Return texture cell utilization
     void getUtilization(int &numCell,int &usedCell);
+
+    /// Return texture cell utilization and the largest free rectangle (in cells).
+    /// The further the latter is from the total free, the more fragmented we are.
+    void getUtilization(int &numCell,int &usedCell,int &largestFree);
     
 protected:
     /// Used for debugging
@@ -106,8 +111,19 @@ protected:
     /// Texture memory format
     TextureType type;
 
-    // Use to track where sub textures are
-    bool *layoutGrid;
+    // Which cells are in use, a bit per cell and wordsPerRow words per row
+    std::vector<uint64_t> usedBits;
+    int wordsPerRow = 0;
+    // Longest run of free cells in each row.  Lets us skip rows that can't fit.
+    std::vector<int> rowFreeRun;
+    int numUsedCells = 0;
+
+    // Recalculate the free run for a row
+    void updateRow(int row);
+    // First run of at least sizeX bits set in the mask (free cells) or -1
+    int findFreeRun(const uint64_t *freeMask,int sizeX) const;
+    // Longest run of bits set in the mask
+    int longestFreeRun(const uint64_t *freeMask) const;
     
     mutable std::mutex regionLock;
     /// These regions have been released by the renderer
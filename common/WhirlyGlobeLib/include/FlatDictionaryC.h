@@ -0,0 +1,196 @@
+/*  FlatDictionaryC.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <memory>
+#import <string>
+#import <unordered_map>
+#import <vector>
+#import "Dictionary.h"
+
+namespace WhirlyKit
+{
+
+/** A fixed set of key names shared by lots of dictionaries.
+
+    Build one of these for a tile or a data set and hand it to all the
+    FlatDictionaryC objects made for it.  They store the index rather than
+    the string.  It can't be changed once built, so it's safe to share between threads.
+ */
+class DictionaryKeyTable
+{
+public:
+    /// Duplicate keys are ignored, the first one gets the index
+    DictionaryKeyTable(const std::vector<std::string> &keys);
+
+    /// Index for the given key, or -1 if it's not in the table
+    int find(const std::string &name) const;
+
+    /// Name of the key at the given index
+    const std::string &getKey(int which) const { return keys[which]; }
+
+    /// Number of keys
+    int size() const { return (int)keys.size(); }
+
+protected:
+    std::vector<std::string> keys;
+    std::unordered_map<std::string,int> index;
+};
+typedef std::shared_ptr<const DictionaryKeyTable> DictionaryKeyTableRef;
+
+/** A dictionary that keeps all its values in a single block of memory.
+
+    Fields are fixed size records at the start of the block and string data is
+    packed in from the end.  Small dictionaries fit in the object itself and never
+    touch the heap.  Key names come from a shared DictionaryKeyTable.  Any key that
+    isn't in the table is stored in the block with the strings.
+
+    Lookups are a linear scan, which beats hashing for the dozen or so attributes
+    a feature usually has.  Behaves like MutableDictionaryC, but only for ints,
+    64 bit values, doubles and strings.  There are no nested dictionaries or arrays.
+ */
+class FlatDictionaryC : public MutableDictionary
+{
+public:
+    /// Keys may be null, in which case every key is stored in the block
+    FlatDictionaryC(DictionaryKeyTableRef keys = DictionaryKeyTableRef());
+    FlatDictionaryC(const FlatDictionaryC &that);
+    FlatDictionaryC(FlatDictionaryC &&that) noexcept;
+    FlatDictionaryC &operator = (const FlatDictionaryC &that);
+    FlatDictionaryC &operator = (FlatDictionaryC &&that) noexcept;
+    virtual ~FlatDictionaryC() = default;
+
+    virtual MutableDictionaryRef copy() const override { return std::make_shared<FlatDictionaryC>(*this); }
+
+    /// The key table we're using
+    const DictionaryKeyTableRef &getKeyTable() const { return keys; }
+
+    virtual int count() const override { return (int)numFields; }
+    virtual bool empty() const override { return numFields == 0; }
+
+    /// Returns true if the field exists
+    virtual bool hasField(const std::string &name) const override;
+    /// Returns the field type
+    virtual DictionaryType getType(const std::string &name) const override;
+    /// Return an int, using the default if it's missing
+    virtual int getInt(const std::string &name,int defVal=0) const override;
+    /// Return an int64, using the default if it's missing
+    virtual int64_t getInt64(const std::string &name,int64_t defVal=0) const override;
+    /// Return a 64 bit unique identity or 0 if missing
+    virtual SimpleIdentity getIdentity(const std::string &name) const override;
+    /// Interpret an int as a boolean
+    virtual bool getBool(const std::string &name,bool defVal=false) const override;
+    /// Interpret an int as a RGBA color
+    virtual RGBAColor getColor(const std::string &name,const RGBAColor &defVal) const override;
+    /// Return a double, using the default if it's missing
+    virtual double getDouble(const std::string &name,double defVal=0.0) const override;
+    /// Return a string, or empty if it's missing
+    virtual std::string getString(const std::string &name) const override;
+    /// Return a string, using the default if it's missing
+    virtual std::string getString(const std::string &name,const std::string &defVal) const override;
+    /// Not supported, always empty
+    virtual DictionaryRef getDict(const std::string &name) const override;
+    // Return a generic entry
+    virtual DictionaryEntryRef getEntry(const std::string &name) const override;
+    /// Not supported, always empty
+    virtual std::vector<DictionaryEntryRef> getArray(const std::string &name) const override;
+    // Return an array of key names
+    virtual std::vector<std::string> getKeys() const override;
+
+    /// Look up by index in the key table rather than by name.  Skips the hashing.
+    DictionaryType getType(int keyIndex) const;
+    double getDouble(int keyIndex,double defVal) const;
+    std::string getString(int keyIndex,const std::string &defVal) const;
+
+    /// Clean out the contents
+    virtual void clear() override;
+    /// Remove the given field by name
+    virtual void removeField(const std::string &name) override;
+    /// Set field as int
+    virtual void setInt(const std::string &name,int val) override;
+    /// Set field as int64
+    virtual void setInt64(const std::string &name,int64_t val) override;
+    /// Set field as 64 bit unique value
+    virtual void setIdentifiable(const std::string &name,SimpleIdentity val) override;
+    /// Set field as double
+    virtual void setDouble(const std::string &name,double val) override;
+    /// Set field as string
+    virtual void setString(const std::string &name,const std::string &val) override;
+    /// Merge in the scalar and string values from another dictionary
+    virtual void addEntries(const Dictionary *other) override;
+
+    /// Bytes used by this object, including any heap block
+    size_t getMemorySize() const;
+
+protected:
+    // Set in Field::key when the key name is stored in the block rather than the table
+    static constexpr uint32_t KeyInBlock = 0x80000000;
+    // This much lives in the object itself before we go to the heap
+    static constexpr uint32_t InlineBytes = 128;
+
+    // One value.  These sit at the start of the block.
+    struct Field
+    {
+        // Index in the key table, or the offset of the name with KeyInBlock set
+        uint32_t key;
+        uint16_t type;
+        // Length of a key name stored in the block
+        uint16_t keyLen;
+        union {
+            int iVal;
+            int64_t i64Val;
+            double dVal;
+            struct {
+                uint32_t offset;
+                uint32_t len;
+            } str;
+        } val;
+    };
+
+    Field *fields() { return reinterpret_cast<Field *>(data); }
+    const Field *fields() const { return reinterpret_cast<const Field *>(data); }
+
+    // Find the field for the given key.  keyIndex is from the table, or -1 to compare names.
+    const Field *findField(const std::string &name) const;
+    const Field *findField(int keyIndex,const std::string *name) const;
+
+    // Make sure there's room for a field and this many string bytes
+    void reserve(uint32_t newFields,uint32_t strBytes);
+    // Copy bytes into the string area, returning the offset
+    uint32_t addBytes(const char *bytes,uint32_t len);
+
+    // Add a new field or update the existing one.  Mismatched types remove the field, like MutableDictionaryC.
+    Field *setField(const std::string &name,DictionaryType type,DictionaryType altType,uint32_t strBytes);
+    void removeAt(uint32_t which);
+
+    std::string fieldString(const Field &field) const;
+    std::string getString(int keyIndex,const std::string &defVal,const std::string *name) const;
+
+    DictionaryKeyTableRef keys;
+
+    // Either points at inlineData or heap
+    char *data;
+    std::unique_ptr<char[]> heap;
+    uint32_t capacity;
+    uint32_t numFields;
+    // String data runs from here to the end of the block.  Removed strings are reclaimed when we grow.
+    uint32_t strStart;
+    alignas(8) char inlineData[InlineBytes];
+};
+typedef std::shared_ptr<FlatDictionaryC> FlatDictionaryCRef;
+
+}
@@ -0,0 +1,89 @@
+/*  GeoJSONStreamParser.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <algorithm>
+#import <functional>
+#import <map>
+#import <string>
+#import "RawData.h"
+#import "TaskPool.h"
+#import "VectorData.h"
+#import "VectorObject.h"
+
+namespace WhirlyKit
+{
+
+/** Parses GeoJSON straight into vector shapes without building a JSON tree first.
+
+    Features come out in batches as they're parsed, so memory use follows the batch
+    size rather than the size of the document.  Files are mapped rather than read in,
+    which lets the OS drop the parts we've already been through.
+
+    With a task pool, the parser finds where each feature in a batch starts and ends,
+    then parses them on the pool.  The callback still gets the batches in document
+    order, on the thread that called parse().
+  */
+class GeoJSONStreamParser
+{
+public:
+    /// Gets each batch of features.  Return false to stop parsing.
+    typedef std::function<bool(const VectorObjectRef &batch)> BatchCallback;
+
+    GeoJSONStreamParser(BatchCallback callback);
+
+    /// Number of features handed to the callback at once.  1000 by default.
+    void setBatchSize(unsigned int size) { batchSize = std::max(size,1u); }
+
+    /// Parse the features in each batch on this pool
+    void setPool(TaskPoolRef pool) { this->pool = std::move(pool); }
+
+    /// Parse a FeatureCollection, a single Feature or bare geometry.
+    /// Returns false if the document is malformed.  Being stopped by the callback isn't a failure.
+    bool parse(const char *data,size_t len);
+
+    bool parse(const std::string &str) { return parse(str.data(),str.size()); }
+
+    /// Map the given file and parse it
+    bool parseFile(const std::string &fileName);
+
+    /// Name of the coordinate system, if the document had a "crs" entry
+    const std::string &getCRS() const { return crs; }
+
+    /// Parse an object full of named GeoJSON documents, as returned by the experimental OSM server
+    static bool ParseAssembly(const char *data,size_t len,std::map<std::string,ShapeSet> &shapes);
+
+protected:
+    typedef std::pair<const char *,const char *> Span;
+
+    // Parse features on the pool and add them to the batch
+    bool parseSpans(const std::vector<Span> &features);
+    // Add a feature's shapes to the batch, handing it off if it's full
+    void addFeature(const std::vector<VectorShapeRef> &shapes);
+    // Hand off whatever's in the batch
+    void flush();
+
+    BatchCallback callback;
+    unsigned int batchSize;
+    TaskPoolRef pool;
+    VectorObjectRef batch;
+    unsigned int batchFeatures;
+    bool stopped;
+    std::string crs;
+};
+
+}
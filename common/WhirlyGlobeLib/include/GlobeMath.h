@@ -54,6 +54,15 @@ public:
     /// Static version for convenience
     static Point3f GeocentricToLocal(Point3f);
     static Point3d GeocentricToLocal(Point3d);
+
+    /// Batch versions of the above
+    virtual void localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const override;
+    virtual void geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const override;
+    virtual void localToGeocentricBatch(const Point3d *in,Point3d *out,size_t count) const override { LocalToGeocentric(in,out,count); }
+    virtual void geocentricToLocalBatch(const Point3d *in,Point3d *out,size_t count) const override { GeocentricToLocal(in,out,count); }
+    /// Static batch versions.  Proj-4 does the whole run in one go.  In and out may be the same.
+    static void LocalToGeocentric(const Point3d *in,Point3d *out,size_t count);
+    static void GeocentricToLocal(const Point3d *in,Point3d *out,size_t count);
     
     /// Convenience routine to convert a whole MBR to local coordinates
     static Mbr GeographicMbrToLocal(GeoMbr);
@@ -96,12 +105,21 @@ public:
     /// Return a normal for the given point
     virtual Point3f normalForLocal(Point3f p) const override { return LocalToDisplay(p); }
     virtual Point3d normalForLocal(Point3d p) const override { return LocalToDisplay(p); }
+
+    /// Batch versions of the above
+    virtual void localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const override { LocalToDisplay(in,out,count); }
+    virtual void normalForLocalBatch(const Point3d *in,Point3d *out,size_t count) const override { LocalToDisplay(in,out,count); }
+    /// Static batch version.  In and out may be the same.
+    static void LocalToDisplay(const Point3d *in,Point3d *out,size_t count);
     
     /// Get a reference to the coordinate system
     virtual CoordSystem *getCoordSystem() const override { return &geoCoordSys; }
     
     /// This system is round
     bool isFlat() const override { return false; }
+
+    /// Pure math, no Proj-4 involved
+    virtual bool isThreadSafe() const override { return true; }
     
 protected:
     mutable GeoCoordSystem geoCoordSys;
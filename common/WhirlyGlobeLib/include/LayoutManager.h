@@ -24,6 +24,7 @@
 #import "SelectionManager.h"
 #import "OverlapHelper.h"
 #import "VectorManager.h"
+#import "TaskPool.h"
 
 #import <math.h>
 #import <map>
@@ -133,6 +134,11 @@ struct LayoutObjectEntry : public Identifiable
 
     // Set if we changed something during evaluation
     bool changed = true;
+
+    // Where it was on screen the last time we searched for a placement
+    Point2f layoutScreenPt {MAXFLOAT,MAXFLOAT};
+    // The orientation we found then, or -1 if it didn't make it
+    int layoutOrient = -1;
 };
 typedef std::shared_ptr<LayoutObjectEntry> LayoutObjectEntryRef;
 typedef std::set<LayoutObjectEntryRef,IdentifiableRefSorter> LayoutEntrySet;
@@ -298,6 +304,23 @@ public:
         hasUpdates = true;
     }
 
+    /// Keep placements from the previous layout where they still fit.
+    /// Only objects that moved more than the tolerance (in pixels) or changed
+    /// visibility get a new placement.  Large view changes still redo everything.
+    void setIncrementalLayout(bool enable,float pixelTolerance = 2.0f);
+    bool getIncrementalLayout() const { return incrementalLayout; }
+
+    /// Project cluster markers to the screen on the given pool, and run the
+    /// clustering tiles on it if tiled clustering is on.  Null does it all on the layout thread.
+    void setClusterPool(TaskPoolRef pool);
+
+    /** Cluster large marker layers in screen tiles rather than one marker at a time.
+        Off by default.  The groups don't depend on the pool or the device, but can differ
+        from the serial ones near the tile edges, see ClusterHelper::addObjects().
+      */
+    void setTiledClustering(bool tiled);
+    bool getTiledClustering() const { return tiledClustering; }
+
     /// Don't run a layout pass until at least the specified absolute time
     /// (e.g., when scheduled animations complete)
     void deferUntil(TimeInterval minTime);
@@ -453,6 +476,20 @@ protected:
     SimpleIDSet debugVecIDs;  // Used to display debug lines for text layout
     SimpleIdentity vecProgID = EmptyIdentity;
 
+    /// Reuse placements from the previous run where we can
+    bool incrementalLayout = false;
+    float incrementalTolerance = 2.0f;
+    /// What the previous run looked like, so we can spot big jumps
+    bool lastLayoutComplete = false;
+    double lastLayoutHeight = 0.0;
+    Point2f lastFrameBufferSize {0,0};
+    int lastNumPlaced = 0;
+    /// Cluster markers are projected and clustered on this, if set
+    TaskPoolRef clusterPool;
+    bool tiledClustering = false;
+    /// Overlap grid, kept between runs so we're not reallocating it
+    std::unique_ptr<OverlapHelper> overlapMan;
+
     // Scene manager lock protects some things, this protects others
     std::timed_mutex internalLock;
     
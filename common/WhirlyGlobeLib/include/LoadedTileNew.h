@@ -63,6 +63,9 @@ public:
     bool enableGeom;
     // If set, we're building single level geometry, so no parent logic
     bool singleLevel;
+    // If set, flat maps build their tiles from a grid shared by every tile with the same sampling.
+    // Tiles that aren't just a moved and scaled copy of that grid are built from scratch.
+    bool useMeshTemplates;
 };
 
 class TileGeomManager;
@@ -81,6 +84,12 @@ public:
     void makeDrawables(SceneRenderer *sceneRender,TileGeomManager *geomManage,
                        const TileGeomSettings &geomSettings,ChangeSet &changes);
 
+    // Build the grid for a flat map tile from the shared template.
+    // Returns false if the tile can't be done that way.
+    bool buildFromMeshTemplate(const BasicDrawableBuilderRef &chunk,TileGeomManager *geomManage,
+                               const Point2d &chunkLL,const Point2d &chunkUR,
+                               int sampleX,int sampleY,const Point2d &texScale,const Point3d &chunkMidDisp);
+
     // Utility routine to build skirts around the edges
     void buildSkirt(const BasicDrawableBuilderRef &draw,const Point3dVector &pts,
                     const std::vector<TexCoord> &texCoords,double skirtFactor,
@@ -118,6 +127,24 @@ public:
 typedef std::shared_ptr<LoadedTileNew> LoadedTileNewRef;
 typedef std::vector<LoadedTileNewRef> LoadedTileVec;
 
+/** The parts of a tile's grid that only depend on the sampling.
+    On a flat map every tile is the same grid, just moved and scaled.
+  */
+class TileMeshTemplate
+{
+public:
+    TileMeshTemplate(int sampleX,int sampleY);
+
+    int sampleX,sampleY;
+    // Where each grid point falls in the tile, from 0 to 1
+    std::vector<double> fracX,fracY;
+    // Texture coordinates for an unclipped tile
+    std::vector<TexCoord> texCoords;
+    // Two triangles per cell
+    std::vector<BasicDrawable::Triangle> tris;
+};
+typedef std::shared_ptr<TileMeshTemplate> TileMeshTemplateRef;
+
 /** Tile Builder builds individual tile geometry for use elsewhere.
     This is just the geometry.  If you want textures on it, you need to do those elsewhere.
   */
@@ -160,6 +187,9 @@ public:
     // Remove all the various geometry
     void cleanup(ChangeSet &changes);
 
+    // Shared grid for the given sampling, made the first time it's asked for
+    const TileMeshTemplate &getMeshTemplate(int sampleX,int sampleY);
+
 protected:
     TileGeomSettings settings;
     
@@ -187,6 +217,7 @@ public:
     
 protected:
     std::map<QuadTreeNew::Node,LoadedTileNewRef> tileMap;
+    std::map<std::pair<int,int>,TileMeshTemplateRef> meshTemplates;
 };
 
 }
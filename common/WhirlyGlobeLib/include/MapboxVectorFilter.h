@@ -20,7 +20,9 @@
 
 #import "Dictionary.h"
 #import "QuadTreeNew.h"
+#import "StringIndexer.h"
 #import <string>
+#import <unordered_set>
 
 namespace WhirlyKit
 {
@@ -37,7 +39,13 @@ typedef std::shared_ptr<MapboxVectorStyleSetImpl> MapboxVectorStyleSetImplRef;
 class MapboxVectorFilter;
 typedef std::shared_ptr<MapboxVectorFilter> MapboxVectorFilterRef;
 
-/// @brief Filter is used to match data in a layer to styles
+/** @brief Filter is used to match data in a layer to styles
+    @details Once parsed, the filter tree is compiled into a flat list of instructions.
+    The parsed tree is read only from then on, so the two can't disagree.
+    Attribute names are turned into string IDs and the comparison values are pulled
+    out of their dictionary entries, so testing a feature doesn't allocate anything.
+    Features from the vector tile parser's lazy dictionaries are looked up by ID.
+  */
 class MapboxVectorFilter
 {
 public:
@@ -47,25 +55,66 @@ public:
     bool parse(const std::vector<DictionaryEntryRef> &styleEntry,MapboxVectorStyleSetImpl *styleSet);
 
     /// @brief Test a feature's attributes against the filter
-    bool testFeature(Dictionary const& attrs,const QuadTreeIdentifier &tileID);
+    bool testFeature(Dictionary const& attrs,const QuadTreeIdentifier &tileID) const;
 
     /// @brief The comparison type for this filter
-    MapboxVectorFilterType filterType;
+    MapboxVectorFilterType getFilterType() const { return filterType; }
 
     /// @brief Attribute name for all the types that take two arguments
-    std::string attrName;
+    const std::string &getAttrName() const { return attrName; }
 
     /// @brief Set if we're comparing geometry type instead of an attribute
-    MapboxVectorGeometryType geomType;
+    MapboxVectorGeometryType getGeomType() const { return geomType; }
 
     /// @brief Attribute value to compare for all the type that take two arguments
-    DictionaryEntryRef attrVal;
+    const DictionaryEntryRef &getAttrVal() const { return attrVal; }
 
     /// @brief Attribute values for the in and !in operators
-    std::vector<DictionaryEntryRef> attrVals;
+    const std::vector<DictionaryEntryRef> &getAttrVals() const { return attrVals; }
 
     /// @brief For All and Any these are the MapboxVectorFilters to evaluate
+    const std::vector<MapboxVectorFilterRef> &getSubFilters() const { return subFilters; }
+
+protected:
+    // The parsed filter.  These are only set by parse(), so the program always matches them.
+    MapboxVectorFilterType filterType;
+    std::string attrName;
+    MapboxVectorGeometryType geomType;
+    DictionaryEntryRef attrVal;
+    std::vector<DictionaryEntryRef> attrVals;
     std::vector<MapboxVectorFilterRef> subFilters;
+
+    // One node of the filter tree, flattened out.  Children follow their parent.
+    struct Instruction
+    {
+        MapboxVectorFilterType filterType = MBFilterNone;
+        // Set for geometry type comparisons
+        MapboxVectorGeometryType geomType = MBGeomNone;
+        // Attribute we're looking at
+        std::string attrName;
+        StringIdentity attrID = 0;
+        // Comparison value in both the forms we might need it
+        std::string strVal;
+        double numVal = 0.0;
+        // Values for in and !in
+        std::unordered_set<std::string> strVals;
+        std::unordered_set<double> numVals;
+        // Index just past this instruction and its children
+        unsigned int end = 0;
+    };
+
+    // Parse without compiling, for the sub-filters
+    bool parseFilter(const std::vector<DictionaryEntryRef> &styleEntry,MapboxVectorStyleSetImpl *styleSet);
+
+    // Flatten the filter tree out into the program
+    void compile();
+    void compileNode(const MapboxVectorFilter &node);
+
+    // Run the instruction at the given index (and its children) using the given attribute lookup
+    template <typename Lookup>
+    bool run(const Lookup &lookup,unsigned int which,const QuadTreeIdentifier &tileID) const;
+
+    std::vector<Instruction> program;
 };
 
 }
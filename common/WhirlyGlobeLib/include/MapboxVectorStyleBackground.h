@@ -62,6 +62,9 @@ public:
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) override;
 
+    /// The background makes its own geometry, so it's down to the platform
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return styleSet->platformIsThreadSafe(); }
+
     virtual RGBAColor getLegendColor(float zoom) const override {
         return paint.color ? paint.color->colorForZoom(zoom) : RGBAColor::clear();
     }
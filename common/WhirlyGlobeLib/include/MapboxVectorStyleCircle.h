@@ -71,6 +71,9 @@ public:
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) override;
 
+    /// Circles only read the features, so it's down to the platform
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return styleSet->platformIsThreadSafe(); }
+
     virtual void cleanup(PlatformThreadInfo *inst,ChangeSet &changes) override;
 
     virtual RGBAColor getLegendColor(float zoom) const override {
@@ -56,6 +56,9 @@ public:
                               const VectorTileDataRef &tileInfo,
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) override;
+
+    /// Fills tessellate their own copies of the polygons, so it's down to the platform
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return styleSet->platformIsThreadSafe(); }
     
     virtual void cleanup(PlatformThreadInfo *inst,ChangeSet &changes) override { }
 
@@ -79,6 +79,9 @@ public:
                               const VectorTileDataRef &tileInfo,
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) override;
+
+    /// Lines only subdivide their own copies of the features, so it's down to the platform
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return styleSet->platformIsThreadSafe(); }
     
     virtual void cleanup(PlatformThreadInfo *inst,ChangeSet &changes) override { }
 
@@ -41,6 +41,9 @@ public:
                               const VectorTileDataRef &tileInfo,
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) override;
+
+    /// Nothing to build
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return true; }
     
     virtual void cleanup(PlatformThreadInfo *inst,ChangeSet &changes) override { }
 
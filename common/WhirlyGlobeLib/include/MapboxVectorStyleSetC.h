@@ -24,6 +24,8 @@
 #import "MapboxVectorTileParser.h"
 #import "MaplyVectorStyleC.h"
 #import "MapboxVectorStyleSpritesImpl.h"
+#import "StringIndexer.h"
+#import <array>
 #import <set>
 
 namespace WhirlyKit
@@ -44,6 +46,9 @@ public:
     // Possible key names in the data. Tried in this order.
     // Not set if this is a simple string
     std::vector<std::string> keys;
+
+    // StringIndexer IDs for the keys, so we can look them up in a tile's key table
+    std::vector<StringIdentity> keyIDs;
 };
 
 // Encapsulates a regular expression field.  Could be a string, could be more complex
@@ -99,16 +104,23 @@ public:
 };
 
 // Collection of function stops
+// These are compiled when they're parsed, so evaluating them at whole
+//  zoom levels is a table lookup and in between is a search and one pow
 class MaplyVectorFunctionStops
 {
 public:
+    MaplyVectorFunctionStops();
+
     bool parse(const DictionaryRef &entry,bool isText);
 
     /// @brief Calculate a value given the zoom level
-    double valueForZoom(double zoom);
+    double valueForZoom(double zoom) const;
 
     /// @brief This version returns colors, assuming we're dealing with colors
-    RGBAColorRef colorForZoom(double zoom);
+    RGBAColorRef colorForZoom(double zoom) const;
+
+    /// @brief Color for the zoom level, returned by value.  Clear if there's no color.
+    RGBAColor colorValueForZoom(double zoom) const;
     
     /// Return the text for a given zoom level
     MapboxRegexField textForZoom(double zoom);
@@ -119,11 +131,37 @@ public:
     /// @brief Returns the maximum value
     double maxValue();
 
+    /// @brief Whole zoom levels we keep precomputed values for
+    static constexpr int MaxTableLevel = 30;
+
 public:
     std::vector<MaplyVectorFunctionStop> stops;
     
     /// @brief Used in exponential calculation
     double base;
+
+protected:
+    // Work out the interpolation for each pair of stops and evaluate every whole level
+    void compile();
+
+    // Find the stop we're past and how far we are toward the next one
+    // Returns false if we're outside the stops, with which set to the one we're clamped to
+    bool findSegment(double zoom,unsigned int &which,double &ratio) const;
+
+    // Interpolate without the tables
+    double calcValue(double zoom) const;
+    RGBAColor calcColor(double zoom) const;
+
+    // Converts the distance into a segment into a ratio
+    // This is 1/(base^span - 1) for exponential stops and 1/span for linear
+    std::vector<double> segScale;
+    // Stop colors as unit floats, if they're colors
+    std::vector<std::array<float,4>> stopColors;
+    // Values and colors at whole levels, from 0 to MaxTableLevel
+    std::vector<double> levelVals;
+    std::vector<RGBAColor> levelColors;
+    // Set if every stop has the same value
+    bool constVal;
 };
 typedef std::shared_ptr<MaplyVectorFunctionStops> MaplyVectorFunctionStopsRef;
 
@@ -136,7 +174,7 @@ public:
     MapboxTransDouble(MaplyVectorFunctionStopsRef stops);
     
     // Return the value for a given level
-    double valForZoom(double zoom);
+    double valForZoom(double zoom) const { return stops ? stops->valueForZoom(zoom) : val; }
     
     // True if this is an expression, rather than a constant
     bool isExpression();
@@ -169,7 +207,7 @@ public:
     bool hasAlphaOverride() { return useAlphaOverride; }
 
     // Return a color for the given zoom level
-    RGBAColor colorForZoom(double zoom);
+    RGBAColor colorForZoom(double zoom) const;
 
     // Check if we've got an expression or it's going to be a constant
     bool isExpression() const;
@@ -274,6 +312,11 @@ public:
     static RGBAColorRef resolveColor(const MapboxTransColorRef &color,const MapboxTransDoubleRef &opacity,
                                      double zoom,MBResolveColorType resolveMode);
 
+    /// Resolve color and opacity into the given color, without allocating one.
+    /// Returns false if the object shouldn't appear
+    static bool resolveColor(const MapboxTransColorRef &color,const MapboxTransDoubleRef &opacity,
+                             double zoom,MBResolveColorType resolveMode,RGBAColor &outColor);
+
     /// @brief Scale the color by the given opacity
     static RGBAColor color(RGBAColor color,double opacity);
 
@@ -327,7 +370,8 @@ public:
     /// Local platform implementation for generating a repeating line texture
     virtual SimpleIdentity makeLineTexture(PlatformThreadInfo *inst,const std::vector<double> &dashComponents) = 0;
     
-    /// Create a local platform LabelInfo (since fonts are local)
+    /// Create a local platform LabelInfo (since fonts are local).
+    /// Each call returns its own, since the symbol layers fill in their settings on it.
     virtual LabelInfoRef makeLabelInfo(PlatformThreadInfo *,
                                        const std::vector<std::string> &fontNames,
                                        float fontHeight,
@@ -348,6 +392,11 @@ public:
     /// Create a local platform component object
     virtual ComponentObjectRef makeComponentObject(PlatformThreadInfo *inst, const Dictionary *desc = nullptr) = 0;
 
+    /// Return true if makeLabelInfo(), makeSingleLabel(), calculateTextWidth(), makeComponentObject()
+    ///  and addSelectionObject() can be called from several threads at once, each with its own PlatformThreadInfo.
+    /// The layers use this to decide if they can build tiles in parallel.
+    virtual bool platformIsThreadSafe() const { return false; }
+
     /// Check whether the stylesheet already has representation layers
     virtual bool hasRepresentations();
 
@@ -18,6 +18,8 @@
 
 #import "MapboxVectorStyleSetC.h"
 #import "MapboxVectorStyleLayer.h"
+#import <mutex>
+#import <unordered_map>
 
 namespace WhirlyKit
 {
@@ -96,11 +98,72 @@ struct MapboxVectorSymbolPaint
     MapboxTransDoubleRef iconOpacity;
 };
 
+/// Label text after the transform and line breaking, shared by every label with the same name
+struct MapboxLabelText
+{
+    /// What goes on the label
+    std::string text;
+    /// Lower case version, for unique labels
+    std::string uniqueID;
+    /// Small tweak to the layout importance, [0.0,1.0]
+    float hash = 0.0f;
+};
+typedef std::shared_ptr<const MapboxLabelText> MapboxLabelTextRef;
+
+/// Label text for one tile, by the text built from the feature
+typedef std::unordered_map<std::string,MapboxLabelTextRef> MapboxLabelTextMap;
+
+/** Label text kept across tiles for a symbol layer.
+    Road and place names repeat a lot, so we only transform and break them up once
+    for a given line width and font size.  Safe to use from multiple threads.
+  */
+class MapboxLabelTextCache
+{
+public:
+    MapboxLabelTextCache(size_t maxEntries = 4096) : maxEntries(maxEntries) { }
+
+    /// Look for text laid out with the given line width and font size
+    MapboxLabelTextRef find(const std::string &rawText,double breakWidth,float fontSize);
+
+    /// Add text laid out with the given line width and font size.
+    /// If we've got too much, we start over.
+    void add(const std::string &rawText,double breakWidth,float fontSize,const MapboxLabelTextRef &text);
+
+    /// Number of distinct labels we're holding on to
+    size_t size();
+
+protected:
+    struct Key
+    {
+        bool operator==(const Key &that) const {
+            return breakWidth == that.breakWidth && fontSize == that.fontSize && rawText == that.rawText;
+        }
+
+        std::string rawText;
+        double breakWidth;
+        float fontSize;
+    };
+    struct KeyHash
+    {
+        size_t operator()(const Key &key) const {
+            return std::hash<std::string>()(key.rawText) ^ (std::hash<double>()(key.breakWidth) * 31) ^ std::hash<float>()(key.fontSize);
+        }
+    };
+
+    std::mutex lock;
+    std::unordered_map<Key,MapboxLabelTextRef,KeyHash> entries;
+    size_t maxEntries;
+};
+typedef std::shared_ptr<MapboxLabelTextCache> MapboxLabelTextCacheRef;
+
 /// @brief Icons and symbols
 class MapboxVectorLayerSymbol : public MapboxVectorStyleLayer
 {
 public:
-    MapboxVectorLayerSymbol(MapboxVectorStyleSetImpl *styleSet) : MapboxVectorStyleLayer(styleSet) { }
+    MapboxVectorLayerSymbol(MapboxVectorStyleSetImpl *styleSet) :
+        MapboxVectorStyleLayer(styleSet),
+        textCache(std::make_shared<MapboxLabelTextCache>())
+    { }
 
     virtual bool parse(PlatformThreadInfo *inst,
                        const DictionaryRef &styleEntry,
@@ -113,6 +176,9 @@ public:
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) override;
 
+    /// Symbols only read the features and get their own LabelInfo, so it's down to the platform
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) override { return styleSet->platformIsThreadSafe(); }
+
     virtual MapboxVectorStyleLayerRef clone() const override;
     virtual MapboxVectorStyleLayer& copy(const MapboxVectorStyleLayer&) override;
 
@@ -135,12 +201,21 @@ public:
                             const std::string &text,
                             double textMaxWidth,
                             const LabelInfoRef &);
+    /// Transform and break up the text for a label, reusing the work for any other label with the same text
+    MapboxLabelTextRef layoutText(PlatformThreadInfo *,
+                                  const std::string &rawText,
+                                  double breakWidth,
+                                  const LabelInfoRef &,
+                                  MapboxLabelTextMap &tileText);
     SingleLabelRef setupLabel(PlatformThreadInfo *,
                               const Point2f &pt,
                               const LabelInfoRef &,
                               const MutableDictionaryRef &attrs,
                               const VectorTileDataRef &tileInfo,
-                              bool mergedIcon);
+                              bool mergedIcon,
+                              const MapboxRegexField &textField,
+                              double breakWidth,
+                              MapboxLabelTextMap &tileText);
     std::unique_ptr<Marker> setupMarker(PlatformThreadInfo *,
                         const Point2f &pt,
                         const MutableDictionaryRef &attrs,
@@ -157,6 +232,9 @@ public:
     /// If set, only one label with its text will be displayed.  Sorted out by the layout manager.
     bool uniqueLabel = false;
     bool useZoomLevels = false;
+
+    /// Label text we've already laid out, across tiles
+    MapboxLabelTextCacheRef textCache;
 };
 
 }
@@ -21,6 +21,7 @@
 #import "QuadTreeNew.h"
 #import "ImageTile.h"
 #import "ComponentManager.h"
+#import "TaskPool.h"
 
 namespace WhirlyKit
 {
@@ -113,6 +114,21 @@ public:
     /// Parse everything, even if there's no style for it
     void setParseAll(bool b = true) { parseAll = b; }
 
+    /// Decode feature attributes only when they're asked for, rather than
+    ///  building a dictionary for every feature as we parse
+    void setLazyAttributes(bool b = true) { lazyAttributes = b; }
+
+    /** Build the styles for a tile on the given pool, rather than one after another.
+        Only styles that say buildObjectsIsThreadSafe() go to the pool, each worker with the
+        PlatformThreadInfo the pool's attach function made for it.  The rest build on the calling
+        thread in between, so they still see the features the way they would have serially.
+        A worker without thread info (one that couldn't attach to the VM, say) leaves its styles
+        for the calling thread.
+        Results are merged back in style order, so the output doesn't depend on the timing.
+        Pass in null to go back to building on the calling thread.
+      */
+    void setBuildPool(TaskPoolRef pool) { buildPool = std::move(pool); }
+
     /// Add a category for a particular style ID
     /// These are used for sorting later on
     void addCategory(const std::string &category,long long styleID);
@@ -154,6 +170,12 @@ public:
 
     const VectorStyleDelegateImplRef &getStyleDelegate() const { return styleDelegate; }
 protected:
+    /// True if the given style can build on a worker thread while the others do
+    bool styleIsThreadSafe(PlatformThreadInfo *styleInst,long long styleID);
+
+    /// Sort the results of one style into categories and merge them into the tile
+    void mergeStyleData(long long styleID,VectorTileData *styleData,VectorTileData *tileData);
+
     /// If set, we'll parse into local coordinates as specified by the bounding box, rather than geo coords
     bool localCoords = false;
 
@@ -163,6 +185,12 @@ protected:
     /// Parse everything, even if there's no style for it
     bool parseAll = false;
 
+    /// Decode feature attributes on demand
+    bool lazyAttributes = false;
+
+    /// If set, we build the thread safe styles in parallel on this
+    TaskPoolRef buildPool;
+
     /// If set, we'll tack a debug label in the middle of the tile
     bool debugLabel = false;
 
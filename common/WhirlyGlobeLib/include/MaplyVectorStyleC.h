@@ -191,6 +191,11 @@ public:
                               const VectorTileDataRef &tileInfo,
                               const Dictionary *desc,
                               const CancelFunction &cancelFn) = 0;
+
+    /// Return true if buildObjects() can run on another thread while other styles build the same tile.
+    /// Each thread gets its own PlatformThreadInfo.  The vector objects are shared between the styles,
+    ///  so anything that changes them in place has to say no.
+    virtual bool buildObjectsIsThreadSafe(PlatformThreadInfo *) { return false; }
 };
 
 }
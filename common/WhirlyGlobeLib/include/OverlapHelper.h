@@ -28,6 +28,7 @@
 #import "ScreenSpaceBuilder.h"
 #import "SelectionManager.h"
 #import "WhirlyVector.h"
+#import "TaskPool.h"
 
 
 namespace WhirlyKit
@@ -41,6 +42,9 @@ struct OverlapHelper
 {
     OverlapHelper(const Mbr &mbr,int sizeX,int sizeY,size_t totalObjs);
 
+    // Empty it out for another round, keeping the memory we've already got
+    void reset(const Mbr &mbr,size_t totalObjs);
+
     // Try to add an object.  Might fail (kind of the whole point).
     bool addCheckObject(const Point2dVector &pts, const char* mergeID = nullptr);
     bool addCheckObject(const Point2dVector &pts, const std::string &mergeID);
@@ -128,6 +132,18 @@ public:
     // Add an object, possibly forming a group
     void addObject(LayoutObjectEntryRef objEntry,const Point2dVector &pts);
 
+    // Add a batch of objects.  Unless tiled is set, or for small batches, this is addObject() on each in turn.
+    // Tiled splits the screen into tiles.  Objects that fit inside a tile are clustered there and the
+    //  results are merged in tile order.  Objects crossing a tile edge are then added serially, in order,
+    //  so they can join groups on either side.  The tiles run as tasks on the pool if there is one
+    //  with workers, and one after another if not, so the groups don't depend on the number of threads.
+    //  They can differ from the serial groups where a cluster grows across an edge.
+    void addObjects(const std::vector<LayoutObjectEntryRef> &objEntries,
+                    const std::vector<Point2dVector> &objPts,
+                    bool tiled,
+                    TaskPool *pool,
+                    volatile bool &cancel);
+
     // Deal with cluster to cluster overlap
     void resolveClusters(volatile bool &cancel);
     
@@ -167,6 +183,12 @@ public:
     
     void calcCells(const Mbr &mbr,int &sx,int &sy,int &ex,int &ey);
 
+    // Group an object already in simpleObjects with whatever it overlaps
+    void placeObject(int newID);
+
+    // Set up the bounds for a cluster around its center
+    void calcClusterPts(ClusterObject &clusterObj);
+
     Point2d clusterMarkerSize;
     
     Mbr mbr;
@@ -21,11 +21,15 @@
 #import <string>
 #import <map>
 #import "WhirlyTypes.h"
+#import "TraceEvents.h"
 
 namespace WhirlyKit
 {
     
-/// Simple performance timing class
+/** Simple performance timing class.
+    This keeps running totals by name.  For a timeline of individual
+    frames and tasks use the trace events in TraceEvents.h instead.
+  */
 class PerformanceTimer
 {
 public:
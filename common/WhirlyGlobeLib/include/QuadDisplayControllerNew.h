@@ -73,6 +73,10 @@ public:
                                    const Mbr &mbr,
                                    const ViewStateRef &viewState,
                                    const Point2f &frameSize) = 0;
+
+    /// Return true if importanceForTile() can be called from several threads at once.
+    /// Importance is only evaluated in parallel if this says so.
+    virtual bool importanceIsThreadSafe() const { return false; }
 };
 
 /** The Quad Display Layer (New) calls an object with this protocol.
@@ -178,6 +182,9 @@ protected:
     // QuadTreeNew overrides
     virtual double importance(const Node &node) override;
     virtual bool visible(const Node &node) override;
+    virtual bool importanceIsThreadSafe() const override;
+    virtual bool nodeBounds(const Node &node,Point3d &center,double &radius) override;
+    virtual bool nodeFootprint(const Point3d &center,double radius,Footprint &footprint) override;
     
     QuadDataStructure *dataStructure;
     QuadLoaderNew *loader;
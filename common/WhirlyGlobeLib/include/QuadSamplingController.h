@@ -98,6 +98,10 @@ public:
                                    const Mbr &mbr,
                                    const ViewStateRef &viewState,
                                    const Point2f &frameSize) override;
+
+    /// Importance is thread safe if the tiles are already in the display's coordinate system
+    ///  and the display adapter doesn't need Proj-4
+    virtual bool importanceIsThreadSafe() const override;
     
     /// **** QuadTileBuilderDelegate methods ****
 
@@ -88,6 +88,16 @@ public:
     
     /// Do we need globe geometry for this sampling set or nah?
     bool generateGeom;
+
+    /// If set, reuse what the last view update decided for parts of the quad tree
+    ///  whose screen footprint hasn't moved more than incrementalThreshold pixels
+    bool incrementalCoverage;
+    double incrementalThreshold;
+
+    /// If non-zero, tile importance below this level is evaluated in parallel
+    ///  on the shared task pool, one subtree per task.
+    /// Only applies when the coordinate systems are safe to use from several threads.
+    int parallelSplitLevel;
     
     /**
      Detail the levels you want loaded in target level mode.
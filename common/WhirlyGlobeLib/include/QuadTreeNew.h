@@ -19,6 +19,8 @@
  */
 
 #import "WhirlyVector.h"
+#import "TaskPool.h"
+#import <memory>
 #import <set>
 
 namespace WhirlyKit
@@ -122,6 +124,23 @@ public:
     };
     typedef std::set<ImportantNode> ImportantNodeSet;
 
+    /// Where a node lands on the screen, once per copy of the world being drawn.
+    /// Each copy is the screen position (x,y) and size (z) of the node's bounding sphere, in pixels.
+    class Footprint
+    {
+    public:
+        static constexpr int MaxCopies = 4;
+
+        /// Add the next copy.  False if there are too many to keep track of.
+        bool addCopy(const Point3d &copy);
+
+        /// True if every copy is within the threshold of the other footprint's
+        bool closeTo(const Footprint &that,double threshold) const;
+
+        int numCopies = 0;
+        Point3d copies[MaxCopies];
+    };
+
     // Calculate a set of nodes to load based on importance, but only up to the maximum
     // siblingNodes forces us to load all four children of a given parent
     ImportantNodeSet calcCoverageImportance(const std::vector<double> &minImportance,int maxNodes,
@@ -136,18 +155,60 @@ public:
                                                          int maxNodes,const std::vector<int> &levelLoads,
                                                          bool keepMinLevel,std::vector<double> &maxRejectedImport);
     
+    /// Compare a new coverage against the previous one, ignoring importance.
+    /// Nodes only in the new set are added, nodes only in the old set are removed
+    ///  and the rest are updates.  If changedOnly is set, updates are limited to
+    ///  the nodes whose importance actually changed.
+    static void calcCoverageDelta(const ImportantNodeSet &oldNodes,const ImportantNodeSet &newNodes,
+                                  bool changedOnly,ImportantNodeSet &toAdd,NodeSet &toRemove,
+                                  ImportantNodeSet &toUpdate);
+
     // Generate a bounding box 
     MbrD generateMbrForNode(const Node &node) const;
+
+    /** Incremental coverage keeps what the last pass decided for each subtree
+        and copies it over wholesale when the subtree's screen footprint hasn't
+        moved or changed size by more than the threshold (in pixels).
+        Subclasses need to fill in nodeBounds() and nodeFootprint() for this
+        to save anything.  The importance walk runs on the calling thread in
+        this mode, so setParallel() doesn't apply to it.
+      */
+    void setIncremental(bool enable,double footprintThreshold = 2.0);
+    bool getIncremental() const { return incremental; }
+
+    /// Throw out what the last pass decided.  The next pass evaluates everything.
+    void resetIncremental();
+
+    /** Evaluate importance for the subtrees below splitLevel in parallel on the given pool.
+        Results are merged so they're identical to the serial version.
+        This only kicks in when importanceIsThreadSafe() says so, otherwise we stay serial.
+        Pass in an empty pool or a split level of 0 to turn it off.
+      */
+    void setParallel(TaskPoolRef pool,int splitLevel);
     
 public:
     // Filled in by the subclass
     virtual double importance(const Node &node) = 0;
     virtual bool visible(const Node &node) = 0;
-    
+
+    // Return true if importance() can be called from several threads at once.
+    // Parallel evaluation falls back to serial if not.
+    virtual bool importanceIsThreadSafe() const { return false; }
+
+    // Incremental mode: a bounding sphere for the node.  Only called when we first see a node.
+    virtual bool nodeBounds(__unused const Node &node,__unused Point3d &center,__unused double &radius) { return false; }
+    // Incremental mode: where the bounding sphere lands on the screen for every copy of the world.
+    // Return false if it can't be estimated and the node will always be evaluated.
+    virtual bool nodeFootprint(__unused const Point3d &center,__unused double radius,__unused Footprint &footprint) { return false; }
+
     // Recursively visit the quad tree evaluating as we go
     void evalNodeImportance(ImportantNode &node,const std::vector<double> &minImportance,
                             ImportantNodeSet &importSet,std::vector<double> &maxRejectedImport);
 
+    // Evaluate a set of starting nodes, splitting the work into subtrees if we're parallel
+    void evalNodesImportance(const std::vector<ImportantNode> &nodes,const std::vector<double> &minImportance,
+                             ImportantNodeSet &importSet,std::vector<double> &maxRejectedImport);
+
     // This version uses pure visibility and goes down to a predefined level
     bool evalNodeVisible(ImportantNode node,const std::vector<double> &minImportance,int maxNodes,
                          const std::set<int> &levelsToLoad,int maxLevel,ImportantNodeSet &visibleSet);
@@ -163,7 +224,92 @@ public:
     int minLevel,maxLevel;
 
 protected:
+    // Recursive evaluation.  Nodes at stopLevel are put aside in subtrees rather than evaluated.
+    void evalNodeImportance(ImportantNode &node,const std::vector<double> &minImportance,
+                            ImportantNodeSet &importSet,std::vector<double> &maxRejectedImport,
+                            int stopLevel,std::vector<ImportantNode> *subtrees);
+
+    // Incremental version of evalNodesImportance.  The results are left in lastPass.
+    // Returns true if nothing had moved and it all came from the last pass.
+    bool evalNodesIncremental(const std::vector<ImportantNode> &nodes,const std::vector<double> &minImportance,
+                              std::vector<double> &maxRejectedImport);
+    // Incremental version of the walk.  Reuses what the last pass decided for subtrees
+    //  that haven't moved and records what this pass decides for the next one.
+    void evalNodeIncremental(ImportantNode &node,const std::vector<double> &minImportance,
+                             int lastIndex,bool checkFootprint);
+    // Find the node's record among siblings in the last pass, starting from cursor
+    int findLastRecord(const Node &node,size_t &cursor,size_t end) const;
+    // Copy a subtree from the last pass into this one
+    void copyLastSubtree(int lastIndex);
+
     volatile bool shutdown = false;
+
+    // Nodes rejected in a pass, for maxRejectedImport
+    struct RejectedNode
+    {
+        int level;
+        double ratio;
+    };
+
+    // What one pass decided about a node and its subtree.  These are kept in
+    //  depth first order and each one covers a range of the accepted and
+    //  rejected nodes, so an unchanged subtree can be copied over in one go.
+    struct SubtreeRecord
+    {
+        SubtreeRecord(const Node &node) : node(node) { }
+
+        Node node;
+        Point3d center = { 0.0, 0.0, 0.0 };
+        double radius = 0.0;
+        bool hasBounds = false;
+        bool hasFootprint = false;
+        // Footprint when the subtree was last evaluated
+        Footprint footprint;
+        // One past the last record in this subtree
+        size_t recordsEnd = 0;
+        size_t nodesBegin = 0,nodesEnd = 0;
+        size_t rejectedBegin = 0,rejectedEnd = 0;
+    };
+
+    // What incremental mode keeps from the last pass made with a given set of cutoffs
+    struct IncrementalState
+    {
+        std::vector<double> minImportance;
+        std::vector<SubtreeRecord> records;
+        std::vector<ImportantNode> nodes;
+        std::vector<RejectedNode> rejected;
+
+        // The last coverage worked out from this pass, handed back as is when nothing moved
+        bool hasImportanceCoverage = false;
+        int importanceMaxNodes = 0;
+        bool siblingNodes = false;
+        ImportantNodeSet importanceCoverage;
+
+        bool hasVisibleCoverage = false;
+        int visibleMaxNodes = 0;
+        std::vector<int> levelLoads;
+        bool keepMinLevel = false;
+        int visibleLevel = 0;
+        ImportantNodeSet visibleCoverage;
+    };
+
+    // The state for these cutoffs, made if need be.  The display controller
+    //  works out coverage twice per view with different cutoffs.
+    IncrementalState &incrementalStateFor(const std::vector<double> &minImportance);
+
+    bool incremental = false;
+    double footprintThreshold = 2.0;
+    std::vector<std::unique_ptr<IncrementalState>> incrementalStates;
+    // The state used by the current pass and how many nodes it had to evaluate
+    IncrementalState *lastPass = nullptr;
+    int passEvaluated = 0;
+    // Scratch for the pass being built
+    std::vector<SubtreeRecord> passRecords;
+    std::vector<ImportantNode> passNodes;
+    std::vector<RejectedNode> passRejected;
+
+    TaskPoolRef taskPool;
+    int parallelSplitLevel = 0;
 };
 
 }
@@ -94,6 +94,10 @@ protected:
 // Caller responsible for deletion
 RawDataWrapper *RawDataFromFile(FILE *fp,unsigned int dataLen);
 
+// Map the whole file read only.  Pages come in as they're touched and can be dropped again
+//  under memory pressure.  Returns null if the file is missing, empty or too big to map.
+RawDataRef RawDataMapFile(const std::string &fileName);
+
 // You can add data to this one as needed
 class MutableRawData : public RawData
 {
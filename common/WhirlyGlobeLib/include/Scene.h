@@ -267,7 +267,7 @@ public:
     /// You can get the coordinate system we're using from that.
     CoordSystemDisplayAdapter *getCoordAdapter() const;
     
-    /// Add a single change request.  You can call this from any thread, it locks.
+    /// Add a single change request.  You can call this from any thread, it doesn't lock.
     /// If you have more than one, don't iterate, use the other version.
     void addChangeRequest(ChangeRequest *newChange);
     /// Add a list of change requets.  You can call this from any thread.
@@ -463,9 +463,15 @@ protected:
     /// Mutex for accessing textures
     mutable std::mutex textureLock;
 
+    /// Change requests come in here from any thread
+    ChangeRequestQueue incomingChanges;
+
+    /// Move the incoming changes over to the immediate and timed lists
+    void takeIncomingChanges();
+
+    /// The renderer sorts incoming changes into these.
+    /// Only the renderer modifies them, the lock is for the other threads looking in.
     mutable std::mutex changeRequestLock;
-    /// We keep a list of change requests to execute
-    /// This can be accessed in multiple threads, so we lock it
     ChangeSet changeRequests;
     SortedChangeSet timedChangeRequests;
 
@@ -26,6 +26,7 @@
 #import "SceneRenderer.h"
 #import "ProgramGLES.h"
 #import "MemManagerGLES.h"
+#import "DrawListBuilder.h"
 
 namespace WhirlyKit
 {
@@ -134,6 +135,9 @@ public:
     int extraFrameCount;
 
     RendererFrameInfoGLESRef lastFrameInfo;
+
+    // Culls and sorts the drawables each frame, reusing the list when nothing changed
+    DrawListBuilder drawListBuilder;
 };
     
 typedef std::shared_ptr<SceneRendererGLES> SceneRendererGLESRef;
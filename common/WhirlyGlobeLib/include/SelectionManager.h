@@ -19,6 +19,8 @@
 #import <math.h>
 #import <set>
 #import <map>
+#import <unordered_map>
+#import "BoundsTree.h"
 #import "Identifiable.h"
 #import "WhirlyGeometry.h"
 #import "WhirlyKitView.h"
@@ -203,6 +205,10 @@ typedef std::set<WhirlyKit::BillboardSelectable> BillboardSelectableSet;
  
     All objects are currently being projected to the 2D screen and
      evaluated for distance there.
+
+    With the spatial index turned on, we keep the display space bounds
+     of everything in a bounding volume tree and only project the objects
+     that might be near the touch.
  
     The selection manager is entirely thread safe except for destruction.
  */
@@ -312,6 +318,23 @@ public:
     /// Find all the objects within a given distance and return them, sorted by distance
     void pickObjects(const Point2f &touchPt,float maxDist,
                      const ViewStateRef &viewState,std::vector<SelectedObject> &selObjs);
+
+    /// Find all the objects whose centers land within the given screen rectangle, sorted by distance from the eye.
+    /// For linears, any of the points will do.
+    void pickObjectsInRect(const Point2f &ll,const Point2f &ur,
+                           const ViewStateRef &viewState,std::vector<SelectedObject> &selObjs);
+
+    /// Find all the objects whose centers land within the given screen polygon (a lasso), sorted by distance from the eye.
+    /// For linears, any of the points will do.
+    void pickObjectsInPolygon(const Point2fVector &screenPoly,
+                              const ViewStateRef &viewState,std::vector<SelectedObject> &selObjs);
+
+    /// Turn the spatial index on or off.  Off by default.
+    /// With lots of selectables, this saves projecting every one of them on every pick.
+    void setUseSpatialIndex(bool useIndex);
+
+    /// Set if we're maintaining the spatial index
+    bool getUseSpatialIndex() const { return useIndex; }
     
     // Everything we need to project a world coordinate to one or more screen locations
     class PlacementInfo
@@ -346,13 +369,41 @@ protected:
     // Projects a world coordinate to one or more points on the screen (wrapping)
     static void projectWorldPointToScreen(const Point3d &worldLoc,const PlacementInfo &pInfo,Point2dVector &screenPts,float scale);
 
-    // Convert rect selectables into more generic screen space objects
-    void getScreenSpaceObjects(const PlacementInfo &pInfo,std::vector<ScreenSpaceObjectLocation> &screenObjs,TimeInterval now);
+    // The sets the selectables live in, as tracked by the spatial index
+    enum SelectableKind {
+        SelectRect3D = 0,
+        SelectRect2D,
+        SelectMovingRect2D,
+        SelectPolytope,
+        SelectMovingPolytope,
+        SelectLinear,
+        SelectBillboard,
+        SelectNumKinds
+    };
+
+    // Convert rect selectables into more generic screen space objects.
+    // Pass in candidates from the spatial index to only consider those.
+    void getScreenSpaceObjects(const PlacementInfo &pInfo,std::vector<ScreenSpaceObjectLocation> &screenObjs,TimeInterval now,
+                               const std::vector<SimpleIdentity> *candidates = nullptr);
 
     // Internal object picking method
     void pickObjects(const Point2f &touchPt,float maxDist,const ViewStateRef &viewState,
                      bool multi,std::vector<SelectedObject> &selObjs);
 
+    // Add a selectable to the spatial index, if it's on.  Caller holds the lock.
+    template <typename T> void addToIndex(SelectableKind kind,const T &sel);
+
+    // Take a selectable out of the spatial index, if it's on.  Caller holds the lock.
+    void removeFromIndex(SimpleIdentity selectID);
+
+    // Build the spatial index from scratch.  Caller holds the lock.
+    void rebuildIndex();
+
+    // Look for anything that might project into the given screen rectangle.
+    // Fills in one list of IDs per SelectableKind.  Caller holds the lock.
+    void findCandidates(const PlacementInfo &pInfo,const Point2f &ll,const Point2f &ur,
+                        std::vector<SimpleIdentity> *candidates);
+
     Scene *scene;
     /// The selectable objects themselves
     WhirlyKit::RectSelectable3DSet rect3Dselectables;
@@ -362,6 +413,14 @@ protected:
     WhirlyKit::MovingPolytopeSelectableSet movingPolytopeSelectables;
     WhirlyKit::LinearSelectableSet linearSelectables;
     WhirlyKit::BillboardSelectableSet billboardSelectables;
+
+    /// Spatial index over the display space bounds of the selectables, one per kind.
+    /// Screen space selectables go in by their centers, which can be off by as much as maxScreenSize
+    bool useIndex = false;
+    BoundsTree<3> kindIndex[SelectNumKinds];
+    float maxScreenSize = 0.0f;
+    /// Index handles by selectable ID, one map per kind
+    std::unordered_map<SimpleIdentity,int> indexHandles[SelectNumKinds];
 };
 typedef std::shared_ptr<SelectionManager> SelectionManagerRef;
  
@@ -19,14 +19,23 @@
  */
 
 #import <math.h>
-#import "VectorData.h"
+#import "BoundsTree.h"
 #import "GlobeMath.h"
+#import "RawData.h"
+#import "TaskPool.h"
+#import "VectorData.h"
+#import "VectorObject.h"
 
 namespace WhirlyKit
 {
 
 /** Shape File Reader.
 	Open a shapefile and return the features as requested.
+
+    For bulk loading, readObjects() and readArea() decode records straight out of
+    the mapped .shp and .dbf files, in batches on a task pool if you give it one.
+    readArea() uses a spatial index over the record bounds, so only the records
+    you need are decoded.
  */
 class ShapeReader : public VectorReader
 {
@@ -49,12 +58,59 @@ public:
 
     /// Fetch an object by the index
     virtual VectorShapeRef getObjectByIndex(unsigned int vecIndex,const StringSet *filter);
-    
+
+    /// Decode records on this pool in readObjects() and readArea().  Serial by default.
+    void setPool(TaskPoolRef pool) { this->pool = std::move(pool); }
+
+    /// Build the spatial index over the record bounds.  Only the bounds are read.
+    /// query() calls this for you.
+    bool buildIndex();
+
+    /// Records whose bounds overlap the given area, which is in radians.
+    /// Not thread safe.
+    void query(const Mbr &mbr,std::vector<unsigned int> &records);
+
+    /// Decode the given records and add them to the shapes.  Null records are skipped.
+    /// The filter works the same as for getObjectByIndex().
+    bool readObjects(const std::vector<unsigned int> &records,const StringSet *filter,ShapeSet &shapes);
+
+    /// Vector object with all the records overlapping the given area, as decoded
+    VectorObjectRef readArea(const Mbr &mbr,const StringSet *filter);
+
 protected:
+    typedef enum {FieldSkip,FieldString,FieldInt,FieldDouble} FieldType;
+
+    // A column in the .dbf file
+    struct DBFField
+    {
+        std::string name;
+        FieldType type;
+        // Type character from the file, which decides what counts as null
+        char dbfType;
+        unsigned int offset,width;
+    };
+
+    // Map the files for the bulk reading path
+    bool mapFiles();
+    // Bounds of a record in radians, padded out to cover the float geometry.  False for null records
+    bool recordBounds(unsigned int which,double *ll,double *ur) const;
+    // Decode a record from the mapped files
+    VectorShapeRef decodeRecord(unsigned int which,const std::vector<const DBFField *> &fields) const;
+
 	void *shp;
 	void *dbf;
 	int where,numEntity,shapeType;
 	double minBound[4], maxBound[4];
+
+    std::string fileName;
+    TaskPoolRef pool;
+    bool triedMap;
+    RawDataRef shpData,shxData,dbfData;
+    unsigned int numRecords;
+    unsigned int dbfRecords,dbfHeaderLen,dbfRecordLen;
+    std::vector<DBFField> dbfFields;
+    bool indexBuilt;
+    BoundsTree<2> index;
 };
 
 }
@@ -51,6 +51,12 @@ public:
     /// Convert from display coordinates to geocentric
     virtual Point3f geocentricToLocal(Point3f) const override;
     virtual Point3d geocentricToLocal(Point3d) const override;
+
+    /// Batch versions of the above
+    virtual void localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const override;
+    virtual void geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const override;
+    virtual void localToGeocentricBatch(const Point3d *in,Point3d *out,size_t count) const override;
+    virtual void geocentricToLocalBatch(const Point3d *in,Point3d *out,size_t count) const override;
     
     /// True if the other system is Spherical Mercator with the same origin
     virtual bool isSameAs(const CoordSystem *coordSys) const override;
@@ -98,6 +104,11 @@ public:
     virtual Point3f normalForLocal(Point3f) const override { return Point3f(0,0,1); }
     virtual Point3d normalForLocal(Point3d) const override { return Point3d(0,0,1); }
 
+    /// Batch versions of the above
+    virtual void localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const override;
+    virtual void displayToLocalBatch(const Point3d *in,Point3d *out,size_t count) const override;
+    virtual void normalForLocalBatch(const Point3d *in,Point3d *out,size_t count) const override;
+
     /// Get a reference to the coordinate system
     virtual CoordSystem *getCoordSystem() const override {
         // todo: eventually return a const pointer
@@ -107,6 +118,9 @@ public:
     /// Return true if this is a projected coordinate system.
     /// False for others, like geographic.
     virtual bool isFlat() const override { return true; }
+
+    /// Just an offset
+    virtual bool isThreadSafe() const override { return true; }
     
 protected:
     Point2d org,ll,ur,geoLL,geoUR;
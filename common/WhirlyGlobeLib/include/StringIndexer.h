@@ -22,6 +22,8 @@
 #import <unordered_map>
 #import <string>
 #import <mutex>
+#import <atomic>
+#import <memory>
 
 namespace WhirlyKit
 {
@@ -98,6 +100,11 @@ extern StringIdentity a_modelDirNameID;
  than a string in certain high performance unordered maps and such.
  
  Only adds strings.  Never removes them.
+
+ Looking up a string that's already there doesn't lock.  The hash table
+ and the ID array only ever grow and what's in them never changes once
+ it's published, so readers just follow atomic pointers.  Adding a new
+ string takes the lock.
  */
 class StringIndexer
 {
@@ -107,6 +114,12 @@ public:
     
     // Return the string for a string identity
     static std::string getString(StringIdentity);
+
+    // Look up the identity for a string without making one.  False if nobody's asked for it yet.
+    static bool findStringID(const std::string &,StringIdentity &strID);
+
+    // IDs are handed out in order, so everything below this has been taken
+    static StringIdentity getNumStrings();
     
 protected:
     StringIndexer();
@@ -114,10 +127,42 @@ protected:
     void operator=(StringIndexer const&)    = delete;
 
     static StringIndexer &getInstance() { return instance; }
-    
-    mutable std::mutex mutex;
-    std::unordered_map<std::string,StringIdentity> stringToIdent;
-    std::vector<std::string> identToString;
+
+    // A string we've seen.  These are never changed or deleted once made.
+    struct Entry
+    {
+        Entry(const std::string &str,size_t hash,StringIdentity strID) : str(str), hash(hash), strID(strID) { }
+        const std::string str;
+        const size_t hash;
+        const StringIdentity strID;
+    };
+
+    // Open addressing hash table.  Replaced with a bigger one when it gets half full.
+    struct Table
+    {
+        Table(size_t size);
+        const size_t mask;
+        std::unique_ptr<std::atomic<const Entry *>[]> slots;
+    };
+
+    // Entries by ID live in segments that double in size, so they never move
+    static constexpr size_t FirstSegmentSize = 512;
+    static constexpr int MaxSegments = 40;
+    static void segmentForID(StringIdentity strID,int &segment,size_t &offset);
+
+    const Entry *find(const std::string &str,size_t hash) const;
+    StringIdentity add(const std::string &str,size_t hash);
+
+    std::atomic<Table *> table;
+    std::atomic<const Entry *> *segments[MaxSegments];
+    std::atomic<size_t> numStrings;
+
+    // Held when adding
+    std::mutex mutex;
+    // Everything we've allocated, including old tables someone might still be reading
+    std::vector<std::unique_ptr<Table>> tables;
+    std::vector<std::unique_ptr<Entry>> entries;
+    std::vector<std::unique_ptr<std::atomic<const Entry *>[]>> segmentStorage;
 
 private:
     static StringIndexer instance;
@@ -0,0 +1,124 @@
+/*  TaskPool.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <atomic>
+#import <condition_variable>
+#import <deque>
+#import <exception>
+#import <functional>
+#import <memory>
+#import <mutex>
+#import <thread>
+#import <vector>
+
+namespace WhirlyKit
+{
+
+class PlatformThreadInfo;
+
+/** A small work stealing thread pool for CPU bound work.
+
+    Each worker has its own queue and takes from the front of it.
+    Idle workers steal from the back of the other queues.
+    The thread waiting on a batch helps out rather than blocking,
+    so it's safe to submit a batch from inside another batch.
+
+    These are meant to be shared between layers, see sharedPool().
+
+    Workers can carry their own PlatformThreadInfo (a JNIEnv on Android).
+    The attach function makes it when a worker starts and detach cleans it up on exit.
+  */
+class TaskPool
+{
+public:
+    typedef std::function<void()> Task;
+    typedef std::function<PlatformThreadInfo *()> AttachFunction;
+    typedef std::function<void(PlatformThreadInfo *)> DetachFunction;
+
+    /// Start up the given number of worker threads.  Zero runs everything on the caller.
+    TaskPool(int numThreads);
+
+    /// Start up the given number of worker threads, calling attach on each as it starts
+    ///  and detach with whatever that returned as it exits.
+    TaskPool(int numThreads,AttachFunction attach,DetachFunction detach);
+    ~TaskPool();
+
+    TaskPool(const TaskPool &) = delete;
+    TaskPool &operator=(const TaskPool &) = delete;
+
+    /// Number of worker threads (not counting the caller)
+    int getNumThreads() const { return (int)workers.size(); }
+
+    /// Run the tasks and return when they're all done.
+    /// The calling thread runs tasks too.
+    /// If any of them throw, the first exception is rethrown here once the rest have finished.
+    void run(std::vector<Task> &tasks);
+
+    /// Call the function for every index in [0,count) and return when they're done.
+    /// Indices are handed out in blocks of batchSize.
+    void parallelFor(size_t count,const std::function<void(size_t)> &func,size_t batchSize = 1);
+
+    /// From inside a task, the thread info our attach function made for this worker.
+    /// Tasks running on the thread that called run(), or in a pool without one, get callerInst back.
+    PlatformThreadInfo *getThreadInfo(PlatformThreadInfo *callerInst) const;
+
+    /// A pool sized to the device, shared by everything that doesn't need its own
+    static std::shared_ptr<TaskPool> sharedPool();
+
+protected:
+    // Keeps track of the outstanding tasks in one run() call
+    struct Batch
+    {
+        std::atomic<int> remaining;
+        std::mutex lock;
+        std::condition_variable cond;
+        // First exception thrown by one of the tasks, protected by lock
+        std::exception_ptr error;
+    };
+
+    struct QueuedTask
+    {
+        Task task;
+        Batch *batch;
+    };
+
+    struct Worker
+    {
+        std::mutex lock;
+        std::deque<QueuedTask> tasks;
+        std::thread thread;
+    };
+
+    void workerMain(int which);
+    bool popTask(int which,QueuedTask &task);
+    bool stealTask(int which,QueuedTask &task);
+    void runTask(QueuedTask &task);
+    void startWorkers(int numThreads);
+
+    AttachFunction attach;
+    DetachFunction detach;
+    std::vector<std::unique_ptr<Worker> > workers;
+    std::atomic<unsigned> nextWorker;
+    std::atomic<int> queued;
+    std::mutex sleepLock;
+    std::condition_variable sleepCond;
+    bool stopping;
+};
+typedef std::shared_ptr<TaskPool> TaskPoolRef;
+
+}
@@ -31,8 +31,13 @@ void TesselateRing(const WhirlyKit::VectorRing &ring,VectorTrianglesRef tris);
 
 /** Tesselate the given areal feature.  The first ring is the outer,
     all others are meant to be holes.
+    Convex rings are fanned and small simple rings are ear clipped.
+    Everything else goes through libtess.
   */
 void TesselateLoops(const std::vector<VectorRing> &loops,VectorTrianglesRef tris);
 
+/// Tesselate with libtess, even if the polygon is simple
+void TesselateLoopsGeneral(const std::vector<VectorRing> &loops,VectorTrianglesRef tris);
+
 
 }
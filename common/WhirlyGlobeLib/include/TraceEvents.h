@@ -0,0 +1,186 @@
+/*  TraceEvents.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <atomic>
+#import <cstdint>
+#import <memory>
+#import <mutex>
+#import <string>
+#import <vector>
+
+namespace WhirlyKit
+{
+
+/** Name and category of a trace event.
+    These are made once per call site (see WK_TRACE_SCOPE) and the events
+    just point to them, so recording an event never touches a string.
+  */
+struct TraceName
+{
+    const char *name;
+    const char *category;
+};
+
+/** A single recorded event.
+    Fields are atomic so that an export can read a buffer while its thread is writing.
+  */
+struct TraceEvent
+{
+    enum Type : int { Complete, Instant, Counter };
+
+    std::atomic<const TraceName *> name{nullptr};
+    std::atomic<int> type{Complete};
+    std::atomic<uint64_t> start{0};
+    std::atomic<uint64_t> dur{0};
+    std::atomic<int64_t> value{0};
+};
+
+/** Fixed size ring of events written by exactly one thread.
+    Old events are overwritten once it fills.
+  */
+class TraceThreadBuffer
+{
+public:
+    TraceThreadBuffer(unsigned int threadID,size_t capacity);
+
+    void record(const TraceName *name,TraceEvent::Type type,uint64_t start,uint64_t dur,int64_t value);
+
+    const unsigned int threadID;
+    std::vector<TraceEvent> events;
+    // Event counts.  The slot for an event is its count modulo the capacity.
+    // Claimed goes up before the slot is filled in, written after.
+    std::atomic<uint64_t> claimed{0};
+    std::atomic<uint64_t> written{0};
+    // Events before this were thrown away by clear()
+    std::atomic<uint64_t> cleared{0};
+    std::string threadName;
+    // Set while a thread owns this buffer
+    std::atomic<bool> inUse{true};
+};
+typedef std::shared_ptr<TraceThreadBuffer> TraceThreadBufferRef;
+
+/** Collects trace events from every thread and writes them out
+    in the Chrome trace format (chrome://tracing or Perfetto).
+    Recording is off until enabled and costs one atomic load when off.
+  */
+class TraceRecorder
+{
+public:
+    /// The one recorder for the process
+    static TraceRecorder &get();
+
+    /// Turn recording on or off
+    void setEnabled(bool enable) { enabled.store(enable,std::memory_order_relaxed); }
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /// Number of events each thread keeps.  Only applies to buffers made after this,
+    ///  so threads that have already recorded, or reuse a buffer, keep the old size.
+    void setEventsPerThread(size_t num);
+
+    /// Name the calling thread in the output
+    void setThreadName(const std::string &name);
+
+    /// Monotonic time in nanoseconds
+    static uint64_t now();
+
+    /// Record a span that's already finished
+    void complete(const TraceName *name,uint64_t start,uint64_t end);
+    /// Record a point in time, such as the start of a frame
+    void instant(const TraceName *name);
+    /// Record the value of a counter
+    void counter(const TraceName *name,int64_t value);
+
+    /// Everything currently in the buffers as Chrome trace JSON
+    std::string exportChromeJSON() const;
+    /// Write the Chrome trace JSON to a file
+    bool writeChromeJSON(const std::string &fileName) const;
+
+    /// Throw away the recorded events
+    void clear();
+
+protected:
+    TraceRecorder() = default;
+
+    // Buffer for the calling thread, set up the first time it records
+    TraceThreadBuffer *threadBuffer();
+    void releaseBuffer(TraceThreadBuffer *buffer);
+    friend struct TraceThreadHolder;
+
+    std::atomic<bool> enabled{false};
+    size_t eventsPerThread = 16384;
+    mutable std::mutex mutex;
+    std::vector<TraceThreadBufferRef> buffers;
+};
+
+/// Records the time between construction and destruction as a span
+class TraceSpan
+{
+public:
+    TraceSpan(const TraceName *name) :
+        name(TraceRecorder::get().isEnabled() ? name : nullptr),
+        start(this->name ? TraceRecorder::now() : 0)
+    {
+    }
+    ~TraceSpan() { end(); }
+
+    /// Finish the span early.  Does nothing after the first time.
+    void end()
+    {
+        if (name)
+            TraceRecorder::get().complete(name,start,TraceRecorder::now());
+        name = nullptr;
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+protected:
+    const TraceName *name;
+    const uint64_t start;
+};
+
+}
+
+#define WK_TRACE_CONCAT2(a,b) a##b
+#define WK_TRACE_CONCAT(a,b) WK_TRACE_CONCAT2(a,b)
+
+/// Trace the rest of the enclosing scope.  Name and category must be string literals.
+#define WK_TRACE_SCOPE(category,name) \
+    static const WhirlyKit::TraceName WK_TRACE_CONCAT(wkTraceName,__LINE__) = {name,category}; \
+    WhirlyKit::TraceSpan WK_TRACE_CONCAT(wkTraceSpan,__LINE__)(&WK_TRACE_CONCAT(wkTraceName,__LINE__))
+
+/// Named span for code that needs to end it before the scope does
+#define WK_TRACE_SPAN(var,category,name) \
+    static const WhirlyKit::TraceName WK_TRACE_CONCAT(wkTraceName,__LINE__) = {name,category}; \
+    WhirlyKit::TraceSpan var(&WK_TRACE_CONCAT(wkTraceName,__LINE__))
+
+/// Mark a point in time
+#define WK_TRACE_INSTANT(category,name) \
+    do { \
+        static const WhirlyKit::TraceName wkTraceName = {name,category}; \
+        if (WhirlyKit::TraceRecorder::get().isEnabled()) \
+            WhirlyKit::TraceRecorder::get().instant(&wkTraceName); \
+    } while (0)
+
+/// Record a counter value
+#define WK_TRACE_COUNTER(category,name,value) \
+    do { \
+        static const WhirlyKit::TraceName wkTraceName = {name,category}; \
+        if (WhirlyKit::TraceRecorder::get().isEnabled()) \
+            WhirlyKit::TraceRecorder::get().counter(&wkTraceName,(value)); \
+    } while (0)
@@ -0,0 +1,211 @@
+/*  VectorFeatureStore.h
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <memory>
+#import <string>
+#import <vector>
+#import "RawData.h"
+#import "VectorData.h"
+#import "VectorObject.h"
+#import "FlatDictionaryC.h"
+
+namespace WhirlyKit
+{
+
+class VectorFeatureStore;
+typedef std::shared_ptr<VectorFeatureStore> VectorFeatureStoreRef;
+
+/** A read only collection of vector features in a single block of memory, usually a mapped file.
+
+    The format is columnar.  Every feature's points are in one array, with offset
+    arrays saying where each feature and each of its parts (loops) start.  Strings,
+    both attribute names and values, are stored once in a shared table.  Features are
+    sorted along a Hilbert curve when written and a packed R-tree over their bounds
+    follows them, so an area query only touches the part of the file it needs.
+
+    Geometry comes back as pointers into the data, nothing is copied.  Use makeShape()
+    or getShapes() to get regular VectorShape objects for everything else.
+
+    Coordinates are geographic, in radians.  Everything in the file is in the writer's
+    byte order.  We refuse to open files from the other kind of machine.
+  */
+class VectorFeatureStore
+{
+public:
+    /// Bumped whenever the layout changes.  Older versions won't open.
+    static constexpr uint32_t FileVersion = 1;
+
+    typedef enum : uint8_t {FeatureNone=0,FeaturePoints,FeatureLinear,FeatureAreal,FeatureTriangles} FeatureType;
+
+    /// Map the given file.  Returns null if it's missing or isn't a feature store we can read.
+    static VectorFeatureStoreRef open(const std::string &fileName);
+
+    /// Use data that's already in memory.  We hang on to it.
+    static VectorFeatureStoreRef open(RawDataRef data);
+
+    /// Number of features
+    unsigned int getNumFeatures() const { return header->numFeatures; }
+
+    /// Bounds of everything in the store
+    Mbr getBounds() const;
+
+    /// Type of the given feature
+    FeatureType getType(unsigned int which) const { return (FeatureType)featTypes[which]; }
+
+    /// Bounds of the given feature
+    Mbr getBounds(unsigned int which) const;
+
+    /// Number of parts.  Areals have one per loop, the outer loop first.  Everything else has one.
+    unsigned int getNumParts(unsigned int which) const { return featParts[which+1] - featParts[which]; }
+
+    /// Points for one part of the feature.  These point into the store, so don't outlive it.
+    const Point2f *getPoints(unsigned int which,unsigned int part,unsigned int &numPts) const;
+
+    /// Heights for the points of a part, if it's a triangle mesh.  Null otherwise.
+    const float *getHeights(unsigned int which,unsigned int part) const;
+
+    /// Triangles for a mesh, indexing into its single part
+    const VectorTriangles::Triangle *getTriangles(unsigned int which,unsigned int &numTris) const;
+
+    /// Attribute names, shared by every dictionary we make
+    const DictionaryKeyTableRef &getKeyTable() const { return keyTable; }
+
+    /// Copy out the attributes for a feature.  If filter is set, only those attributes are copied.
+    MutableDictionaryRef makeAttributes(unsigned int which,const StringSet *filter = nullptr) const;
+
+    /// Features whose bounds overlap the given area, in storage order
+    void query(const Mbr &mbr,std::vector<unsigned int> &features) const;
+
+    /// Copy the feature out as a regular vector shape
+    VectorShapeRef makeShape(unsigned int which,const StringSet *filter = nullptr) const;
+
+    /// Make shapes for all the features
+    void getShapes(ShapeSet &shapes) const;
+
+    /// Make shapes for the features overlapping the given area
+    void getShapes(const Mbr &mbr,ShapeSet &shapes) const;
+
+    /// Vector object with the features overlapping the given area
+    VectorObjectRef makeVectorObject(const Mbr &mbr) const;
+
+    // Layout of the start of the file
+    struct Header
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t byteOrder;
+        uint32_t numFeatures;
+        uint32_t numParts;
+        uint32_t numPoints;
+        uint32_t numHeights;
+        uint32_t numTris;
+        uint32_t numAttrs;
+        uint32_t numStrings;
+        // The first numKeys strings are attribute names
+        uint32_t numKeys;
+        uint32_t stringBytes;
+        // Children per node in the spatial index
+        uint32_t nodeSize;
+        uint32_t numIndexLevels;
+        uint32_t numIndexBoxes;
+        uint32_t reserved;
+        float bounds[4];
+        // Where each of the Section arrays starts
+        uint64_t sections[12];
+    };
+
+    // The arrays after the header
+    enum Section {
+        SectFeatTypes,      // uint8_t per feature
+        SectFeatParts,      // uint32_t per feature + 1, index of first part
+        SectFeatTris,       // uint32_t per feature + 1, index of first triangle
+        SectFeatAttrs,      // uint32_t per feature + 1, index of first attribute
+        SectPartPoints,     // uint32_t per part + 1, index of first point
+        SectPoints,         // Point2f
+        SectHeights,        // float per point, only if there are meshes
+        SectTris,           // VectorTriangles::Triangle
+        SectAttrs,          // Attr
+        SectStringOffsets,  // uint32_t per string + 1
+        SectStringData,     // char
+        SectIndex,          // float[4] per box, the level with every feature first, root last
+        NumSections
+    };
+
+    // A single attribute value
+    struct Attr
+    {
+        uint32_t key;
+        uint32_t type;
+        union {
+            int64_t iVal;
+            double dVal;
+            uint32_t strVal;
+        } val;
+    };
+
+protected:
+    VectorFeatureStore(RawDataRef data);
+
+    // Check the header and arrays make sense before we trust them
+    bool setup();
+
+    // String from the shared table
+    std::string getString(uint32_t which) const;
+
+    RawDataRef data;
+    const Header *header = nullptr;
+    const uint8_t *featTypes = nullptr;
+    const uint32_t *featParts = nullptr;
+    const uint32_t *featTris = nullptr;
+    const uint32_t *featAttrs = nullptr;
+    const uint32_t *partPoints = nullptr;
+    const Point2f *points = nullptr;
+    const float *heights = nullptr;
+    const VectorTriangles::Triangle *tris = nullptr;
+    const Attr *attrs = nullptr;
+    const uint32_t *stringOffsets = nullptr;
+    const char *stringData = nullptr;
+    const float *indexBoxes = nullptr;
+    // Where each level of the index starts, counted in boxes
+    std::vector<uint32_t> levelStarts;
+    DictionaryKeyTableRef keyTable;
+};
+
+/// Write the shapes as a feature store.  Points, linears, areals and triangle meshes are supported.
+/// Attributes may be ints, 64 bit values, doubles or strings.  Anything else is dropped.
+bool VectorFeatureStoreWrite(const std::string &fileName,const ShapeSet &shapes);
+
+/** Reads shapes out of a feature store one at a time, for the code that wants a VectorReader.
+  */
+class VectorFeatureStoreReader : public VectorReader
+{
+public:
+    VectorFeatureStoreReader(VectorFeatureStoreRef store);
+
+    virtual bool isValid() override { return store.get() != nullptr; }
+    virtual VectorShapeRef getNextObject(const StringSet *filter) override;
+    virtual bool canReadByIndex() override { return true; }
+    virtual unsigned int getNumObjects() override;
+    virtual VectorShapeRef getObjectByIndex(unsigned int vecIndex,const StringSet *filter) override;
+
+protected:
+    VectorFeatureStoreRef store;
+    unsigned int next;
+};
+
+}
@@ -9,10 +9,12 @@
 #ifndef VectorTilePBFParser_h
 #define VectorTilePBFParser_h
 
+#include <Dictionary.h>
 #include <Identifiable.h>
 #include <VectorData.h>
 #include <WhirlyVector.h>
 #include <MapboxVectorTileParser.h>
+#include <StringIndexer.h>
 
 #include <functional>
 #include <map>
@@ -40,6 +42,110 @@ class VectorObject;
 typedef std::shared_ptr<MutableDictionaryC> MutableDictionaryCRef;
 typedef std::shared_ptr<VectorObject> VectorObjectRef;
 
+/// Keys, values and feature tags for one layer of a vector tile.
+/// Shared by the lazy attribute dictionaries of all the features in that layer.
+/// We keep copies of the strings, so this outlives the tile data.
+struct VectorTileLayerAttributes
+{
+    struct Value
+    {
+        DictionaryType type = DictTypeNone;
+        int intVal = 0;
+        double doubleVal = 0.0;
+        std::string stringVal;
+    };
+
+    std::string layerName;
+    int layerOrder = 0;
+    std::vector<std::string> keys;
+    /// StringIndexer IDs for the keys, so lookups can skip the string compares.
+    /// Only keys somebody has already asked for by ID (filters, mostly) get one,
+    ///  the rest are NoKeyID.  We don't want every key of every tile in the indexer.
+    std::vector<StringIdentity> keyIDs;
+    /// The indexer's size when the IDs were looked up.  Newer IDs have to compare names.
+    StringIdentity keyIDLimit = 0;
+    static constexpr StringIdentity NoKeyID = ~(StringIdentity)0;
+    std::vector<Value> values;
+    /// Key/value index pairs for all the features in the layer
+    std::vector<uint32_t> tags;
+
+    /// Fill in a regular dictionary with the attributes for one feature
+    void fillDictionary(MutableDictionaryC &dict,uint32_t tagStart,uint32_t tagEnd,int geomType) const;
+};
+typedef std::shared_ptr<const VectorTileLayerAttributes> VectorTileLayerAttributesRef;
+
+/** Attributes for a single vector tile feature, decoded on demand.
+
+    Rather than building a dictionary for every feature, this points into the
+    layer's shared key/value tables.  Lookups scan the feature's tags, which is
+    about as fast as a hash lookup for the handful of tags a feature usually has.
+    If anyone modifies it, we build a regular dictionary and use that from then on.
+ */
+class VectorTileFeatureDictionary : public MutableDictionary
+{
+public:
+    VectorTileFeatureDictionary(VectorTileLayerAttributesRef layer,uint32_t tagStart,uint32_t tagEnd,int geomType);
+    virtual ~VectorTileFeatureDictionary() = default;
+
+    virtual int count() const override;
+    virtual bool empty() const override { return count() == 0; }
+    virtual bool hasField(const std::string &name) const override;
+    virtual DictionaryType getType(const std::string &name) const override;
+    virtual int getInt(const std::string &name,int defVal) const override;
+    virtual int64_t getInt64(const std::string &name,int64_t defVal) const override;
+    virtual SimpleIdentity getIdentity(const std::string &name) const override;
+    virtual bool getBool(const std::string &name,bool defVal) const override;
+    virtual RGBAColor getColor(const std::string &name,const RGBAColor &defVal) const override;
+    virtual double getDouble(const std::string &name,double defVal) const override;
+    virtual std::string getString(const std::string &name) const override;
+    virtual std::string getString(const std::string &name,const std::string &defVal) const override;
+    virtual DictionaryRef getDict(const std::string &name) const override;
+    virtual DictionaryEntryRef getEntry(const std::string &name) const override;
+    virtual std::vector<DictionaryEntryRef> getArray(const std::string &name) const override;
+    virtual std::vector<std::string> getKeys() const override;
+
+    virtual MutableDictionaryRef copy() const override;
+    virtual void clear() override;
+    virtual void removeField(const std::string &name) override;
+    virtual void setInt(const std::string &name,int val) override;
+    virtual void setInt64(const std::string &name,int64_t val) override;
+    virtual void setIdentifiable(const std::string &name,SimpleIdentity val) override;
+    virtual void setDouble(const std::string &name,double val) override;
+    virtual void setString(const std::string &name,const std::string &val) override;
+    virtual void addEntries(const Dictionary *other) override;
+
+    /// A single value, either from the layer tables or one of the ones we make up
+    struct ValueRef
+    {
+        DictionaryType type = DictTypeNone;
+        int intVal = 0;
+        double doubleVal = 0.0;
+        const std::string *stringVal = nullptr;
+    };
+
+    /// Look up a value by the StringIndexer ID of its key rather than the key itself.
+    /// This only sees the layer tables, so check isModified() first.
+    bool findValueByID(StringIdentity keyID,ValueRef &val) const;
+
+    /// Set once someone has changed the attributes and we've switched to a regular dictionary
+    bool isModified() const { return (bool)dict; }
+
+protected:
+    // Look for the value with the given name
+    bool findValue(const std::string &name,ValueRef &val) const;
+
+    // Switch over to a regular dictionary so we can modify it
+    MutableDictionaryC &materialize();
+
+    VectorTileLayerAttributesRef layer;
+    uint32_t tagStart;
+    uint32_t tagEnd;
+    int geomType;
+
+    // Set once we've been modified
+    MutableDictionaryCRef dict;
+};
+
 class VectorTilePBFParser
 {
 public:
@@ -59,6 +165,11 @@ public:
 
     bool parse(const uint8_t* data, size_t length);
 
+    /// Point features at the shared layer tables rather than building a dictionary for each.
+    /// Attribute values are only decoded when a style or the caller asks for them.
+    void setLazyAttributes(bool lazy) { _lazyAttributes = lazy; }
+    bool getLazyAttributes() const { return _lazyAttributes; }
+
     unsigned getLayerCount() const { return _layerCount; }
     unsigned getFeatureCount() const { return _featureCount; }
     
@@ -148,8 +259,9 @@ private:
     inline bool featureDecode(pb_istream_t *stream, const pb_field_iter_t *field);
 
     // Parsing methods
-    inline bool processTags(const MutableDictionaryCRef &attributes, size_t tagIdx, size_t geomIdx, const Feature &feature);
-    inline bool checkStyles(SimpleIDUSet& styleIDs, const MutableDictionaryCRef &attributes, const std::string &layerName);
+    inline bool processTags(MutableDictionaryC *attributes, size_t tagIdx, size_t geomIdx, const Feature &feature);
+    inline bool checkStyles(SimpleIDUSet& styleIDs, const Dictionary &attributes, const std::string &layerName);
+    inline VectorTileLayerAttributesRef makeLayerAttributes(const std::string &layerName) const;
     inline void parseLineString(const uint32_t *geometry, size_t geomCount, ShapeSet& shapes) const;
     inline bool parsePolygon(const uint32_t *geometry, size_t geomCount, VectorAreal& shape);
     inline bool parsePoints(const uint32_t *geometry, size_t geomCount, VectorPoints& shape);
@@ -195,6 +307,7 @@ private:
     const bool _parseAll;
     std::vector<VectorObjectRef>* _keepVectors = nullptr;
     CancelFunction _checkCancelled;
+    bool _lazyAttributes = false;
 
     // Reused storage
     VectorRing tempRing;
@@ -21,11 +21,14 @@
 #import <vector>
 #import <set>
 #import <map>
+#import <memory>
+#import <cstring>
 #import "RawData.h"
 #import "Identifiable.h"
 #import "StringIndexer.h"
 #import "WhirlyVector.h"
 #import "ChangeRequest.h"
+#import "Expect.h"
 
 namespace WhirlyKit
 {
@@ -41,13 +44,78 @@ typedef enum {
     BDDataTypeMax
 } BDAttributeDataType;
 
+/// Size in bytes of a single value of the given type
+int VertexAttributeTypeSize(BDAttributeDataType dataType);
+
+/// Maps the C++ type we store to the attribute data type
+template<typename T> struct VertexAttributeType;
+template<> struct VertexAttributeType<Eigen::Vector4f> { static constexpr BDAttributeDataType value = BDFloat4Type; };
+template<> struct VertexAttributeType<Eigen::Vector3f> { static constexpr BDAttributeDataType value = BDFloat3Type; };
+template<> struct VertexAttributeType<RGBAColor> { static constexpr BDAttributeDataType value = BDChar4Type; };
+template<> struct VertexAttributeType<Eigen::Vector2f> { static constexpr BDAttributeDataType value = BDFloat2Type; };
+template<> struct VertexAttributeType<TexCoord> { static constexpr BDAttributeDataType value = BDFloat2Type; };
+template<> struct VertexAttributeType<float> { static constexpr BDAttributeDataType value = BDFloatType; };
+template<> struct VertexAttributeType<int> { static constexpr BDAttributeDataType value = BDIntType; };
+template<> struct VertexAttributeType<int64_t> { static constexpr BDAttributeDataType value = BDInt64Type; };
+
+/** Memory for the vertex attributes of a single drawable build.
+
+    Attribute arrays are carved out of a few big blocks rather than each
+    one going to the heap as it grows.  The last allocation can grow in
+    place, which is the common case when adding one vertex at a time.
+    Big arrays get a block of their own, which is freed when they outgrow it.
+    Everything else stays until the arena goes away, which happens when the
+    builder and every attribute using it are done with it.
+
+    Not thread safe.  Use one per builder.
+ */
+class VertexAttributeArena
+{
+public:
+    VertexAttributeArena() = default;
+    VertexAttributeArena(const VertexAttributeArena &) = delete;
+    VertexAttributeArena &operator = (const VertexAttributeArena &) = delete;
+
+    /// Allocate the given number of bytes, aligned for any of the attribute types
+    void *alloc(size_t bytes);
+
+    /// Grow an allocation, copying the old contents over if it has to move
+    void *realloc(void *ptr,size_t oldBytes,size_t newBytes);
+
+    /// Bytes we're holding on to from the system
+    size_t getAllocatedSize() const { return allocated; }
+
+protected:
+    static constexpr size_t Alignment = 16;
+    static constexpr size_t MinBlockSize = 1024;
+    static constexpr size_t MaxBlockSize = 64*1024;
+    // Allocations this big get their own block
+    static constexpr size_t LargeAllocSize = 16*1024;
+
+    std::vector<std::unique_ptr<char[]>> blocks;
+    std::vector<std::pair<std::unique_ptr<char[]>,size_t>> largeBlocks;
+    char *blockStart = nullptr;
+    char *last = nullptr;
+    size_t blockUsed = 0;
+    size_t blockSize = 0;
+    size_t allocated = 0;
+};
+typedef std::shared_ptr<VertexAttributeArena> VertexAttributeArenaRef;
+
 /// Used to keep track of attributes (other than points)
 class VertexAttribute
 {
 public:
     VertexAttribute(BDAttributeDataType dataType,int slot,StringIdentity nameID);
+    /// Copies everything but the data
     VertexAttribute(const VertexAttribute &that);
+    /// Takes the data along with everything else
+    VertexAttribute(VertexAttribute &&that) noexcept;
     virtual ~VertexAttribute();
+
+    /// Allocate data from the given arena rather than the heap.
+    /// Clearing the attribute lets go of the arena.
+    void setArena(VertexAttributeArenaRef newArena) { arena = std::move(newArena); }
     
     /// Make a copy of everything for the data
     VertexAttribute templateCopy() const;
@@ -65,20 +133,54 @@ public:
     void setDefaultFloat(float val);
     
     /// Convenience routine to add a color (if the type matches)
-    void addColor(const RGBAColor &color);
+    void addColor(const RGBAColor &color) { add(color); }
     /// Convenience routine to add a 2D vector (if the type matches)
-    void addVector2f(const Eigen::Vector2f &vec);
+    void addVector2f(const Eigen::Vector2f &vec) { add(vec); }
     /// Convenience routine to add a 3D vector (if the type matches)
-    void addVector3f(const Eigen::Vector3f &vec);
+    void addVector3f(const Eigen::Vector3f &vec) { add(vec); }
     /// Convenience routine to add a 4D vector (if the type matches)
-    void addVector4f(const Eigen::Vector4f &vec);
+    void addVector4f(const Eigen::Vector4f &vec) { add(vec); }
     /// Convenience routine to add a float (if the type matches)
-    void addFloat(float val);
+    void addFloat(float val) { add(val); }
     /// Convenience routine to add an int (if the type matches)
-    void addInt(int val);
+    void addInt(int val) { add(val); }
     /// Convenience routine to add an int64 (if the type matches)
-    void addInt64(int64_t val);
-    
+    void addInt64(int64_t val) { add(val); }
+
+    /// Add a single value.  Does nothing if the type doesn't match.
+    /// These are called once per vertex, so everything but running out of room stays inline.
+    template<typename T> void add(const T &val)
+    {
+        if (VertexAttributeType<T>::value != dataType)
+            return;
+        if (UNLIKELY(count == capacity))
+            grow(count + 1);
+        memcpy(bytes + (size_t)count * sizeof(T),&val,sizeof(T));
+        count++;
+    }
+
+    /// Add a run of values in one go.  Does nothing if the type doesn't match.
+    template<typename T> void append(const T *vals,size_t num)
+    {
+        if (VertexAttributeType<T>::value != dataType || num == 0)
+            return;
+        if (count + (int)num > capacity)
+            grow(count + (int)num);
+        memcpy(bytes + (size_t)count * sizeof(T),vals,num * sizeof(T));
+        count += (int)num;
+    }
+    template<typename T,typename A> void append(const std::vector<T,A> &vals) { append(vals.data(),vals.size()); }
+
+    /// Typed access to the data array.  Null if the type doesn't match or there's nothing there.
+    template<typename T> T *getData()
+    {
+        return (VertexAttributeType<T>::value == dataType && count > 0) ? (T *)bytes : nullptr;
+    }
+    template<typename T> const T *getData() const
+    {
+        return (VertexAttributeType<T>::value == dataType && count > 0) ? (const T *)bytes : nullptr;
+    }
+
     /// Reserve size in the data array
     void reserve(int size);
     
@@ -93,6 +195,11 @@ public:
     
     /// Return a pointer to the given element
     void *addressForElement(int which);
+
+protected:
+    // Make room for at least this many values
+    void grow(int minCapacity);
+    void setCapacity(int newCapacity);
     
 public:
     /// Data type for the attribute data
@@ -110,8 +217,14 @@ public:
     } defaultData;
     /// Used by Metal instead of a name
     int slot;
-    /// std::vector of attribute data.  Type is known by the caller.
-    void *data;
+
+protected:
+    // Values, packed.  These come from the arena if we have one.
+    char *bytes = nullptr;
+    int count = 0;
+    int capacity = 0;
+    VertexAttributeArenaRef arena;
+    std::unique_ptr<char[]> heapBytes;
 };
 typedef std::shared_ptr<VertexAttribute> VertexAttributeRef;
 
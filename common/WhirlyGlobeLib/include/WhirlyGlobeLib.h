@@ -26,14 +26,18 @@
 #import "BasicDrawableInstanceBuilder.h"
 #import "BillboardDrawableBuilder.h"
 #import "BillboardManager.h"
+#import "BoundsTree.h"
 #import "ComponentManager.h"
 #import "CoordSystem.h"
 #import "Dictionary.h"
 #import "DictionaryC.h"
 #import "Drawable.h"
+#import "DrawListBuilder.h"
 #import "DynamicTextureAtlas.h"
+#import "FlatDictionaryC.h"
 #import "FlatMath.h"
 #import "FontTextureManager.h"
+#import "GeoJSONStreamParser.h"
 #import "GeometryManager.h"
 #import "GeometryOBJReader.h"
 #import "GlobeAnimateHeight.h"
@@ -101,10 +105,13 @@
 #import "SphericalMercator.h"
 #import "StringIndexer.h"
 #import "Sun.h"
+#import "TaskPool.h"
 #import "Tesselator.h"
 #import "Texture.h"
 #import "TextureAtlas.h"
+#import "TraceEvents.h"
 #import "VectorData.h"
+#import "VectorFeatureStore.h"
 #import "VectorManager.h"
 #import "VectorObject.h"
 #import "WhirlyGeometry.h"
@@ -83,6 +83,8 @@ public:
     float miterLimit = 2.0f;
     bool closeAreals = true;
     bool selectable = true;
+    /// Use the color attribute on each shape, when it has one
+    bool colorOverride = true;
 
     WideVectorCoordsType coordType = WideVecCoordScreen;
     WideVectorLineJoinType joinType = WideVecMiterJoin;
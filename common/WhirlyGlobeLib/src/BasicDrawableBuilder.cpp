@@ -98,6 +98,8 @@ void BasicDrawableBuilder::Init()
     basicDraw->valuesChanged = true;
     basicDraw->texturesChanged = true;
     includeExp = false;
+
+    attrArena = std::make_shared<VertexAttributeArena>();
 }
     
 void BasicDrawableBuilder::setupStandardAttributes(int numReserve)
@@ -390,6 +392,13 @@ unsigned int BasicDrawableBuilder::addPoint(const Point3d &pt)
     points.push_back(Point3f(pt.x(),pt.y(),pt.z()));
     return (unsigned int)(points.size()-1);
 }
+
+unsigned int BasicDrawableBuilder::addPoints(const Point3f *pts,size_t num)
+{
+    const auto first = (unsigned int)points.size();
+    points.insert(points.end(),pts,pts+num);
+    return first;
+}
     
 unsigned int BasicDrawableBuilder::getNumPoints() const
 {
@@ -440,6 +449,34 @@ void BasicDrawableBuilder::addNormal(const Point3f &norm)
     basicDraw->vertexAttributes[basicDraw->normalEntry]->addVector3f(norm);
 }
 
+void BasicDrawableBuilder::addTexCoords(int which,const TexCoord *coords,size_t num)
+{
+    if (which == -1)
+    {
+        for (const auto &texInfo : basicDraw->texInfo)
+            basicDraw->vertexAttributes[texInfo.texCoordEntry]->append(coords,num);
+    } else {
+        setupTexCoordEntry(which, 0);
+        basicDraw->vertexAttributes[basicDraw->texInfo[which].texCoordEntry]->append(coords,num);
+    }
+}
+
+void BasicDrawableBuilder::addColors(const RGBAColor *colors,size_t num)
+{
+    if (basicDraw->colorEntry < 0)
+        return;
+
+    basicDraw->vertexAttributes[basicDraw->colorEntry]->append(colors,num);
+}
+
+void BasicDrawableBuilder::addNormals(const Point3f *norms,size_t num)
+{
+    if (basicDraw->normalEntry < 0)
+        return;
+
+    basicDraw->vertexAttributes[basicDraw->normalEntry]->append(norms,num);
+}
+
 void BasicDrawableBuilder::setCalculationData(int numEntries,const std::vector<RawDataRef> &data)
 {
     basicDraw->setCalculationData(numEntries, data);
@@ -573,7 +610,7 @@ void BasicDrawableBuilder::addAttributeValue(int attrId,int val)
 }
 
 void BasicDrawableBuilder::addAttributeValue(int attrId,int64_t val)
-{ basicDraw->vertexAttributes[attrId]->addFloat(val); }
+{ basicDraw->vertexAttributes[attrId]->addInt64(val); }
 
 int BasicDrawableBuilder::findAttribute(int nameID)
 {
@@ -609,12 +646,13 @@ void BasicDrawableBuilder::applySubTexture(int which,const SubTexture &subTex,in
         
         BasicDrawable::TexInfo &thisTexInfo = basicDraw->texInfo[which];
         thisTexInfo.texId = subTex.texId;
-        auto *texCoords = (std::vector<TexCoord> *)basicDraw->vertexAttributes[thisTexInfo.texCoordEntry]->data;
-        
-        for (unsigned int ii=startingAt;ii<texCoords->size();ii++)
+        VertexAttribute *texAttr = basicDraw->vertexAttributes[thisTexInfo.texCoordEntry];
+        if (auto *texCoords = texAttr->getData<TexCoord>())
         {
-            Point2f tc = (*texCoords)[ii];
-            (*texCoords)[ii] = subTex.processTexCoord(TexCoord(tc.x(),tc.y()));
+            for (int ii=startingAt;ii<texAttr->numElements();ii++)
+            {
+                texCoords[ii] = subTex.processTexCoord(texCoords[ii]);
+            }
         }
     }
 }
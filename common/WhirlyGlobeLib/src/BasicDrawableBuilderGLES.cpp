@@ -71,6 +71,7 @@ BasicDrawableBuilderGLES::~BasicDrawableBuilderGLES()
 int BasicDrawableBuilderGLES::addAttribute(BDAttributeDataType dataType,StringIdentity nameID,int slot,int numThings)
 {
     VertexAttribute *attr = new VertexAttributeGLES(dataType,nameID);
+    attr->setArena(attrArena);
     if (numThings > 0)
         attr->reserve(numThings);
     basicDraw->vertexAttributes.push_back(attr);
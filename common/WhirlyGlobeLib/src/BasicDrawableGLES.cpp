@@ -100,10 +100,10 @@ void BasicDrawableGLES::setupForRenderer(const RenderSetupInfo *inSetupInfo,Scen
     
     // Offset the geometry upward by minZres units along the normals
     // Only do this once, obviously
-    if (drawOffset != 0 && (points.size() == vertexAttributes[normalEntry]->numElements()))
+    const Point3f *norms = (normalEntry >= 0) ? vertexAttributes[normalEntry]->getData<Point3f>() : nullptr;
+    if (drawOffset != 0 && norms && (points.size() == vertexAttributes[normalEntry]->numElements()))
     {
         float scale = setupInfo->minZres*drawOffset;
-        Point3fVector &norms = *(Point3fVector *)vertexAttributes[normalEntry]->data;
         
         for (unsigned int ii=0;ii<points.size();ii++)
         {
@@ -0,0 +1,351 @@
+/*  BoundsTree.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "BoundsTree.h"
+#import <algorithm>
+#import <cassert>
+
+namespace WhirlyKit
+{
+
+// Sum of the extents.  Perimeter in 2D, close enough in 3D for picking siblings.
+template <int Dim>
+static inline double boxCost(const double *ll,const double *ur)
+{
+    double cost = 0.0;
+    for (int ii=0;ii<Dim;ii++)
+    {
+        cost += ur[ii] - ll[ii];
+    }
+    return cost;
+}
+
+// Cost of the box that holds both of the inputs
+template <int Dim>
+static inline double unionCost(const double *ll0,const double *ur0,const double *ll1,const double *ur1)
+{
+    double cost = 0.0;
+    for (int ii=0;ii<Dim;ii++)
+    {
+        cost += std::max(ur0[ii],ur1[ii]) - std::min(ll0[ii],ll1[ii]);
+    }
+    return cost;
+}
+
+template <int Dim>
+int BoundsTree<Dim>::allocNode()
+{
+    if (freeList < 0)
+    {
+        nodes.emplace_back();
+        return (int)nodes.size() - 1;
+    }
+
+    const int which = freeList;
+    freeList = nodes[which].parent;
+    nodes[which] = Node();
+    return which;
+}
+
+template <int Dim>
+void BoundsTree<Dim>::freeNode(int which)
+{
+    Node &node = nodes[which];
+    node.parent = freeList;
+    node.child1 = node.child2 = -1;
+    node.height = -1;
+    freeList = which;
+}
+
+template <int Dim>
+int BoundsTree<Dim>::insert(const double *ll,const double *ur,uint64_t data)
+{
+    const int leaf = allocNode();
+    Node &node = nodes[leaf];
+    for (int ii=0;ii<Dim;ii++)
+    {
+        node.ll[ii] = std::min(ll[ii],ur[ii]);
+        node.ur[ii] = std::max(ll[ii],ur[ii]);
+    }
+    node.data = data;
+    node.height = 0;
+
+    insertLeaf(leaf);
+    count++;
+
+    return leaf;
+}
+
+template <int Dim>
+void BoundsTree<Dim>::remove(int handle)
+{
+    if (handle < 0 || handle >= (int)nodes.size() || !nodes[handle].isLeaf() || nodes[handle].height < 0)
+    {
+        return;
+    }
+
+    removeLeaf(handle);
+    freeNode(handle);
+    count--;
+}
+
+template <int Dim>
+void BoundsTree<Dim>::clear()
+{
+    nodes.clear();
+    root = -1;
+    freeList = -1;
+    count = 0;
+}
+
+template <int Dim>
+void BoundsTree<Dim>::refit(int which)
+{
+    Node &node = nodes[which];
+    const Node &child1 = nodes[node.child1];
+    const Node &child2 = nodes[node.child2];
+    for (int ii=0;ii<Dim;ii++)
+    {
+        node.ll[ii] = std::min(child1.ll[ii],child2.ll[ii]);
+        node.ur[ii] = std::max(child1.ur[ii],child2.ur[ii]);
+    }
+    node.height = 1 + std::max(child1.height,child2.height);
+}
+
+template <int Dim>
+void BoundsTree<Dim>::insertLeaf(int leaf)
+{
+    if (root < 0)
+    {
+        root = leaf;
+        nodes[root].parent = -1;
+        return;
+    }
+
+    // Walk down looking for the sibling that costs the least to join
+    const double *leafLL = nodes[leaf].ll;
+    const double *leafUR = nodes[leaf].ur;
+    int which = root;
+    while (!nodes[which].isLeaf())
+    {
+        const Node &node = nodes[which];
+        const double area = boxCost<Dim>(node.ll,node.ur);
+        const double combinedArea = unionCost<Dim>(node.ll,node.ur,leafLL,leafUR);
+
+        // Cost of making a new parent for this node and the leaf
+        const double cost = 2.0 * combinedArea;
+        // Minimum cost of pushing the leaf further down
+        const double inheritCost = 2.0 * (combinedArea - area);
+
+        double childCost[2];
+        const int children[2] = { node.child1, node.child2 };
+        for (int ci=0;ci<2;ci++)
+        {
+            const Node &child = nodes[children[ci]];
+            const double joined = unionCost<Dim>(child.ll,child.ur,leafLL,leafUR);
+            childCost[ci] = (child.isLeaf() ? joined : joined - boxCost<Dim>(child.ll,child.ur)) + inheritCost;
+        }
+
+        if (cost < childCost[0] && cost < childCost[1])
+        {
+            break;
+        }
+
+        which = (childCost[0] < childCost[1]) ? node.child1 : node.child2;
+    }
+    const int sibling = which;
+
+    // New parent for the sibling and the leaf
+    const int oldParent = nodes[sibling].parent;
+    const int newParent = allocNode();
+    nodes[newParent].parent = oldParent;
+    nodes[newParent].child1 = sibling;
+    nodes[newParent].child2 = leaf;
+    nodes[sibling].parent = newParent;
+    nodes[leaf].parent = newParent;
+    refit(newParent);
+
+    if (oldParent >= 0)
+    {
+        if (nodes[oldParent].child1 == sibling)
+            nodes[oldParent].child1 = newParent;
+        else
+            nodes[oldParent].child2 = newParent;
+    }
+    else
+    {
+        root = newParent;
+    }
+
+    // Fix up the boxes and heights on the way back up
+    which = nodes[leaf].parent;
+    while (which >= 0)
+    {
+        which = balance(which);
+        refit(which);
+        which = nodes[which].parent;
+    }
+}
+
+template <int Dim>
+void BoundsTree<Dim>::removeLeaf(int leaf)
+{
+    if (leaf == root)
+    {
+        root = -1;
+        return;
+    }
+
+    const int parent = nodes[leaf].parent;
+    const int grandParent = nodes[parent].parent;
+    const int sibling = (nodes[parent].child1 == leaf) ? nodes[parent].child2 : nodes[parent].child1;
+
+    if (grandParent >= 0)
+    {
+        // The sibling takes the parent's place
+        if (nodes[grandParent].child1 == parent)
+            nodes[grandParent].child1 = sibling;
+        else
+            nodes[grandParent].child2 = sibling;
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int which = grandParent;
+        while (which >= 0)
+        {
+            which = balance(which);
+            refit(which);
+            which = nodes[which].parent;
+        }
+    }
+    else
+    {
+        root = sibling;
+        nodes[sibling].parent = -1;
+        freeNode(parent);
+    }
+}
+
+// Rotate the tree if one side of this node is too tall.  Returns the new subtree root.
+template <int Dim>
+int BoundsTree<Dim>::balance(int iA)
+{
+    Node &A = nodes[iA];
+    if (A.isLeaf() || A.height < 2)
+    {
+        return iA;
+    }
+
+    const int iB = A.child1;
+    const int iC = A.child2;
+    Node &B = nodes[iB];
+    Node &C = nodes[iC];
+
+    const int heightDiff = C.height - B.height;
+
+    // Rotate C up
+    if (heightDiff > 1)
+    {
+        const int iF = C.child1;
+        const int iG = C.child2;
+        Node &F = nodes[iF];
+        Node &G = nodes[iG];
+
+        C.child1 = iA;
+        C.parent = A.parent;
+        A.parent = iC;
+
+        if (C.parent >= 0)
+        {
+            if (nodes[C.parent].child1 == iA)
+                nodes[C.parent].child1 = iC;
+            else
+                nodes[C.parent].child2 = iC;
+        }
+        else
+        {
+            root = iC;
+        }
+
+        if (F.height > G.height)
+        {
+            C.child2 = iF;
+            A.child2 = iG;
+            G.parent = iA;
+        }
+        else
+        {
+            C.child2 = iG;
+            A.child2 = iF;
+            F.parent = iA;
+        }
+        refit(iA);
+        refit(iC);
+
+        return iC;
+    }
+
+    // Rotate B up
+    if (heightDiff < -1)
+    {
+        const int iD = B.child1;
+        const int iE = B.child2;
+        Node &D = nodes[iD];
+        Node &E = nodes[iE];
+
+        B.child1 = iA;
+        B.parent = A.parent;
+        A.parent = iB;
+
+        if (B.parent >= 0)
+        {
+            if (nodes[B.parent].child1 == iA)
+                nodes[B.parent].child1 = iB;
+            else
+                nodes[B.parent].child2 = iB;
+        }
+        else
+        {
+            root = iB;
+        }
+
+        if (D.height > E.height)
+        {
+            B.child2 = iD;
+            A.child1 = iE;
+            E.parent = iA;
+        }
+        else
+        {
+            B.child2 = iE;
+            A.child1 = iD;
+            D.parent = iA;
+        }
+        refit(iA);
+        refit(iB);
+
+        return iB;
+    }
+
+    return iA;
+}
+
+template class BoundsTree<2>;
+template class BoundsTree<3>;
+
+}
@@ -44,6 +44,91 @@ void RenderTeardownInfo::destroyDrawable(SceneRenderer *renderer,const DrawableR
     draw->teardownForRenderer(renderer->getRenderSetupInfo(), renderer->getScene(), renderer->getTeardownInfo());
 }
 
+ChangeRequestQueue::ChangeRequestQueue() :
+    head(nullptr),
+    count(0)
+{
+}
+
+ChangeRequestQueue::~ChangeRequestQueue()
+{
+    ChangeSet changes;
+    drain(changes);
+    discardChanges(changes);
+}
+
+void ChangeRequestQueue::push(ChangeRequest *change)
+{
+    Node *node = new Node();
+    node->change = change;
+    pushNode(node, 1);
+}
+
+void ChangeRequestQueue::push(ChangeSet &changes)
+{
+    if (changes.empty())
+    {
+        return;
+    }
+
+    Node *node = new Node();
+    const int num = (int)changes.size();
+    node->changes.swap(changes);
+    pushNode(node, num);
+}
+
+void ChangeRequestQueue::pushNode(Node *node,int num)
+{
+    count.fetch_add(num, std::memory_order_relaxed);
+
+    node->next = head.load(std::memory_order_relaxed);
+    while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+int ChangeRequestQueue::drain(ChangeSet &changes)
+{
+    // Take the whole list at once, so there's no contention with the producers after this
+    Node *node = head.exchange(nullptr, std::memory_order_acquire);
+    if (!node)
+    {
+        return 0;
+    }
+
+    // It's newest first, so flip it around
+    Node *oldest = nullptr;
+    while (node)
+    {
+        Node *next = node->next;
+        node->next = oldest;
+        oldest = node;
+        node = next;
+    }
+
+    int num = 0;
+    for (node = oldest; node; )
+    {
+        if (node->changes.empty())
+        {
+            changes.push_back(node->change);
+            num++;
+        }
+        else
+        {
+            changes.insert(changes.end(), node->changes.begin(), node->changes.end());
+            num += (int)node->changes.size();
+        }
+
+        Node *next = node->next;
+        delete node;
+        node = next;
+    }
+    count.fetch_sub(num, std::memory_order_relaxed);
+
+    return num;
+}
+
 bool ChangeRequest::needsFlush() { return false; }
 
 void ChangeRequest::setupForRenderer(const RenderSetupInfo *,Scene *scene) { }
@@ -85,12 +85,63 @@ void ComponentManager::setScene(Scene *scene)
     partSysManager    = scene ? scene->getManager<ParticleSystemManager>(kWKParticleSystemManager) : nullptr;
 }
 
+// Bounds of all the vectors in a component object, including the offset for centered ones
+static bool VectorBounds(const ComponentObject &compObj,Point2d &ll,Point2d &ur)
+{
+    bool valid = false;
+    for (const auto &vecObj : compObj.vecObjs)
+    {
+        Point2d thisLL,thisUR;
+        if (vecObj && vecObj->boundingBox(thisLL,thisUR))
+        {
+            ll = valid ? ll.cwiseMin(thisLL) : thisLL;
+            ur = valid ? ur.cwiseMax(thisUR) : thisUR;
+            valid = true;
+        }
+    }
+    if (valid && compObj.vectorOffset != Point2d(0.0,0.0))
+    {
+        // Area tests use the point as is, the linear tests are relative to the offset
+        ll = ll.cwiseMin(ll + compObj.vectorOffset);
+        ur = ur.cwiseMax(ur + compObj.vectorOffset);
+    }
+    return valid;
+}
+
+void ComponentManager::indexVectors_NoLock(const ComponentObjectRef &compObj,const Point2d *ll,const Point2d *ur)
+{
+    unindexVectors_NoLock(compObj);
+    if (ll && ur)
+    {
+        compObj->vecIndexHandle = vecIndex.insert(ll->data(),ur->data(),compObj->getId());
+    }
+}
+
+void ComponentManager::unindexVectors_NoLock(const ComponentObjectRef &compObj)
+{
+    if (compObj->vecIndexHandle >= 0)
+    {
+        vecIndex.remove(compObj->vecIndexHandle);
+        compObj->vecIndexHandle = -1;
+    }
+}
+
 void ComponentManager::addComponentObject(const ComponentObjectRef &compObj, ChangeSet &changes)
 {
+    // Work out the bounds before we take the lock
+    Point2d vecLL,vecUR;
+    const bool hasBounds = VectorBounds(*compObj,vecLL,vecUR);
+
     std::lock_guard<std::mutex> guardLock(lock);
 
     compObj->underConstruction = false;
-    compObjsById[compObj->getId()] = compObj;
+    const auto result = compObjsById.insert(std::make_pair(compObj->getId(),compObj));
+    if (!result.second && result.first->second != compObj)
+    {
+        unindexVectors_NoLock(result.first->second);
+        result.first->second = compObj;
+    }
+    indexVectors_NoLock(compObj,hasBounds ? &vecLL : nullptr,hasBounds ? &vecUR : nullptr);
 
     // Does the new object have a UUID?
     if (!compObj->uuid.empty())
@@ -194,6 +245,8 @@ void ComponentManager::removeComponentObjects_NoLock(PlatformThreadInfo *,
             }
         }
 
+        unindexVectors_NoLock(compObj);
+
         objs.push_back(compObj);
 
         compObjsById.erase(it);
@@ -645,17 +698,114 @@ void ComponentManager::releaseMaskIDs(const SimpleIDSet &maskIDs)
     }
 }
     
+// Work out a geographic box around the point covering everything within the given screen distance.
+// Returns false if we can't, such as when the search area runs off the edge of the globe.
+static bool GeoSearchBox(const Point2d &pt,double maxDist,const ViewStateRef &viewState,
+                         const Point2f &frameSize,Point2d &ll,Point2d &ur)
+{
+    ll = pt;
+    ur = pt;
+    if (maxDist <= 0.0)
+    {
+        return true;
+    }
+
+    const auto globeView = dynamic_cast<WhirlyGlobe::GlobeViewState*>(viewState.get());
+    const auto mapView = dynamic_cast<Maply::MapViewState*>(viewState.get());
+    CoordSystemDisplayAdapter *coordAdapter = viewState->coordAdapter;
+    if ((!globeView && !mapView) || !coordAdapter || viewState->fullMatrices.empty())
+    {
+        return false;
+    }
+    const CoordSystem *coordSys = coordAdapter->getCoordSystem();
+    const Eigen::Matrix4d &modelTrans = viewState->fullMatrices[0];
+
+    const Point3d dispPt = coordAdapter->localToDisplay(coordSys->geographicToLocal(pt));
+    const Point2f screenPt = viewState->pointOnScreenFromDisplay(dispPt,&modelTrans,frameSize);
+
+    // Walk around the edge of the search square, taking the points back to geographic
+    static constexpr int EdgeSamples = 4;
+    const double dist = maxDist * 1.1;
+    for (int side=0;side<4;side++)
+    {
+        for (int ii=0;ii<EdgeSamples;ii++)
+        {
+            const double t = -1.0 + 2.0 * ii / EdgeSamples;
+            const Point2d offs = (side == 0) ? Point2d(t,-1.0) : (side == 1) ? Point2d(1.0,t) :
+                                 (side == 2) ? Point2d(-t,1.0) : Point2d(-1.0,-t);
+            const Point2f samplePt = screenPt + (offs * dist).cast<float>();
+
+            Point3d hit;
+            const bool valid = globeView ?
+                    globeView->pointOnSphereFromScreen(samplePt,modelTrans,frameSize,hit,false) :
+                    mapView->pointOnPlaneFromScreen(samplePt,modelTrans,frameSize,hit,false);
+            if (!valid)
+            {
+                return false;
+            }
+            const Point2d geoPt = coordSys->localToGeographicD(coordAdapter->displayToLocal(hit));
+            ll = ll.cwiseMin(geoPt);
+            ur = ur.cwiseMax(geoPt);
+        }
+    }
+
+    // Crossing the anti-meridian makes a mess of the box, so don't try
+    if (ur.x() - ll.x() > M_PI)
+    {
+        return false;
+    }
+
+    // The edges curve between samples, so leave some room
+    const Point2d pad = (ur - ll) * 0.1;
+    ll -= pad;
+    ur += pad;
+
+    return true;
+}
+
 std::vector<std::pair<ComponentObjectRef,VectorObjectRef>> ComponentManager::findVectors(
         const Point2d &pt,double maxDist,const ViewStateRef &viewState,
         const Point2f &frameSize,int resultLimit)
 {
-    // not locked, we don't care if the size is off, we just want
-    // to typically do the allocations outside the locked region.
+    // Figure out where we're looking, if we can
+    Point2d searchLL,searchUR;
+    const bool useIndex = GeoSearchBox(pt,maxDist,viewState,frameSize,searchLL,searchUR);
+
     std::vector<ComponentObjectRef> compRefs;
-    compRefs.reserve(compObjsById.size());
 
     // Copy out the vectors that might be candidates
+    if (useIndex)
     {
+        std::vector<SimpleIdentity> compIDs;
+
+        std::lock_guard<std::mutex> guardLock(lock);
+        vecIndex.queryBox(searchLL.data(),searchUR.data(),[&](uint64_t compID)
+        {
+            compIDs.push_back(compID);
+        });
+
+        // Keep them in ID order, as they would be from the map
+        std::sort(compIDs.begin(),compIDs.end());
+        compRefs.reserve(compIDs.size());
+        for (const auto compID : compIDs)
+        {
+            const auto it = compObjsById.find(compID);
+            if (it != compObjsById.end())
+            {
+                const auto &compObj = it->second;
+                if (compObj->enable && compObj->isSelectable && !compObj->vecObjs.empty())
+                {
+                    compRefs.push_back(compObj);
+                }
+            }
+        }
+    }
+    else
+    {
+        // not locked, we don't care if the size is off, we just want
+        // to typically do the allocations outside the locked region.
+        compRefs.reserve(compObjsById.size());
+
         std::lock_guard<std::mutex> guardLock(lock);
         for (const auto &kvp: compObjsById)
         {
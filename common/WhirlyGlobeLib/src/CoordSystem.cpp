@@ -44,6 +44,67 @@ Point3d CoordSystemConvert3d(const CoordSystem *inSystem,const CoordSystem *outS
     return outSystem->geocentricToLocal(inSystem->localToGeocentric(inCoord));
 }
 
+void CoordSystemConvert3d(const CoordSystem *inSystem,const CoordSystem *outSystem,const Point3d *inCoords,Point3d *outCoords,size_t count)
+{
+    if (inSystem->isSameAs(outSystem))
+    {
+        if (inCoords != outCoords)
+            std::copy(inCoords,inCoords+count,outCoords);
+        return;
+    }
+
+    inSystem->localToGeocentricBatch(inCoords,outCoords,count);
+    outSystem->geocentricToLocalBatch(outCoords,outCoords,count);
+}
+
+void CoordSystem::localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = localToGeographicD(in[ii]);
+}
+
+void CoordSystem::geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = geographicToLocal(in[ii]);
+}
+
+void CoordSystem::localToGeocentricBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = localToGeocentric(in[ii]);
+}
+
+void CoordSystem::geocentricToLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = geocentricToLocal(in[ii]);
+}
+
+void CoordSystemDisplayAdapter::localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = localToDisplay(in[ii]);
+}
+
+void CoordSystemDisplayAdapter::displayToLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = displayToLocal(in[ii]);
+}
+
+void CoordSystemDisplayAdapter::normalForLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = normalForLocal(in[ii]);
+}
+
+void CoordSystemDisplayAdapter::geographicToDisplayBatch(const Point2d *in,Point3d *out,size_t count) const
+{
+    coordSys->geographicToLocalBatch(in,out,count);
+    localToDisplayBatch(out,out,count);
+}
+
 GeneralCoordSystemDisplayAdapter::GeneralCoordSystemDisplayAdapter(CoordSystem *coordSys,const Point3d &ll,const Point3d &ur,
                                                                    const Point3d &inCenter,const Point3d &inScale) :
     CoordSystemDisplayAdapter(coordSys,inCenter),
@@ -103,4 +164,27 @@ Point3d GeneralCoordSystemDisplayAdapter::displayToLocal(Point3d dispPt) const
             center;
 }
 
+void GeneralCoordSystemDisplayAdapter::localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    if (count == 0)
+        return;
+    const Map<const Array3Xd> src(in->data(),3,(Index)count);
+    Map<Array3Xd> dst(out->data(),3,(Index)count);
+    dst = (src.colwise() * scale.array()).colwise() - center.array();
+}
+
+void GeneralCoordSystemDisplayAdapter::displayToLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    if (count == 0)
+        return;
+    const Map<const Array3Xd> src(in->data(),3,(Index)count);
+    Map<Array3Xd> dst(out->data(),3,(Index)count);
+    dst = (src.colwise() / scale.array()).colwise() + center.array();
+}
+
+void GeneralCoordSystemDisplayAdapter::normalForLocalBatch(const Point3d *,Point3d *out,size_t count) const
+{
+    std::fill(out,out+count,Point3d(0,0,1));
+}
+
 }
@@ -593,6 +593,29 @@ std::vector<std::string> MutableDictionaryC::getKeys() const
     return keys;
 }
 
+bool MutableDictionaryC::findValue(const std::string &name,ValueRef &val) const
+{
+    const auto keyIt = stringMap.find(name);
+    if (keyIt == stringMap.end())
+        return false;
+    const auto it = valueMap.find(keyIt->second);
+    if (it == valueMap.end())
+        return false;
+
+    const auto &value = it->second;
+    val.type = value.type;
+    switch (value.type)
+    {
+        case DictTypeInt:      val.num = intVals[value.entry];  break;
+        case DictTypeInt64:
+        case DictTypeIdentity: val.num = (double)int64Vals[value.entry];  break;
+        case DictTypeDouble:   val.num = dVals[value.entry];  break;
+        case DictTypeString:   val.str = &stringVals[value.entry];  break;
+        default: break;
+    }
+    return true;
+}
+
 int MutableDictionaryC::getKeyID(const std::string &name)
 {
     const auto &it = stringMap.find(name);
@@ -765,6 +788,39 @@ void MutableDictionaryC::addEntries(const Dictionary *inOther)
     if (const auto other = dynamic_cast<const MutableDictionaryC *>(inOther))
     {
         addEntries(other);
+        return;
+    }
+    if (!inOther)
+    {
+        return;
+    }
+
+    // Some other implementation (a lazy vector tile feature, say), so go through the generic interface
+    for (const auto &name : inOther->getKeys())
+    {
+        switch (inOther->getType(name))
+        {
+            case DictTypeString:    setString(name,inOther->getString(name));  break;
+            case DictTypeInt:       setInt(name,inOther->getInt(name,0));  break;
+            case DictTypeInt64:     setInt64(name,inOther->getInt64(name,0));  break;
+            case DictTypeIdentity:  setIdentifiable(name,inOther->getIdentity(name));  break;
+            case DictTypeDouble:    setDouble(name,inOther->getDouble(name,0.0));  break;
+            case DictTypeArray:     setArray(name,inOther->getArray(name));  break;
+            case DictTypeDictionary:
+                if (const auto dict = inOther->getDict(name))
+                {
+                    auto dictC = std::dynamic_pointer_cast<MutableDictionaryC>(dict);
+                    if (!dictC)
+                    {
+                        dictC = std::make_shared<MutableDictionaryC>();
+                        dictC->addEntries(dict.get());
+                    }
+                    setDict(name,dictC);
+                }
+                break;
+            default:
+                break;
+        }
     }
 }
 
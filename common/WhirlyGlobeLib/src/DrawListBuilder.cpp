@@ -0,0 +1,252 @@
+/*  DrawListBuilder.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "DrawListBuilder.h"
+#import <algorithm>
+#import <unordered_set>
+
+using namespace Eigen;
+
+namespace WhirlyKit
+{
+
+// Below this it's not worth waking up the pool
+static constexpr size_t MinParallelDrawables = 256;
+static constexpr size_t ParallelBatchSize = 64;
+
+void DrawListBuilder::setSortZBuffer(bool newVal)
+{
+    if (sortZBuffer != newVal)
+    {
+        sortZBuffer = newVal;
+        valid = false;
+    }
+}
+
+void DrawListBuilder::clear()
+{
+    valid = false;
+    reused = false;
+    lastDrawables.clear();
+    lastOffsetMats.clear();
+    visible.clear();
+    lastVisible.clear();
+    drawStates.clear();
+    lastDrawStates.clear();
+    offFrameInfos.clear();
+    gathered.clear();
+    sortKeys.clear();
+    drawList.clear();
+}
+
+void DrawListBuilder::cull(RendererFrameInfo *frameInfo,const std::vector<Drawable *> &drawables)
+{
+    const Matrix4d &projMat4d = frameInfo->projMat4d;
+    const Matrix4d &viewTrans4d = frameInfo->viewTrans4d;
+    const Matrix4d &modelTrans4d = frameInfo->modelTrans4d;
+    const std::vector<Matrix4d> &offsetMats = frameInfo->offsetMatrices;
+    const size_t numOffsets = offsetMats.size();
+
+    // Frame info for each offset, in case the drawables care when deciding if they're on
+    offFrameInfos.resize(numOffsets);
+    for (size_t off=0;off<numOffsets;off++)
+    {
+        RendererFrameInfo &offFrameInfo = offFrameInfos[off];
+        offFrameInfo = *frameInfo;
+        const Matrix4d mvMat4d = viewTrans4d * offsetMats[off] * modelTrans4d;
+        const Matrix4d pvMat4d = projMat4d * viewTrans4d * offsetMats[off];
+        const Matrix4d mvpMat4d = projMat4d * mvMat4d;
+        offFrameInfo.viewAndModelMat4d = mvMat4d;
+        offFrameInfo.viewAndModelMat = Matrix4dToMatrix4f(mvMat4d);
+        offFrameInfo.viewModelNormalMat = Matrix4dToMatrix4f(mvMat4d.inverse().transpose());
+        offFrameInfo.mvpMat4d = mvpMat4d;
+        offFrameInfo.mvpMat = Matrix4dToMatrix4f(mvpMat4d);
+        offFrameInfo.mvpInvMat = Matrix4dToMatrix4f(mvpMat4d.inverse());
+        offFrameInfo.mvpNormalMat = Matrix4dToMatrix4f(mvpMat4d.inverse().transpose());
+        offFrameInfo.pvMat4d = pvMat4d;
+        offFrameInfo.pvMat = Matrix4dToMatrix4f(pvMat4d);
+    }
+
+    visible.resize(drawables.size() * numOffsets);
+    drawStates.resize(drawables.size());
+    const auto cullOne = [&](size_t which)
+    {
+        Drawable *draw = drawables[which];
+        for (size_t off=0;off<numOffsets;off++)
+        {
+            visible[which * numOffsets + off] = draw && draw->isOn(&offFrameInfos[off]);
+        }
+
+        // Anything that changes the entries has to stop us reusing the list
+        DrawState &state = drawStates[which];
+        const Matrix4d *localMat = draw ? draw->getMatrix() : nullptr;
+        state.hasLocalMat = localMat != nullptr;
+        if (localMat)
+        {
+            state.localMat = *localMat;
+        }
+        state.priority = draw ? draw->getDrawPriority() : 0;
+        state.zBuffer = draw && draw->getRequestZBuffer();
+    };
+
+    if (taskPool && taskPool->getNumThreads() > 0 && drawables.size() >= MinParallelDrawables)
+    {
+        taskPool->parallelFor(drawables.size(),cullOne,ParallelBatchSize);
+    }
+    else
+    {
+        for (size_t ii=0;ii<drawables.size();ii++)
+        {
+            cullOne(ii);
+        }
+    }
+}
+
+bool DrawListBuilder::DrawState::operator == (const DrawState &that) const
+{
+    return hasLocalMat == that.hasLocalMat && priority == that.priority && zBuffer == that.zBuffer &&
+           (!hasLocalMat || localMat == that.localMat);
+}
+
+bool DrawListBuilder::sameView(const RendererFrameInfo *frameInfo) const
+{
+    return lastModelMat == frameInfo->modelTrans4d &&
+           lastViewMat == frameInfo->viewTrans4d &&
+           lastProjMat == frameInfo->projMat4d &&
+           lastOffsetMats == frameInfo->offsetMatrices;
+}
+
+void DrawListBuilder::buildMatrices()
+{
+    drawList.resize(sortKeys.size());
+
+    const auto buildOne = [&](size_t which)
+    {
+        const SortKey &key = sortKeys[which];
+        const RendererFrameInfo &offFrameInfo = offFrameInfos[key.offset];
+        DrawListEntry &entry = drawList[which];
+        entry.drawable = key.drawable;
+        entry.offset = key.offset;
+        if (const Matrix4d *localMat = key.drawable->getMatrix())
+        {
+            entry.mvpMat = offFrameInfo.mvpMat4d * (*localMat);
+            entry.mvMat = offFrameInfo.viewAndModelMat4d * (*localMat);
+            entry.mvNormalMat = entry.mvMat.inverse().transpose();
+        }
+        else
+        {
+            entry.mvpMat = offFrameInfo.mvpMat4d;
+            entry.mvMat = offFrameInfo.viewAndModelMat4d;
+            entry.mvNormalMat = offFrameInfo.viewAndModelMat4d.inverse().transpose();
+        }
+        entry.mvpInvMat = entry.mvpMat.inverse();
+    };
+
+    if (taskPool && taskPool->getNumThreads() > 0 && sortKeys.size() >= MinParallelDrawables)
+    {
+        taskPool->parallelFor(sortKeys.size(),buildOne,ParallelBatchSize);
+    }
+    else
+    {
+        for (size_t ii=0;ii<sortKeys.size();ii++)
+        {
+            buildOne(ii);
+        }
+    }
+}
+
+const DrawList &DrawListBuilder::build(RendererFrameInfo *frameInfo,const std::vector<Drawable *> &drawables)
+{
+    cull(frameInfo,drawables);
+
+    // Same drawables in the same state, same visibility and the same view give the same list
+    reused = valid && visible == lastVisible && drawables == lastDrawables &&
+             drawStates == lastDrawStates && sameView(frameInfo);
+    if (reused)
+    {
+        return drawList;
+    }
+
+    const size_t numOffsets = frameInfo->offsetMatrices.size();
+    sortKeys.clear();
+    for (size_t off=0;off<numOffsets;off++)
+    {
+        for (size_t ii=0;ii<drawables.size();ii++)
+        {
+            if (visible[ii * numOffsets + off])
+            {
+                Drawable *draw = drawables[ii];
+                const DrawState &state = drawStates[ii];
+                sortKeys.push_back(SortKey { state.priority, sortZBuffer && state.zBuffer,
+                                             draw->getId(), (int)off, draw });
+            }
+        }
+    }
+
+    // Priority first, then the ones that want the z buffer go after the ones that don't.
+    // ID and offset keep the order stable from frame to frame.
+    std::sort(sortKeys.begin(),sortKeys.end(),[](const SortKey &a,const SortKey &b)
+    {
+        if (a.priority != b.priority)
+            return a.priority < b.priority;
+        if (a.zBuffer != b.zBuffer)
+            return !a.zBuffer;
+        if (a.drawID != b.drawID)
+            return a.drawID < b.drawID;
+        return a.offset < b.offset;
+    });
+
+    buildMatrices();
+
+    valid = true;
+    lastVisible.swap(visible);
+    lastDrawStates.swap(drawStates);
+    lastDrawables = drawables;
+    lastModelMat = frameInfo->modelTrans4d;
+    lastViewMat = frameInfo->viewTrans4d;
+    lastProjMat = frameInfo->projMat4d;
+    lastOffsetMats = frameInfo->offsetMatrices;
+
+    return drawList;
+}
+
+const DrawList &DrawListBuilder::build(RendererFrameInfo *frameInfo,const std::vector<WorkGroupRef> &workGroups)
+{
+    // A drawable can be in more than one group (e.g. calculation and a render target)
+    gathered.clear();
+    std::unordered_set<Drawable *> seen;
+    for (const auto &workGroup : workGroups)
+    {
+        if (!workGroup)
+            continue;
+        for (const auto &targetCon : workGroup->renderTargetContainers)
+        {
+            for (const auto &draw : targetCon->drawables)
+            {
+                if (seen.insert(draw.get()).second)
+                {
+                    gathered.push_back(draw.get());
+                }
+            }
+        }
+    }
+
+    return build(frameInfo,gathered);
+}
+
+}
@@ -27,7 +27,7 @@ namespace WhirlyKit
 {
 
 DynamicTexture::DynamicTexture(const std::string &name)
-: TextureBase(name), layoutGrid(NULL)
+: TextureBase(name)
 {
 }
 
@@ -38,18 +38,14 @@ void DynamicTexture::setup(int inTexSize,int inCellSize,TextureType inType,bool
     type = inType;
     clearTextures = inClearTextures;
     numCell = texSize/cellSize;
-    layoutGrid = new bool[numCell * numCell];
-    for (unsigned int ii=0;ii<numCell * numCell;ii++)
-        layoutGrid[ii] = false;
+    wordsPerRow = (numCell + 63) / 64;
+    usedBits.assign(wordsPerRow * numCell, 0);
+    rowFreeRun.assign(numCell, numCell);
+    numUsedCells = 0;
 }
 
 DynamicTexture::~DynamicTexture()
 {
-    if (!layoutGrid)
-        return;
-    
-    delete [] layoutGrid;
-    layoutGrid = NULL;
 }
     
 void DynamicTexture::addTexture(Texture *tex,const Region &region)
@@ -67,14 +63,130 @@ void DynamicTexture::setRegion(const Region &region, bool enable)
 {
     const int sx = std::max(region.sx,0), sy = std::max(region.sy,0);
     const int ex = std::min(region.ex,numCell-1), ey = std::min(region.ey,numCell-1);
-    
-    for (unsigned int ix=sx;ix<=ex;ix++)
-        for (unsigned int iy=sy;iy<=ey;iy++)
+    if (sx > ex || sy > ey)
+        return;
+
+    for (int iy=sy;iy<=ey;iy++)
+    {
+        uint64_t *row = &usedBits[iy*wordsPerRow];
+        for (int word=sx/64;word<=ex/64;word++)
         {
-            layoutGrid[iy*numCell+ix] = enable;
+            // Bits from sx to ex that fall in this word
+            const int lo = std::max(sx - word*64, 0);
+            const int hi = std::min(ex - word*64, 63);
+            const uint64_t mask = (hi == 63 ? ~(uint64_t)0 : (((uint64_t)1 << (hi+1)) - 1)) & ~(((uint64_t)1 << lo) - 1);
+            const uint64_t changed = enable ? (mask & ~row[word]) : (mask & row[word]);
+            numUsedCells += (enable ? 1 : -1) * __builtin_popcountll(changed);
+            row[word] ^= changed;
         }
+        updateRow(iy);
+    }
 }
-    
+
+int DynamicTexture::findFreeRun(const uint64_t *freeMask,int sizeX) const
+{
+    int runStart = 0,runLen = 0;
+    for (int word=0;word<wordsPerRow;word++)
+    {
+        uint64_t bits = freeMask[word];
+        if (bits == ~(uint64_t)0)
+        {
+            if (runLen == 0)
+                runStart = word*64;
+            runLen += 64;
+        } else {
+            // Walk the runs of free bits in this word
+            int bit = 0;
+            while (bit < 64)
+            {
+                const uint64_t rest = bits >> bit;
+                if (rest & 1)
+                {
+                    const int len = (~rest == 0) ? 64-bit : __builtin_ctzll(~rest);
+                    if (runLen == 0)
+                        runStart = word*64+bit;
+                    runLen += len;
+                    bit += len;
+                    if (bit < 64)
+                    {
+                        if (runLen >= sizeX)
+                            return runStart;
+                        runLen = 0;
+                    }
+                } else {
+                    if (runLen >= sizeX)
+                        return runStart;
+                    runLen = 0;
+                    if (rest == 0)
+                        break;
+                    bit += __builtin_ctzll(rest);
+                }
+            }
+        }
+        if (runLen >= sizeX)
+            return runStart;
+    }
+
+    return -1;
+}
+
+int DynamicTexture::longestFreeRun(const uint64_t *freeMask) const
+{
+    int best = 0,runLen = 0;
+    for (int word=0;word<wordsPerRow;word++)
+    {
+        const uint64_t bits = freeMask[word];
+        if (bits == ~(uint64_t)0)
+        {
+            runLen += 64;
+            continue;
+        }
+        int bit = 0;
+        while (bit < 64)
+        {
+            const uint64_t rest = bits >> bit;
+            if (rest & 1)
+            {
+                const int len = (~rest == 0) ? 64-bit : __builtin_ctzll(~rest);
+                runLen += len;
+                bit += len;
+                if (bit < 64)
+                {
+                    best = std::max(best,runLen);
+                    runLen = 0;
+                }
+            } else {
+                best = std::max(best,runLen);
+                runLen = 0;
+                if (rest == 0)
+                    break;
+                bit += __builtin_ctzll(rest);
+            }
+        }
+    }
+
+    return std::max(best,runLen);
+}
+
+// Free cells in a row, with anything past the end of the grid marked as used
+static inline uint64_t FreeBits(uint64_t used,int word,int numCell)
+{
+    uint64_t free = ~used;
+    const int valid = numCell - word*64;
+    if (valid < 64)
+        free &= ((uint64_t)1 << valid) - 1;
+    return free;
+}
+
+void DynamicTexture::updateRow(int row)
+{
+    std::vector<uint64_t> freeMask(wordsPerRow);
+    const uint64_t *used = &usedBits[row*wordsPerRow];
+    for (int word=0;word<wordsPerRow;word++)
+        freeMask[word] = FreeBits(used[word],word,numCell);
+    rowFreeRun[row] = longestFreeRun(freeMask.data());
+}
+
 void DynamicTexture::clearRegion(const Region &clearRegion,ChangeSet &changes,bool mainThreadMerge,unsigned char *emptyData)
 {
     int startX = clearRegion.sx * cellSize;
@@ -111,27 +223,43 @@ bool DynamicTexture::findRegion(int sizeX,int sizeY,Region &region)
         setRegion(ii, false);
     }
     
-    // Now look for a region that'll fit
-    // Look for a spot big enough
+    // Now look for the lowest, then leftmost spot big enough.
+    // Each row is a bit mask, so we AND the rows together and look for a run of free bits.
     bool found = false;
     int foundX=0,foundY=0;
-    for (int iy=0;iy<=numCell-sizeY && !found;iy++)
-        for (int ix=0;ix<=numCell-sizeX && !found;ix++)
-        {
-            bool clear = true;
-            for (int testY=0;testY<sizeY && clear;testY++)
-                for (int testX=0;testX<sizeX && clear;testX++)
-                {
-                    if (layoutGrid[(testY+iy)*numCell+(testX+ix)])
-                        clear = false;
-                }
-            if (clear)
+    std::vector<uint64_t> freeMask(wordsPerRow);
+    for (int iy=0;iy<=numCell-sizeY && !found;)
+    {
+        // Any row that can't fit the width rules out every window that includes it
+        int blocked = -1;
+        for (int testY=sizeY-1;testY>=0;testY--)
+            if (rowFreeRun[iy+testY] < sizeX)
             {
-                foundX = ix;
-                foundY = iy;
-                found = true;
+                blocked = iy+testY;
+                break;
             }
+        if (blocked >= 0)
+        {
+            iy = blocked+1;
+            continue;
+        }
+
+        for (int word=0;word<wordsPerRow;word++)
+        {
+            uint64_t used = 0;
+            for (int testY=0;testY<sizeY;testY++)
+                used |= usedBits[(iy+testY)*wordsPerRow+word];
+            freeMask[word] = FreeBits(used,word,numCell);
+        }
+        const int ix = findFreeRun(freeMask.data(),sizeX);
+        if (ix >= 0)
+        {
+            foundX = ix;
+            foundY = iy;
+            found = true;
         }
+        iy++;
+    }
     
     if (!found)
         return false;
@@ -157,11 +285,36 @@ bool DynamicTexture::empty()
 void DynamicTexture::getUtilization(int &outNumCell,int &usedCell)
 {
     outNumCell = numCell*numCell;
-    usedCell = 0;
-    for (unsigned int ii=0;ii<numCell*numCell;ii++)
+    usedCell = numUsedCells;
+}
+
+void DynamicTexture::getUtilization(int &outNumCell,int &usedCell,int &largestFree)
+{
+    getUtilization(outNumCell,usedCell);
+
+    // Largest all free rectangle, using the histogram of free cells above each column
+    largestFree = 0;
+    std::vector<int> heights(numCell+1,0);
+    std::vector<int> stack;
+    stack.reserve(numCell+1);
+    for (int iy=0;iy<numCell;iy++)
     {
-        if (layoutGrid[ii])
-            usedCell++;
+        const uint64_t *row = &usedBits[iy*wordsPerRow];
+        for (int ix=0;ix<numCell;ix++)
+            heights[ix] = (row[ix/64] >> (ix%64)) & 1 ? 0 : heights[ix]+1;
+
+        stack.clear();
+        for (int ix=0;ix<=numCell;ix++)
+        {
+            while (!stack.empty() && heights[stack.back()] >= heights[ix])
+            {
+                const int height = heights[stack.back()];
+                stack.pop_back();
+                const int width = stack.empty() ? ix : ix - stack.back() - 1;
+                largestFree = std::max(largestFree,height*width);
+            }
+            stack.push_back(ix);
+        }
     }
 }
     
@@ -525,13 +678,14 @@ void DynamicTextureAtlas::getUsage(int &numRegions,int &dynamicTextures) const
 
 void DynamicTextureAtlas::log() const
 {
-    int numCells=0,usedCells=0;
+    int numCells=0,usedCells=0,largestFree=0;
     for (const auto *texVec : textures)
     {
-        int thisNumCells,thisUsedCells;
-        texVec->at(0)->getUtilization(thisNumCells,thisUsedCells);
+        int thisNumCells,thisUsedCells,thisLargestFree;
+        texVec->at(0)->getUtilization(thisNumCells,thisUsedCells,thisLargestFree);
         numCells += thisNumCells;
         usedCells += thisUsedCells;
+        largestFree = std::max(largestFree,thisLargestFree);
     }
 
     int texelSize = 4;
@@ -566,7 +720,12 @@ void DynamicTextureAtlas::log() const
     
     wkLogLevel(Warn,"DynamicTextureAtlas: %ld textures, (%.2f MB)",textures.size(),textures.size() * texSize*texSize*texelSize/(float)(1024*1024));
     if (numCells > 0)
+    {
         wkLogLevel(Warn,"DynamicTextureAtlas: using %.2f%% of the cells",100 * usedCells / (float)numCells);
+        // How much of the free space is in one piece.  Low numbers mean we're fragmented.
+        if (usedCells < numCells)
+            wkLogLevel(Warn,"DynamicTextureAtlas: largest free area is %.2f%% of the free cells",100 * largestFree / (float)(numCells - usedCells));
+    }
 }
 
 }
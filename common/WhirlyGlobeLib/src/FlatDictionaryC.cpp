@@ -0,0 +1,561 @@
+/*  FlatDictionaryC.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "FlatDictionaryC.h"
+#import "DictionaryC.h"
+#import "WhirlyKitLog.h"
+#import <algorithm>
+#import <cstring>
+
+namespace WhirlyKit
+{
+
+DictionaryKeyTable::DictionaryKeyTable(const std::vector<std::string> &inKeys)
+{
+    keys.reserve(inKeys.size());
+    index.reserve(inKeys.size());
+    for (const auto &key : inKeys)
+    {
+        if (index.insert(std::make_pair(key,(int)keys.size())).second)
+        {
+            keys.push_back(key);
+        }
+    }
+}
+
+int DictionaryKeyTable::find(const std::string &name) const
+{
+    const auto it = index.find(name);
+    return (it != index.end()) ? it->second : -1;
+}
+
+FlatDictionaryC::FlatDictionaryC(DictionaryKeyTableRef keys) :
+    keys(std::move(keys)),
+    data(inlineData),
+    capacity(InlineBytes),
+    numFields(0),
+    strStart(InlineBytes)
+{
+}
+
+FlatDictionaryC::FlatDictionaryC(const FlatDictionaryC &that) :
+    FlatDictionaryC(that.keys)
+{
+    *this = that;
+}
+
+FlatDictionaryC::FlatDictionaryC(FlatDictionaryC &&that) noexcept :
+    FlatDictionaryC(that.keys)
+{
+    *this = std::move(that);
+}
+
+FlatDictionaryC &FlatDictionaryC::operator = (const FlatDictionaryC &that)
+{
+    if (this == &that)
+    {
+        return *this;
+    }
+
+    // Offsets are from the start of the block, so a straight copy works
+    keys = that.keys;
+    if (that.capacity <= InlineBytes)
+    {
+        heap.reset();
+        data = inlineData;
+    }
+    else if (!heap || capacity != that.capacity)
+    {
+        heap.reset(new char[that.capacity]);
+        data = heap.get();
+    }
+    capacity = that.capacity;
+    numFields = that.numFields;
+    strStart = that.strStart;
+    memcpy(data, that.data, numFields * sizeof(Field));
+    memcpy(data + strStart, that.data + strStart, capacity - strStart);
+
+    return *this;
+}
+
+FlatDictionaryC &FlatDictionaryC::operator = (FlatDictionaryC &&that) noexcept
+{
+    if (this == &that)
+    {
+        return *this;
+    }
+
+    if (that.heap)
+    {
+        heap = std::move(that.heap);
+        data = heap.get();
+        keys = std::move(that.keys);
+        capacity = that.capacity;
+        numFields = that.numFields;
+        strStart = that.strStart;
+    }
+    else
+    {
+        *this = (const FlatDictionaryC &)that;
+    }
+
+    that.data = that.inlineData;
+    that.capacity = InlineBytes;
+    that.numFields = 0;
+    that.strStart = InlineBytes;
+
+    return *this;
+}
+
+const FlatDictionaryC::Field *FlatDictionaryC::findField(const std::string &name) const
+{
+    return findField(keys ? keys->find(name) : -1, &name);
+}
+
+const FlatDictionaryC::Field *FlatDictionaryC::findField(int keyIndex,const std::string *name) const
+{
+    const Field *theFields = fields();
+    if (keyIndex >= 0)
+    {
+        for (uint32_t ii=0;ii<numFields;ii++)
+        {
+            if (theFields[ii].key == (uint32_t)keyIndex)
+                return &theFields[ii];
+        }
+    }
+    else if (name)
+    {
+        for (uint32_t ii=0;ii<numFields;ii++)
+        {
+            const Field &field = theFields[ii];
+            if ((field.key & KeyInBlock) && field.keyLen == name->size() &&
+                memcmp(data + (field.key & ~KeyInBlock), name->data(), field.keyLen) == 0)
+                return &field;
+        }
+    }
+    return nullptr;
+}
+
+void FlatDictionaryC::reserve(uint32_t newFields,uint32_t strBytes)
+{
+    const uint32_t fieldBytes = (numFields + newFields) * sizeof(Field);
+    if (fieldBytes + strBytes <= strStart)
+    {
+        return;
+    }
+
+    // Strings that are still in use.  Everything else gets dropped as we copy.
+    uint32_t liveBytes = 0;
+    const Field *theFields = fields();
+    for (uint32_t ii=0;ii<numFields;ii++)
+    {
+        liveBytes += theFields[ii].keyLen;
+        if (theFields[ii].type == DictTypeString)
+            liveBytes += theFields[ii].val.str.len;
+    }
+
+    const uint32_t needed = fieldBytes + liveBytes + strBytes;
+    uint32_t newCapacity = (needed <= capacity) ? capacity : std::max(capacity * 2, needed);
+    newCapacity = (newCapacity + 7) & ~7;
+
+    std::unique_ptr<char[]> newHeap(new char[newCapacity]);
+    char *newData = newHeap.get();
+    memcpy(newData, data, numFields * sizeof(Field));
+
+    // Pack the strings in from the end
+    uint32_t newStrStart = newCapacity;
+    Field *newFieldPtr = reinterpret_cast<Field *>(newData);
+    for (uint32_t ii=0;ii<numFields;ii++)
+    {
+        Field &field = newFieldPtr[ii];
+        if (field.key & KeyInBlock)
+        {
+            newStrStart -= field.keyLen;
+            memcpy(newData + newStrStart, data + (field.key & ~KeyInBlock), field.keyLen);
+            field.key = KeyInBlock | newStrStart;
+        }
+        if (field.type == DictTypeString)
+        {
+            newStrStart -= field.val.str.len;
+            memcpy(newData + newStrStart, data + field.val.str.offset, field.val.str.len);
+            field.val.str.offset = newStrStart;
+        }
+    }
+
+    if (newCapacity <= InlineBytes)
+    {
+        // Compacting was enough and it still fits in the object
+        memcpy(inlineData, newData, newCapacity);
+        heap.reset();
+        data = inlineData;
+    }
+    else
+    {
+        heap = std::move(newHeap);
+        data = heap.get();
+    }
+    capacity = newCapacity;
+    strStart = newStrStart;
+}
+
+uint32_t FlatDictionaryC::addBytes(const char *bytes,uint32_t len)
+{
+    strStart -= len;
+    if (len > 0)
+    {
+        memcpy(data + strStart, bytes, len);
+    }
+    return strStart;
+}
+
+FlatDictionaryC::Field *FlatDictionaryC::setField(const std::string &name,DictionaryType type,DictionaryType altType,uint32_t strBytes)
+{
+    const int keyIndex = keys ? keys->find(name) : -1;
+    if (const Field *found = findField(keyIndex, &name))
+    {
+        const uint32_t which = found - fields();
+        if (found->type != type && found->type != altType)
+        {
+            // Type mismatch, remove it.  Same as MutableDictionaryC.
+            removeAt(which);
+            return nullptr;
+        }
+        reserve(0, strBytes);
+        return &fields()[which];
+    }
+
+    const bool keyInBlock = (keyIndex < 0);
+    const uint32_t keyLen = keyInBlock ? (uint32_t)name.size() : 0;
+    if (keyLen > 0xffff)
+    {
+        wkLogLevel(Warn, "FlatDictionaryC: Key name too long (%d)", (int)keyLen);
+        return nullptr;
+    }
+
+    reserve(1, keyLen + strBytes);
+    Field &field = fields()[numFields++];
+    field.key = keyInBlock ? (KeyInBlock | addBytes(name.data(), keyLen)) : (uint32_t)keyIndex;
+    field.keyLen = (uint16_t)keyLen;
+    field.type = (uint16_t)type;
+    return &field;
+}
+
+void FlatDictionaryC::removeAt(uint32_t which)
+{
+    // String data stays put until the next time we have to make room
+    Field *theFields = fields();
+    memmove(&theFields[which], &theFields[which+1], (numFields - which - 1) * sizeof(Field));
+    numFields--;
+}
+
+std::string FlatDictionaryC::fieldString(const Field &field) const
+{
+    return std::string(data + field.val.str.offset, field.val.str.len);
+}
+
+bool FlatDictionaryC::hasField(const std::string &name) const
+{
+    return findField(name) != nullptr;
+}
+
+DictionaryType FlatDictionaryC::getType(const std::string &name) const
+{
+    const Field *field = findField(name);
+    return field ? (DictionaryType)field->type : DictTypeNone;
+}
+
+DictionaryType FlatDictionaryC::getType(int keyIndex) const
+{
+    const Field *field = findField(keyIndex, nullptr);
+    return field ? (DictionaryType)field->type : DictTypeNone;
+}
+
+int FlatDictionaryC::getInt(const std::string &name,int defVal) const
+{
+    const Field *field = findField(name);
+    if (!field)
+        return defVal;
+
+    switch (field->type) {
+        case DictTypeInt:    return field->val.iVal;
+        case DictTypeInt64:  return (int)field->val.i64Val;
+        case DictTypeDouble: return (int)field->val.dVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to int", field->type);
+            return defVal;
+    }
+}
+
+int64_t FlatDictionaryC::getInt64(const std::string &name,int64_t defVal) const
+{
+    const Field *field = findField(name);
+    if (!field)
+        return defVal;
+
+    switch (field->type) {
+        case DictTypeInt:      return field->val.iVal;
+        case DictTypeInt64:
+        case DictTypeIdentity: return field->val.i64Val;
+        case DictTypeDouble:   return (int64_t)field->val.dVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to int64", field->type);
+            return defVal;
+    }
+}
+
+SimpleIdentity FlatDictionaryC::getIdentity(const std::string &name) const
+{
+    const Field *field = findField(name);
+    if (!field)
+        return EmptyIdentity;
+
+    switch (field->type) {
+        case DictTypeInt:      return field->val.iVal;
+        case DictTypeInt64:
+        case DictTypeIdentity: return field->val.i64Val;
+        case DictTypeDouble:   return (SimpleIdentity)field->val.dVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to identity", field->type);
+            return EmptyIdentity;
+    }
+}
+
+bool FlatDictionaryC::getBool(const std::string &name,bool defVal) const
+{
+    const Field *field = findField(name);
+    if (!field)
+        return defVal;
+
+    switch (field->type) {
+        case DictTypeInt:   return field->val.iVal != 0;
+        case DictTypeInt64: return field->val.i64Val != 0;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to bool", field->type);
+            return defVal;
+    }
+}
+
+RGBAColor FlatDictionaryC::getColor(const std::string &name,const RGBAColor &defVal) const
+{
+    const Field *field = findField(name);
+    if (!field)
+        return defVal;
+
+    switch (field->type)
+    {
+        case DictTypeString:
+        {
+            // We're looking for #RRGGBBAA, #RRGGBB, #RGBA, or #RGB
+            const std::string str = fieldString(*field);
+            if (str.length() < 4 || str[0] != '#')
+                return defVal;
+            return parseColor(&str.c_str()[1], defVal);
+        }
+        case DictTypeInt:
+            return ARGBtoRGBAColor(field->val.iVal);
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to color", field->type);
+            return defVal;
+    }
+}
+
+// Shared by the lookups by name and by index
+static double fieldDouble(int type,int iVal,int64_t i64Val,double dVal,double defVal)
+{
+    switch (type) {
+        case DictTypeInt:      return iVal;
+        case DictTypeInt64:
+        case DictTypeIdentity: return i64Val;
+        case DictTypeDouble:   return dVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to double", type);
+            return defVal;
+    }
+}
+
+double FlatDictionaryC::getDouble(const std::string &name,double defVal) const
+{
+    const Field *field = findField(name);
+    return field ? fieldDouble(field->type, field->val.iVal, field->val.i64Val, field->val.dVal, defVal) : defVal;
+}
+
+double FlatDictionaryC::getDouble(int keyIndex,double defVal) const
+{
+    const Field *field = findField(keyIndex, nullptr);
+    return field ? fieldDouble(field->type, field->val.iVal, field->val.i64Val, field->val.dVal, defVal) : defVal;
+}
+
+std::string FlatDictionaryC::getString(const std::string &name) const
+{
+    return getString(name, std::string());
+}
+
+std::string FlatDictionaryC::getString(const std::string &name,const std::string &defVal) const
+{
+    return getString(keys ? keys->find(name) : -1, defVal, &name);
+}
+
+std::string FlatDictionaryC::getString(int keyIndex,const std::string &defVal) const
+{
+    return getString(keyIndex, defVal, nullptr);
+}
+
+std::string FlatDictionaryC::getString(int keyIndex,const std::string &defVal,const std::string *name) const
+{
+    const Field *field = findField(keyIndex, name);
+    if (!field)
+        return defVal;
+
+    switch (field->type)
+    {
+        case DictTypeString:   return fieldString(*field);
+        case DictTypeInt:      return std::to_string(field->val.iVal);
+        case DictTypeInt64:
+        case DictTypeIdentity: return std::to_string(field->val.i64Val);
+        case DictTypeDouble:   return std::to_string(field->val.dVal);
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to string", field->type);
+            return defVal;
+    }
+}
+
+DictionaryRef FlatDictionaryC::getDict(__unused const std::string &name) const
+{
+    wkLogLevel(Warn, "FlatDictionaryC: Nested dictionaries aren't supported");
+    return DictionaryRef();
+}
+
+DictionaryEntryRef FlatDictionaryC::getEntry(const std::string &name) const
+{
+    const Field *field = findField(name);
+    if (!field)
+        return DictionaryEntryRef();
+
+    switch (field->type)
+    {
+        case DictTypeInt:      return std::make_shared<DictionaryEntryCBasic>(field->val.iVal);
+        case DictTypeInt64:
+        case DictTypeIdentity: return std::make_shared<DictionaryEntryCBasic>(field->val.i64Val);
+        case DictTypeDouble:   return std::make_shared<DictionaryEntryCBasic>(field->val.dVal);
+        case DictTypeString:   return std::make_shared<DictionaryEntryCString>(fieldString(*field));
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to entry", field->type);
+            return DictionaryEntryRef();
+    }
+}
+
+std::vector<DictionaryEntryRef> FlatDictionaryC::getArray(__unused const std::string &name) const
+{
+    return std::vector<DictionaryEntryRef>();
+}
+
+std::vector<std::string> FlatDictionaryC::getKeys() const
+{
+    std::vector<std::string> ret;
+    ret.reserve(numFields);
+    const Field *theFields = fields();
+    for (uint32_t ii=0;ii<numFields;ii++)
+    {
+        const Field &field = theFields[ii];
+        if (field.key & KeyInBlock)
+            ret.emplace_back(data + (field.key & ~KeyInBlock), field.keyLen);
+        else
+            ret.push_back(keys->getKey((int)field.key));
+    }
+    return ret;
+}
+
+void FlatDictionaryC::clear()
+{
+    numFields = 0;
+    strStart = capacity;
+}
+
+void FlatDictionaryC::removeField(const std::string &name)
+{
+    if (const Field *field = findField(name))
+    {
+        removeAt(field - fields());
+    }
+}
+
+void FlatDictionaryC::setInt(const std::string &name,int val)
+{
+    if (Field *field = setField(name, DictTypeInt, DictTypeInt, 0))
+        field->val.iVal = val;
+}
+
+void FlatDictionaryC::setInt64(const std::string &name,int64_t val)
+{
+    if (Field *field = setField(name, DictTypeInt64, DictTypeInt64, 0))
+        field->val.i64Val = val;
+}
+
+void FlatDictionaryC::setIdentifiable(const std::string &name,SimpleIdentity val)
+{
+    if (Field *field = setField(name, DictTypeIdentity, DictTypeInt64, 0))
+        field->val.i64Val = (int64_t)val;
+}
+
+void FlatDictionaryC::setDouble(const std::string &name,double val)
+{
+    if (Field *field = setField(name, DictTypeDouble, DictTypeDouble, 0))
+        field->val.dVal = val;
+}
+
+void FlatDictionaryC::setString(const std::string &name,const std::string &val)
+{
+    // Strings replace whatever was there, whatever the type
+    removeField(name);
+    if (Field *field = setField(name, DictTypeString, DictTypeString, (uint32_t)val.size()))
+    {
+        field->val.str.len = (uint32_t)val.size();
+        field->val.str.offset = addBytes(val.data(), (uint32_t)val.size());
+    }
+}
+
+void FlatDictionaryC::addEntries(const Dictionary *other)
+{
+    if (!other)
+    {
+        return;
+    }
+
+    for (const auto &key : other->getKeys())
+    {
+        switch (other->getType(key))
+        {
+            case DictTypeInt:      setInt(key, other->getInt(key, 0));         break;
+            case DictTypeInt64:    setInt64(key, other->getInt64(key, 0));     break;
+            case DictTypeIdentity: setIdentifiable(key, other->getIdentity(key)); break;
+            case DictTypeDouble:   setDouble(key, other->getDouble(key, 0.0)); break;
+            case DictTypeString:   setString(key, other->getString(key));      break;
+            default:
+                wkLogLevel(Warn, "FlatDictionaryC: Skipping unsupported type %d for key %s",
+                           other->getType(key), key.c_str());
+                break;
+        }
+    }
+}
+
+size_t FlatDictionaryC::getMemorySize() const
+{
+    return sizeof(*this) + (heap ? capacity : 0);
+}
+
+}
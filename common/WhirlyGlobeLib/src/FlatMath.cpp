@@ -43,6 +43,28 @@ Point3d PlateCarreeCoordSystem::geocentricToLocal(Point3d geocPt) const
     return GeoCoordSystem::GeocentricToLocal(geocPt);
 }
     
+void PlateCarreeCoordSystem::localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = Point2d(in[ii].x(),in[ii].y());
+}
+
+void PlateCarreeCoordSystem::geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = Point3d(in[ii].x(),in[ii].y(),0.0);
+}
+
+void PlateCarreeCoordSystem::localToGeocentricBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    GeoCoordSystem::LocalToGeocentric(in,out,count);
+}
+
+void PlateCarreeCoordSystem::geocentricToLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    GeoCoordSystem::GeocentricToLocal(in,out,count);
+}
+
 bool PlateCarreeCoordSystem::isSameAs(const CoordSystem *coordSys) const
 {
     const auto other = dynamic_cast<const PlateCarreeCoordSystem *>(coordSys);
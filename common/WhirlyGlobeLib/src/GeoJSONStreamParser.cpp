@@ -0,0 +1,790 @@
+/*  GeoJSONStreamParser.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <cstdlib>
+#import <cstring>
+#import "GeoJSONStreamParser.h"
+#import "Dictionary.h"
+
+namespace WhirlyKit
+{
+
+namespace
+{
+
+// Pulls JSON tokens out of a block of memory, one at a time
+class JSONScanner
+{
+public:
+    JSONScanner(const char *start,const char *end) : p(start), end(end) { }
+
+    // Where we are, past any white space
+    const char *pos() { skipSpace(); return p; }
+
+    // Next character that isn't white space, or zero at the end
+    char peek() { skipSpace(); return p < end ? *p : 0; }
+
+    // Consume the next character if it's the one we want
+    bool consume(char c)
+    {
+        if (peek() != c)
+            return false;
+        p++;
+        return true;
+    }
+
+    // Read a string.  If there are no escapes, we point into the source rather than copying.
+    bool parseString(const char *&str,size_t &len,std::string &scratch)
+    {
+        if (!consume('"'))
+            return false;
+        const char *start = p;
+        while (p < end && *p != '"' && *p != '\\')
+            p++;
+        if (p >= end)
+            return false;
+        if (*p == '"')
+        {
+            str = start;
+            len = p - start;
+            p++;
+            return true;
+        }
+
+        scratch.assign(start,p-start);
+        while (p < end && *p != '"')
+        {
+            if (*p != '\\')
+            {
+                scratch.push_back(*p++);
+                continue;
+            }
+            if (++p >= end)
+                return false;
+            switch (*p++)
+            {
+                case '"': scratch.push_back('"'); break;
+                case '\\': scratch.push_back('\\'); break;
+                case '/': scratch.push_back('/'); break;
+                case 'b': scratch.push_back('\b'); break;
+                case 'f': scratch.push_back('\f'); break;
+                case 'n': scratch.push_back('\n'); break;
+                case 'r': scratch.push_back('\r'); break;
+                case 't': scratch.push_back('\t'); break;
+                case 'u':
+                {
+                    uint32_t code;
+                    if (!parseHex(code))
+                        return false;
+                    // Surrogate pairs come in two escapes
+                    if (code >= 0xD800 && code < 0xDC00 && end - p >= 6 && p[0] == '\\' && p[1] == 'u')
+                    {
+                        p += 2;
+                        uint32_t low;
+                        if (!parseHex(low))
+                            return false;
+                        if (low >= 0xDC00 && low < 0xE000)
+                            code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUTF8(scratch,code);
+                }
+                    break;
+                default:
+                    return false;
+            }
+        }
+        if (p >= end)
+            return false;
+        p++;
+        str = scratch.data();
+        len = scratch.size();
+        return true;
+    }
+
+    bool parseString(std::string &str)
+    {
+        const char *s;
+        size_t len;
+        std::string scratch;
+        if (!parseString(s,len,scratch))
+            return false;
+        str.assign(s,len);
+        return true;
+    }
+
+    // Read an object key and the colon after it
+    bool parseKey(const char *&key,size_t &len,std::string &scratch)
+    {
+        return parseString(key,len,scratch) && consume(':');
+    }
+
+    bool nextIsNumber()
+    {
+        const char c = peek();
+        return c == '-' || (c >= '0' && c <= '9');
+    }
+
+    bool parseNumber(double &val)
+    {
+        // Powers of ten that are exact as doubles
+        static const double pow10[] = {1e0,1e1,1e2,1e3,1e4,1e5,1e6,1e7,1e8,1e9,1e10,1e11,
+                                       1e12,1e13,1e14,1e15,1e16,1e17,1e18,1e19,1e20,1e21,1e22};
+
+        const char *start = pos();
+        const bool neg = p < end && *p == '-';
+        if (neg)
+            p++;
+        if (p >= end || !isDigit(*p))
+            return false;
+
+        // Most numbers fit in a 64 bit mantissa and a small power of ten, which is exact
+        uint64_t mant = 0;
+        int digits = 0, exp10 = 0;
+        bool exact = true;
+        for (;p < end && isDigit(*p);p++)
+        {
+            if (digits < 19)
+            {
+                mant = mant*10 + (*p - '0');
+                if (mant)
+                    digits++;
+            } else {
+                exp10++;
+                exact = false;
+            }
+        }
+        if (p < end && *p == '.')
+        {
+            p++;
+            if (p >= end || !isDigit(*p))
+                return false;
+            for (;p < end && isDigit(*p);p++)
+            {
+                if (digits < 19)
+                {
+                    mant = mant*10 + (*p - '0');
+                    if (mant)
+                        digits++;
+                    exp10--;
+                } else
+                    exact = false;
+            }
+        }
+        if (p < end && (*p == 'e' || *p == 'E'))
+        {
+            p++;
+            bool expNeg = false;
+            if (p < end && (*p == '+' || *p == '-'))
+                expNeg = *p++ == '-';
+            if (p >= end || !isDigit(*p))
+                return false;
+            int expVal = 0;
+            for (;p < end && isDigit(*p);p++)
+                if (expVal < 100000)
+                    expVal = expVal*10 + (*p - '0');
+            exp10 += expNeg ? -expVal : expVal;
+        }
+
+        if (exact && mant <= (1ull<<53) && exp10 >= -22 && exp10 <= 22)
+        {
+            double res = (double)mant;
+            res = exp10 < 0 ? res / pow10[-exp10] : res * pow10[exp10];
+            val = neg ? -res : res;
+        } else {
+            // Let strtod get the tricky ones right
+            const std::string str(start,p-start);
+            val = strtod(str.c_str(),nullptr);
+        }
+
+        return true;
+    }
+
+    // Check for a literal like true or null
+    bool parseLiteral(const char *lit)
+    {
+        const size_t len = strlen(lit);
+        skipSpace();
+        if ((size_t)(end - p) < len || memcmp(p,lit,len) != 0)
+            return false;
+        p += len;
+        return true;
+    }
+
+    // Skip over a whole value.  We only check the nesting, the contents get checked if anyone parses them.
+    bool skipValue()
+    {
+        int depth = 0;
+        skipSpace();
+        while (p < end)
+        {
+            const char c = *p;
+            if (c == '"')
+            {
+                p++;
+                while (p < end && *p != '"')
+                    p += (*p == '\\') ? 2 : 1;
+                if (p >= end)
+                    return false;
+                p++;
+            } else if (c == '{' || c == '[') {
+                depth++;
+                p++;
+            } else if (c == '}' || c == ']') {
+                if (depth == 0)
+                    return true;
+                depth--;
+                p++;
+            } else if (c == ',' && depth == 0) {
+                return true;
+            } else
+                p++;
+
+            if (depth == 0 && (c == '"' || c == '}' || c == ']'))
+                return true;
+        }
+
+        return depth == 0;
+    }
+
+protected:
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    void skipSpace()
+    {
+        while (p < end && (*p == ' ' || *p == '\n' || *p == '\r' || *p == '\t'))
+            p++;
+    }
+
+    bool parseHex(uint32_t &code)
+    {
+        if (end - p < 4)
+            return false;
+        code = 0;
+        for (int ii=0;ii<4;ii++,p++)
+        {
+            const char c = *p;
+            code <<= 4;
+            if (c >= '0' && c <= '9')
+                code |= c - '0';
+            else if (c >= 'a' && c <= 'f')
+                code |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F')
+                code |= c - 'A' + 10;
+            else
+                return false;
+        }
+        return true;
+    }
+
+    static void appendUTF8(std::string &str,uint32_t code)
+    {
+        if (code < 0x80)
+            str.push_back((char)code);
+        else if (code < 0x800)
+        {
+            str.push_back((char)(0xC0 | (code >> 6)));
+            str.push_back((char)(0x80 | (code & 0x3F)));
+        } else if (code < 0x10000) {
+            str.push_back((char)(0xE0 | (code >> 12)));
+            str.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+            str.push_back((char)(0x80 | (code & 0x3F)));
+        } else {
+            str.push_back((char)(0xF0 | (code >> 18)));
+            str.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+            str.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+            str.push_back((char)(0x80 | (code & 0x3F)));
+        }
+    }
+
+    const char *p,*end;
+};
+
+static bool KeyIs(const char *key,size_t len,const char *name)
+{
+    return strlen(name) == len && memcmp(key,name,len) == 0;
+}
+
+// Walk the members of an object, calling the function with each key.
+// The function has to consume the value.
+template<typename Func> static bool ParseObject(JSONScanner &scan,Func &&func)
+{
+    if (!scan.consume('{'))
+        return false;
+    if (scan.consume('}'))
+        return true;
+
+    std::string scratch;
+    while (true)
+    {
+        const char *key;
+        size_t keyLen;
+        if (!scan.parseKey(key,keyLen,scratch) || !func(key,keyLen))
+            return false;
+        if (scan.consume(','))
+            continue;
+        return scan.consume('}');
+    }
+}
+
+// Shapes from a single feature, before they go in the batch
+typedef std::vector<VectorShapeRef> ShapeList;
+
+// Coordinates, however deeply they were nested
+struct GeoCoords
+{
+    // Innermost lists of positions
+    std::vector<VectorRing> rings;
+    // First ring and number of rings in each list of rings
+    std::vector<std::pair<size_t,size_t> > polys;
+    // Last position we read
+    Point2f pos;
+};
+
+// Parse a coordinate array.  Depth is 1 for a single position, 2 for a list of them and so on.
+static bool ParseCoordArray(JSONScanner &scan,GeoCoords &coords,int &depth)
+{
+    if (!scan.consume('['))
+        return false;
+    depth = 0;
+    if (scan.consume(']'))
+        return true;
+
+    if (scan.nextIsNumber())
+    {
+        // A position.  There might be a Z value or other junk, we just want the first two.
+        double vals[2];
+        int numVals = 0;
+        do
+        {
+            double val;
+            if (!scan.parseNumber(val))
+                return false;
+            if (numVals < 2)
+                vals[numVals++] = val;
+        } while (scan.consume(','));
+        if (numVals < 2 || !scan.consume(']'))
+            return false;
+        coords.pos = GeoCoord::CoordFromDegrees((float)vals[0],(float)vals[1]);
+        depth = 1;
+        return true;
+    }
+
+    const size_t startRing = coords.rings.size();
+    bool inRing = false;
+    int childDepth = 0;
+    do
+    {
+        int thisDepth;
+        if (!ParseCoordArray(scan,coords,thisDepth))
+            return false;
+        if (thisDepth == 1)
+        {
+            if (!inRing)
+            {
+                coords.rings.emplace_back();
+                inRing = true;
+            }
+            coords.rings.back().push_back(coords.pos);
+        } else if (thisDepth == 0) {
+            // An empty list of positions
+            coords.rings.emplace_back();
+            thisDepth = 2;
+        }
+        childDepth = std::max(childDepth,thisDepth);
+    } while (scan.consume(','));
+    if (!scan.consume(']'))
+        return false;
+
+    if (childDepth == 2)
+        coords.polys.emplace_back(startRing,coords.rings.size()-startRing);
+    depth = childDepth + 1;
+
+    return true;
+}
+
+static bool ParseGeometry(JSONScanner &scan,ShapeList &shapes);
+
+// Turn the coordinates into shapes, now that we know the type
+static bool BuildGeometry(const char *type,size_t typeLen,GeoCoords &coords,ShapeList &shapes)
+{
+    if (KeyIs(type,typeLen,"Point") || KeyIs(type,typeLen,"MultiPoint"))
+    {
+        VectorPointsRef pts = VectorPoints::createPoints();
+        for (const auto &ring : coords.rings)
+            pts->pts.insert(pts->pts.end(),ring.begin(),ring.end());
+        pts->initGeoMbr();
+        shapes.push_back(pts);
+    } else if (KeyIs(type,typeLen,"LineString")) {
+        VectorLinearRef lin = VectorLinear::createLinear();
+        for (const auto &ring : coords.rings)
+            lin->pts.insert(lin->pts.end(),ring.begin(),ring.end());
+        lin->initGeoMbr();
+        shapes.push_back(lin);
+    } else if (KeyIs(type,typeLen,"Polygon")) {
+        VectorArealRef ar = VectorAreal::createAreal();
+        ar->loops = std::move(coords.rings);
+        ar->initGeoMbr();
+        shapes.push_back(ar);
+    } else if (KeyIs(type,typeLen,"MultiLineString")) {
+        for (auto &ring : coords.rings)
+        {
+            VectorLinearRef lin = VectorLinear::createLinear();
+            lin->pts = std::move(ring);
+            lin->initGeoMbr();
+            shapes.push_back(lin);
+        }
+    } else if (KeyIs(type,typeLen,"MultiPolygon")) {
+        for (const auto &poly : coords.polys)
+        {
+            VectorArealRef ar = VectorAreal::createAreal();
+            ar->loops.reserve(poly.second);
+            for (size_t ii=0;ii<poly.second;ii++)
+                ar->loops.push_back(std::move(coords.rings[poly.first+ii]));
+            ar->initGeoMbr();
+            shapes.push_back(ar);
+        }
+    } else
+        return false;
+
+    return true;
+}
+
+// Parse a geometry object.  The members can come in any order, so we hang on to what we find until the end.
+static bool ParseGeometry(JSONScanner &scan,ShapeList &shapes)
+{
+    std::string typeScratch;
+    const char *type = nullptr;
+    size_t typeLen = 0;
+    GeoCoords coords;
+    bool haveCoords = false, haveGeoms = false;
+    ShapeList geoms;
+    const bool ok = ParseObject(scan,[&](const char *key,size_t keyLen)
+    {
+        if (KeyIs(key,keyLen,"type"))
+            return scan.parseString(type,typeLen,typeScratch);
+        else if (KeyIs(key,keyLen,"coordinates") && scan.peek() == '[')
+        {
+            int depth;
+            if (!ParseCoordArray(scan,coords,depth))
+                return false;
+            // A lone point
+            if (depth == 1)
+                coords.rings.push_back(VectorRing { coords.pos });
+            haveCoords = true;
+            return true;
+        } else if (KeyIs(key,keyLen,"geometries") && scan.peek() == '[')
+        {
+            haveGeoms = true;
+            if (!scan.consume('['))
+                return false;
+            if (scan.consume(']'))
+                return true;
+            do
+            {
+                if (!ParseGeometry(scan,geoms))
+                    return false;
+            } while (scan.consume(','));
+            return scan.consume(']');
+        }
+        return scan.skipValue();
+    });
+    if (!ok || !type)
+        return false;
+
+    if (KeyIs(type,typeLen,"GeometryCollection"))
+    {
+        if (!haveGeoms)
+            return false;
+        shapes.insert(shapes.end(),geoms.begin(),geoms.end());
+        return true;
+    }
+
+    return haveCoords && BuildGeometry(type,typeLen,coords,shapes);
+}
+
+// Strings, numbers and bools go in the dictionary.  Nested objects and arrays are skipped.
+static bool ParseProperties(JSONScanner &scan,const MutableDictionaryRef &dict)
+{
+    std::string scratch;
+    return ParseObject(scan,[&](const char *key,size_t keyLen)
+    {
+        const std::string name(key,keyLen);
+        switch (scan.peek())
+        {
+            case '"':
+            {
+                const char *str;
+                size_t len;
+                if (!scan.parseString(str,len,scratch))
+                    return false;
+                dict->setString(name,std::string(str,len));
+            }
+                return true;
+            case 't':
+                dict->setInt(name,1);
+                return scan.parseLiteral("true");
+            case 'f':
+                dict->setInt(name,0);
+                return scan.parseLiteral("false");
+            default:
+                if (scan.nextIsNumber())
+                {
+                    double val;
+                    if (!scan.parseNumber(val))
+                        return false;
+                    dict->setDouble(name,val);
+                    return true;
+                }
+                return scan.skipValue();
+        }
+    });
+}
+
+// Parse a feature, which may turn into several shapes.  They share the properties.
+static bool ParseFeature(JSONScanner &scan,ShapeList &shapes)
+{
+    const size_t startShape = shapes.size();
+    MutableDictionaryRef properties;
+    bool haveGeom = false;
+    const bool ok = ParseObject(scan,[&](const char *key,size_t keyLen)
+    {
+        if (KeyIs(key,keyLen,"geometry"))
+        {
+            haveGeom = true;
+            return ParseGeometry(scan,shapes);
+        } else if (KeyIs(key,keyLen,"properties"))
+        {
+            properties = MutableDictionaryMake();
+            return scan.peek() == '{' ? ParseProperties(scan,properties) : scan.skipValue();
+        }
+        return scan.skipValue();
+    });
+    if (!ok || !haveGeom)
+        return false;
+
+    if (properties)
+        for (size_t ii=startShape;ii<shapes.size();ii++)
+            shapes[ii]->setAttrDict(properties);
+
+    return true;
+}
+
+// Pull the name out of a "crs" entry
+static bool ParseCRS(JSONScanner &scan,std::string &crsName)
+{
+    std::string type,name;
+    const bool ok = ParseObject(scan,[&](const char *key,size_t keyLen)
+    {
+        if (KeyIs(key,keyLen,"type") && scan.peek() == '"')
+            return scan.parseString(type);
+        else if (KeyIs(key,keyLen,"properties") && scan.peek() == '{')
+        {
+            return ParseObject(scan,[&](const char *propKey,size_t propKeyLen)
+            {
+                if (KeyIs(propKey,propKeyLen,"name") && scan.peek() == '"')
+                    return scan.parseString(name);
+                return scan.skipValue();
+            });
+        }
+        return scan.skipValue();
+    });
+    if (ok && type == "name" && !name.empty())
+        crsName = name;
+
+    return ok;
+}
+
+}
+
+GeoJSONStreamParser::GeoJSONStreamParser(BatchCallback callback) :
+    callback(std::move(callback)),
+    batchSize(1000),
+    batchFeatures(0),
+    stopped(false)
+{
+}
+
+bool GeoJSONStreamParser::parse(const char *data,size_t len)
+{
+    batch.reset();
+    batchFeatures = 0;
+    stopped = false;
+    crs.clear();
+
+    JSONScanner scan(data,data+len);
+    const char *topStart = scan.pos();
+    std::string type;
+    bool haveFeatures = false;
+    std::vector<Span> spans;
+    const bool ok = ParseObject(scan,[&](const char *key,size_t keyLen)
+    {
+        if (KeyIs(key,keyLen,"type"))
+            return scan.parseString(type);
+        else if (KeyIs(key,keyLen,"crs") && scan.peek() == '{')
+            return ParseCRS(scan,crs);
+        else if (KeyIs(key,keyLen,"features") && scan.peek() == '[' &&
+                 (type.empty() || type == "FeatureCollection"))
+        {
+            // This is the part that can be huge
+            haveFeatures = true;
+            scan.consume('[');
+            if (scan.consume(']'))
+                return true;
+            ShapeList shapes;
+            do
+            {
+                if (pool)
+                {
+                    // Find the edges of the features here and do the real work on the pool
+                    const char *start = scan.pos();
+                    if (scan.peek() != '{' || !scan.skipValue())
+                        return false;
+                    spans.emplace_back(start,scan.pos());
+                    if (spans.size() >= batchSize)
+                    {
+                        if (!parseSpans(spans))
+                            return false;
+                        spans.clear();
+                    }
+                } else {
+                    shapes.clear();
+                    if (!ParseFeature(scan,shapes))
+                        return false;
+                    addFeature(shapes);
+                }
+                // Bail out of the whole parse
+                if (stopped)
+                    return false;
+            } while (scan.consume(','));
+            if (!scan.consume(']'))
+                return false;
+            if (!spans.empty() && !parseSpans(spans))
+                return false;
+            return !stopped;
+        }
+        return scan.skipValue();
+    });
+    if (stopped)
+        return true;
+    if (!ok || type.empty())
+        return false;
+
+    if (type == "FeatureCollection")
+    {
+        if (!haveFeatures)
+            return false;
+        flush();
+        return true;
+    }
+
+    // A lone feature or bare geometry.  Now that we know which, go back and parse the whole thing.
+    JSONScanner again(topStart,scan.pos());
+    ShapeList shapes;
+    if (!(type == "Feature" ? ParseFeature(again,shapes) : ParseGeometry(again,shapes)))
+        return false;
+    addFeature(shapes);
+    flush();
+
+    return true;
+}
+
+bool GeoJSONStreamParser::parseFile(const std::string &fileName)
+{
+    const auto data = RawDataMapFile(fileName);
+    if (!data)
+        return false;
+
+    return parse((const char *)data->getRawData(),data->getLen());
+}
+
+bool GeoJSONStreamParser::parseSpans(const std::vector<Span> &features)
+{
+    // A few chunks per thread so a slow one doesn't hold everyone up
+    const size_t numChunks = std::min(features.size(),(size_t)(pool->getNumThreads()+1)*4);
+    std::vector<ShapeList> chunkShapes(numChunks);
+    std::vector<char> chunkOk(numChunks,0);
+    pool->parallelFor(numChunks,[&](size_t chunk)
+    {
+        const size_t start = chunk * features.size() / numChunks;
+        const size_t end = (chunk+1) * features.size() / numChunks;
+        for (size_t ii=start;ii<end;ii++)
+        {
+            JSONScanner scan(features[ii].first,features[ii].second);
+            if (!ParseFeature(scan,chunkShapes[chunk]))
+                return;
+        }
+        chunkOk[chunk] = 1;
+    });
+
+    for (size_t ii=0;ii<numChunks;ii++)
+    {
+        if (!chunkOk[ii])
+            return false;
+        if (!batch)
+            batch = std::make_shared<VectorObject>();
+        batch->shapes.insert(chunkShapes[ii].begin(),chunkShapes[ii].end());
+    }
+    batchFeatures += (unsigned int)features.size();
+    if (batchFeatures >= batchSize)
+        flush();
+
+    return true;
+}
+
+void GeoJSONStreamParser::addFeature(const ShapeList &shapes)
+{
+    if (!batch)
+        batch = std::make_shared<VectorObject>();
+    batch->shapes.insert(shapes.begin(),shapes.end());
+    if (++batchFeatures >= batchSize)
+        flush();
+}
+
+void GeoJSONStreamParser::flush()
+{
+    if (batch && !stopped && !callback(batch))
+        stopped = true;
+    batch.reset();
+    batchFeatures = 0;
+}
+
+bool GeoJSONStreamParser::ParseAssembly(const char *data,size_t len,std::map<std::string,ShapeSet> &shapes)
+{
+    JSONScanner scan(data,data+len);
+    return ParseObject(scan,[&](const char *key,size_t keyLen)
+    {
+        if (scan.peek() != '{')
+            return scan.skipValue();
+
+        const char *start = scan.pos();
+        if (!scan.skipValue())
+            return false;
+        ShapeSet theseShapes;
+        GeoJSONStreamParser parser([&](const VectorObjectRef &batch)
+        {
+            theseShapes.insert(batch->shapes.begin(),batch->shapes.end());
+            return true;
+        });
+        if (!parser.parse(start,scan.pos()-start))
+            return false;
+        shapes[std::string(key,keyLen)] = std::move(theseShapes);
+        return true;
+    });
+}
+
+}
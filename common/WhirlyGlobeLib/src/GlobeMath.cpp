@@ -83,6 +83,40 @@ Point3d GeoCoordSystem::GeocentricToLocal(Point3d geocPt)
     return Point3d(x,y,z);
 }
 
+void GeoCoordSystem::LocalToGeocentric(const Point3d *in,Point3d *out,size_t count)
+{
+    if (count == 0)
+        return;
+    InitProj4();
+
+    if (in != out)
+        std::copy(in,in+count,out);
+    pj_transform(pj_latlon, pj_geocentric, (long)count, 3, &out->x(), &out->y(), &out->z());
+}
+
+void GeoCoordSystem::GeocentricToLocal(const Point3d *in,Point3d *out,size_t count)
+{
+    if (count == 0)
+        return;
+    InitProj4();
+
+    if (in != out)
+        std::copy(in,in+count,out);
+    pj_transform(pj_geocentric, pj_latlon, (long)count, 3, &out->x(), &out->y(), &out->z());
+}
+
+void GeoCoordSystem::localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = Point2d(in[ii].x(),in[ii].y());
+}
+
+void GeoCoordSystem::geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = Point3d(in[ii].x(),in[ii].y(),0.0);
+}
+
 Mbr GeoCoordSystem::GeographicMbrToLocal(GeoMbr geoMbr)
 {
     Mbr localMbr;
@@ -125,6 +159,12 @@ Point3d FakeGeocentricDisplayAdapter::LocalToDisplay(Point3d geoPt)
     return pt;
 }
 
+void FakeGeocentricDisplayAdapter::LocalToDisplay(const Point3d *in,Point3d *out,size_t count)
+{
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = LocalToDisplay(in[ii]);
+}
+
 Point3f FakeGeocentricDisplayAdapter::DisplayToLocal(Point3f pt)
 {
     pt.normalize();
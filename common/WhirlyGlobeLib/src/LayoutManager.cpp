@@ -23,6 +23,7 @@
 #import "LinearTextBuilder.h"
 #import "WhirlyKitLog.h"
 #import "Expect.h"
+#import "TraceEvents.h"
 
 using namespace Eigen;
 
@@ -325,6 +326,28 @@ void LayoutManager::setFadeOutTime(TimeInterval time)
     hasUpdates = true;
 }
 
+void LayoutManager::setIncrementalLayout(bool enable,float pixelTolerance)
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+    incrementalLayout = enable;
+    incrementalTolerance = pixelTolerance;
+    lastLayoutComplete = false;
+    hasUpdates = true;
+}
+
+void LayoutManager::setClusterPool(TaskPoolRef pool)
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+    clusterPool = std::move(pool);
+}
+
+void LayoutManager::setTiledClustering(bool tiled)
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+    tiledClustering = tiled;
+    hasUpdates = true;
+}
+
 // Return the screen space objects in a form the selection manager can understand
 void LayoutManager::getScreenSpaceObjects(const SelectionManager::PlacementInfo &pInfo,
                                           std::vector<ScreenSpaceObjectLocation> &screenSpaceObjs)
@@ -475,6 +498,10 @@ static const int OverlapSampleY = 60;
 // Now much around the screen we'll take into account
 static const float ScreenBuffer = 0.1;
 
+// Below this many cluster objects it's not worth waking up the pool to project them
+static const size_t MinParallelProjection = 1024;
+static const size_t ParallelProjectionBatch = 256;
+
 bool LayoutManager::calcScreenPt(Point2f &objPt,const LayoutObject *layoutObj,
                                  const ViewStateRef &viewState,
                                  const Mbr &screenMbr,const Point2f &frameBufferSize)
@@ -548,6 +575,10 @@ struct LayoutManager::LayoutObjectContainer
     // Objects that share the same unique ID
     std::vector<LayoutObjectEntryRef> objs;
 
+    // Set if this object may keep its placement from the last run, and where it is now
+    LayoutObjectEntry *kept = nullptr;
+    Point2f keptPt;
+
     bool operator < (const LayoutObjectContainer &that) const {
         if (objs.empty())  // Never happen
             return false;
@@ -613,6 +644,33 @@ static Point2d offsetForOrientation(unsigned orient, const Point2d &span)
     }
 }
 
+// Screen space corners of a layout object placed with the given orientation.  Returns the offset.
+static Point2d placementPts(const LayoutObject &obj, unsigned orient, const Matrix2d &screenRotMat,
+                            const Point2f &objPt, float resScale, Point2dVector &objPts)
+{
+    // Layout points are relative to the object, figure out where they are on the screen
+    const Mbr layoutMbr(obj.layoutPts);
+    const Point2f span = layoutMbr.span();
+    const Point2f &layoutOrg = layoutMbr.ll();
+
+    // Set up the offset for this orientation
+    const Point2d objOffset = offsetForOrientation(orient, span.cast<double>());
+
+    objPts.resize(4);
+    objPts[0] = objOffset + layoutOrg.cast<double>();
+    objPts[1] = objPts[0] + Point2d(span.x(), 0.0);
+    objPts[2] = objPts[0] + Point2d(span.x(), span.y());
+    objPts[3] = objPts[0] + Point2d(0.0, span.y());
+
+    for (auto &p : objPts)
+    {
+        const Point2d offPt = screenRotMat * (p * resScale);
+        p = Point2d(offPt.x(),-offPt.y()) + objPt.cast<double>();
+    }
+
+    return objOffset;
+}
+
 // Do the actual layout logic.  We'll modify the offset and on value in place.
 bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
                                    const ViewStateRef &viewState,
@@ -622,8 +680,13 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
                                    std::vector<ClusterGenerator::ClusterClassParams> &outClusterParams,
                                    ChangeSet &changes)
 {
+    WK_TRACE_SCOPE("layout","LayoutManager::runLayoutRules");
+
     if (localLayoutObjects.empty())
+    {
+        lastLayoutComplete = false;
         return false;
+    }
 
     bool hadChanges = false;
 
@@ -784,13 +847,21 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
 
     if (UNLIKELY(cancelLayout))
     {
+        lastLayoutComplete = false;
         return false;
     }
 
 //    NSLog(@"----Starting Layout----");
 
-    // Set up the overlap sampler
-    OverlapHelper overlapMan(screenMbr,OverlapSampleX,OverlapSampleY,localLayoutObjects.size());
+    // Set up the overlap sampler, reusing the one from last time if we can
+    if (overlapMan)
+    {
+        overlapMan->reset(screenMbr,localLayoutObjects.size());
+    }
+    else
+    {
+        overlapMan = std::make_unique<OverlapHelper>(screenMbr,OverlapSampleX,OverlapSampleY,localLayoutObjects.size());
+    }
 
     // Add in the unique objects, cluster entries and then sort them all
     for (auto &it : uniqueLayoutObjs)
@@ -809,9 +880,60 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
         {
             pt = pt * resScale + objPt.cast<double>();
         }
-        overlapMan.addObject(objPts);
+        overlapMan->addObject(objPts);
     }
 
+    // Incremental layout keeps the placements from the last run for objects that haven't moved much.
+    // If the view jumped, or we didn't finish last time, we do the whole thing.
+    const double viewHeight = globeViewState ? globeViewState->heightAboveGlobe : mapViewState->heightAboveSurface;
+    bool incremental = incrementalLayout && lastLayoutComplete && !showDebugBoundaries &&
+                       lastFrameBufferSize == frameBufferSize &&
+                       viewHeight < lastLayoutHeight * 1.25 && viewHeight > lastLayoutHeight / 1.25;
+    const float tolerance2 = incrementalTolerance * incrementalTolerance;
+    int numKeepers = 0, numWerePlaced = 0;
+    if (incremental)
+    {
+        // Find the objects that were placed last time and are close to where they were.
+        // They get their old spot back if it's still free when we get to them in importance order.
+        for (auto &container : layoutObjs)
+        {
+            for (auto &layoutObj : container.objs)
+            {
+                numWerePlaced += layoutObj->currentEnable ? 1 : 0;
+            }
+            for (auto &layoutObj : container.objs)
+            {
+                if (layoutObj->currentEnable && layoutObj->layoutOrient >= 0 && layoutObj->obj.layoutShape.empty())
+                {
+                    Point2f objPt;
+                    if (calcScreenPt(objPt,&layoutObj->obj,viewState,screenMbr,frameBufferSize) &&
+                        (objPt - layoutObj->layoutScreenPt).squaredNorm() <= tolerance2)
+                    {
+                        container.kept = layoutObj.get();
+                        container.keptPt = objPt;
+                        numKeepers++;
+                    }
+                    break;
+                }
+            }
+        }
+
+        // If most of them moved, it's a big enough change to start over
+        if (numKeepers * 2 < lastNumPlaced)
+        {
+            incremental = false;
+            for (auto &container : layoutObjs)
+            {
+                container.kept = nullptr;
+            }
+        }
+    }
+
+    // If nothing more important that we placed last time has gone away, anything that didn't fit
+    // last time and hasn't moved still won't fit.  Clusters and shapes move around, so we can't tell with those.
+    // Once we pass something that was placed and isn't being kept, that's no longer true.
+    bool skipRejects = incremental && numWerePlaced >= lastNumPlaced && clusterEntries.empty();
+
     std::unordered_multimap<std::string, LayoutObjectEntryRef> mergeMap(localLayoutObjects.size());
 
     // Lay out the various objects that are active
@@ -838,6 +960,61 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
         // Some of these may share unique IDs
         bool pickedOne = false;
 
+        // Try a keeper at its old orientation first.  Anything more important has already
+        // been placed, so it may have lost its spot, in which case it gets the full search.
+        if (container.kept)
+        {
+            LayoutObjectEntry *layoutObj = container.kept;
+            bool fits = false;
+            if (isActive)
+            {
+                float screenRot = 0.0;
+                Matrix2d screenRotMat = Matrix2d::Identity();
+                if (layoutObj->obj.rotation != 0.0)
+                {
+                    screenRotMat = calcScreenRot(screenRot, viewState, globeViewState, &layoutObj->obj,
+                                                 container.keptPt, modelTrans, normalMat, frameBufferSize);
+                }
+                placementPts(layoutObj->obj, layoutObj->layoutOrient, screenRotMat, container.keptPt, resScale, objPts);
+                fits = container.importance >= MAXFLOAT ||
+                       overlapMan->addCheckObject(objPts, layoutObj->obj.mergeID);
+            }
+            if (!fits)
+            {
+                container.kept = nullptr;
+            }
+        }
+        if (skipRejects && !container.kept)
+        {
+            for (const auto &layoutObj : container.objs)
+            {
+                if (layoutObj->currentEnable)
+                {
+                    skipRejects = false;
+                    break;
+                }
+            }
+        }
+
+        // Nothing in here fit last time and none of it has moved
+        bool rejectAll = false;
+        if (skipRejects && !container.kept)
+        {
+            rejectAll = true;
+            for (const auto &layoutObj : container.objs)
+            {
+                Point2f objPt;
+                if (layoutObj->currentEnable || layoutObj->layoutOrient >= 0 ||
+                    !layoutObj->obj.layoutShape.empty() || layoutObj->layoutScreenPt.x() == MAXFLOAT ||
+                    !calcScreenPt(objPt,&layoutObj->obj,viewState,screenMbr,frameBufferSize) ||
+                    (objPt - layoutObj->layoutScreenPt).squaredNorm() > tolerance2)
+                {
+                    rejectAll = false;
+                    break;
+                }
+            }
+        }
+
         for (auto &layoutObj : container.objs)
         {
             if (UNLIKELY(cancelLayout))
@@ -849,10 +1026,28 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
             layoutObj->obj.layoutModelPlaces.clear();
             layoutObj->obj.layoutPlaces.clear();
 
+            if (container.kept)
+            {
+                // Kept its spot from last time and it's already in the overlap grid
+                if (layoutObj.get() == container.kept)
+                {
+                    isActive = true;
+                    objOffset = layoutObj->offset;
+                    pickedOne = true;
+                }
+                else
+                {
+                    isActive = false;
+                }
+            }
+            else if (rejectAll)
+            {
+                isActive = false;
+            }
             // Layout along a shape
-            if (!layoutObj->obj.layoutShape.empty())
+            else if (!layoutObj->obj.layoutShape.empty())
             {
-                layoutAlongShape(layoutObj, viewState, frameBufferSize, overlapMan, changes, isActive, hadChanges);
+                layoutAlongShape(layoutObj, viewState, frameBufferSize, *overlapMan, changes, isActive, hadChanges);
             }
             else
             {
@@ -862,12 +1057,19 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
                 if (pickedOne)
                     isActive = false;
 
+                layoutObj->layoutScreenPt = Point2f(MAXFLOAT,MAXFLOAT);
+                layoutObj->layoutOrient = -1;
+
                 if (isActive)
                 {
                     Point2f objPt;
                     bool isInside = calcScreenPt(objPt,&layoutObj->obj,viewState,screenMbr,frameBufferSize);
 
                     isActive &= isInside;
+                    if (isInside)
+                    {
+                        layoutObj->layoutScreenPt = objPt;
+                    }
 
                     // Deal with the rotation
                     float screenRot = 0.0;
@@ -891,33 +1093,16 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
                                 if (!(layoutObj->obj.acceptablePlacement & (1U<<orient)))
                                     continue;
 
-                                // Layout points are relative to the object, figure out where they are on the screen
-                                const Point2dVector &layoutPts = layoutObj->obj.layoutPts;
-                                const Mbr layoutMbr(layoutPts);
-                                const Point2f span = layoutMbr.span();
-                                const Point2f &layoutOrg = layoutMbr.ll();
-
-                                // Set up the offset for this orientation
-                                objOffset = offsetForOrientation(orient, span.cast<double>());
-
-                                objPts[0] = objOffset + layoutOrg.cast<double>();
-                                objPts[1] = objPts[0] + Point2d(span.x(), 0.0);
-                                objPts[2] = objPts[0] + Point2d(span.x(), span.y());
-                                objPts[3] = objPts[0] + Point2d(0.0, span.y());
-
-                                for (auto &p : objPts)
-                                {
-                                    const Point2d offPt = screenRotMat * (p * resScale);
-                                    p = Point2d(offPt.x(),-offPt.y()) + objPt.cast<double>();
-                                }
+                                objOffset = placementPts(layoutObj->obj, orient, screenRotMat, objPt, resScale, objPts);
 
                                 //wkLogLevel(Debug, "Center pt = (%f,%f), orient = %d, pts:",objPt.x(),objPt.y(),orient);
                                 //for (const auto &p : objPts) wkLogLevel(Debug, "  (%f,%f)\n",p.x(),p.y());
 
                                 // Now try it.  Objects we've pegged as essential always win
                                 if (container.importance >= MAXFLOAT ||
-                                    overlapMan.addCheckObject(objPts, layoutObj->obj.mergeID))
+                                    overlapMan->addCheckObject(objPts, layoutObj->obj.mergeID))
                                 {
+                                    layoutObj->layoutOrient = (int)orient;
                                     if (showDebugBoundaries || layoutObj->obj.layoutDebug)
                                     {
                                         // Debugging visual output
@@ -999,9 +1184,18 @@ bool LayoutManager::runLayoutRules(PlatformThreadInfo *threadInfo,
             layoutObj->newEnable = isActive;
             layoutObj->newCluster = -1;
             layoutObj->offset = objOffset;
+            if (!isActive)
+            {
+                layoutObj->layoutOrient = -1;
+            }
         }
     }
 
+    lastLayoutComplete = !cancelLayout;
+    lastLayoutHeight = viewHeight;
+    lastFrameBufferSize = frameBufferSize;
+    lastNumPlaced = numSoFar;
+
     //wkLogLevel(Debug, "----Finished layout---- changes=%d", hadChanges);
 
     return hadChanges;
@@ -1022,6 +1216,14 @@ void LayoutManager::runLayoutClustering(PlatformThreadInfo *threadInfo,
 {
     const float resScale = renderer->getScale();
 
+    TaskPoolRef pool;
+    bool tiled;
+    {
+        std::lock_guard<std::mutex> guardLock(lock);
+        pool = clusterPool;
+        tiled = tiledClustering;
+    }
+
     clusterGen->startLayoutObjects(threadInfo);
 
     // Lay out the cluster groups in order
@@ -1033,48 +1235,80 @@ void LayoutManager::runLayoutClustering(PlatformThreadInfo *threadInfo,
 
         ClusterHelper clusterHelper(screenMbr,OverlapSampleX,OverlapSampleY,resScale,params.clusterSize);
 
-        // Add all the various objects to the cluster and figure out overlaps
-        for (const auto &entry : cluster->getLayoutObjects())
+        // Project the points and figure out the rotation
+        const LayoutSortingSet &clusterObjs = cluster->getLayoutObjects();
+        std::vector<LayoutObjectEntryRef> entries(clusterObjs.begin(),clusterObjs.end());
+        std::vector<Point2dVector> entryPts(entries.size());
+        std::vector<char> entryActive(entries.size(),0);
+        const auto projectOne = [&](size_t which)
         {
-            // Project the point and figure out the rotation
-            bool isActive = true;
+            const auto &entry = entries[which];
             Point2f objPt;
-            bool isInside = calcScreenPt(objPt,&entry->obj,viewState,screenMbr,frameBufferSize);
+            if (!calcScreenPt(objPt,&entry->obj,viewState,screenMbr,frameBufferSize))
+            {
+                return;
+            }
+            entryActive[which] = 1;
 
-            isActive &= isInside;
+            // Deal with the rotation
+            float screenRot = 0.0;
+            Matrix2d screenRotMat = Matrix2d::Identity();
+            if (entry->obj.rotation != 0.0)
+            {
+                screenRotMat = calcScreenRot(screenRot,viewState,globeViewState,&entry->obj,
+                                             objPt,modelTrans,normalMat,frameBufferSize);
+            }
 
-            if (isActive)
+            // Rotate the rectangle
+            Point2dVector &objPts = entryPts[which];
+            objPts.resize(4);
+            if (screenRot == 0.0)
             {
-                // Deal with the rotation
-                float screenRot = 0.0;
-                Matrix2d screenRotMat;
-                if (entry->obj.rotation != 0.0)
+                for (unsigned int ii=0;ii<4;ii++)
+                    objPts[ii] = Point2d(objPt.x(),objPt.y()) + entry->obj.layoutPts[ii] * resScale;
+            }
+            else
+            {
+                Point2d center = objPt.cast<double>();
+                for (unsigned int ii=0;ii<4;ii++)
                 {
-                    screenRotMat = calcScreenRot(screenRot,viewState,globeViewState,&entry->obj,
-                                                 objPt,modelTrans,normalMat,frameBufferSize);
+                    const Point2d &thisObjPt = entry->obj.layoutPts[ii];
+                    const Point2d offPt = screenRotMat * (thisObjPt * resScale);
+                    objPts[ii] = Point2d(offPt.x(),-offPt.y()) + center;
                 }
+            }
+        };
+        if (pool && pool->getNumThreads() > 0 && entries.size() >= MinParallelProjection)
+        {
+            pool->parallelFor(entries.size(),projectOne,ParallelProjectionBatch);
+        }
+        else
+        {
+            for (size_t ii=0;ii<entries.size();ii++)
+            {
+                projectOne(ii);
+            }
+        }
 
-                // Rotate the rectangle
-                Point2dVector objPts(4);
-                if (screenRot == 0.0)
-                {
-                    for (unsigned int ii=0;ii<4;ii++)
-                        objPts[ii] = Point2d(objPt.x(),objPt.y()) + entry->obj.layoutPts[ii] * resScale;
-                }
-                else
+        // Drop the ones that didn't make it on screen, keeping the order
+        size_t numActive = 0;
+        for (size_t ii=0;ii<entries.size();ii++)
+        {
+            if (entryActive[ii])
+            {
+                if (numActive != ii)
                 {
-                    Point2d center = objPt.cast<double>();
-                    for (unsigned int ii=0;ii<4;ii++)
-                    {
-                        const Point2d &thisObjPt = entry->obj.layoutPts[ii];
-                        const Point2d offPt = screenRotMat * (thisObjPt * resScale);
-                        objPts[ii] = Point2d(offPt.x(),-offPt.y()) + center;
-                    }
+                    entries[numActive] = std::move(entries[ii]);
+                    entryPts[numActive] = std::move(entryPts[ii]);
                 }
-
-                clusterHelper.addObject(entry,objPts);
+                numActive++;
             }
         }
+        entries.resize(numActive);
+        entryPts.resize(numActive);
+
+        // Add all the various objects to the cluster and figure out overlaps
+        clusterHelper.addObjects(entries,entryPts,tiled,pool.get(),cancelLayout);
 
         // Deal with the clusters and their own overlaps
         clusterHelper.resolveClusters(cancelLayout);
@@ -1761,6 +1995,8 @@ void LayoutManager::handleFadeOut(const TimeInterval curTime,
 // Layout all the objects we're tracking
 void LayoutManager::updateLayout(PlatformThreadInfo *threadInfo,const ViewStateRef &viewState,ChangeSet &changes)
 {
+    WK_TRACE_SCOPE("layout","LayoutManager::updateLayout");
+
     CoordSystemDisplayAdapter *coordAdapter = scene->getCoordAdapter();
 
     if (!vecManage)
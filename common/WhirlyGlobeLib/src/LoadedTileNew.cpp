@@ -30,9 +30,44 @@ TileGeomSettings::TileGeomSettings()
       programID(0), sampleX(10), sampleY(10), topSampleX(10), topSampleY(10),
       minVis(DrawVisibleInvalid), maxVis(DrawVisibleInvalid),
       baseDrawPriority(0), drawPriorityPerLevel(1), lineMode(false),
-      includeElev(false), enableGeom(true), singleLevel(false)
+      includeElev(false), enableGeom(true), singleLevel(false),
+      useMeshTemplates(true)
 {
 }
+
+TileMeshTemplate::TileMeshTemplate(int sampleX,int sampleY) :
+    sampleX(sampleX), sampleY(sampleY)
+{
+    fracX.resize(sampleX+1);
+    for (int ix=0;ix<=sampleX;ix++)
+        fracX[ix] = (double)ix / sampleX;
+    fracY.resize(sampleY+1);
+    for (int iy=0;iy<=sampleY;iy++)
+        fracY[iy] = (double)iy / sampleY;
+
+    const TexCoord texIncr(1.0/(float)sampleX,1.0/(float)sampleY);
+    texCoords.reserve((sampleX+1)*(sampleY+1));
+    for (int iy=0;iy<=sampleY;iy++)
+        for (int ix=0;ix<=sampleX;ix++)
+            texCoords.emplace_back(ix*texIncr.x(),1.0-(iy*texIncr.y()));
+
+    tris.reserve(2*sampleX*sampleY);
+    for (int iy=0;iy<sampleY;iy++)
+    {
+        for (int ix=0;ix<sampleX;ix++)
+        {
+            BasicDrawable::Triangle triA,triB;
+            triA.verts[0] = (iy+1)*(sampleX+1)+ix;
+            triA.verts[1] = iy*(sampleX+1)+ix;
+            triA.verts[2] = (iy+1)*(sampleX+1)+(ix+1);
+            triB.verts[0] = triA.verts[2];
+            triB.verts[1] = triA.verts[1];
+            triB.verts[2] = iy*(sampleX+1)+(ix+1);
+            tris.push_back(triA);
+            tris.push_back(triB);
+        }
+    }
+}
     
 LoadedTileNew::LoadedTileNew(const QuadTreeNew::ImportantNode &ident,const MbrD &mbr)
     : ident(ident), mbr(mbr), enabled(false),
@@ -203,6 +238,9 @@ void LoadedTileNew::makeDrawables(SceneRenderer *sceneRender,TileGeomManager *ge
                 chunk->addNormal(ptB_3D);
                 chunk->addTexCoord(-1,texCoord);
             }
+    } else if (geomSettings.useMeshTemplates && geomManage->coordAdapter->isFlat() &&
+               buildFromMeshTemplate(chunk,geomManage,chunkLL,chunkUR,sphereTessX,sphereTessY,texScale,chunkMidDisp)) {
+        // Flat tiles don't get skirts or poles, so that's it
     } else {
         chunk->setType(Triangles);
         // Generate point, texture coords, and normals
@@ -432,6 +470,80 @@ void LoadedTileNew::makeDrawables(SceneRenderer *sceneRender,TileGeomManager *ge
     }
 }
     
+bool LoadedTileNew::buildFromMeshTemplate(const BasicDrawableBuilderRef &chunk,TileGeomManager *geomManage,
+                                          const Point2d &chunkLL,const Point2d &chunkUR,
+                                          int sampleX,int sampleY,const Point2d &texScale,const Point3d &chunkMidDisp)
+{
+    CoordSystemDisplayAdapter *coordAdapter = geomManage->coordAdapter;
+    const CoordSystem *cs = geomManage->coordSys.get();
+    const CoordSystem *sceneCoordSys = coordAdapter->getCoordSystem();
+    const auto toDisplay = [&](double x,double y)
+    {
+        Point3d disp = coordAdapter->localToDisplay(CoordSystemConvert3d(cs,sceneCoordSys,Point3d(x,y,0.0)));
+        disp.z() = 0.0;
+        return disp;
+    };
+
+    // The grid is only a scaled copy if the display is linear in x and y across the tile.
+    // Check the other corners and the middle against what we'd get from ll and ur.
+    const Point3d dispLL = toDisplay(chunkLL.x(),chunkLL.y());
+    const Point3d dispUR = toDisplay(chunkUR.x(),chunkUR.y());
+    const Point3d dispSize = dispUR - dispLL;
+    const double tol = 1e-6 * std::max(dispSize.norm(),1e-12);
+    const Point3d checks[3][2] = {
+        { toDisplay(chunkUR.x(),chunkLL.y()), Point3d(dispUR.x(),dispLL.y(),0.0) },
+        { toDisplay(chunkLL.x(),chunkUR.y()), Point3d(dispLL.x(),dispUR.y(),0.0) },
+        { toDisplay((chunkLL.x()+chunkUR.x())/2.0,(chunkLL.y()+chunkUR.y())/2.0), (dispLL+dispUR)/2.0 },
+    };
+    for (const auto &check : checks)
+    {
+        if ((check[0] - check[1]).norm() > tol)
+            return false;
+    }
+
+    const TileMeshTemplate &meshTemplate = geomManage->getMeshTemplate(sampleX,sampleY);
+
+    chunk->setType(Triangles);
+
+    // Every normal is the same, so let the default take care of it rather than storing one per vertex
+    const Point3d norm3D = coordAdapter->normalForLocal(dispLL);
+    const BasicDrawableRef &basicDraw = chunk->basicDraw;
+    if (basicDraw->normalEntry >= 0)
+        basicDraw->vertexAttributes[basicDraw->normalEntry]->setDefaultVector3f(norm3D.cast<float>());
+
+    Point3fVector pts;
+    pts.reserve((sampleX+1)*(sampleY+1));
+    for (int iy=0;iy<=sampleY;iy++)
+    {
+        const double y = dispLL.y() + meshTemplate.fracY[iy] * dispSize.y() - chunkMidDisp.y();
+        for (int ix=0;ix<=sampleX;ix++)
+        {
+            const double x = dispLL.x() + meshTemplate.fracX[ix] * dispSize.x() - chunkMidDisp.x();
+            pts.emplace_back(x,y,-chunkMidDisp.z());
+        }
+    }
+    chunk->addPoints(pts.data(),pts.size());
+
+    if (texScale.x() == 1.0 && texScale.y() == 1.0)
+    {
+        chunk->addTexCoords(-1,meshTemplate.texCoords.data(),meshTemplate.texCoords.size());
+    }
+    else
+    {
+        // Clipped at the edge of the area, so the texture only covers part of it
+        std::vector<TexCoord> texCoords;
+        texCoords.reserve(meshTemplate.texCoords.size());
+        for (const auto &texCoord : meshTemplate.texCoords)
+            texCoords.emplace_back(texCoord.x() * texScale.x(),1.0 - (1.0 - texCoord.y()) * texScale.y());
+        chunk->addTexCoords(-1,texCoords.data(),texCoords.size());
+    }
+
+    for (const auto &tri : meshTemplate.tris)
+        chunk->addTriangle(tri);
+
+    return true;
+}
+
 void LoadedTileNew::buildSkirt(const BasicDrawableBuilderRef &draw,const Point3dVector &pts,
                                const std::vector<TexCoord> &texCoords,double skirtFactor,
                                bool haveElev,const Point3d &theCenter)
@@ -562,6 +674,14 @@ TileGeomManager::NodeChanges TileGeomManager::addRemoveTiles(
     return nodeChanges;
 }
 
+const TileMeshTemplate &TileGeomManager::getMeshTemplate(int sampleX,int sampleY)
+{
+    auto &meshTemplate = meshTemplates[std::make_pair(sampleX,sampleY)];
+    if (!meshTemplate)
+        meshTemplate = std::make_shared<TileMeshTemplate>(sampleX,sampleY);
+    return *meshTemplate;
+}
+
 void TileGeomManager::cleanup(ChangeSet &changes)
 {
     for (const auto &tileInst: tileMap) {
@@ -19,20 +19,59 @@
 */
 
 #import "MapboxVectorFilter.h"
+#import "DictionaryC.h"
 #import "MapboxVectorStyleSetC.h"
+#import "VectorTilePBFParser.h"
 #import "WhirlyKitLog.h"
+#import <typeinfo>
 
 namespace WhirlyKit
 {
 
-MapboxVectorFilter::MapboxVectorFilter()
+MapboxVectorFilter::MapboxVectorFilter() :
+    filterType(MBFilterNone),
+    geomType(MBGeomNone)
 {
 }
 
 static const char * const filterTypes[] = {"==","!=",">",">=","<","<=","in","!in","has","!has","all","any","none"};
 static const char * const geomTypes[] = {"Point","LineString","Polygon"};
 
+// Numeric form of a string value, if the whole thing is a number
+static bool NumberFromString(const std::string &str,double &num)
+{
+    if (str.empty())
+    {
+        return false;
+    }
+    char *endp = nullptr;
+    num = strtod(str.c_str(),&endp);
+    return endp && *endp == '\0';
+}
+
+// String form of a numeric value, the shortest one that reads back the same
+static std::string StringFromNumber(double num)
+{
+    char buf[32];
+    snprintf(buf,sizeof(buf),"%.15g",num);
+    if (strtod(buf,nullptr) != num)
+    {
+        snprintf(buf,sizeof(buf),"%.17g",num);
+    }
+    return buf;
+}
+
 bool MapboxVectorFilter::parse(const std::vector<DictionaryEntryRef> &filterArray,MapboxVectorStyleSetImpl *styleSet)
+{
+    const bool ret = parseFilter(filterArray, styleSet);
+
+    // Compile whatever we got, even if it was partly bad.  That's what we'd have evaluated.
+    compile();
+
+    return ret;
+}
+
+bool MapboxVectorFilter::parseFilter(const std::vector<DictionaryEntryRef> &filterArray,MapboxVectorStyleSetImpl *styleSet)
 {
     if (filterArray.empty()) {
         wkLogLevel(Warn, "Expecting array for filter");
@@ -102,7 +141,7 @@ bool MapboxVectorFilter::parse(const std::vector<DictionaryEntryRef> &filterArra
         for (unsigned int ii=1;ii<filterArray.size();ii++)
         {
             const auto subFilter = std::make_shared<MapboxVectorFilter>();
-            if (!subFilter->parse(filterArray[ii]->getArray(), styleSet))
+            if (!subFilter->parseFilter(filterArray[ii]->getArray(), styleSet))
                 return false;
             subFilters.push_back(subFilter);
         }
@@ -113,92 +152,328 @@ bool MapboxVectorFilter::parse(const std::vector<DictionaryEntryRef> &filterArra
 
 namespace {
     const static std::string geometryType("geometry_type");
+
+    // An attribute value pulled out of a feature.
+    // Strings point into the dictionary when they can, so be done with it before the next lookup.
+    struct FilterValue
+    {
+        DictionaryType type = DictTypeNone;
+        double num = 0.0;
+        const std::string *str = nullptr;
+    };
+
+    // Attribute lookup for the vector tile parser's lazy dictionaries, by ID and without copies
+    struct LazyLookup
+    {
+        LazyLookup(const VectorTileFeatureDictionary &dict) : dict(dict) { }
+
+        bool find(const std::string &,StringIdentity attrID,FilterValue &val) const
+        {
+            VectorTileFeatureDictionary::ValueRef ref;
+            if (!dict.findValueByID(attrID, ref))
+                return false;
+            val.type = ref.type;
+            val.num = (ref.type == DictTypeInt) ? ref.intVal : ref.doubleVal;
+            val.str = ref.stringVal;
+            return true;
+        }
+
+        bool has(const std::string &,StringIdentity attrID) const
+        {
+            VectorTileFeatureDictionary::ValueRef ref;
+            return dict.findValueByID(attrID, ref);
+        }
+
+        const VectorTileFeatureDictionary &dict;
+    };
+
+    // Attribute lookup for regular dictionaries, one search and no copies
+    struct EagerLookup
+    {
+        EagerLookup(const MutableDictionaryC &dict) : dict(dict) { }
+
+        bool find(const std::string &attrName,StringIdentity,FilterValue &val) const
+        {
+            MutableDictionaryC::ValueRef ref;
+            if (!dict.findValue(attrName, ref))
+                return false;
+            val.type = ref.type;
+            val.num = ref.num;
+            val.str = ref.str;
+            return true;
+        }
+
+        bool has(const std::string &attrName,StringIdentity) const
+        {
+            return dict.hasField(attrName);
+        }
+
+        const MutableDictionaryC &dict;
+    };
+
+    // Attribute lookup for any other dictionary, by name
+    struct DictLookup
+    {
+        DictLookup(const Dictionary &dict) : dict(dict) { }
+
+        bool find(const std::string &attrName,StringIdentity,FilterValue &val) const
+        {
+            val.type = dict.getType(attrName);
+            switch (val.type)
+            {
+                case DictTypeNone:
+                    return false;
+                case DictTypeString:
+                    str = dict.getString(attrName);
+                    val.str = &str;
+                    break;
+                case DictTypeInt:
+                case DictTypeDouble:
+                    val.num = dict.getDouble(attrName);
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        bool has(const std::string &attrName,StringIdentity) const
+        {
+            return dict.hasField(attrName);
+        }
+
+        const Dictionary &dict;
+        mutable std::string str;
+    };
 }
 
-bool MapboxVectorFilter::testFeature(const Dictionary &attrs,const QuadTreeIdentifier &tileID)
+void MapboxVectorFilter::compile()
 {
-    // Compare geometry type
-    if (geomType != MBGeomNone)
+    program.clear();
+    compileNode(*this);
+}
+
+void MapboxVectorFilter::compileNode(const MapboxVectorFilter &node)
+{
+    const unsigned int which = program.size();
+    program.emplace_back();
+    {
+        Instruction &inst = program.back();
+        inst.filterType = node.filterType;
+        // Only the comparisons look at an attribute.  All, any and none have no name to intern.
+        if (node.filterType != MBFilterAll && node.filterType != MBFilterAny && node.filterType != MBFilterNone)
+        {
+            // Only equality looks at the geometry type, the rest compare against "$type"
+            const bool isGeomType = (node.filterType == MBFilterEqual || node.filterType == MBFilterNotEqual) &&
+                                    node.geomType != MBGeomNone;
+            inst.attrName = isGeomType ? geometryType : node.attrName;
+            inst.attrID = StringIndexer::getStringID(inst.attrName);
+        }
+
+        switch (node.filterType)
+        {
+            case MBFilterEqual:
+            case MBFilterNotEqual:
+                inst.geomType = node.geomType;
+                // fall through
+            case MBFilterGreaterThan:
+            case MBFilterGreaterThanEqual:
+            case MBFilterLessThan:
+            case MBFilterLessThanEqual:
+                // Strings are compared as strings and everything else as numbers
+                if (node.attrVal)
+                {
+                    inst.strVal = node.attrVal->getString();
+                    // Parse string values quietly, most of them aren't numbers and that's fine
+                    inst.numVal = (node.attrVal->getType() == DictTypeString) ? strtod(inst.strVal.c_str(),nullptr) :
+                                                                                 node.attrVal->getDouble();
+                }
+                break;
+            case MBFilterIn:
+            case MBFilterNotIn:
+                // Values are matched across types, so each one goes in both sets if it can
+                for (const auto &val : node.attrVals)
+                {
+                    switch (val->getType())
+                    {
+                        case DictTypeString:
+                        {
+                            const std::string str = val->getString();
+                            inst.strVals.insert(str);
+                            double num;
+                            if (NumberFromString(str,num))
+                            {
+                                inst.numVals.insert(num);
+                            }
+                            break;
+                        }
+                        case DictTypeInt:
+                        case DictTypeInt64:
+                        case DictTypeDouble:
+                            inst.numVals.insert(val->getDouble());
+                            inst.strVals.insert(StringFromNumber(val->getDouble()));
+                            break;
+                        default:
+                            wkLogLevel(Warn,"MapboxVectorFilter: Unsupported value type %d for '%s' in filter",
+                                       val->getType(), node.attrName.c_str());
+                            break;
+                    }
+                }
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (node.filterType == MBFilterAll || node.filterType == MBFilterAny)
     {
-        const int attrGeomType = attrs.getInt(geometryType) - 1;
-        switch (filterType)
+        for (const auto &subFilter : node.subFilters)
         {
-            case MBFilterEqual:    return attrGeomType == geomType;
-            case MBFilterNotEqual: return attrGeomType != geomType;
-            default: break;
+            compileNode(*subFilter);
         }
     }
 
-    switch (filterType) {
+    // The vector may have moved
+    program[which].end = program.size();
+}
+
+template <typename Lookup>
+bool MapboxVectorFilter::run(const Lookup &lookup,unsigned int which,const QuadTreeIdentifier &tileID) const
+{
+    const Instruction &inst = program[which];
+
+    // Compare geometry type
+    if (inst.geomType != MBGeomNone)
+    {
+        FilterValue val;
+        const bool found = lookup.find(inst.attrName, inst.attrID, val) &&
+                           (val.type == DictTypeInt || val.type == DictTypeDouble);
+        const int attrGeomType = (found ? (int)val.num : 0) - 1;
+        return (attrGeomType == inst.geomType) == (inst.filterType == MBFilterEqual);
+    }
+
+    switch (inst.filterType)
+    {
     // Run each of the rules as either AND or OR
     case MBFilterAll:
-        for (const auto &filter : subFilters) {
-            if (!filter->testFeature(attrs, tileID)) {
+        for (unsigned int child = which+1; child < inst.end; child = program[child].end)
+        {
+            if (!run(lookup, child, tileID))
+            {
                 return false;
             }
         }
         return true;
     case MBFilterAny:
-        for (const auto &filter : subFilters) {
-            if (filter->testFeature(attrs, tileID)) {
+        for (unsigned int child = which+1; child < inst.end; child = program[child].end)
+        {
+            if (run(lookup, child, tileID))
+            {
                 return true;
             }
         }
         return false;
     case MBFilterIn:
     case MBFilterNotIn:
-        // Check for attribute value membership
-        // Note: Not dealing with differing types well
-        if (const auto featAttrVal = attrs.getEntry(attrName)) {
-            for (const auto &match : attrVals) {
-                if (match->isEqual(featAttrVal)) {
-                    return (filterType == MBFilterIn);
+        {
+            // Check for attribute value membership
+            bool match = false;
+            FilterValue val;
+            if (lookup.find(inst.attrName, inst.attrID, val))
+            {
+                switch (val.type)
+                {
+                    case DictTypeString:
+                        match = val.str && inst.strVals.find(*val.str) != inst.strVals.end();
+                        break;
+                    case DictTypeInt:
+                    case DictTypeDouble:
+                        match = inst.numVals.find(val.num) != inst.numVals.end();
+                        break;
+                    default:
+                        break;
                 }
             }
+            return match == (inst.filterType == MBFilterIn);
         }
-        return (filterType != MBFilterIn);
     case MBFilterHas:
         // Check for attribute existence
-        return attrs.hasField(attrName);
+        return lookup.has(inst.attrName, inst.attrID);
     case MBFilterNotHas:
         // Check for attribute non-existence
-        return !attrs.hasField(attrName);
+        return !lookup.has(inst.attrName, inst.attrID);
+    case MBFilterNone:
+        return false;
     default:
-        // Equality related operators
-        if (auto featAttrVal = attrs.getEntry(attrName)) {
-            switch (featAttrVal->getType()) {
-            case DictTypeString:
-                switch (filterType) {
-                    case MBFilterEqual:    return  featAttrVal->isEqual(attrVal);
-                    case MBFilterNotEqual: return !featAttrVal->isEqual(attrVal);
-                    default: return true;  // Note: Not expecting other comparisons to strings
-                }
-            case DictTypeInt:
-            case DictTypeDouble:
-                {
-                const double val1 = featAttrVal->getDouble();
-                const double val2 = attrVal->getDouble();
-                switch (filterType)
+        {
+            // Equality related operators
+            FilterValue val;
+            if (lookup.find(inst.attrName, inst.attrID, val))
+            {
+                switch (val.type)
                 {
-                    case MBFilterEqual:            return val1 == val2;
-                    case MBFilterNotEqual:         return val1 != val2;
-                    case MBFilterGreaterThan:      return val1 > val2;
-                    case MBFilterGreaterThanEqual: return val1 >= val2;
-                    case MBFilterLessThan:         return val1 < val2;
-                    case MBFilterLessThanEqual:    return val1 <= val2;
-                    default: return true;
+                case DictTypeString:
+                    {
+                    const bool equal = val.str && *val.str == inst.strVal;
+                    switch (inst.filterType)
+                    {
+                        case MBFilterEqual:    return  equal;
+                        case MBFilterNotEqual: return !equal;
+                        default: return true;  // Note: Not expecting other comparisons to strings
+                    }
+                    }
+                case DictTypeInt:
+                case DictTypeDouble:
+                    {
+                    const double val1 = val.num;
+                    const double val2 = inst.numVal;
+                    switch (inst.filterType)
+                    {
+                        case MBFilterEqual:            return val1 == val2;
+                        case MBFilterNotEqual:         return val1 != val2;
+                        case MBFilterGreaterThan:      return val1 > val2;
+                        case MBFilterGreaterThanEqual: return val1 >= val2;
+                        case MBFilterLessThan:         return val1 < val2;
+                        case MBFilterLessThanEqual:    return val1 <= val2;
+                        default: return true;
+                    }
+                    }
+                default:
+                    wkLogLevel(Warn,"MapboxVectorFilter: Found numeric comparison that doesn't use numbers - '%s', %d/%d/%d",
+                               inst.attrName.c_str(), tileID.level, tileID.x, tileID.y);
+                    return true;
                 }
             }
-            default:
-                wkLogLevel(Warn,"MapboxVectorFilter: Found numeric comparison that doesn't use numbers - '%s', %d/%d/%d",
-                           attrName.c_str(), tileID.level, tileID.x, tileID.y);
-                return true;
-            }
+            // No attribute means no pass
+            // A missing value and != is valid
+            return (inst.filterType == MBFilterNotEqual);
         }
-        // No attribute means no pass
-        // A missing value and != is valid
-        return (filterType == MBFilterNotEqual);
     }
 }
 
+bool MapboxVectorFilter::testFeature(const Dictionary &attrs,const QuadTreeIdentifier &tileID) const
+{
+    if (program.empty())
+    {
+        return false;
+    }
+
+    // The parser's lazy dictionaries can be searched by ID, as long as nobody's changed them.
+    // Neither dictionary class has subclasses, so comparing the type is enough and it's cheaper than a cast.
+    const std::type_info &attrsType = typeid(attrs);
+    if (attrsType == typeid(VectorTileFeatureDictionary))
+    {
+        const auto &lazyAttrs = static_cast<const VectorTileFeatureDictionary &>(attrs);
+        if (!lazyAttrs.isModified())
+        {
+            return run(LazyLookup(lazyAttrs), 0, tileID);
+        }
+    }
+    else if (attrsType == typeid(MutableDictionaryC))
+    {
+        return run(EagerLookup(static_cast<const MutableDictionaryC &>(attrs)), 0, tileID);
+    }
+    return run(DictLookup(attrs), 0, tileID);
+}
+
 }
@@ -141,18 +141,23 @@ void MapboxVectorLayerFill::buildObjects(PlatformThreadInfo *inst,
                 auto coordAdapter = scene->getCoordAdapter();
                 auto coordSys = coordAdapter->getCoordSystem();
 
-                // Convert to local to make tessellation work better (#1392)
-                for (auto &loop : ar->loops)
+                // Convert to local to make tessellation work better (#1392).
+                // Other styles share the feature, so convert a copy.
+                std::vector<VectorRing> localLoops(ar->loops.size());
+                for (size_t ii=0;ii<ar->loops.size();ii++)
                 {
-                    for (auto &pt : loop)
+                    const auto &loop = ar->loops[ii];
+                    auto &localLoop = localLoops[ii];
+                    localLoop.reserve(loop.size());
+                    for (const auto &pt : loop)
                     {
-                        pt = coordSys->geographicToLocal2(pt.cast<double>()).cast<float>();
+                        localLoop.push_back(coordSys->geographicToLocal2(pt.cast<double>()).cast<float>());
                     }
                 }
 
                 const auto trisRef = VectorTriangles::createTriangles();
                 trisRef->localCoords = true;
-                TesselateLoops(ar->loops, trisRef);
+                TesselateLoops(localLoops, trisRef);
                 trisRef->setAttrDict(ar->getAttrDict());
 
                 // Generate MBR in local, that's what the builders will expect when we've
@@ -173,15 +178,16 @@ void MapboxVectorLayerFill::buildObjects(PlatformThreadInfo *inst,
             resolveMode = MBResolveColorOpacityMultiply;
         }
 #endif
-        if (const auto color = MapboxVectorStyleSetImpl::resolveColor(paint.color, paint.opacity,
-                                                                      tileInfo->ident.level, resolveMode))
+        RGBAColor color;
+        if (MapboxVectorStyleSetImpl::resolveColor(paint.color, paint.opacity,
+                                                   tileInfo->ident.level, resolveMode, color))
         {
             // Set up the description for constructing vectors
             VectorInfo vecInfo;
             vecInfo.hasExp = true;
             vecInfo.filled = true;
             vecInfo.centered = true;
-            vecInfo.color = *color;
+            vecInfo.color = color;
             vecInfo.zoomSlot = styleSet->zoomSlot;
             vecInfo.zBufferWrite = styleSet->tileStyleSettings->zBufferWrite;
             vecInfo.zBufferRead = styleSet->tileStyleSettings->zBufferRead;
@@ -200,7 +206,7 @@ void MapboxVectorLayerFill::buildObjects(PlatformThreadInfo *inst,
                 vecInfo.maxZoomVis = maxzoom;
             }
 
-            //wkLogLevel(Debug, "Color: %s %d %d %d %d",ident.c_str(),(int)color->r,(int)color->g,(int)color->b,(int)color->a);
+            //wkLogLevel(Debug, "Color: %s %d %d %d %d",ident.c_str(),(int)color.r,(int)color.g,(int)color.b,(int)color.a);
 
             const SimpleIdentity vecID = styleSet->vecManage->addVectors(&tessShapes, vecInfo, tileInfo->changes);
             if (vecID != EmptyIdentity)
@@ -219,9 +225,10 @@ void MapboxVectorLayerFill::buildObjects(PlatformThreadInfo *inst,
     // Outlines
     if (paint.outlineColor)
     {
-        if (const auto color = WhirlyKit::MapboxVectorStyleSetImpl::resolveColor(
+        RGBAColor color;
+        if (WhirlyKit::MapboxVectorStyleSetImpl::resolveColor(
                 paint.outlineColor, paint.opacity,
-                tileInfo->ident.level, MBResolveColorOpacityComposeAlpha))
+                tileInfo->ident.level, MBResolveColorOpacityComposeAlpha, color))
         {
             // Set up the description for constructing vectors
             VectorInfo vecInfo;
@@ -231,7 +238,7 @@ void MapboxVectorLayerFill::buildObjects(PlatformThreadInfo *inst,
             vecInfo.colorExp = paint.outlineColor->expression();
             vecInfo.opacityExp = paint.opacity->expression();
             vecInfo.programID = (arealShaderID != EmptyIdentity) ? arealShaderID : styleSet->vectorArealProgramID;
-            vecInfo.color = *color;
+            vecInfo.color = color;
             vecInfo.zoomSlot = styleSet->zoomSlot;
             vecInfo.drawPriority = drawPriority + tileInfo->ident.level * std::max(0, styleSet->tileStyleSettings->drawPriorityPerLevel) + 1;
             vecInfo.drawOrder = tileInfo->tileNumber();
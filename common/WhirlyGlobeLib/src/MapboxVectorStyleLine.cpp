@@ -140,8 +140,6 @@ MapboxVectorStyleLayer& MapboxVectorLayerLine::copy(const MapboxVectorStyleLayer
     return *this;
 }
 
-static const std::string colorStr = "color"; // NOLINT(cert-err58-cpp)   constructor can throw
-
 static WideVectorLineJoinType convertJoin(MapboxVectorLineJoin join)
 {
     switch (join)
@@ -204,6 +202,11 @@ void MapboxVectorLayerLine::buildObjects(PlatformThreadInfo *inst,
         }
         if (newVecObj)
         {
+            // Subdividing works in place, and other styles share the feature
+            if (subdivToGlobe > 0.0 && newVecObj == vecObj)
+            {
+                newVecObj = vecObj->deepCopy();
+            }
             vecObjs.push_back(newVecObj);
         }
     }
@@ -211,14 +214,10 @@ void MapboxVectorLayerLine::buildObjects(PlatformThreadInfo *inst,
     // Subdivide long-ish lines to the globe, if set
     if (subdivToGlobe > 0.0)
     {
-        std::vector<VectorObjectRef> newVecObjs;
-        newVecObjs.reserve(3 * vecObjs.size());
         for (const auto &vecObj : vecObjs)
         {
             vecObj->subdivideToGlobe((float)subdivToGlobe);
-            newVecObjs.push_back(vecObj);
         }
-        vecObjs = newVecObjs;
     }
     
     // If we have a filled texture, we'll use that
@@ -239,12 +238,13 @@ void MapboxVectorLayerLine::buildObjects(PlatformThreadInfo *inst,
     }
 #endif
 
-    const RGBAColorRef color = MapboxVectorStyleSetImpl::resolveColor(paint.color, paint.opacity, tileInfo->ident.level, resolveMode);
+    RGBAColor color;
+    const bool hasColor = MapboxVectorStyleSetImpl::resolveColor(paint.color, paint.opacity, tileInfo->ident.level, resolveMode, color);
 
     const double width = paint.width->valForZoom(tileInfo->ident.level) * lineScale;
     const double offset = paint.offset->valForZoom(tileInfo->ident.level) * lineScale;
     
-    if (!color || width <= 0.0)
+    if (!hasColor || width <= 0.0)
     {
         return;
     }
@@ -254,7 +254,7 @@ void MapboxVectorLayerLine::buildObjects(PlatformThreadInfo *inst,
     vecInfo.fadeIn = fade;
     vecInfo.fadeOut = fade;
     vecInfo.zoomSlot = styleSet->zoomSlot;
-    vecInfo.color = *color;
+    vecInfo.color = color;
     vecInfo.width = (float)width;
     vecInfo.offset = (float)-offset;
     vecInfo.joinType = layout.joinSet ? convertJoin(layout.join) : WideVecMiterSimpleJoin;
@@ -307,7 +307,8 @@ void MapboxVectorLayerLine::buildObjects(PlatformThreadInfo *inst,
     auto const capacity = inVecObjs.size() * 5;  // ?
     std::unordered_map<std::string,ShapeRefVec> shapesByUUID(capacity);
 
-    const bool colorOverride = styleSet->tileStyleSettings->enableOverrideColor;
+    // Individual vector objects may not be allowed to override the color
+    vecInfo.colorOverride = styleSet->tileStyleSettings->enableOverrideColor;
 
     // Gather all the linear features
     for (const auto &vecObj : vecObjs)
@@ -331,12 +332,6 @@ void MapboxVectorLayerLine::buildObjects(PlatformThreadInfo *inst,
         if (shapes.empty())
             shapes.reserve(shapes.size() + vecObj->shapes.size());
         std::copy(vecObj->shapes.begin(),vecObj->shapes.end(),std::back_inserter(shapes));
-
-        // If individual vector objects aren't allowed to override colors, drop the color attribute.
-        if (!colorOverride)
-        {
-            attrs->removeField(colorStr);
-        }
     }
 
     for (const auto &kvp : shapesByUUID)
@@ -23,6 +23,8 @@
 #import "MapboxVectorStyleBackground.h"
 #import "MapboxVectorStyleLine.h"
 #import "MapboxVectorStyleSymbol.h"
+#import "VectorTilePBFParser.h"
+#import <algorithm>
 #import <regex>
 
 namespace WhirlyKit
@@ -70,6 +72,9 @@ bool MapboxRegexField::parse(const std::string &textField)
                 regexChunk[index] = '_';
                 textChunk.keys.emplace_back(std::move(regexChunk));
             }
+            for (const auto &key : textChunk.keys) {
+                textChunk.keyIDs.push_back(StringIndexer::getStringID(key));
+            }
         }
         chunks.emplace_back(std::move(textChunk));
         isJustText = !isJustText;
@@ -106,6 +111,31 @@ static void trim(std::string &s)
     }
 }
 
+// Append the value for a key straight out of the tile's tables.  True if we added something.
+static bool appendValueByID(const VectorTileFeatureDictionary &attrs,StringIdentity keyID,std::string &text,bool &found)
+{
+    VectorTileFeatureDictionary::ValueRef val;
+    if (!attrs.findValueByID(keyID, val))
+        return false;
+    found = true;
+    switch (val.type)
+    {
+        case DictTypeString:
+            if (val.stringVal->empty())
+                return false;
+            text += *val.stringVal;
+            return true;
+        case DictTypeInt:
+            text += std::to_string(val.intVal);
+            return true;
+        case DictTypeDouble:
+            text += std::to_string(val.doubleVal);
+            return true;
+        default:
+            return false;
+    }
+}
+
 std::string MapboxRegexField::build(const DictionaryRef &attrs) const
 {
     bool found = false;
@@ -114,12 +144,25 @@ std::string MapboxRegexField::build(const DictionaryRef &attrs) const
     std::string text;
     text.reserve(chunks.size() * 20);
 
+    // The parser's lazy dictionaries can be searched by ID without copying the strings out
+    const auto lazyAttrs = dynamic_cast<const VectorTileFeatureDictionary *>(attrs.get());
+    const bool byID = lazyAttrs && !lazyAttrs->isModified();
+
     std::string keyVal;
     for (const auto &chunk : chunks) {
         if (!chunk.str.empty()) {
             text += chunk.str;
             continue;
         }
+        if (byID && chunk.keyIDs.size() == chunk.keys.size()) {
+            didLookup = didLookup || !chunk.keyIDs.empty();
+            for (const auto keyID : chunk.keyIDs) {
+                if (appendValueByID(*lazyAttrs, keyID, text, found)) {
+                    break;
+                }
+            }
+            continue;
+        }
         for (const auto &key : chunk.keys) {
             didLookup = true;
             if (attrs->hasField(key)) {
@@ -166,6 +209,12 @@ MaplyVectorFunctionStop::MaplyVectorFunctionStop()
 {
 }
 
+MaplyVectorFunctionStops::MaplyVectorFunctionStops() :
+    base(1.0),
+    constVal(false)
+{
+}
+
 bool MaplyVectorFunctionStops::parse(const DictionaryRef &entry,bool isText)
 {
     base = entry->getDouble(strBase,1.0);
@@ -176,16 +225,21 @@ bool MaplyVectorFunctionStops::parse(const DictionaryRef &entry,bool isText)
         wkLogLevel(Warn, "Expecting at least two arguments for function stops.");
         return false;
     }
+    bool ok = true;
+    bool sorted = true;
     for (const auto &stop : dataArray) {
         if (stop->getType() == DictTypeArray) {
             const std::vector<DictionaryEntryRef> stopEntries = stop->getArray();
             if (stopEntries.size() != 2) {
                 wkLogLevel(Warn,"Expecting two arguments in each entry for a function stop.");
-                return false;
+                ok = false;
+                break;
             }
 
             MaplyVectorFunctionStop fStop;
             fStop.zoom = stopEntries[0]->getDouble();
+            if (!stops.empty() && fStop.zoom < stops.back().zoom)
+                sorted = false;
             if (stopEntries[1]->getType() == DictTypeDouble || stopEntries[1]->getType() == DictTypeInt) {
                 fStop.val = stopEntries[1]->getDouble();
             } else {
@@ -203,76 +257,159 @@ bool MaplyVectorFunctionStops::parse(const DictionaryRef &entry,bool isText)
                         break;
                     default:
                         wkLogLevel(Warn, "Expecting color compatible object in function stop.");
-                        return false;
+                        ok = false;
+                        break;
                 }
+                if (!ok)
+                    break;
             }
             
             stops.push_back(fStop);
         } else {
             wkLogLevel(Warn, "Expecting arrays in the function stops.");
-            return false;
+            ok = false;
+            break;
         }
     }
 
-    return true;
+    // The lookups assume ascending zoom, so put them in order rather than give up on the style.
+    // Stable, so stops at the same zoom keep their order.
+    if (!sorted)
+    {
+        wkLogLevel(Warn, "Function stops aren't in ascending zoom order, sorting them.");
+        // The stops can't be assigned, so sort their indices and copy them over in that order
+        std::vector<unsigned int> order(stops.size());
+        for (unsigned int ii=0;ii<order.size();ii++)
+            order[ii] = ii;
+        std::stable_sort(order.begin(),order.end(),
+                         [this](unsigned int a,unsigned int b) { return stops[a].zoom < stops[b].zoom; });
+        std::vector<MaplyVectorFunctionStop> sortedStops;
+        sortedStops.reserve(stops.size());
+        for (unsigned int which : order)
+            sortedStops.push_back(stops[which]);
+        stops.swap(sortedStops);
+    }
+
+    // Some callers use the stops even if they didn't parse completely
+    compile();
+
+    return ok;
 }
 
-double MaplyVectorFunctionStops::valueForZoom(double zoom)
+void MaplyVectorFunctionStops::compile()
 {
-    const MaplyVectorFunctionStop *a = &stops[0];
-    const MaplyVectorFunctionStop *b = nullptr;
-    if (zoom <= a->zoom)
-        return a->val;
-    for (int which = 1;which < stops.size(); which++)
+    segScale.resize(stops.size());
+    for (unsigned int ii=0;ii+1<stops.size();ii++)
     {
-        b = &stops[which];
-        if (a->zoom <= zoom && zoom < b->zoom)
-        {
-            double ratio;
-            if (base == 1.0) {
-                ratio = (zoom-a->zoom)/(b->zoom-a->zoom);
-            } else {
-                const double soFar = zoom-a->zoom;
-                ratio = (pow(base, soFar) - 1.0) / (pow(base,b->zoom-a->zoom) - 1.0);
-            }
-            return ratio * (b->val-a->val) + a->val;
-        }
-        a = b;
+        const double span = stops[ii+1].zoom - stops[ii].zoom;
+        segScale[ii] = (base == 1.0) ? 1.0 / span : 1.0 / (pow(base,span) - 1.0);
+    }
+
+    stopColors.clear();
+    const bool hasColors = std::any_of(stops.begin(),stops.end(),
+                                       [](const MaplyVectorFunctionStop &stop) { return stop.color != nullptr; });
+    if (hasColors)
+    {
+        stopColors.resize(stops.size());
+        for (unsigned int ii=0;ii<stops.size();ii++)
+            (stops[ii].color ? *stops[ii].color : RGBAColor::clear()).asUnitFloats(stopColors[ii].data());
+    }
+
+    constVal = !stops.empty() && !hasColors &&
+               std::all_of(stops.begin(),stops.end(),
+                           [&](const MaplyVectorFunctionStop &stop) { return stop.val == stops[0].val; });
+
+    levelVals.clear();
+    levelColors.clear();
+    if (stops.empty())
+        return;
+    levelVals.resize(MaxTableLevel+1);
+    for (int level=0;level<=MaxTableLevel;level++)
+        levelVals[level] = calcValue(level);
+    if (hasColors)
+    {
+        levelColors.resize(MaxTableLevel+1);
+        for (int level=0;level<=MaxTableLevel;level++)
+            levelColors[level] = calcColor(level);
     }
+}
 
-    return b ? b->val : 0;
+bool MaplyVectorFunctionStops::findSegment(double zoom,unsigned int &which,double &ratio) const
+{
+    if (zoom <= stops[0].zoom)
+    {
+        which = 0;
+        return false;
+    }
+    // First stop past the zoom, so we're between that and the one before
+    const auto it = std::upper_bound(stops.begin(),stops.end(),zoom,
+                                     [](double z,const MaplyVectorFunctionStop &stop) { return z < stop.zoom; });
+    if (it == stops.end())
+    {
+        which = (unsigned int)stops.size()-1;
+        return false;
+    }
+    which = (unsigned int)(it - stops.begin()) - 1;
+
+    const double soFar = zoom - stops[which].zoom;
+    ratio = (base == 1.0) ? soFar * segScale[which] : (pow(base,soFar) - 1.0) * segScale[which];
+    return true;
 }
 
-RGBAColorRef MaplyVectorFunctionStops::colorForZoom(double zoom)
+double MaplyVectorFunctionStops::calcValue(double zoom) const
 {
-    const MaplyVectorFunctionStop *a = &stops[0];
-    const MaplyVectorFunctionStop *b = nullptr;
-    if (zoom <= a->zoom)
-        return a->color;
-    for (int which = 1;which < stops.size(); which++)
+    unsigned int which;
+    double ratio;
+    if (!findSegment(zoom,which,ratio))
+        return stops[which].val;
+
+    const MaplyVectorFunctionStop &a = stops[which], &b = stops[which+1];
+    return ratio * (b.val-a.val) + a.val;
+}
+
+RGBAColor MaplyVectorFunctionStops::calcColor(double zoom) const
+{
+    unsigned int which;
+    double ratio;
+    if (!findSegment(zoom,which,ratio))
+        return RGBAColor::FromUnitFloats(stopColors[which].data());
+
+    const auto &ac = stopColors[which], &bc = stopColors[which+1];
+    float res[4];
+    for (unsigned int ii=0;ii<4;ii++)
+        res[ii] = (float)ratio * (bc[ii]-ac[ii]) + ac[ii];
+    return RGBAColor::FromUnitFloats(res);
+}
+
+double MaplyVectorFunctionStops::valueForZoom(double zoom) const
+{
+    if (constVal)
+        return stops[0].val;
+    if (zoom >= 0 && zoom <= MaxTableLevel && !levelVals.empty())
     {
-        b = &stops[which];
-        if (a->zoom <= zoom && zoom < b->zoom)
-        {
-            double ratio;
-            if (base == 1.0) {
-                ratio = (zoom-a->zoom)/(b->zoom-a->zoom);
-            } else {
-                const double soFar = zoom-a->zoom;
-                ratio = (pow(base, soFar) - 1.0) / (pow(base,b->zoom-a->zoom) - 1.0);
-            }
-            float ac[4],bc[4];
-            a->color->asUnitFloats(ac);
-            b->color->asUnitFloats(bc);
-            float res[4];
-            for (unsigned int ii=0;ii<4;ii++)
-                res[ii] = (float)ratio * (bc[ii]-ac[ii]) + ac[ii];
-            return std::make_shared<RGBAColor>(RGBAColor::FromUnitFloats(res));
-        }
-        a = b;
+        const int level = (int)zoom;
+        if (level == zoom)
+            return levelVals[level];
     }
+    return stops.empty() ? 0.0 : calcValue(zoom);
+}
 
-    return b ? b->color : RGBAColorRef();
+RGBAColor MaplyVectorFunctionStops::colorValueForZoom(double zoom) const
+{
+    if (stopColors.empty())
+        return RGBAColor::clear();
+    if (zoom >= 0 && zoom <= MaxTableLevel)
+    {
+        const int level = (int)zoom;
+        if (level == zoom)
+            return levelColors[level];
+    }
+    return calcColor(zoom);
+}
+
+RGBAColorRef MaplyVectorFunctionStops::colorForZoom(double zoom) const
+{
+    return stopColors.empty() ? RGBAColorRef() : std::make_shared<RGBAColor>(colorValueForZoom(zoom));
 }
 
 MapboxRegexField MaplyVectorFunctionStops::textForZoom(double zoom)
@@ -327,11 +464,6 @@ MapboxTransDouble::MapboxTransDouble(MaplyVectorFunctionStopsRef inStops)
     stops = std::move(inStops);
 }
 
-double MapboxTransDouble::valForZoom(double zoom)
-{
-    return stops ? stops->valueForZoom(zoom) : val;
-}
-
 bool MapboxTransDouble::isExpression()
 {
     return stops.get() != nullptr;
@@ -387,9 +519,9 @@ void MapboxTransColor::setAlphaOverride(double alphaOverride)
     alpha = alphaOverride;
 }
 
-RGBAColor MapboxTransColor::colorForZoom(double zoom)
+RGBAColor MapboxTransColor::colorForZoom(double zoom) const
 {
-    RGBAColor theColor = *(stops ? stops->colorForZoom(zoom) : color);
+    RGBAColor theColor = stops ? stops->colorValueForZoom(zoom) : *color;
 
     if (useAlphaOverride)
     {
@@ -920,16 +1052,25 @@ void MapboxVectorStyleSetImpl::unsupportedCheck(const char *field,const char *wh
 }
 
 RGBAColorRef MapboxVectorStyleSetImpl::resolveColor(const MapboxTransColorRef &color,const MapboxTransDoubleRef &opacity,double zoom,MBResolveColorType resolveMode)
+{
+    RGBAColor theColor;
+    return resolveColor(color,opacity,zoom,resolveMode,theColor) ? std::make_shared<RGBAColor>(theColor) : RGBAColorRef();
+}
+
+bool MapboxVectorStyleSetImpl::resolveColor(const MapboxTransColorRef &color,const MapboxTransDoubleRef &opacity,double zoom,MBResolveColorType resolveMode,RGBAColor &outColor)
 {
     // No color means no color
     if (!color)
-        return RGBAColorRef();
+        return false;
 
     const RGBAColor thisColor = color->colorForZoom(zoom);
 
     // No opacity means full opacity
     if (!opacity || color->hasAlphaOverride())
-        return std::make_shared<RGBAColor>(thisColor);
+    {
+        outColor = thisColor;
+        return true;
+    }
 
     const float thisOpacity = (float)opacity->valForZoom(zoom) * 255;
 
@@ -938,16 +1079,17 @@ RGBAColorRef MapboxVectorStyleSetImpl::resolveColor(const MapboxTransColorRef &c
     switch (resolveMode)
     {
         case MBResolveColorOpacityMultiply:
-            return std::make_shared<RGBAColor>(vals[0]*thisOpacity,vals[1]*thisOpacity,vals[2]*thisOpacity,vals[3]*thisOpacity);
+            outColor = RGBAColor(vals[0]*thisOpacity,vals[1]*thisOpacity,vals[2]*thisOpacity,vals[3]*thisOpacity);
+            return true;
         case MBResolveColorOpacityReplaceAlpha:
-            return std::make_shared<RGBAColor>(vals[0]*255,vals[1]*255,vals[2]*255,thisOpacity);
+            outColor = RGBAColor(vals[0]*255,vals[1]*255,vals[2]*255,thisOpacity);
+            return true;
         case MBResolveColorOpacityComposeAlpha:
-            return std::make_shared<RGBAColor>(vals[0]*255,vals[1]*255,vals[2]*255,vals[3]*thisOpacity);
+            outColor = RGBAColor(vals[0]*255,vals[1]*255,vals[2]*255,vals[3]*thisOpacity);
+            return true;
         default:
             assert(!"Invalid color resolve type");
-#ifdef NDEBUG
-            return RGBAColorRef();
-#endif
+            return false;
     }
 }
 
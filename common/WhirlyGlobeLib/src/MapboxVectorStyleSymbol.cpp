@@ -219,6 +219,8 @@ MapboxVectorStyleLayer& MapboxVectorLayerSymbol::copy(const MapboxVectorStyleLay
     {
         // N.B.: paint and symbol settings share refs, may need to deep-copy
         operator=(*line);
+        // The copy may get different fonts or transforms, so it can't share laid out text
+        textCache = std::make_shared<MapboxLabelTextCache>();
     }
     return *this;
 }
@@ -268,32 +270,94 @@ static void transformText(std::string &text, MapboxTextTransform tx)
     }
 }
 
+MapboxLabelTextRef MapboxLabelTextCache::find(const std::string &rawText,double breakWidth,float fontSize)
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+    const auto it = entries.find(Key { rawText, breakWidth, fontSize });
+    return (it == entries.end()) ? MapboxLabelTextRef() : it->second;
+}
+
+void MapboxLabelTextCache::add(const std::string &rawText,double breakWidth,float fontSize,const MapboxLabelTextRef &text)
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+    if (entries.size() >= maxEntries)
+    {
+        entries.clear();
+    }
+    entries[Key { rawText, breakWidth, fontSize }] = text;
+}
+
+size_t MapboxLabelTextCache::size()
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+    return entries.size();
+}
+
+MapboxLabelTextRef MapboxVectorLayerSymbol::layoutText(PlatformThreadInfo *inst,
+                                                       const std::string &rawText,
+                                                       double breakWidth,
+                                                       const LabelInfoRef &labelInfo,
+                                                       MapboxLabelTextMap &tileText)
+{
+    // Names repeat a lot within a tile
+    const auto it = tileText.find(rawText);
+    if (it != tileText.end())
+    {
+        return it->second;
+    }
+
+    // And between tiles
+    auto labelText = textCache->find(rawText,breakWidth,labelInfo->fontPointSize);
+    if (!labelText)
+    {
+        auto newText = std::make_shared<MapboxLabelText>();
+        newText->text = rawText;
+
+        // Change the text if needed
+        transformText(newText->text, layout.textTransform);
+
+        // Break it up into lines, if necessary
+        if (breakWidth != 0.0)
+        {
+            newText->text = breakUpText(inst,newText->text,breakWidth,labelInfo);
+        }
+
+        if (uniqueLabel)
+        {
+            newText->uniqueID = newText->text;
+            std::transform(newText->uniqueID.begin(), newText->uniqueID.end(), newText->uniqueID.begin(), ::tolower);
+        }
+        newText->hash = calcStringHash(newText->text);
+
+        labelText = std::move(newText);
+        textCache->add(rawText,breakWidth,labelInfo->fontPointSize,labelText);
+    }
+
+    tileText[rawText] = labelText;
+    return labelText;
+}
+
 SingleLabelRef MapboxVectorLayerSymbol::setupLabel(PlatformThreadInfo *inst,
                                                    const Point2f &pt,
                                                    const LabelInfoRef &labelInfo,
                                                    const MutableDictionaryRef &attrs,
                                                    const VectorTileDataRef &tileInfo,
-                                                   bool mergedIcon)
+                                                   bool mergedIcon,
+                                                   const MapboxRegexField &textField,
+                                                   double breakWidth,
+                                                   MapboxLabelTextMap &tileText)
 {
     // Reconstruct the string from its replacement form
-    std::string text = layout.textField->textForZoom(tileInfo->ident.level).build(attrs);
+    const std::string rawText = textField.build(attrs);
 
-    if (text.empty())
+    if (rawText.empty())
     {
         return SingleLabelRef();
     }
-    
-    // Change the text if needed
-    transformText(text, layout.textTransform);
 
-    // TODO: Put this back, but we need information about the font
-    // Break it up into lines, if necessary
-    double textMaxWidth = layout.textMaxWidth->valForZoom(tileInfo->ident.level);
-    if (textMaxWidth != 0.0)
-    {
-        text = breakUpText(inst,text,textMaxWidth * labelInfo->fontPointSize,labelInfo);
-    }
-    
+    const auto labelText = layoutText(inst,rawText,breakWidth,labelInfo,tileText);
+    const std::string &text = labelText->text;
+
     // Construct the label
     auto label = styleSet->makeSingleLabel(inst,text);
     label->loc = pt;
@@ -305,8 +369,7 @@ SingleLabelRef MapboxVectorLayerSymbol::setupLabel(PlatformThreadInfo *inst,
     }
     else if (uniqueLabel)
     {
-        label->uniqueID = text;
-        std::transform(label->uniqueID.begin(), label->uniqueID.end(), label->uniqueID.begin(), ::tolower);
+        label->uniqueID = labelText->uniqueID;
     }
 
     label->layoutEngine = true;
@@ -329,7 +392,7 @@ SingleLabelRef MapboxVectorLayerSymbol::setupLabel(PlatformThreadInfo *inst,
         // values are (almost) certainly unique, making the sort order stable and preventing the
         // layout from changing which items are in front on every pass.
         // todo: this is actually larger than the level value, consider adjusting the denominators
-        const auto hashImport = calcStringHash(text) / 10000.0f;
+        const auto hashImport = labelText->hash / 10000.0f;
         label->layoutImportance = layout.layoutImportance + rankImport + levelImport + hashImport;
     }
 
@@ -429,10 +492,11 @@ void MapboxVectorLayerSymbol::buildObjects(PlatformThreadInfo *inst,
 
     // We'll try for one color for the whole thing
     // Note: To fix this we need to blast the text apart into pieces
-    const auto textColor = MapboxVectorStyleSetImpl::resolveColor(paint.textColor, nullptr, zoomLevel,
-                                                                  MBResolveColorOpacityReplaceAlpha);
+    RGBAColor textColor;
+    const bool hasTextColor = MapboxVectorStyleSetImpl::resolveColor(paint.textColor, nullptr, zoomLevel,
+                                                                     MBResolveColorOpacityReplaceAlpha, textColor);
 
-    const auto textField = (textColor && layout.textField) ?
+    const auto textField = (hasTextColor && layout.textField) ?
                            layout.textField->textForZoom(zoomLevel) : MapboxRegexField();
 
     const bool iconInclude = layout.iconImageField && styleSet->sprites;
@@ -488,7 +552,7 @@ void MapboxVectorLayerSymbol::buildObjects(PlatformThreadInfo *inst,
         labelInfo->textJustify = layout.textJustify;
         labelInfo->drawPriority = priority;
         labelInfo->opacityExp = paint.textOpacity->expression();
-        labelInfo->textColor = textColor ? *textColor : RGBAColor::white();
+        labelInfo->textColor = hasTextColor ? textColor : RGBAColor::white();
 
         // We can apply a scale, but it needs to be scaled to the current text size.
         // That is, the expression produces [0.0,1.0] when is then multiplied by textSize
@@ -544,6 +608,11 @@ void MapboxVectorLayerSymbol::buildObjects(PlatformThreadInfo *inst,
     const Point2d offset = Point2d(layout.textOffsetX ? (layout.textOffsetX->valForZoom(zoomLevel) * textSize) : 0.0,
                                    layout.textOffsetY ? (layout.textOffsetY->valForZoom(zoomLevel) * -textSize) : 0.0);
 
+    // Lines get broken up at the same width for the whole tile
+    const double textMaxWidth = textInclude ? layout.textMaxWidth->valForZoom(zoomLevel) : 0.0;
+    const double breakWidth = textMaxWidth * labelInfo->fontPointSize;
+    MapboxLabelTextMap tileText;
+
     auto const capacity = vecObjs.size() * 5;  // ?
     std::unordered_map<std::string,std::tuple<MarkerPtrVec,VecObjRefVec,LabelRefVec>> markersByUUID(capacity);
 
@@ -587,7 +656,7 @@ void MapboxVectorLayerSymbol::buildObjects(PlatformThreadInfo *inst,
                     {
                         if (textInclude)
                         {
-                            if (auto label = setupLabel(inst,pt,labelInfo,attrs,tileInfo,iconInclude))
+                            if (auto label = setupLabel(inst,pt,labelInfo,attrs,tileInfo,iconInclude,textField,breakWidth,tileText))
                             {
                                 if (iconInclude)
                                 {
@@ -682,7 +751,7 @@ void MapboxVectorLayerSymbol::buildObjects(PlatformThreadInfo *inst,
 
                     if (textInclude)
                     {
-                        if (auto label = setupLabel(inst,pt,labelInfo,attrs,tileInfo,iconInclude))
+                        if (auto label = setupLabel(inst,pt,labelInfo,attrs,tileInfo,iconInclude,textField,breakWidth,tileText))
                         {
                             if (markerAdded)
                             {
@@ -763,7 +832,7 @@ void MapboxVectorLayerSymbol::buildObjects(PlatformThreadInfo *inst,
 
                     if (textInclude)
                     {
-                        if (auto label = setupLabel(inst, pt, labelInfo, attrs, tileInfo, iconInclude))
+                        if (auto label = setupLabel(inst, pt, labelInfo, attrs, tileInfo, iconInclude, textField, breakWidth, tileText))
                         {
                             if (markerAdded)
                             {
@@ -22,6 +22,7 @@
 #import "WhirlyKitLog.h"
 #import "DictionaryC.h"
 #import "VectorTilePBFParser.h"
+#import "TraceEvents.h"
 
 #include <utility>
 #import <vector>
@@ -182,11 +183,13 @@ bool MapboxVectorTileParser::parse(PlatformThreadInfo *styleInst,
 //    wkLogLevel(Verbose, "MapboxVectorTileParser: Parse [%d/%d/%d] starting",
 //               tileData->ident.level, tileData->ident.x, tileData->ident.y);
 //#endif
+    WK_TRACE_SCOPE("vectortile","MapboxVectorTileParser::parse");
     const auto t0 = std::chrono::steady_clock::now();
 
     VectorTilePBFParser parser(tileData, &*styleDelegate, styleInst, filterName, filterValues,
                                tileData->vecObjsByStyle, localCoords, parseAll,
                                keepVectors ? &tileData->vecObjs : nullptr, cancelFn);
+    parser.setLazyAttributes(lazyAttributes);
     if (!parser.parse(rawData->getRawData(), rawData->getLen()))
     {
         if (parser.getParseCancelled())
@@ -238,32 +241,76 @@ bool MapboxVectorTileParser::parse(PlatformThreadInfo *styleInst,
 //        tileData->mergeFrom(styleData.get());
 //    }
     
-    // Run the styles over their assembled data
-    for (const auto &it : tileData->vecObjsByStyle)
+    // Run the styles over their assembled data, in style order.
+    // With a pool, consecutive styles that are safe to build at the same time go to it together.
+    // The others build here on their own, since they may change the features the rest look at.
+    const std::vector<std::pair<long long,std::vector<VectorObjectRef> *> > styles(tileData->vecObjsByStyle.begin(),
+                                                                                   tileData->vecObjsByStyle.end());
+    const bool usePool = buildPool && buildPool->getNumThreads() > 0 && styles.size() > 1;
+    std::vector<VectorTileDataRef> styleDatas;
+    for (size_t start=0;start<styles.size();)
     {
-        std::vector<VectorObjectRef> &vecs = *it.second;
+        size_t end = start + 1;
+        if (usePool && styleIsThreadSafe(styleInst,styles[start].first))
+        {
+            while (end < styles.size() && styleIsThreadSafe(styleInst,styles[end].first))
+            {
+                end++;
+            }
+        }
+
+        styleDatas.clear();
+        styleDatas.resize(end - start);
+        if (end - start == 1)
+        {
+            auto styleData = std::make_shared<VectorTileData>(*tileData);
 
-        auto styleData = std::make_shared<VectorTileData>(*tileData);
+            // Ask the subclass to run the style and fill in the VectorTileData
+            buildForStyle(styleInst,styles[start].first,*styles[start].second,styleData,cancelFn);
+            styleDatas[0] = std::move(styleData);
+        }
+        else
+        {
+            // Workers without thread info (say, one that couldn't attach to the VM) leave their styles for us
+            std::vector<char> onCaller(end - start,0);
+            buildPool->parallelFor(end - start, [&](size_t which) {
+                PlatformThreadInfo *inst = buildPool->getThreadInfo(styleInst);
+                if (!inst && styleInst)
+                {
+                    onCaller[which] = 1;
+                    return;
+                }
+                if (cancelFn(inst))
+                {
+                    return;
+                }
+                const auto &style = styles[start + which];
+                auto styleData = std::make_shared<VectorTileData>(*tileData);
+                buildForStyle(inst,style.first,*style.second,styleData,cancelFn);
+                styleDatas[which] = std::move(styleData);
+            });
 
-        // Ask the subclass to run the style and fill in the VectorTileData
-        buildForStyle(styleInst,it.first,vecs,styleData,cancelFn);
+            for (size_t which=0;which<onCaller.size();which++)
+            {
+                if (onCaller[which] && !cancelFn(styleInst))
+                {
+                    const auto &style = styles[start + which];
+                    auto styleData = std::make_shared<VectorTileData>(*tileData);
+                    buildForStyle(styleInst,style.first,*style.second,styleData,cancelFn);
+                    styleDatas[which] = std::move(styleData);
+                }
+            }
+        }
 
-        // Sort the results into categories if needed
-        auto catIt = styleCategories.find(it.first);
-        if (catIt != styleCategories.end() && !styleData->compObjs.empty())
+        // Merge in style order, same as we would have serially.
+        for (size_t ii=0;ii<styleDatas.size();ii++)
         {
-            const std::string &category = catIt->second;
-            auto &compObjs = styleData->compObjs;
-            auto categoryIt = tileData->categories.find(category);
-            if (categoryIt != tileData->categories.end())
+            if (styleDatas[ii])
             {
-                compObjs.insert(compObjs.end(), categoryIt->second.begin(), categoryIt->second.end());
+                mergeStyleData(styles[start + ii].first,styleDatas[ii].get(),tileData);
             }
-            tileData->categories[category] = compObjs;
         }
-        
-        // Merge this into the general return data
-        tileData->mergeFrom(styleData.get());
+        start = end;
 
         // The changes in `tileData` represent objects already tracked
         // in the managers they must be merged or we'll have leaks, so
@@ -321,6 +368,32 @@ bool MapboxVectorTileParser::parse(PlatformThreadInfo *styleInst,
     return true;
 }
 
+bool MapboxVectorTileParser::styleIsThreadSafe(PlatformThreadInfo *styleInst,long long styleID)
+{
+    const auto style = styleDelegate->styleForUUID(styleInst,styleID);
+    return !style || style->buildObjectsIsThreadSafe(styleInst);
+}
+
+void MapboxVectorTileParser::mergeStyleData(long long styleID,VectorTileData *styleData,VectorTileData *tileData)
+{
+    // Sort the results into categories if needed
+    auto catIt = styleCategories.find(styleID);
+    if (catIt != styleCategories.end() && !styleData->compObjs.empty())
+    {
+        const std::string &category = catIt->second;
+        auto &compObjs = styleData->compObjs;
+        auto categoryIt = tileData->categories.find(category);
+        if (categoryIt != tileData->categories.end())
+        {
+            compObjs.insert(compObjs.end(), categoryIt->second.begin(), categoryIt->second.end());
+        }
+        tileData->categories[category] = compObjs;
+    }
+
+    // Merge this into the general return data
+    tileData->mergeFrom(styleData);
+}
+
 void MapboxVectorTileParser::buildForStyle(PlatformThreadInfo *styleInst,
                                            long long styleID,
                                            const std::vector<VectorObjectRef> &vecObjs,
@@ -43,6 +43,20 @@ OverlapHelper::OverlapHelper(const Mbr &mbr, int sizeX, int sizeY, size_t count)
     }
 }
 
+void OverlapHelper::reset(const Mbr &newMbr, size_t count)
+{
+    mbr = newMbr;
+    totalObjs = count;
+    cellSize = mbr.span().cwiseQuotient(Point2f(sizeX, sizeY));
+
+    objects.clear();
+    objects.reserve(count);
+    for (auto &cell : grid)
+    {
+        cell.objIndexes.clear();
+    }
+}
+
 bool OverlapHelper::addCheckObject(const Point2dVector &pts, const std::string &mergeID)
 {
     return addCheckObject(pts, mergeID.empty() ? nullptr : mergeID.c_str());
@@ -225,6 +239,17 @@ void ClusterHelper::findObjectsWithin(const Mbr &objMbr,std::set<int> &objSet)
     }
 }
 
+void ClusterHelper::calcClusterPts(ClusterObject &clusterObj)
+{
+    const Point2d halfSize = clusterMarkerSize * resScale / 2.0;
+    clusterObj.pts.clear();
+    clusterObj.pts.reserve(4);
+    clusterObj.pts.push_back(clusterObj.center + Point2d(-halfSize.x(),-halfSize.y()));
+    clusterObj.pts.push_back(clusterObj.center + Point2d(halfSize.x(),-halfSize.y()));
+    clusterObj.pts.push_back(clusterObj.center + Point2d(halfSize.x(),halfSize.y()));
+    clusterObj.pts.push_back(clusterObj.center + Point2d(-halfSize.x(),halfSize.y()));
+}
+
 // Try to add an object.  Might fail (kind of the whole point).
 void ClusterHelper::addObject(LayoutObjectEntryRef objEntry,const Point2dVector &pts)
 {
@@ -237,7 +262,13 @@ void ClusterHelper::addObject(LayoutObjectEntryRef objEntry,const Point2dVector
     newObj.center = CalcCenterOfMass(pts);
     newObj.pts = pts;
 
-    const Mbr ptsMbr(pts);
+    placeObject(newID);
+}
+
+void ClusterHelper::placeObject(int newID)
+{
+    SimpleObject &newObj = simpleObjects[newID];
+    const Mbr ptsMbr(newObj.pts);
     
     // All the things we might overlap
     std::set<int> objSet;
@@ -290,12 +321,7 @@ void ClusterHelper::addObject(LayoutObjectEntryRef objEntry,const Point2dVector
             }
 
             newObj.parentObject = clusterID;
-            clusterObj->pts.clear();
-            clusterObj->pts.reserve(4);
-            clusterObj->pts.push_back(clusterObj->center + Point2d(-clusterMarkerSize.x()*resScale/2.0,-clusterMarkerSize.y()*resScale/2.0));
-            clusterObj->pts.push_back(clusterObj->center + Point2d(clusterMarkerSize.x()*resScale/2.0,-clusterMarkerSize.y()*resScale/2.0));
-            clusterObj->pts.push_back(clusterObj->center + Point2d(clusterMarkerSize.x()*resScale/2.0,clusterMarkerSize.y()*resScale/2.0));
-            clusterObj->pts.push_back(clusterObj->center + Point2d(-clusterMarkerSize.x()*resScale/2.0,clusterMarkerSize.y()*resScale/2.0));
+            calcClusterPts(*clusterObj);
 
             const Mbr clusterMbr(clusterObj->pts);
             addToCells(clusterMbr,-(clusterID+1));
@@ -310,6 +336,163 @@ void ClusterHelper::addObject(LayoutObjectEntryRef objEntry,const Point2dVector
         addToCells(ptsMbr, newID);
 }
 
+// Below this it's not worth splitting up the work
+static const size_t MinTiledClusterObjects = 1024;
+// Tiles we split the screen into for tiled clustering.
+// This is fixed, rather than based on the pool size, so the groups don't depend on the device.
+static const int ClusterTilesX = 4;
+static const int ClusterTilesY = 4;
+
+void ClusterHelper::addObjects(const std::vector<LayoutObjectEntryRef> &objEntries,
+                               const std::vector<Point2dVector> &objPts,
+                               bool tiled,
+                               TaskPool *pool,
+                               volatile bool &cancel)
+{
+    const size_t count = std::min(objEntries.size(),objPts.size());
+    if (!tiled || count < MinTiledClusterObjects)
+    {
+        simpleObjects.reserve(simpleObjects.size() + count);
+        for (size_t ii=0;ii<count && !cancel;ii++)
+        {
+            addObject(objEntries[ii],objPts[ii]);
+        }
+        return;
+    }
+
+    // Sort the objects into tiles, keeping them in order within each.
+    // Anything that crosses a tile edge waits for the serial pass.
+    const int tilesX = ClusterTilesX, tilesY = ClusterTilesY;
+    const Point2d org = mbr.ll().cast<double>();
+    const Point2d tileSpan = mbr.span().cast<double>().cwiseQuotient(Point2d(tilesX,tilesY));
+    const auto tileX = [&](double x) { return std::min(std::max((int)floor((x - org.x()) / tileSpan.x()),0),tilesX-1); };
+    const auto tileY = [&](double y) { return std::min(std::max((int)floor((y - org.y()) / tileSpan.y()),0),tilesY-1); };
+    std::vector<std::vector<int> > tileObjs(tilesX * tilesY);
+    std::vector<int> edgeObjs;
+    for (size_t ii=0;ii<count;ii++)
+    {
+        const Point2dVector &pts = objPts[ii];
+        if (pts.empty())
+        {
+            edgeObjs.push_back((int)ii);
+            continue;
+        }
+        Point2d ll = pts[0], ur = pts[0];
+        for (const auto &pt : pts)
+        {
+            ll = ll.cwiseMin(pt);
+            ur = ur.cwiseMax(pt);
+        }
+        const int sx = tileX(ll.x()), ex = tileX(ur.x());
+        const int sy = tileY(ll.y()), ey = tileY(ur.y());
+        if (sx == ex && sy == ey)
+        {
+            tileObjs[sy * tilesX + sx].push_back((int)ii);
+        }
+        else
+        {
+            edgeObjs.push_back((int)ii);
+        }
+    }
+
+    // Cluster each tile on its own.  Objects inside different tiles can't overlap.
+    std::vector<std::unique_ptr<ClusterHelper> > tileHelpers(tileObjs.size());
+    const auto clusterTile = [&](size_t which)
+    {
+        const std::vector<int> &objs = tileObjs[which];
+        if (objs.empty())
+        {
+            return;
+        }
+
+        const int tx = (int)which % tilesX, ty = (int)which / tilesX;
+        const Mbr tileMbr(Point2f(org.x() + tx * tileSpan.x(), org.y() + ty * tileSpan.y()),
+                          Point2f(org.x() + (tx+1) * tileSpan.x(), org.y() + (ty+1) * tileSpan.y()));
+        auto helper = std::make_unique<ClusterHelper>(tileMbr,std::max(1,sizeX/tilesX),std::max(1,sizeY/tilesY),
+                                                      resScale,clusterMarkerSize);
+        helper->simpleObjects.reserve(objs.size());
+        for (int idx : objs)
+        {
+            if (UNLIKELY(cancel))
+            {
+                return;
+            }
+            helper->addObject(objEntries[idx],objPts[idx]);
+        }
+        tileHelpers[which] = std::move(helper);
+    };
+    if (pool && pool->getNumThreads() > 0)
+    {
+        pool->parallelFor(tileObjs.size(),clusterTile);
+    }
+    else
+    {
+        for (size_t which=0;which<tileObjs.size();which++)
+        {
+            clusterTile(which);
+        }
+    }
+
+    if (UNLIKELY(cancel))
+    {
+        return;
+    }
+
+    // Pull the tiles together in order.  Objects keep their position in the batch.
+    const int baseID = (int)simpleObjects.size();
+    simpleObjects.resize(baseID + count);
+    for (unsigned int tile=0;tile<tileHelpers.size();tile++)
+    {
+        if (!tileHelpers[tile])
+        {
+            continue;
+        }
+        ClusterHelper &tileHelper = *tileHelpers[tile];
+        const std::vector<int> &objs = tileObjs[tile];
+        const int clusterOffset = (int)clusterObjects.size();
+        for (unsigned int local=0;local<tileHelper.simpleObjects.size();local++)
+        {
+            SimpleObject &obj = tileHelper.simpleObjects[local];
+            const int objID = baseID + objs[local];
+            if (obj.parentObject >= 0)
+            {
+                obj.parentObject += clusterOffset;
+            }
+            else
+            {
+                addToCells(Mbr(obj.pts),objID);
+            }
+            simpleObjects[objID] = std::move(obj);
+        }
+        for (auto &clusterObj : tileHelper.clusterObjects)
+        {
+            for (int &child : clusterObj.children)
+            {
+                child = baseID + objs[child];
+            }
+            const int clusterID = (int)clusterObjects.size();
+            addToCells(Mbr(clusterObj.pts),-(clusterID+1));
+            clusterObjects.push_back(std::move(clusterObj));
+        }
+        tileHelpers[tile].reset();
+    }
+
+    // Now the ones on the edges, in their original order
+    for (int idx : edgeObjs)
+    {
+        if (UNLIKELY(cancel))
+        {
+            return;
+        }
+
+        SimpleObject &obj = simpleObjects[baseID + idx];
+        obj.objEntry = objEntries[idx];
+        obj.center = CalcCenterOfMass(objPts[idx]);
+        obj.pts = objPts[idx];
+        placeObject(baseID + idx);
+    }
+}
+
 void ClusterHelper::resolveClusters(volatile bool &cancel)
 {
     // Find single objects that overlap existing clusters.
@@ -17,6 +17,7 @@
  */
 
 #import "QuadDisplayControllerNew.h"
+#import "TraceEvents.h"
 
 namespace WhirlyKit
 {
@@ -168,6 +169,8 @@ void QuadDisplayControllerNew::stop(PlatformThreadInfo *threadInfo,ChangeSet &ch
 
 bool QuadDisplayControllerNew::viewUpdate(PlatformThreadInfo *threadInfo,const ViewStateRef &inViewState,ChangeSet &changes)
 {
+    WK_TRACE_SCOPE("tiles","QuadDisplayControllerNew::viewUpdate");
+
     // Just put ourselves on hold for a while
     if (!running || !scene || !inViewState)
     {
@@ -225,44 +228,11 @@ bool QuadDisplayControllerNew::viewUpdate(PlatformThreadInfo *threadInfo,const V
 //        wkLogLevel(Debug," %d: (%d,%d), import = %f",node.level,node.x,node.y,node.importance);
 //    }
     
+    // In incremental mode only the nodes whose importance moved count as updates
     QuadTreeNew::ImportantNodeSet toAdd,toUpdate;
     QuadTreeNew::NodeSet toRemove;
-    
-    // Need a version of new and old that has no importance values, since those change
-    QuadTreeNew::NodeSet testNewNodes;
-    for (const auto &node : newNodes)
-    {
-        testNewNodes.insert(node);
-    }
+    calcCoverageDelta(currentNodes, newNodes, incremental, toAdd, toRemove, toUpdate);
 
-    QuadTreeNew::NodeSet testCurrentNodes;
-    for (const auto &node : currentNodes)
-    {
-        testCurrentNodes.insert(node);
-    }
-    
-    // Nodes to remove
-    for (const auto &node : currentNodes)
-    {
-        if (testNewNodes.find(node) == testNewNodes.end())
-        {
-            toRemove.insert(node);
-        }
-    }
-
-    // Nodes to add and nodes to update importance for
-    for (const auto &node : newNodes)
-    {
-        if (testCurrentNodes.find(node) == testCurrentNodes.end())
-        {
-            toAdd.insert(node);
-        }
-        else
-        {
-            toUpdate.insert(node);
-        }
-    }
-    
     const QuadTreeNew::NodeSet removesToKeep =
         loader->quadLoaderUpdate(threadInfo, toAdd, toRemove, toUpdate, targetLevel, changes);
 
@@ -338,6 +308,11 @@ double QuadDisplayControllerNew::importance(const Node &node)
     return dataStructure->importanceForTile(ident, nodeMbr, viewState, renderer->getFramebufferSize());
 }
 
+bool QuadDisplayControllerNew::importanceIsThreadSafe() const
+{
+    return dataStructure->importanceIsThreadSafe();
+}
+
 // Pure visibility check
 bool QuadDisplayControllerNew::visible(const Node &node) {
     MbrD nodeMbrD = generateMbrForNode(node);
@@ -357,5 +332,93 @@ bool QuadDisplayControllerNew::visible(const Node &node) {
     return dataStructure->visibilityForTile(ident, nodeMbr, viewState, renderer->getFramebufferSize());
 }
 
+// Bounding sphere in display space, for the incremental mode
+bool QuadDisplayControllerNew::nodeBounds(const Node &node,Point3d &center,double &radius)
+{
+    const auto coordAdapter = scene ? scene->getCoordAdapter() : nullptr;
+    if (!coordAdapter || !coordSys)
+    {
+        return false;
+    }
+    // Hemisphere sized tiles on the globe aren't well described by a sphere
+    if (node.level == 0 && !coordAdapter->isFlat())
+    {
+        return false;
+    }
+
+    MbrD nodeMbr = generateMbrForNode(node);
+    if (mbrScaling != 1.0)
+        nodeMbr.expandByFraction(mbrScaling-1.0);
+
+    const CoordSystem *displaySystem = coordAdapter->getCoordSystem();
+    const Point2d mid = nodeMbr.mid();
+    const Point3d srcPts[] = {
+        {nodeMbr.ll().x(), nodeMbr.ll().y(), 0.0},
+        {nodeMbr.ur().x(), nodeMbr.ll().y(), 0.0},
+        {nodeMbr.ur().x(), nodeMbr.ur().y(), 0.0},
+        {nodeMbr.ll().x(), nodeMbr.ur().y(), 0.0},
+        {mid.x(), mid.y(), 0.0},
+    };
+
+    Point3d dispPts[5];
+    center = Point3d(0.0,0.0,0.0);
+    for (int ii=0;ii<5;ii++)
+    {
+        dispPts[ii] = coordAdapter->localToDisplay(CoordSystemConvert3d(coordSys, displaySystem, srcPts[ii]));
+        center += dispPts[ii];
+    }
+    center /= 5.0;
+
+    radius = 0.0;
+    for (const auto &pt : dispPts)
+    {
+        radius = std::max(radius,(pt - center).norm());
+    }
+
+    return std::isfinite(radius);
+}
+
+// Where the bounding sphere lands on the screen and how big it is.
+// Wrapped maps draw several copies of the world, so we look at all of them.
+bool QuadDisplayControllerNew::nodeFootprint(const Point3d &center,double radius,Footprint &footprint)
+{
+    if (!viewState || viewState->fullMatrices.empty())
+    {
+        return false;
+    }
+
+    const Point2f frameSize = renderer->getFramebufferSize();
+    const Eigen::Vector4d edgeX(radius,0.0,0.0,0.0), edgeY(0.0,radius,0.0,0.0);
+    footprint.numCopies = 0;
+    for (const auto &fullMatrix : viewState->fullMatrices)
+    {
+        const Eigen::Vector4d eyePt = fullMatrix * Eigen::Vector4d(center.x(),center.y(),center.z(),1.0);
+        // Behind us (or nearly), so we can't say much about it
+        if (eyePt.z() >= -radius)
+        {
+            return false;
+        }
+
+        const Eigen::Vector4d clipPt = viewState->projMatrix * eyePt;
+        const Eigen::Vector4d clipX = viewState->projMatrix * (eyePt + edgeX);
+        const Eigen::Vector4d clipY = viewState->projMatrix * (eyePt + edgeY);
+        if (clipPt.w() <= 0.0 || clipX.w() <= 0.0 || clipY.w() <= 0.0)
+        {
+            return false;
+        }
+
+        const double screenX = (clipPt.x() / clipPt.w() + 1.0) / 2.0 * frameSize.x();
+        const double screenY = (clipPt.y() / clipPt.w() + 1.0) / 2.0 * frameSize.y();
+        const double sizeX = std::abs((clipX.x() / clipX.w() + 1.0) / 2.0 * frameSize.x() - screenX);
+        const double sizeY = std::abs((clipY.y() / clipY.w() + 1.0) / 2.0 * frameSize.y() - screenY);
+        if (!footprint.addCopy(Point3d(screenX, screenY, std::max(sizeX, sizeY))))
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
     
 }
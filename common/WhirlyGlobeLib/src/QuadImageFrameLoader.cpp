@@ -18,6 +18,7 @@
 
 #import "QuadImageFrameLoader.h"
 #import "WhirlyKitLog.h"
+#import "TraceEvents.h"
 
 namespace WhirlyKit
 {
@@ -999,6 +1000,8 @@ void QuadImageFrameLoader::removeTile(PlatformThreadInfo *threadInfo,const QuadT
     
 void QuadImageFrameLoader::mergeLoadedTile(PlatformThreadInfo *threadInfo,QuadLoaderReturn *loadReturn,ChangeSet &changes)
 {
+    WK_TRACE_SCOPE("tiles","QuadImageFrameLoader::mergeLoadedTile");
+
     changesSinceLastFlush = true;
 
     if (debugMode)
@@ -1370,7 +1373,9 @@ void QuadImageFrameLoader::builderLoad(PlatformThreadInfo *threadInfo,
     // Not initialized yet
     if (!this->builder)
         return;
-    
+
+    WK_TRACE_SCOPE("tiles","QuadImageFrameLoader::builderLoad");
+
     // Only handling loads and unloads for now
     if (updates.loadTiles.empty() && updates.unloadTiles.empty())
         return;
@@ -55,6 +55,11 @@ void QuadSamplingController::start(const SamplingParams &inParams,Scene *inScene
     displayControl->setMinImportancePerLevel(importance);
     displayControl->setMBRScaling(params.boundsScale);
     displayControl->setMaxTiles(params.maxTiles);
+    displayControl->setIncremental(params.incrementalCoverage,params.incrementalThreshold);
+    if (params.parallelSplitLevel > 0)
+    {
+        displayControl->setParallel(TaskPool::sharedPool(),params.parallelSplitLevel);
+    }
 
     valid = true;
 }
@@ -167,6 +172,18 @@ void QuadSamplingController::newViewState(ViewStateRef viewState)
 {
 }
 
+bool QuadSamplingController::importanceIsThreadSafe() const
+{
+    const auto coordAdapter = scene ? scene->getCoordAdapter() : nullptr;
+    if (!coordAdapter || !coordAdapter->isThreadSafe() || !params.coordSys)
+    {
+        return false;
+    }
+
+    // Converting between two different systems goes through geocentric, which is Proj-4
+    return params.coordSys->isSameAs(coordAdapter->getCoordSystem());
+}
+
 bool QuadSamplingController::visibilityForTile(const QuadTreeIdentifier &ident,
                                const Mbr &mbr,
                                const ViewStateRef &viewState,
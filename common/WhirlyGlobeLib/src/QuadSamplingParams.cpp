@@ -32,7 +32,10 @@ SamplingParams::SamplingParams()
     singleLevel(false),
     forceMinLevel(true),
     forceMinLevelHeight(0.0),
-    generateGeom(true)
+    generateGeom(true),
+    incrementalCoverage(false),
+    incrementalThreshold(2.0),
+    parallelSplitLevel(0)
 {
 }
 
@@ -58,6 +61,9 @@ bool SamplingParams::operator == (const SamplingParams &that) const
         forceMinLevelHeight == that.forceMinLevelHeight &&
         clipBounds == that.clipBounds &&
         generateGeom == that.generateGeom &&
+        incrementalCoverage == that.incrementalCoverage &&
+        incrementalThreshold == that.incrementalThreshold &&
+        parallelSplitLevel == that.parallelSplitLevel &&
         levelLoads == that.levelLoads &&
         importancePerLevel == that.importancePerLevel;
 }
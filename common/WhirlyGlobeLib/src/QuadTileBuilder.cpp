@@ -19,6 +19,7 @@
 #import "QuadTileBuilder.h"
 #import "LoadedTileNew.h"
 #import "WhirlyKitLog.h"
+#import "TraceEvents.h"
 
 namespace WhirlyKit
 {
@@ -158,6 +159,8 @@ QuadTreeNew::NodeSet QuadTileBuilder::quadLoaderUpdate(PlatformThreadInfo *threa
                                                        const QuadTreeNew::ImportantNodeSet &updateTiles,
                                                        int targetLevel, ChangeSet &changes)
 {
+    WK_TRACE_SCOPE("tiles","QuadTileBuilder::quadLoaderUpdate");
+
     TileBuilderDelegateInfo info;
     info.unloadTiles = unloadTiles;
     info.changeTiles = updateTiles;
@@ -107,14 +107,32 @@ QuadTreeNew::ImportantNodeSet QuadTreeNew::calcCoverageImportance(const std::vec
     // Start at the lowest level and work our way to higher resolution
     const int numX = 1<<minLevel;
     const int numY = 1<<minLevel;
+    std::vector<ImportantNode> startNodes;
+    startNodes.reserve(numX*numY);
     for (int iy=0;iy<numY;iy++)
     {
         for (int ix=0;ix<numX;ix++)
         {
-            ImportantNode node(ix,iy,minLevel);
-            evalNodeImportance(node,minImportance,sortedNodes,maxRejectedImport);
+            startNodes.emplace_back(ix,iy,minLevel);
         }
     }
+    IncrementalState *state = nullptr;
+    if (incremental)
+    {
+        // Nothing moved, so the answer hasn't changed either
+        const bool unchanged = evalNodesIncremental(startNodes,minImportance,maxRejectedImport);
+        state = lastPass;
+        if (unchanged && state->hasImportanceCoverage &&
+            state->importanceMaxNodes == maxNodes && state->siblingNodes == siblingNodes)
+        {
+            return state->importanceCoverage;
+        }
+        sortedNodes.insert(state->nodes.begin(),state->nodes.end());
+    }
+    else
+    {
+        evalNodesImportance(startNodes,minImportance,sortedNodes,maxRejectedImport);
+    }
 
     // Add the most important nodes first until we run out
     ImportantNodeSet retNodes;
@@ -148,11 +166,118 @@ QuadTreeNew::ImportantNodeSet QuadTreeNew::calcCoverageImportance(const std::vec
         }
     }
 
+    if (state && !shutdown)
+    {
+        state->hasImportanceCoverage = true;
+        state->importanceMaxNodes = maxNodes;
+        state->siblingNodes = siblingNodes;
+        state->importanceCoverage = retNodes;
+    }
+
     return retNodes;
 }
 
 void QuadTreeNew::evalNodeImportance(ImportantNode &node,const std::vector<double> &minImportance,
                                      ImportantNodeSet &importSet,std::vector<double> &maxRejectedImport)
+{
+    evalNodeImportance(node,minImportance,importSet,maxRejectedImport,-1,nullptr);
+}
+
+void QuadTreeNew::evalNodesImportance(const std::vector<ImportantNode> &nodes,const std::vector<double> &minImportance,
+                                      ImportantNodeSet &importSet,std::vector<double> &maxRejectedImport)
+{
+    if (incremental)
+    {
+        evalNodesIncremental(nodes,minImportance,maxRejectedImport);
+        importSet.insert(lastPass->nodes.begin(),lastPass->nodes.end());
+        return;
+    }
+
+    const bool parallel = taskPool && parallelSplitLevel > 0 && taskPool->getNumThreads() > 0 &&
+                          importanceIsThreadSafe();
+
+    // Work down to the split level on this thread, setting aside the subtrees below it
+    std::vector<ImportantNode> subtrees;
+    for (const auto &startNode : nodes)
+    {
+        ImportantNode node = startNode;
+        evalNodeImportance(node,minImportance,importSet,maxRejectedImport,
+                           parallel ? parallelSplitLevel : -1,&subtrees);
+    }
+
+    if (subtrees.empty() || UNLIKELY(shutdown))
+    {
+        return;
+    }
+
+    // Each subtree gets its own results, so there's nothing to lock
+    std::vector<ImportantNodeSet> subImportSets(subtrees.size());
+    std::vector<std::vector<double>> subMaxRejected(subtrees.size(),std::vector<double>(maxRejectedImport.size(),0.0));
+
+    taskPool->parallelFor(subtrees.size(),[&](size_t which)
+    {
+        ImportantNode node = subtrees[which];
+        evalNodeImportance(node,minImportance,subImportSets[which],subMaxRejected[which],-1,nullptr);
+    });
+
+    // Merge in subtree order.  Set union and max don't care about order,
+    //  so this comes out the same as the serial version.
+    for (size_t ii=0;ii<subtrees.size();ii++)
+    {
+        importSet.insert(subImportSets[ii].begin(),subImportSets[ii].end());
+        const auto &subRejected = subMaxRejected[ii];
+        for (size_t level=0;level<maxRejectedImport.size();level++)
+        {
+            maxRejectedImport[level] = std::max(maxRejectedImport[level],subRejected[level]);
+        }
+    }
+}
+
+bool QuadTreeNew::evalNodesIncremental(const std::vector<ImportantNode> &nodes,const std::vector<double> &minImportance,
+                                       std::vector<double> &maxRejectedImport)
+{
+    lastPass = &incrementalStateFor(minImportance);
+    passEvaluated = 0;
+    passRecords.clear();
+    passNodes.clear();
+    passRejected.clear();
+
+    size_t cursor = 0;
+    for (const auto &startNode : nodes)
+    {
+        ImportantNode node = startNode;
+        const int lastIndex = findLastRecord(node,cursor,lastPass->records.size());
+        evalNodeIncremental(node,minImportance,lastIndex,true);
+    }
+
+    for (const auto &rejected : passRejected)
+    {
+        maxRejectedImport[rejected.level] = std::max(maxRejectedImport[rejected.level],rejected.ratio);
+    }
+
+    const bool unchanged = passEvaluated == 0 && !passRecords.empty() && !shutdown;
+    if (!unchanged)
+    {
+        lastPass->hasImportanceCoverage = false;
+        lastPass->hasVisibleCoverage = false;
+    }
+    if (UNLIKELY(shutdown))
+    {
+        // A partial pass is no good to the next one
+        passRecords.clear();
+        passNodes.clear();
+        passRejected.clear();
+    }
+    lastPass->records.swap(passRecords);
+    lastPass->nodes.swap(passNodes);
+    lastPass->rejected.swap(passRejected);
+
+    return unchanged;
+}
+
+void QuadTreeNew::evalNodeImportance(ImportantNode &node,const std::vector<double> &minImportance,
+                                     ImportantNodeSet &importSet,std::vector<double> &maxRejectedImport,
+                                     int stopLevel,std::vector<ImportantNode> *subtrees)
 {
     // Stop recursing if we get a shutdown signal
     if (UNLIKELY(shutdown) || node.level > maxLevel)
@@ -160,6 +285,13 @@ void QuadTreeNew::evalNodeImportance(ImportantNode &node,const std::vector<doubl
         return;
     }
 
+    // Someone else will deal with this one
+    if (node.level == stopLevel && subtrees)
+    {
+        subtrees->push_back(node);
+        return;
+    }
+
     node.importance = (node.level >= minLevel) ? importance(node) : 0;
 
     //wkLogLevel(Verbose,"tree %llx node %d:(%d,%d) importance=%f",this,node.level,node.x,node.y,node.importance);
@@ -190,7 +322,7 @@ void QuadTreeNew::evalNodeImportance(ImportantNode &node,const std::vector<doubl
             for (int ix=0;ix<2;ix++)
             {
                 ImportantNode childNode(2*node.x + ix, indY,node.level + 1);
-                evalNodeImportance(childNode,minImportance,importSet,maxRejectedImport);
+                evalNodeImportance(childNode,minImportance,importSet,maxRejectedImport,stopLevel,subtrees);
             }
         }
     }
@@ -247,16 +379,38 @@ std::tuple<int,QuadTreeNew::ImportantNodeSet> QuadTreeNew::calcCoverageVisible(
     ImportantNodeSet sortedNodes;
 
     // Start at the lowest level and work our way to higher resolution
-    ImportantNode node(0,0,0);
-    evalNodeImportance(node,minImportance,sortedNodes,maxRejectedImport);
+    const ImportantNode node(0,0,0);
+    IncrementalState *state = nullptr;
+    bool unchanged = false;
+    if (incremental)
+    {
+        unchanged = evalNodesIncremental({node},minImportance,maxRejectedImport);
+        state = lastPass;
+    }
+    else
+    {
+        evalNodesImportance({node},minImportance,sortedNodes,maxRejectedImport);
+    }
 
     if (shutdown)
     {
         return {0,{}};
     }
 
+    // Nothing moved, so the answer hasn't changed either
+    if (unchanged && state->hasVisibleCoverage && state->visibleMaxNodes == maxNodes &&
+        state->levelLoads == levelLoads && state->keepMinLevel == keepMinLevel)
+    {
+        return {state->visibleLevel,state->visibleCoverage};
+    }
+
     // Max level is the one we want to load (or try anyway)
     int targetLevel = -1;
+    if (state)
+    {
+        for (const auto &inode: state->nodes)
+            targetLevel = std::max(targetLevel,inode.level);
+    }
     for (const auto &inode: sortedNodes)
         targetLevel = std::max(targetLevel,inode.level);
  
@@ -289,7 +443,266 @@ std::tuple<int,QuadTreeNew::ImportantNodeSet> QuadTreeNew::calcCoverageVisible(
         chosenLevel--;
     }
 
+    if (state && !shutdown)
+    {
+        state->hasVisibleCoverage = true;
+        state->visibleMaxNodes = maxNodes;
+        state->levelLoads = levelLoads;
+        state->keepMinLevel = keepMinLevel;
+        state->visibleLevel = chosenLevel;
+        state->visibleCoverage = chosenNodes;
+    }
+
     return {chosenLevel,chosenNodes};
 }
+
+void QuadTreeNew::calcCoverageDelta(const ImportantNodeSet &oldNodes,const ImportantNodeSet &newNodes,
+                                    bool changedOnly,ImportantNodeSet &toAdd,NodeSet &toRemove,
+                                    ImportantNodeSet &toUpdate)
+{
+    // Old importance values by node number, since the sets are sorted by importance
+    std::unordered_map<int64_t,double> oldImport;
+    oldImport.reserve(oldNodes.size());
+    for (const auto &node : oldNodes)
+    {
+        oldImport[node.NodeNumber()] = node.importance;
+    }
+
+    for (const auto &node : newNodes)
+    {
+        const auto it = oldImport.find(node.NodeNumber());
+        if (it == oldImport.end())
+        {
+            toAdd.insert(node);
+        }
+        else
+        {
+            if (!changedOnly || it->second != node.importance)
+            {
+                toUpdate.insert(node);
+            }
+            // Anything left over at the end is a remove
+            oldImport.erase(it);
+        }
+    }
+
+    if (!oldImport.empty())
+    {
+        for (const auto &node : oldNodes)
+        {
+            if (oldImport.find(node.NodeNumber()) != oldImport.end())
+            {
+                toRemove.insert(node);
+            }
+        }
+    }
+}
+
+bool QuadTreeNew::Footprint::addCopy(const Point3d &copy)
+{
+    if (numCopies >= MaxCopies)
+    {
+        return false;
+    }
+    copies[numCopies++] = copy;
+    return true;
+}
+
+bool QuadTreeNew::Footprint::closeTo(const Footprint &that,double threshold) const
+{
+    if (numCopies != that.numCopies)
+    {
+        return false;
+    }
+    for (int ii=0;ii<numCopies;ii++)
+    {
+        if ((copies[ii] - that.copies[ii]).cwiseAbs().maxCoeff() > threshold)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void QuadTreeNew::setIncremental(bool enable,double threshold)
+{
+    incremental = enable;
+    footprintThreshold = threshold;
+    if (!incremental)
+    {
+        resetIncremental();
+    }
+}
+
+void QuadTreeNew::setParallel(TaskPoolRef pool,int splitLevel)
+{
+    taskPool = std::move(pool);
+    parallelSplitLevel = splitLevel;
+}
+
+void QuadTreeNew::resetIncremental()
+{
+    incrementalStates.clear();
+    lastPass = nullptr;
+}
+
+QuadTreeNew::IncrementalState &QuadTreeNew::incrementalStateFor(const std::vector<double> &minImportance)
+{
+    for (const auto &state : incrementalStates)
+    {
+        if (state->minImportance == minImportance)
+        {
+            return *state;
+        }
+    }
+
+    // Only a few sets of cutoffs are in play at once, so drop the oldest
+    static constexpr size_t maxStates = 4;
+    if (incrementalStates.size() >= maxStates)
+    {
+        incrementalStates.erase(incrementalStates.begin());
+    }
+    incrementalStates.emplace_back(new IncrementalState());
+    incrementalStates.back()->minImportance = minImportance;
+    return *incrementalStates.back();
+}
+
+int QuadTreeNew::findLastRecord(const Node &node,size_t &cursor,size_t end) const
+{
+    // Siblings are visited in the same order every pass, so this is usually the first one
+    for (size_t ii=cursor;ii<end;ii=lastPass->records[ii].recordsEnd)
+    {
+        if (lastPass->records[ii].node == node)
+        {
+            cursor = lastPass->records[ii].recordsEnd;
+            return (int)ii;
+        }
+    }
+
+    return -1;
+}
+
+void QuadTreeNew::copyLastSubtree(int lastIndex)
+{
+    const SubtreeRecord &top = lastPass->records[lastIndex];
+
+    // Everything moves over by the same amount
+    const size_t recordShift = passRecords.size() - lastIndex;
+    const size_t nodeShift = passNodes.size() - top.nodesBegin;
+    const size_t rejectedShift = passRejected.size() - top.rejectedBegin;
+
+    for (size_t ii=lastIndex;ii<top.recordsEnd;ii++)
+    {
+        passRecords.push_back(lastPass->records[ii]);
+        SubtreeRecord &record = passRecords.back();
+        record.recordsEnd += recordShift;
+        record.nodesBegin += nodeShift;
+        record.nodesEnd += nodeShift;
+        record.rejectedBegin += rejectedShift;
+        record.rejectedEnd += rejectedShift;
+    }
+    passNodes.insert(passNodes.end(),lastPass->nodes.begin() + top.nodesBegin,lastPass->nodes.begin() + top.nodesEnd);
+    passRejected.insert(passRejected.end(),lastPass->rejected.begin() + top.rejectedBegin,lastPass->rejected.begin() + top.rejectedEnd);
+}
+
+void QuadTreeNew::evalNodeIncremental(ImportantNode &node,const std::vector<double> &minImportance,
+                                      int lastIndex,bool checkFootprint)
+{
+    // Stop recursing if we get a shutdown signal
+    if (UNLIKELY(shutdown) || node.level > maxLevel)
+    {
+        return;
+    }
+
+    // Where is it now and where was it when we last evaluated it?
+    const SubtreeRecord *last = (lastIndex >= 0) ? &lastPass->records[lastIndex] : nullptr;
+    size_t recordIndex = 0;
+    bool moved = true,movedFar = false;
+    if (checkFootprint)
+    {
+        SubtreeRecord record(node);
+        if (last && last->hasBounds)
+        {
+            record.center = last->center;
+            record.radius = last->radius;
+            record.hasBounds = true;
+        }
+        else if (!last)
+        {
+            record.hasBounds = nodeBounds(node,record.center,record.radius);
+        }
+        record.hasFootprint = record.hasBounds && nodeFootprint(record.center,record.radius,record.footprint);
+
+        if (record.hasFootprint && last && last->hasFootprint)
+        {
+            moved = !record.footprint.closeTo(last->footprint,footprintThreshold);
+            // When a node has moved well past the threshold, its children have
+            //  almost certainly moved too, so don't bother checking them.
+            movedFar = moved && !record.footprint.closeTo(last->footprint,4.0*footprintThreshold);
+        }
+
+        // Nothing has changed, so everything we decided last time still holds
+        if (!moved)
+        {
+            copyLastSubtree(lastIndex);
+            return;
+        }
+
+        recordIndex = passRecords.size();
+        passRecords.push_back(record);
+    }
+
+    const size_t nodesBegin = passNodes.size();
+    const size_t rejectedBegin = passRejected.size();
+
+    node.importance = (node.level >= minLevel) ? importance(node) : 0;
+    passEvaluated++;
+
+    assert(node.level < minImportance.size());
+
+    const auto levelMinImport = minImportance[node.level];
+    if (node.importance < levelMinImport && levelMinImport != MAXFLOAT)
+    {
+        const double ratio = (levelMinImport > 0.0) ? (node.importance / levelMinImport) : 1.0;
+        if (ratio > 0)
+        {
+            passRejected.push_back(RejectedNode{node.level,ratio});
+        }
+    }
+    else
+    {
+        if (node.level >= minLevel)
+        {
+            passNodes.push_back(node);
+        }
+
+        if (node.level < maxLevel)
+        {
+            const bool checkChildren = checkFootprint && !movedFar;
+            size_t cursor = (last && checkChildren) ? lastIndex + 1 : 0;
+            const size_t lastEnd = (last && checkChildren) ? last->recordsEnd : 0;
+            for (int iy=0;iy<2;iy++)
+            {
+                const int indY = 2*node.y + iy;
+                for (int ix=0;ix<2;ix++)
+                {
+                    ImportantNode childNode(2*node.x + ix, indY,node.level + 1);
+                    const int childIndex = findLastRecord(childNode,cursor,lastEnd);
+                    evalNodeIncremental(childNode,minImportance,childIndex,checkChildren);
+                }
+            }
+        }
+    }
+
+    if (checkFootprint)
+    {
+        SubtreeRecord &record = passRecords[recordIndex];
+        record.recordsEnd = passRecords.size();
+        record.nodesBegin = nodesBegin;
+        record.nodesEnd = passNodes.size();
+        record.rejectedBegin = rejectedBegin;
+        record.rejectedEnd = passRejected.size();
+    }
+}
     
 }
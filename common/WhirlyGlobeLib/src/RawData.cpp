@@ -20,6 +20,11 @@
 #include <string>
 #include <cstring>
 #include <utility>
+#include <climits>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #import "RawData.h"
 
 namespace WhirlyKit
@@ -179,4 +184,25 @@ RawDataWrapper *RawDataFromFile(FILE *fp,unsigned int dataLen)
     return new RawDataWrapper(data,dataLen,true);
 }
 
+RawDataRef RawDataMapFile(const std::string &fileName)
+{
+    const int fd = ::open(fileName.c_str(),O_RDONLY);
+    if (fd < 0)
+        return nullptr;
+
+    struct stat info = {};
+    if (fstat(fd,&info) != 0 || info.st_size <= 0 || (uint64_t)info.st_size > UINT_MAX)
+    {
+        ::close(fd);
+        return nullptr;
+    }
+    const size_t len = (size_t)info.st_size;
+    void *addr = mmap(nullptr,len,PROT_READ,MAP_PRIVATE,fd,0);
+    ::close(fd);
+    if (addr == MAP_FAILED)
+        return nullptr;
+
+    return std::make_shared<RawDataWrapper>(addr,len,[len](const void *ptr){ munmap((void *)ptr,len); });
+}
+
 }
@@ -37,6 +37,7 @@
 #import "BillboardManager.h"
 #import "GeometryManager.h"
 #import "ComponentManager.h"
+#import "TraceEvents.h"
 
 #if __clang_major__ >= 3
 #include <cxxabi.h>
@@ -174,6 +175,7 @@ Scene::~Scene()
 #endif
 
     auto theChangeRequests = std::move(changeRequests);
+    incomingChanges.drain(theChangeRequests);
     for (auto *theChangeRequest : theChangeRequests)
     {
         delete theChangeRequest;
@@ -231,32 +233,40 @@ void Scene::setDisplayAdapter(CoordSystemDisplayAdapter *newCoordAdapter)
 // Add change requests to our list
 void Scene::addChangeRequests(ChangeSet &newChanges)
 {
-    std::lock_guard<std::mutex> guardLock(changeRequestLock);
-    for (ChangeRequest *change : newChanges) {
-        if (change && change->when > 0.0)
-            timedChangeRequests.insert(change);
-        else
-            changeRequests.push_back(change);
-    }
+    incomingChanges.push(newChanges);
     newChanges.clear();
 }
 
 // Add a single change request
 void Scene::addChangeRequest(ChangeRequest *newChange)
 {
-    std::lock_guard<std::mutex> guardLock(changeRequestLock);
+    incomingChanges.push(newChange);
+}
 
-    if (newChange && newChange->when > 0.0)
-        timedChangeRequests.insert(newChange);
-    else
-        changeRequests.push_back(newChange);
+// Sort out the incoming changes into the immediate and timed ones.
+// Called with the change request lock held.
+void Scene::takeIncomingChanges()
+{
+    if (incomingChanges.empty())
+    {
+        return;
+    }
+
+    ChangeSet newChanges;
+    incomingChanges.drain(newChanges);
+    for (ChangeRequest *change : newChanges) {
+        if (change && change->when > 0.0)
+            timedChangeRequests.insert(change);
+        else
+            changeRequests.push_back(change);
+    }
 }
 
 int Scene::getNumChangeRequests() const
 {
     std::lock_guard<std::mutex> guardLock(changeRequestLock);
 
-    return changeRequests.size();
+    return changeRequests.size() + incomingChanges.size();
 }
 
 DrawableRef Scene::getDrawable(SimpleIdentity drawId) const
@@ -402,6 +412,8 @@ int Scene::preProcessChanges(WhirlyKit::View *view,SceneRenderer *renderer,__unu
 
     {
         std::lock_guard<std::mutex> guardLock(changeRequestLock);
+        takeIncomingChanges();
+
         // Just doing the ones that require a pre-process
         for (auto &req : changeRequests)
         {
@@ -430,12 +442,15 @@ int Scene::preProcessChanges(WhirlyKit::View *view,SceneRenderer *renderer,__unu
 // We'll grab the lock and we're only expecting to be called in the rendering thread
 int Scene::processChanges(WhirlyKit::View *view,SceneRenderer *renderer,TimeInterval now)
 {
+    WK_TRACE_SCOPE("scene","Scene::processChanges");
+
     // Set up a local collection of approximately the same capacity before locking
     decltype(changeRequests) localChanges;
     localChanges.reserve(changeRequests.capacity());
 
     {
         std::lock_guard<std::mutex> guardLock(changeRequestLock);
+        takeIncomingChanges();
 
         // See if any of the timed changes are ready
         if (!timedChangeRequests.empty())
@@ -474,16 +489,18 @@ int Scene::processChanges(WhirlyKit::View *view,SceneRenderer *renderer,TimeInte
 
     const auto processed = (int)localChanges.size();
     localChanges.clear();
+    WK_TRACE_COUNTER("scene","Changes processed",processed);
     return processed;
 }
     
 bool Scene::hasChanges(TimeInterval now) const
 {
-    bool changes = false;
+    // Some of these may be timed changes for later, but that just costs us a frame
+    bool changes = !incomingChanges.empty();
     std::unique_lock<std::mutex> lock(changeRequestLock,std::try_to_lock);
     if (lock.owns_lock())
     {
-        changes = !changeRequests.empty();
+        changes = changes || !changeRequests.empty();
         
         if (!changes && !timedChangeRequests.empty())
             changes = now >= (*timedChangeRequests.begin())->when;
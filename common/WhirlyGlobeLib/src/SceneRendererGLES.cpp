@@ -174,80 +174,6 @@ bool SceneRendererGLES::resize(int sizeX,int sizeY)
 
 SceneRendererGLES::~SceneRendererGLES() = default;
 
-// Keep track of a drawable and the MVP we're supposed to use with it
-class DrawableContainer
-{
-public:
-    explicit DrawableContainer(DrawableGLES *draw) :
-        drawable(draw),
-        mvpMat(Eigen::Matrix4d::Identity()),
-        mvMat(Eigen::Matrix4d::Identity()),
-        mvNormalMat(Eigen::Matrix4d::Identity())
-    {
-    }
-
-    DrawableContainer(DrawableGLES *draw,Matrix4d mvpMat,Matrix4d mvMat,Matrix4d mvNormalMat) :
-        drawable(draw),
-        mvpMat(std::move(mvpMat)),
-        mvMat(std::move(mvMat)),
-        mvNormalMat(std::move(mvNormalMat))
-    {
-    }
-
-    DrawableGLES *drawable;
-    Matrix4d mvpMat,mvMat,mvNormalMat;
-};
-
-// Alpha stuff goes at the end
-// Otherwise sort by draw priority
-class DrawListSortStruct2
-{
-public:
-    DrawListSortStruct2() = delete;
-    DrawListSortStruct2(bool useZBuffer,const RendererFrameInfo *frameInfo) : useZBuffer(useZBuffer), frameInfo(frameInfo)
-    {
-    }
-    DrawListSortStruct2(const DrawListSortStruct2 &that) = default;
-    DrawListSortStruct2 & operator =(const DrawListSortStruct2 &that)
-    {
-        if (this != &that)
-        {
-            useZBuffer = that.useZBuffer;
-            frameInfo = that.frameInfo;
-        }
-        return *this;
-    }
-    bool operator()(const DrawableContainer &conA, const DrawableContainer &conB) const
-    {
-        const Drawable *a = conA.drawable;
-        const Drawable *b = conB.drawable;
-
-        if (a->getDrawPriority() == b->getDrawPriority())
-        {
-            if (useZBuffer)
-            {
-                const bool bufferA = a->getRequestZBuffer();
-                const bool bufferB = b->getRequestZBuffer();
-                if (bufferA != bufferB)
-                    return !bufferA;
-            }
-            // Ensure a stable order among items with identical priority and z-buffering
-            const auto idA = a->getId();
-            const auto idB = b->getId();
-            if (idA == idB) {
-                // Different offsets of the same item
-                return (&conA < &conB);
-            }
-            return (idA < idB);
-        }
-        
-        return a->getDrawPriority() < b->getDrawPriority();
-    }
-    
-    bool useZBuffer;
-    const RendererFrameInfo *frameInfo;
-};
-
 void SceneRendererGLES::setExtraFrameMode(bool newMode)
 {
     extraFrameMode = newMode;
@@ -266,6 +192,9 @@ void SceneRendererGLES::render(TimeInterval duration)
         return;
     
     frameCount++;
+
+    WK_TRACE_INSTANT("render","Frame");
+    WK_TRACE_SPAN(frameTrace,"render","Render Frame");
         
     theView->animate();
     
@@ -393,6 +322,7 @@ void SceneRendererGLES::render(TimeInterval duration)
         
         if (UNLIKELY(reportStats))
             perfTimer.startTiming("Scene preprocessing");
+        WK_TRACE_SPAN(preProcessTrace,"render","Scene preprocessing");
         
         // Run the preprocess for the changes.  These modify things the active models need.
         // Since the results won't actually be drawn instantly, consider changes up to half a frame ahead.
@@ -401,6 +331,7 @@ void SceneRendererGLES::render(TimeInterval duration)
         if (UNLIKELY(reportStats))
             perfTimer.addCount("Preprocess Changes", numPreProcessChanges);
         
+        preProcessTrace.end();
         if (UNLIKELY(reportStats))
             perfTimer.stopTiming("Scene preprocessing");
         
@@ -427,75 +358,29 @@ void SceneRendererGLES::render(TimeInterval duration)
             perfTimer.startTiming("Scene processing");
         
         // Merge any outstanding changes into the scenegraph
-        scene->processChanges(theView,this,now + duration / 2);
+        const int numChanges = scene->processChanges(theView,this,now + duration / 2);
 
         if (UNLIKELY(reportStats))
             perfTimer.stopTiming("Scene processing");
         
-        // Work through the available offset matrices (only 1 if we're not wrapping)
-        const std::vector<Matrix4d> &offsetMats = baseFrameInfo.offsetMatrices;
-        // Turn these drawables in to a vector
-        std::vector<DrawableContainer> drawList;
-        std::vector<DrawableRef> screenDrawables;
-        std::vector<DrawableRef> generatedDrawables;
-        std::vector<Matrix4d> mvpMats;
-        std::vector<Matrix4d> mvpInvMats;
-        std::vector<Matrix4f> mvpMats4f;
-        std::vector<Matrix4f> mvpInvMats4f;
-        mvpMats.resize(offsetMats.size());
-        mvpInvMats.resize(offsetMats.size());
-        mvpMats4f.resize(offsetMats.size());
-        mvpInvMats4f.resize(offsetMats.size());
-        for (unsigned int off=0;off<offsetMats.size();off++)
+        if (numPreProcessChanges > 0 || numChanges > 0)
+            drawListBuilder.invalidate();
+
+        if (UNLIKELY(reportStats))
+            perfTimer.startTiming("Cull and Sort");
+        WK_TRACE_SPAN(cullTrace,"render","Cull and Sort");
+
+        // Figure out what's visible and sort it (possibly multiple of the same if we have offset matrices)
+        drawListBuilder.setSortZBuffer(zBufferMode == zBufferOffDefault);
+        const DrawList &drawList = drawListBuilder.build(&baseFrameInfo,scene->getDrawables());
+        cullTrace.end();
+
+        if (UNLIKELY(reportStats))
         {
-            RendererFrameInfoGLES offFrameInfo(baseFrameInfo);
-            // Tweak with the appropriate offset matrix
-            modelAndViewMat4d = viewTrans4d * offsetMats[off] * modelTrans4d;
-            pvMat = projMat4d * viewTrans4d * offsetMats[off];
-            modelAndViewMat = Matrix4dToMatrix4f(modelAndViewMat4d);
-            mvpMats[off] = projMat4d * modelAndViewMat4d;
-            mvpInvMats[off] = (Eigen::Matrix4d)mvpMats[off].inverse();
-            mvpMats4f[off] = Matrix4dToMatrix4f(mvpMats[off]);
-            mvpInvMats4f[off] = Matrix4dToMatrix4f(mvpInvMats[off]);
-            modelAndViewNormalMat4d = modelAndViewMat4d.inverse().transpose();
-            modelAndViewNormalMat = Matrix4dToMatrix4f(modelAndViewNormalMat4d);
-            const Matrix4d &thisMvpMat = mvpMats[off];
-            offFrameInfo.mvpMat = mvpMats4f[off];
-            offFrameInfo.mvpInvMat = mvpInvMats4f[off];
-            mvpNormalMat4f = Matrix4dToMatrix4f(mvpMats[off].inverse().transpose());
-            offFrameInfo.mvpNormalMat = mvpNormalMat4f;
-            offFrameInfo.viewModelNormalMat = modelAndViewNormalMat;
-            offFrameInfo.viewAndModelMat4d = modelAndViewMat4d;
-            offFrameInfo.viewAndModelMat = modelAndViewMat;
-            offFrameInfo.pvMat = Matrix4dToMatrix4f(pvMat);
-            offFrameInfo.pvMat4d = pvMat;
-
-            const auto rawDrawables = scene->getDrawables();
-            drawList.reserve(rawDrawables.size());
-            for (auto *draw : rawDrawables)
-            {
-                auto *theDrawable = dynamic_cast<DrawableGLES *>(draw);
-                if (theDrawable && theDrawable->isOn(&offFrameInfo))
-                {
-                    if (const Matrix4d *localMat = theDrawable->getMatrix())
-                    {
-                        Matrix4d newMvpMat = thisMvpMat * (*localMat);
-                        Matrix4d newMvMat = modelAndViewMat4d * (*localMat);
-                        Matrix4d newMvNormalMat = newMvMat.inverse().transpose();
-                        drawList.emplace_back(theDrawable,newMvpMat,newMvMat,newMvNormalMat);
-                    }
-                    else
-                    {
-                        drawList.emplace_back(theDrawable,thisMvpMat,modelAndViewMat4d,modelAndViewNormalMat4d);
-                    }
-                }
-            }
+            perfTimer.stopTiming("Cull and Sort");
+            perfTimer.addCount("Draw list reused", drawListBuilder.wasReused() ? 1 : 0);
         }
-        
-        // Sort the drawables (possibly multiple of the same if we have offset matrices)
-        const bool sortLinesToEnd = (zBufferMode == zBufferOffDefault);
-        std::sort(drawList.begin(),drawList.end(),DrawListSortStruct2(sortLinesToEnd,&baseFrameInfo));
-        
+
         if (UNLIKELY(reportStats))
             perfTimer.startTiming("Calculation Shaders");
 
@@ -552,6 +437,7 @@ void SceneRendererGLES::render(TimeInterval duration)
         
         if (UNLIKELY(reportStats))
             perfTimer.startTiming("Draw Execution");
+        WK_TRACE_SPAN(drawTrace,"render","Draw Execution");
         
         SimpleIdentity curProgramId = EmptyIdentity;
         
@@ -576,6 +462,10 @@ void SceneRendererGLES::render(TimeInterval duration)
             //bool depthMaskOn = (zBufferMode == zBufferOn);
             for (const auto &drawContain : drawList)
             {
+                auto *theDrawable = dynamic_cast<DrawableGLES *>(drawContain.drawable);
+                if (!theDrawable)
+                    continue;
+
                 // For this mode we turn the z buffer off until we get a request to turn it on
                 if (zBufferMode == zBufferOffDefault)
                 {
@@ -599,7 +489,7 @@ void SceneRendererGLES::render(TimeInterval duration)
                 
                 // Set up transforms to use right now
                 const Matrix4f currentMvpMat = Matrix4dToMatrix4f(drawContain.mvpMat);
-                const Matrix4f currentMvpInvMat = Matrix4dToMatrix4f(drawContain.mvpMat.inverse());
+                const Matrix4f currentMvpInvMat = Matrix4dToMatrix4f(drawContain.mvpInvMat);
                 const Matrix4f currentMvMat = Matrix4dToMatrix4f(drawContain.mvMat);
                 const Matrix4f currentMvNormalMat = Matrix4dToMatrix4f(drawContain.mvNormalMat);
                 baseFrameInfo.mvpMat = currentMvpMat;
@@ -653,7 +543,7 @@ void SceneRendererGLES::render(TimeInterval duration)
                     perfTimer.startTiming("Draw Drawables");
 
                 // Draw using the given program
-                drawContain.drawable->draw(&baseFrameInfo,scene);
+                theDrawable->draw(&baseFrameInfo,scene);
 
                 if (UNLIKELY(reportStats))
                     perfTimer.stopTiming("Draw Drawables");
@@ -666,15 +556,13 @@ void SceneRendererGLES::render(TimeInterval duration)
             }
         }
         
+        drawTrace.end();
+        WK_TRACE_COUNTER("render","Drawables drawn",numDrawables);
         if (UNLIKELY(reportStats))
             perfTimer.stopTiming("Draw Execution");
 
         if (UNLIKELY(reportStats))
             perfTimer.addCount("Drawables drawn", numDrawables);
-
-        // Anything generated needs to be cleaned up
-        generatedDrawables.clear();
-        drawList.clear();
     }
     
     //    if (UNLIKELY(reportStats))
@@ -688,6 +576,7 @@ void SceneRendererGLES::render(TimeInterval duration)
     
     if (UNLIKELY(reportStats))
         perfTimer.startTiming("Present Renderbuffer");
+    WK_TRACE_SPAN(presentTrace,"render","Present Renderbuffer");
 
 #ifndef __ANDROID__
     // Explicitly discard the depth buffer
@@ -701,7 +590,9 @@ void SceneRendererGLES::render(TimeInterval duration)
     
     // Snapshots tend to be platform specific
     snapshotCallback(now);
-    
+
+    presentTrace.end();
+    frameTrace.end();
     if (UNLIKELY(reportStats))
         perfTimer.stopTiming("Present Renderbuffer");
     
@@ -718,7 +609,8 @@ void SceneRendererGLES::render(TimeInterval duration)
         if (UNLIKELY(reportStats))
             perfTimer.startTiming("Scene processing 2");
 
-        scene->processChanges(theView, this, newNow + duration / 2);
+        if (scene->processChanges(theView, this, newNow + duration / 2) > 0)
+            drawListBuilder.invalidate();
 
         if (UNLIKELY(reportStats))
             perfTimer.stopTiming("Scene processing 2");
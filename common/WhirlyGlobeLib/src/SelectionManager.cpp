@@ -102,6 +102,235 @@ SelectionManager::SelectionManager(Scene *scene)
 {
 }
 
+// Expand the bounds to hold the given point
+static inline void addToBounds(const Point3d &pt,Point3d &ll,Point3d &ur)
+{
+    ll = ll.cwiseMin(pt);
+    ur = ur.cwiseMax(pt);
+}
+
+// Display space bounds of the various selectables
+static void calcBounds(const RectSelectable3D &sel,Point3d &ll,Point3d &ur)
+{
+    for (const auto &pt : sel.pts)
+        addToBounds(pt.cast<double>(),ll,ur);
+}
+
+static void calcBounds(const RectSelectable2D &sel,Point3d &ll,Point3d &ur)
+{
+    addToBounds(sel.center,ll,ur);
+}
+
+static void calcBounds(const MovingRectSelectable2D &sel,Point3d &ll,Point3d &ur)
+{
+    // It moves in a straight line, so the ends will do
+    addToBounds(sel.center,ll,ur);
+    addToBounds(sel.endCenter,ll,ur);
+}
+
+static void calcBounds(const PolytopeSelectable &sel,Point3d &ll,Point3d &ur)
+{
+    for (const auto &poly : sel.polys)
+        for (const auto &pt : poly)
+            addToBounds(pt.cast<double>() + sel.centerPt,ll,ur);
+}
+
+static void calcBounds(const MovingPolytopeSelectable &sel,Point3d &ll,Point3d &ur)
+{
+    for (const auto &poly : sel.polys)
+        for (const auto &pt : poly)
+        {
+            addToBounds(pt.cast<double>() + sel.centerPt,ll,ur);
+            addToBounds(pt.cast<double>() + sel.endCenterPt,ll,ur);
+        }
+}
+
+static void calcBounds(const LinearSelectable &sel,Point3d &ll,Point3d &ur)
+{
+    for (const auto &pt : sel.pts)
+        addToBounds(pt,ll,ur);
+}
+
+static void calcBounds(const BillboardSelectable &sel,Point3d &ll,Point3d &ur)
+{
+    // It turns to face the viewer, so it could be anywhere in this range
+    const double rad = (sel.size.x()/2.0 + sel.size.y()) * sel.normal.norm();
+    addToBounds(sel.center - Point3d(rad,rad,rad),ll,ur);
+    addToBounds(sel.center + Point3d(rad,rad,rad),ll,ur);
+}
+
+// How far a screen space selectable sticks out from its center
+static float calcScreenSize(const Selectable &)
+{
+    return 0.0f;
+}
+
+static float calcScreenSize(const RectSelectable2D &sel)
+{
+    float size = 0.0f;
+    for (const auto &pt : sel.pts)
+        size = std::max(size,pt.norm());
+    return size;
+}
+
+template <typename T>
+void SelectionManager::addToIndex(SelectableKind kind,const T &sel)
+{
+    if (!useIndex)
+        return;
+
+    Point3d ll(MAXFLOAT,MAXFLOAT,MAXFLOAT),ur(-MAXFLOAT,-MAXFLOAT,-MAXFLOAT);
+    calcBounds(sel,ll,ur);
+
+    const bool isScreen = (kind == SelectRect2D || kind == SelectMovingRect2D);
+    if (isScreen)
+        maxScreenSize = std::max(maxScreenSize,calcScreenSize(sel));
+
+    indexHandles[kind][sel.selectID] = kindIndex[kind].insert(ll.data(),ur.data(),sel.selectID);
+}
+
+void SelectionManager::removeFromIndex(SimpleIdentity selectID)
+{
+    if (!useIndex)
+        return;
+
+    for (int kind=0;kind<SelectNumKinds;kind++)
+    {
+        const auto it = indexHandles[kind].find(selectID);
+        if (it != indexHandles[kind].end())
+        {
+            kindIndex[kind].remove(it->second);
+            indexHandles[kind].erase(it);
+        }
+    }
+}
+
+void SelectionManager::rebuildIndex()
+{
+    for (int kind=0;kind<SelectNumKinds;kind++)
+    {
+        kindIndex[kind].clear();
+        indexHandles[kind].clear();
+    }
+    maxScreenSize = 0.0f;
+    if (!useIndex)
+        return;
+
+    for (const auto &sel : rect3Dselectables)
+        addToIndex(SelectRect3D,sel);
+    for (const auto &sel : rect2Dselectables)
+        addToIndex(SelectRect2D,sel);
+    for (const auto &sel : movingRect2Dselectables)
+        addToIndex(SelectMovingRect2D,sel);
+    for (const auto &sel : polytopeSelectables)
+        addToIndex(SelectPolytope,sel);
+    for (const auto &sel : movingPolytopeSelectables)
+        addToIndex(SelectMovingPolytope,sel);
+    for (const auto &sel : linearSelectables)
+        addToIndex(SelectLinear,sel);
+    for (const auto &sel : billboardSelectables)
+        addToIndex(SelectBillboard,sel);
+}
+
+void SelectionManager::setUseSpatialIndex(bool newUseIndex)
+{
+    std::lock_guard<std::mutex> guardLock(lock);
+
+    if (useIndex == newUseIndex)
+        return;
+    useIndex = newUseIndex;
+    rebuildIndex();
+}
+
+// Planes around the part of display space that projects into the given screen rectangle.
+// There's a set of five for each of the view matrices (more than one if the map wraps).
+static void calcPickPlanes(const SelectionManager::PlacementInfo &pInfo,const Point2f &ll,const Point2f &ur,Vector4dVector &planes)
+{
+    // Screen rectangle in normalized device coordinates.  Screen y runs down.
+    const Point2f &frameSize = pInfo.frameSizeScale;
+    const double minX = 2.0 * ll.x() / frameSize.x() - 1.0;
+    const double maxX = 2.0 * ur.x() / frameSize.x() - 1.0;
+    const double minY = 1.0 - 2.0 * ur.y() / frameSize.y();
+    const double maxY = 1.0 - 2.0 * ll.y() / frameSize.y();
+
+    planes.clear();
+    planes.reserve(5 * pInfo.viewState->fullMatrices.size());
+    for (const auto &fullMat : pInfo.viewState->fullMatrices)
+    {
+        const Matrix4d mat = pInfo.viewState->projMatrix * fullMat;
+        const Vector4d rowX = mat.row(0).transpose();
+        const Vector4d rowY = mat.row(1).transpose();
+        const Vector4d rowW = mat.row(3).transpose();
+        planes.emplace_back(rowX - minX * rowW);
+        planes.emplace_back(maxX * rowW - rowX);
+        planes.emplace_back(rowY - minY * rowW);
+        planes.emplace_back(maxY * rowW - rowY);
+        planes.emplace_back(rowW);
+    }
+}
+
+// True if some part of the box might be inside any of the sets of planes
+static bool boxInPickPlanes(const Vector4dVector &planes,const double *ll,const double *ur)
+{
+    for (unsigned int pi=0;pi+5<=planes.size();pi+=5)
+    {
+        bool inside = true;
+        for (unsigned int ii=pi;ii<pi+5 && inside;ii++)
+        {
+            // Check the corner furthest along the normal
+            const Vector4d &plane = planes[ii];
+            double dist = plane.w();
+            for (unsigned int ci=0;ci<3;ci++)
+                dist += plane[ci] * (plane[ci] >= 0.0 ? ur[ci] : ll[ci]);
+            inside = dist >= 0.0;
+        }
+        if (inside)
+            return true;
+    }
+    return false;
+}
+
+void SelectionManager::findCandidates(const PlacementInfo &pInfo,const Point2f &ll,const Point2f &ur,
+                                      std::vector<SimpleIdentity> *candidates)
+{
+    Vector4dVector planes,screenPlanes;
+    calcPickPlanes(pInfo,ll,ur,planes);
+
+    // The screen space objects can stick out from their centers
+    const Point2f screenBuffer(maxScreenSize,maxScreenSize);
+    calcPickPlanes(pInfo,ll - screenBuffer,ur + screenBuffer,screenPlanes);
+
+    for (int kind=0;kind<SelectNumKinds;kind++)
+    {
+        const Vector4dVector &kindPlanes = (kind == SelectRect2D || kind == SelectMovingRect2D) ? screenPlanes : planes;
+        std::vector<SimpleIdentity> &kindCandidates = candidates[kind];
+        kindIndex[kind].query([&kindPlanes](const double *boxLL,const double *boxUR) {
+            return boxInPickPlanes(kindPlanes,boxLL,boxUR);
+        },[&kindCandidates](uint64_t selectID) {
+            kindCandidates.push_back(selectID);
+        });
+    }
+}
+
+// Run over a set of selectables, or just the ones we've got candidates for
+template <typename TSet,typename TFunc>
+static void forSelectables(const TSet &selSet,const std::vector<SimpleIdentity> *candidates,const TFunc &func)
+{
+    if (!candidates)
+    {
+        for (const auto &sel : selSet)
+            func(sel);
+        return;
+    }
+
+    for (const SimpleIdentity selectID : *candidates)
+    {
+        const auto it = selSet.find(typename TSet::value_type(selectID));
+        if (it != selSet.end())
+            func(*it);
+    }
+}
+
 // Add a rectangle (in 3-space) available for selection
 void SelectionManager::addSelectableRect(SimpleIdentity selectId,const Point3f *pts,bool enable)
 {
@@ -120,7 +349,9 @@ void SelectionManager::addSelectableRect(SimpleIdentity selectId,const Point3f *
     }
 
     std::lock_guard<std::mutex> guardLock(lock);
-    rect3Dselectables.insert(std::move(newSelect));
+    const auto res = rect3Dselectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectRect3D,*res.first);
 }
 
 // Add a rectangle (in 3-space) for selection, but only between the given visibilities
@@ -142,7 +373,9 @@ void SelectionManager::addSelectableRect(SimpleIdentity selectId,const Point3f *
     }
 
     std::lock_guard<std::mutex> guardLock(lock);
-    rect3Dselectables.insert(std::move(newSelect));
+    const auto res = rect3Dselectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectRect3D,*res.first);
 }
 
 /// Add a screen space rectangle (2D) for selection, between the given visibilities
@@ -168,7 +401,9 @@ void SelectionManager::addSelectableScreenRect(SimpleIdentity selectId,const Poi
     }
     
     std::lock_guard<std::mutex> guardLock(lock);
-    rect2Dselectables.insert(std::move(newSelect));
+    const auto res = rect2Dselectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectRect2D,*res.first);
 }
 
 /// Add a screen space rectangle (2D) for selection, between the given visibilities
@@ -199,7 +434,9 @@ void SelectionManager::addSelectableMovingScreenRect(SimpleIdentity selectId,con
     }
     
     std::lock_guard<std::mutex> guardLock(lock);
-    movingRect2Dselectables.insert(std::move(newSelect));
+    const auto res = movingRect2Dselectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectMovingRect2D,*res.first);
 }
 
 static const int corners[6][4] = {{0,1,2,3},{7,6,5,4},{1,0,4,5},{1,5,6,2},{2,6,7,3},{3,7,4,0}};
@@ -241,7 +478,9 @@ void SelectionManager::addSelectableRectSolid(SimpleIdentity selectId,const Poin
     
     {
         std::lock_guard<std::mutex> guardLock(lock);
-        polytopeSelectables.insert(std::move(newSelect));
+        const auto res = polytopeSelectables.insert(std::move(newSelect));
+        if (res.second)
+            addToIndex(SelectPolytope,*res.first);
     }
 }
 
@@ -280,7 +519,9 @@ void SelectionManager::addSelectableRectSolid(SimpleIdentity selectId,const Poin
     }
     
     std::lock_guard<std::mutex> guardLock(lock);
-    polytopeSelectables.insert(std::move(newSelect));
+    const auto res = polytopeSelectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectPolytope,*res.first);
 }
 
 void SelectionManager::addSelectableRectSolid(SimpleIdentity selectId,const BBox &bbox,
@@ -329,7 +570,9 @@ void SelectionManager::addPolytope(SimpleIdentity selectId,
     }
     
     std::lock_guard<std::mutex> guardLock(lock);
-    polytopeSelectables.insert(std::move(newSelect));
+    const auto res = polytopeSelectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectPolytope,*res.first);
 }
 
 void SelectionManager::addPolytopeFromBox(SimpleIdentity selectId,const Point3d &ll,const Point3d &ur,
@@ -406,7 +649,9 @@ void SelectionManager::addMovingPolytope(SimpleIdentity selectId,const std::vect
     }
     
     std::lock_guard<std::mutex> guardLock(lock);
-    movingPolytopeSelectables.insert(std::move(newSelect));
+    const auto res = movingPolytopeSelectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectMovingPolytope,*res.first);
 }
 
 void SelectionManager::addMovingPolytopeFromBox(SimpleIdentity selectID, const Point3d &ll, const Point3d &ur,
@@ -468,7 +713,9 @@ void SelectionManager::addSelectableLinear(SimpleIdentity selectId,const Point3d
     newSelect.pts = pts;
 
     std::lock_guard<std::mutex> guardLock(lock);
-    linearSelectables.insert(std::move(newSelect));
+    const auto res = linearSelectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectLinear,*res.first);
 }
 
 void SelectionManager::addSelectableBillboard(SimpleIdentity selectId,const Point3d &center,
@@ -489,7 +736,9 @@ void SelectionManager::addSelectableBillboard(SimpleIdentity selectId,const Poin
     newSelect.maxVis = maxVis;
     
     std::lock_guard<std::mutex> guardLock(lock);
-    billboardSelectables.insert(std::move(newSelect));
+    const auto res = billboardSelectables.insert(std::move(newSelect));
+    if (res.second)
+        addToIndex(SelectBillboard,*res.first);
 }
 
 void SelectionManager::enableSelectable(SimpleIdentity selectID,bool enable)
@@ -638,6 +887,8 @@ void SelectionManager::removeSelectable(SimpleIdentity selectID)
 {
     std::lock_guard<std::mutex> guardLock(lock);
 
+    removeFromIndex(selectID);
+
     const auto it = rect3Dselectables.find(RectSelectable3D(selectID));
     if (it != rect3Dselectables.end())
         rect3Dselectables.erase(it);
@@ -674,6 +925,8 @@ void SelectionManager::removeSelectables(const SimpleIDSet &selectIDs)
     
     for (const SimpleIdentity selectID : selectIDs)
     {
+        removeFromIndex(selectID);
+
         const auto it = rect3Dselectables.find(RectSelectable3D(selectID));
         if (it != rect3Dselectables.end())
         {
@@ -728,14 +981,16 @@ void SelectionManager::removeSelectables(const SimpleIDSet &selectIDs)
 //        NSLog(@"Tried to delete selectable that doesn't exist.");
 }
 
-void SelectionManager::getScreenSpaceObjects(const PlacementInfo &pInfo,std::vector<ScreenSpaceObjectLocation> &screenPts,TimeInterval now)
+void SelectionManager::getScreenSpaceObjects(const PlacementInfo &pInfo,std::vector<ScreenSpaceObjectLocation> &screenPts,TimeInterval now,
+                                             const std::vector<SimpleIdentity> *candidates)
 {
-    screenPts.reserve(rect2Dselectables.size() + movingRect2Dselectables.size());
-    for (const auto &sel : rect2Dselectables)
+    screenPts.reserve(candidates ? candidates[SelectRect2D].size() + candidates[SelectMovingRect2D].size() :
+                                   rect2Dselectables.size() + movingRect2Dselectables.size());
+    forSelectables(rect2Dselectables, candidates ? &candidates[SelectRect2D] : nullptr, [&](const RectSelectable2D &sel)
     {
         if (!sel.isVisibleAt(pInfo.heightAboveSurface))
         {
-            continue;
+            return;
         }
 
         screenPts.emplace_back();
@@ -748,13 +1003,13 @@ void SelectionManager::getScreenSpaceObjects(const PlacementInfo &pInfo,std::vec
             objLoc.pts.emplace_back(pt.x(),pt.y());
             objLoc.mbr.addPoint(pt);
         }
-    }
+    });
 
-    for (const auto & sel : movingRect2Dselectables)
+    forSelectables(movingRect2Dselectables, candidates ? &candidates[SelectMovingRect2D] : nullptr, [&](const MovingRectSelectable2D &sel)
     {
         if (!sel.isVisibleAt(pInfo.heightAboveSurface))
         {
-            continue;
+            return;
         }
         screenPts.emplace_back();
         ScreenSpaceObjectLocation &objLoc = screenPts.back();
@@ -766,7 +1021,7 @@ void SelectionManager::getScreenSpaceObjects(const PlacementInfo &pInfo,std::vec
             objLoc.pts.emplace_back(pt.x(),pt.y());
             objLoc.mbr.addPoint(pt);
         }
-    }
+    });
 }
 
 SelectionManager::PlacementInfo::PlacementInfo(ViewStateRef inViewState,SceneRenderer *renderer)
@@ -942,10 +1197,18 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
 
     std::lock_guard<std::mutex> guardLock(lock);
 
+    // Narrow it down to the objects near the touch, if we can
+    std::vector<SimpleIdentity> candidates[SelectNumKinds];
+    if (useIndex)
+    {
+        findCandidates(pInfo,touchPt - Point2f(maxDist,maxDist),touchPt + Point2f(maxDist,maxDist),candidates);
+    }
+    const auto candidatesFor = [&](SelectableKind kind) { return useIndex ? &candidates[kind] : nullptr; };
+
     // Figure out where the screen space objects are, both layout manager
     //  controlled and other
     std::vector<ScreenSpaceObjectLocation> ssObjs;
-    getScreenSpaceObjects(pInfo,ssObjs,now);
+    getScreenSpaceObjects(pInfo,ssObjs,now,useIndex ? candidates : nullptr);
     if (layoutManager)
         layoutManager->getScreenSpaceObjects(pInfo,ssObjs);
 
@@ -1045,11 +1308,11 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
     if (!polytopeSelectables.empty())
     {
         // Work through the axis aligned rectangular solids
-        for (const auto &sel : polytopeSelectables)
+        forSelectables(polytopeSelectables, candidatesFor(SelectPolytope), [&](const PolytopeSelectable &sel)
         {
             if (!sel.isVisibleAt(pInfo.heightAboveSurface))
             {
-                continue;
+                return;
             }
 
             float closeDist2 = MAXFLOAT;
@@ -1081,17 +1344,17 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
                 const float dist3d = (sel.centerPt - eyePos).norm();
                 selObjs.emplace_back(sel.selectID,dist3d,std::sqrt(closeDist2));
             }
-        }
+        });
     }
     
     if (!movingPolytopeSelectables.empty())
     {
         // Work through the axis aligned rectangular solids
-        for (const auto &sel : movingPolytopeSelectables)
+        forSelectables(movingPolytopeSelectables, candidatesFor(SelectMovingPolytope), [&](const MovingPolytopeSelectable &sel)
         {
             if (!sel.isVisibleAt(pInfo.heightAboveSurface))
             {
-                continue;
+                return;
             }
 
             // Current center
@@ -1126,14 +1389,14 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
                 const double dist3d = (centerPt - eyePos).norm();
                 selObjs.emplace_back(sel.selectID,dist3d,std::sqrt(closeDist2));
             }
-        }
+        });
     }
     
-    for (const auto &sel : linearSelectables)
+    forSelectables(linearSelectables, candidatesFor(SelectLinear), [&](const LinearSelectable &sel)
     {
         if (!sel.isVisibleAt(pInfo.heightAboveSurface))
         {
-            continue;
+            return;
         }
 
         Point2dVector p0Pts;
@@ -1170,14 +1433,14 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
         {
             selObjs.emplace_back(sel.selectID,closeDist3d,sqrtf(closeDist2));
         }
-    }
+    });
 
     // Work through the 3D rectangles
-    for (const auto &sel : rect3Dselectables)
+    forSelectables(rect3Dselectables, candidatesFor(SelectRect3D), [&](const RectSelectable3D &sel)
     {
         if (!sel.isVisibleAt(pInfo.heightAboveSurface))
         {
-            continue;
+            return;
         }
 
         screenPts.clear();
@@ -1233,15 +1496,14 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
         {
             selObjs.emplace_back(sel.selectID,closeDist3d,sqrtf(closeDist2));
         }
-    }
+    });
 
     // Work through the billboards
-    for (const auto &billboardSelectable : billboardSelectables)
+    forSelectables(billboardSelectables, candidatesFor(SelectBillboard), [&](const BillboardSelectable &sel)
     {
-        const BillboardSelectable &sel = billboardSelectable;
         if (sel.selectID == EmptyIdentity || !sel.enable)
         {
-            continue;
+            return;
         }
 
         // Come up with a rectangle in display space
@@ -1262,17 +1524,151 @@ void SelectionManager::pickObjects(const Point2f &touchPt,float maxDist,const Vi
         if (screenPts.size() > 2 && PointInPolygon(touchPt, screenPts))
         {
             closeDist2 = 0.0;
-            break;
         }
-
-        closeDist2 = checkScreenPts(screenPts, touchPt, closeDist2);
+        else
+        {
+            closeDist2 = checkScreenPts(screenPts, touchPt, closeDist2);
+        }
 
         if (closeDist2 < maxDist2)
         {
             const auto closeDist3d = (sel.center - eyePos).norm();
             selObjs.emplace_back(sel.selectID, closeDist3d, std::sqrt(closeDist2));
         }
-    }
+    });
 
 //    NSLog(@"Found %d selected objects",selObjs.size());
 }
+
+void SelectionManager::pickObjectsInRect(const Point2f &ll,const Point2f &ur,
+                                         const ViewStateRef &viewState,std::vector<SelectedObject> &selObjs)
+{
+    const Point2fVector screenPoly = { ll, Point2f(ur.x(),ll.y()), ur, Point2f(ll.x(),ur.y()) };
+    pickObjectsInPolygon(screenPoly,viewState,selObjs);
+}
+
+void SelectionManager::pickObjectsInPolygon(const Point2fVector &screenPoly,
+                                            const ViewStateRef &viewState,std::vector<SelectedObject> &selObjs)
+{
+    if (!renderer || screenPoly.size() < 3)
+        return;
+
+    PlacementInfo pInfo(viewState,renderer);
+    if (!pInfo.globeViewState && !pInfo.mapViewState)
+        return;
+
+    const TimeInterval now = scene->getCurrentTime();
+    const float scale = renderer->getScale();
+    const Point3d eyePos = pInfo.globeViewState ? pInfo.globeViewState->eyePos : pInfo.mapViewState->eyePos;
+    const auto layoutManager = scene->getManager<LayoutManager>(kWKLayoutManager);
+
+    Mbr polyMbr;
+    for (const auto &pt : screenPoly)
+        polyMbr.addPoint(pt);
+
+    std::lock_guard<std::mutex> guardLock(lock);
+
+    std::vector<SimpleIdentity> candidates[SelectNumKinds];
+    if (useIndex)
+    {
+        findCandidates(pInfo,polyMbr.ll(),polyMbr.ur(),candidates);
+    }
+    const auto candidatesFor = [&](SelectableKind kind) { return useIndex ? &candidates[kind] : nullptr; };
+
+    // See if a display space point lands inside in any of its (wrapped) locations
+    Point2dVector projPts;
+    const auto isInside = [&](const Point3d &dispPt)
+    {
+        projPts.clear();
+        projectWorldPointToScreen(dispPt,pInfo,projPts,scale);
+        for (const auto &projPt : projPts)
+        {
+            if (PointInPolygon(projPt.cast<float>(),screenPoly))
+                return true;
+        }
+        return false;
+    };
+
+    std::vector<ScreenSpaceObjectLocation> ssObjs;
+    getScreenSpaceObjects(pInfo,ssObjs,now,useIndex ? candidates : nullptr);
+    if (layoutManager)
+        layoutManager->getScreenSpaceObjects(pInfo,ssObjs);
+
+    for (const auto &screenObj : ssObjs)
+    {
+        if (screenObj.shapeIDs.empty() || !isInside(screenObj.dispLoc))
+        {
+            continue;
+        }
+
+        const auto coordAdapter = scene->getCoordAdapter();
+        const auto center = coordAdapter->getCoordSystem()->localToGeographic(coordAdapter->displayToLocal(screenObj.dispLoc));
+        for (SimpleIdentity shapeID : screenObj.shapeIDs)
+        {
+            selObjs.emplace_back(shapeID,(screenObj.dispLoc - eyePos).norm(),0.0);
+            auto &selObj = selObjs.back();
+            selObj.isCluster = screenObj.isCluster();
+            selObj.center = center;
+            selObj.clusterId = screenObj.clusterId;
+            selObj.clusterGroup = screenObj.clusterGroup;
+        }
+    }
+
+    forSelectables(polytopeSelectables, candidatesFor(SelectPolytope), [&](const PolytopeSelectable &sel)
+    {
+        if (sel.isVisibleAt(pInfo.heightAboveSurface) && isInside(sel.centerPt))
+        {
+            selObjs.emplace_back(sel.selectID,(sel.centerPt - eyePos).norm(),0.0);
+        }
+    });
+
+    forSelectables(movingPolytopeSelectables, candidatesFor(SelectMovingPolytope), [&](const MovingPolytopeSelectable &sel)
+    {
+        const double t = (now-sel.startTime)/sel.duration;
+        const Point3d centerPt = (sel.endCenterPt - sel.centerPt)*t + sel.centerPt;
+        if (sel.isVisibleAt(pInfo.heightAboveSurface) && isInside(centerPt))
+        {
+            selObjs.emplace_back(sel.selectID,(centerPt - eyePos).norm(),0.0);
+        }
+    });
+
+    forSelectables(linearSelectables, candidatesFor(SelectLinear), [&](const LinearSelectable &sel)
+    {
+        if (!sel.isVisibleAt(pInfo.heightAboveSurface))
+        {
+            return;
+        }
+        for (const auto &pt : sel.pts)
+        {
+            if (isInside(pt))
+            {
+                selObjs.emplace_back(sel.selectID,(pt - eyePos).norm(),0.0);
+                break;
+            }
+        }
+    });
+
+    forSelectables(rect3Dselectables, candidatesFor(SelectRect3D), [&](const RectSelectable3D &sel)
+    {
+        Point3d midPt(0,0,0);
+        for (const auto &pt : sel.pts)
+        {
+            midPt += pt.cast<double>();
+        }
+        midPt /= sizeof(sel.pts)/sizeof(sel.pts[0]);
+        if (sel.isVisibleAt(pInfo.heightAboveSurface) && isInside(midPt))
+        {
+            selObjs.emplace_back(sel.selectID,(midPt - eyePos).norm(),0.0);
+        }
+    });
+
+    forSelectables(billboardSelectables, candidatesFor(SelectBillboard), [&](const BillboardSelectable &sel)
+    {
+        if (sel.isVisibleAt(pInfo.heightAboveSurface) && isInside(sel.center))
+        {
+            selObjs.emplace_back(sel.selectID,(sel.center - eyePos).norm(),0.0);
+        }
+    });
+
+    std::sort(selObjs.begin(),selObjs.end(),selectedSorter);
+}
@@ -18,6 +18,10 @@
  *
  */
 
+#import <algorithm>
+#import <cmath>
+#import <cstring>
+#import <limits>
 #import "ShapeReader.h"
 #import "shapefil.h"
 #import "GlobeMath.h"
@@ -26,7 +30,9 @@ namespace WhirlyKit
 {
 
 ShapeReader::ShapeReader(const std::string &fileName)
-    : shp(NULL), dbf(NULL)
+    : shp(NULL), dbf(NULL), where(0), numEntity(0), shapeType(SHPT_NULL),
+      fileName(fileName), triedMap(false), numRecords(0),
+      dbfRecords(0), dbfHeaderLen(0), dbfRecordLen(0), indexBuilt(false)
 {
 	const char *cFile =  fileName.c_str();
 	shp = SHPOpen(cFile, "rb");
@@ -95,9 +101,9 @@ VectorShapeRef ShapeReader::getObjectByIndex(unsigned int vecIndex,const StringS
         case SHPT_MULTIPOINTZ:
         {
             VectorPointsRef points = VectorPoints::createPoints();
-            points->pts.reserve(thisShape->nParts);
+            points->pts.reserve(thisShape->nVertices);
             theShape = points;
-            for (unsigned int ii=0;ii<thisShape->nParts;ii++)
+            for (int ii=0;ii<thisShape->nVertices;ii++)
             {
                 Point2f pt(WhirlyKit::DegToRad<float>(thisShape->padfX[ii]),WhirlyKit::DegToRad<float>(thisShape->padfY[ii]));
                 points->pts.push_back(pt);
@@ -213,4 +219,427 @@ VectorShapeRef ShapeReader::getNextObject(const StringSet *filterAttrs)
     return retShape;
 }
 	
+
+namespace
+{
+
+// Shapefile records are little endian and not necessarily aligned
+inline int32_t ReadInt32LE(const unsigned char *ptr)
+{
+    int32_t val;
+    memcpy(&val,ptr,sizeof(val));
+    return val;
+}
+
+inline double ReadDoubleLE(const unsigned char *ptr)
+{
+    double val;
+    memcpy(&val,ptr,sizeof(val));
+    return val;
+}
+
+// The .shx offsets and lengths are big endian, in 16 bit words
+inline uint32_t ReadInt32BE(const unsigned char *ptr)
+{
+    return ((uint32_t)ptr[0] << 24) | ((uint32_t)ptr[1] << 16) | ((uint32_t)ptr[2] << 8) | ptr[3];
+}
+
+inline bool HostIsLittleEndian()
+{
+    const uint16_t val = 1;
+    unsigned char first;
+    memcpy(&first,&val,1);
+    return first == 1;
+}
+
+// The geometry is decoded to float, which can land past the double bounds in the header.
+// Round the bounds the same way and then out one more ulp so the index never misses a shape.
+inline double LowBoundToFloat(double deg)
+{
+    return std::nextafter(DegToRad<float>(deg),-std::numeric_limits<float>::infinity());
+}
+
+inline double HighBoundToFloat(double deg)
+{
+    return std::nextafter(DegToRad<float>(deg),std::numeric_limits<float>::infinity());
+}
+
+// Map one of the files that go with a shapefile.  Shapelib tries both cases for the extension.
+RawDataRef MapShapeFilePart(const std::string &fileName,const char *ext,const char *extUpper)
+{
+    std::string base = fileName;
+    const size_t dot = base.find_last_of('.');
+    const size_t slash = base.find_last_of("/\\");
+    if (dot != std::string::npos && (slash == std::string::npos || dot > slash))
+        base.resize(dot);
+
+    if (auto data = RawDataMapFile(base + ext))
+        return data;
+    return RawDataMapFile(base + extUpper);
+}
+
+// Same as shapelib's DBFReadStringAttribute, which trims white space
+void TrimField(const char *&str,size_t &len)
+{
+    while (len > 0 && *str == ' ')
+    {
+        str++;
+        len--;
+    }
+    while (len > 0 && str[len-1] == ' ')
+        len--;
+}
+
+}
+
+bool ShapeReader::mapFiles()
+{
+    if (triedMap)
+        return shpData && shxData;
+    triedMap = true;
+
+    if (!shp || !HostIsLittleEndian())
+        return false;
+
+    shpData = MapShapeFilePart(fileName,".shp",".SHP");
+    shxData = MapShapeFilePart(fileName,".shx",".SHX");
+    if (!shpData || !shxData || shxData->getLen() < 100 || shpData->getLen() < 100)
+    {
+        shpData.reset();
+        shxData.reset();
+        return false;
+    }
+    numRecords = std::min((unsigned int)(shxData->getLen() - 100) / 8,(unsigned int)numEntity);
+
+    // Work out the .dbf layout the way shapelib does
+    dbfData = MapShapeFilePart(fileName,".dbf",".DBF");
+    if (dbfData && dbfData->getLen() >= 32)
+    {
+        const unsigned char *header = dbfData->getRawData();
+        dbfRecords = header[4] | (header[5] << 8) | (header[6] << 16) | ((uint32_t)header[7] << 24);
+        dbfHeaderLen = header[8] | (header[9] << 8);
+        dbfRecordLen = header[10] | (header[11] << 8);
+        if (dbfHeaderLen < 32 || dbfHeaderLen > dbfData->getLen())
+            dbfRecords = 0;
+        else
+            dbfRecords = std::min(dbfRecords,(unsigned int)((dbfData->getLen() - dbfHeaderLen) / std::max(dbfRecordLen,1u)));
+
+        const unsigned int numFields = (dbfHeaderLen - 32) / 32;
+        unsigned int offset = 1;
+        for (unsigned int ii=0;ii<numFields && dbfRecords > 0;ii++)
+        {
+            const unsigned char *info = header + 32 + ii*32;
+            DBFField field;
+            char name[12];
+            strncpy(name,(const char *)info,11);
+            name[11] = 0;
+            for (int ci = 10; ci > 0 && name[ci] == ' '; ci--)
+                name[ci] = 0;
+            field.name = name;
+            field.dbfType = (char)info[11];
+            field.width = info[16];
+            field.offset = offset;
+            offset += field.width;
+            if (field.dbfType == 'L')
+                field.type = FieldSkip;
+            else if (field.dbfType == 'N' || field.dbfType == 'F')
+                field.type = (info[17] > 0 || field.width > 10) ? FieldDouble : FieldInt;
+            else
+                field.type = FieldString;
+            if (offset > dbfRecordLen)
+            {
+                dbfRecords = 0;
+                break;
+            }
+            dbfFields.push_back(field);
+        }
+    }
+
+    return true;
+}
+
+bool ShapeReader::recordBounds(unsigned int which,double *ll,double *ur) const
+{
+    const unsigned char *shx = shxData->getRawData() + 100 + which*8;
+    const uint64_t offset = (uint64_t)ReadInt32BE(shx) * 2 + 8;
+    const uint64_t len = (uint64_t)ReadInt32BE(shx+4) * 2;
+    if (len < 4 || offset + len > shpData->getLen())
+        return false;
+    const unsigned char *rec = shpData->getRawData() + offset;
+
+    switch (ReadInt32LE(rec))
+    {
+        case SHPT_POINT:
+        case SHPT_POINTZ:
+        case SHPT_POINTM:
+            if (len < 20)
+                return false;
+        {
+            const double x = ReadDoubleLE(rec+4), y = ReadDoubleLE(rec+12);
+            ll[0] = LowBoundToFloat(x);  ll[1] = LowBoundToFloat(y);
+            ur[0] = HighBoundToFloat(x);  ur[1] = HighBoundToFloat(y);
+            return true;
+        }
+        case SHPT_NULL:
+            return false;
+        default:
+            if (len < 36)
+                return false;
+            ll[0] = LowBoundToFloat(ReadDoubleLE(rec+4));
+            ll[1] = LowBoundToFloat(ReadDoubleLE(rec+12));
+            ur[0] = HighBoundToFloat(ReadDoubleLE(rec+20));
+            ur[1] = HighBoundToFloat(ReadDoubleLE(rec+28));
+            return true;
+    }
+}
+
+bool ShapeReader::buildIndex()
+{
+    if (indexBuilt)
+        return true;
+    if (!shp)
+        return false;
+
+    index.clear();
+    double ll[2],ur[2];
+    if (mapFiles())
+    {
+        for (unsigned int ii=0;ii<numRecords;ii++)
+            if (recordBounds(ii,ll,ur))
+                index.insert(ll,ur,ii);
+    } else {
+        // Slow way, through shapelib
+        for (int ii=0;ii<numEntity;ii++)
+        {
+            SHPObject *thisShape = SHPReadObject((SHPInfo *)shp, ii);
+            if (!thisShape)
+                continue;
+            if (thisShape->nSHPType != SHPT_NULL && thisShape->nVertices > 0)
+            {
+                ll[0] = LowBoundToFloat(thisShape->dfXMin);  ll[1] = LowBoundToFloat(thisShape->dfYMin);
+                ur[0] = HighBoundToFloat(thisShape->dfXMax);  ur[1] = HighBoundToFloat(thisShape->dfYMax);
+                index.insert(ll,ur,ii);
+            }
+            SHPDestroyObject(thisShape);
+        }
+    }
+    indexBuilt = true;
+
+    return true;
+}
+
+void ShapeReader::query(const Mbr &mbr,std::vector<unsigned int> &records)
+{
+    records.clear();
+    if (!buildIndex())
+        return;
+
+    const double ll[2] = {mbr.ll().x(),mbr.ll().y()};
+    const double ur[2] = {mbr.ur().x(),mbr.ur().y()};
+    index.queryBox(ll,ur,[&records](uint64_t which) { records.push_back((unsigned int)which); });
+    // Reading in file order is kinder to the disk
+    std::sort(records.begin(),records.end());
+}
+
+VectorShapeRef ShapeReader::decodeRecord(unsigned int which,const std::vector<const DBFField *> &fields) const
+{
+    if (which >= numRecords)
+        return VectorShapeRef();
+    const unsigned char *shx = shxData->getRawData() + 100 + which*8;
+    const uint64_t offset = (uint64_t)ReadInt32BE(shx) * 2 + 8;
+    const uint64_t len = (uint64_t)ReadInt32BE(shx+4) * 2;
+    if (len < 4 || offset + len > shpData->getLen())
+        return VectorShapeRef();
+    const unsigned char *rec = shpData->getRawData() + offset;
+    const int recType = ReadInt32LE(rec);
+    if (recType == SHPT_NULL)
+        return VectorShapeRef();
+
+    VectorShapeRef theShape;
+    switch (shapeType)
+    {
+        case SHPT_POINT:
+        case SHPT_POINTZ:
+        {
+            if (len < 20)
+                return VectorShapeRef();
+            VectorPointsRef points = VectorPoints::createPoints();
+            points->pts.emplace_back(DegToRad<float>(ReadDoubleLE(rec+4)),DegToRad<float>(ReadDoubleLE(rec+12)));
+            points->initGeoMbr();
+            theShape = points;
+        }
+            break;
+        case SHPT_MULTIPOINT:
+        case SHPT_MULTIPOINTZ:
+        {
+            if (len < 40)
+                return VectorShapeRef();
+            const uint32_t numPts = (uint32_t)ReadInt32LE(rec+36);
+            if (numPts > (len - 40) / 16)
+                return VectorShapeRef();
+            VectorPointsRef points = VectorPoints::createPoints();
+            points->pts.reserve(numPts);
+            const unsigned char *pts = rec + 40;
+            for (uint32_t ii=0;ii<numPts;ii++,pts+=16)
+                points->pts.emplace_back(DegToRad<float>(ReadDoubleLE(pts)),DegToRad<float>(ReadDoubleLE(pts+8)));
+            points->initGeoMbr();
+            theShape = points;
+        }
+            break;
+        case SHPT_ARC:
+        case SHPT_ARCZ:
+        case SHPT_POLYGON:
+        case SHPT_POLYGONZ:
+        {
+            if (len < 44)
+                return VectorShapeRef();
+            const uint32_t numParts = (uint32_t)ReadInt32LE(rec+36);
+            const uint32_t numPts = (uint32_t)ReadInt32LE(rec+40);
+            if (numParts > (len - 44) / 4 || numPts > (len - 44 - numParts*4) / 16)
+                return VectorShapeRef();
+            const unsigned char *parts = rec + 44;
+            const unsigned char *pts = parts + numParts*4;
+
+            if (shapeType == SHPT_ARC || shapeType == SHPT_ARCZ)
+            {
+                // Parts get run together, same as getObjectByIndex()
+                VectorLinearRef linear = VectorLinear::createLinear();
+                linear->pts.reserve(numPts);
+                for (uint32_t ii=0;ii<numPts;ii++,pts+=16)
+                    linear->pts.emplace_back(DegToRad<float>(ReadDoubleLE(pts)),DegToRad<float>(ReadDoubleLE(pts+8)));
+                linear->initGeoMbr();
+                theShape = linear;
+            } else {
+                VectorArealRef areal = VectorAreal::createAreal();
+                areal->loops.reserve(std::max(numParts,1u));
+                for (uint32_t part=0;part<std::max(numParts,1u);part++)
+                {
+                    const uint32_t start = part < numParts ? (uint32_t)ReadInt32LE(parts+part*4) : 0;
+                    const uint32_t end = part+1 < numParts ? (uint32_t)ReadInt32LE(parts+(part+1)*4) : numPts;
+                    if (start > end || end > numPts)
+                        return VectorShapeRef();
+                    if (start == end)
+                        continue;
+                    areal->loops.emplace_back();
+                    VectorRing &ring = areal->loops.back();
+                    ring.reserve(end-start);
+                    for (uint32_t ii=start;ii<end;ii++)
+                    {
+                        const unsigned char *pt = pts + ii*16;
+                        ring.emplace_back(DegToRad<float>(ReadDoubleLE(pt)),DegToRad<float>(ReadDoubleLE(pt+8)));
+                    }
+                }
+                areal->initGeoMbr();
+                theShape = areal;
+            }
+        }
+            break;
+        default:
+            return VectorShapeRef();
+    }
+    // Attributes, decoded the way shapelib would
+    const MutableDictionaryRef attrDict = theShape->getAttrDict();
+    if (which < dbfRecords)
+    {
+        const char *dbfRec = (const char *)dbfData->getRawData() + dbfHeaderLen + (size_t)which*dbfRecordLen;
+        for (const DBFField *field : fields)
+        {
+            const char *str = dbfRec + field->offset;
+            size_t strLen = strnlen(str,field->width);
+            TrimField(str,strLen);
+
+            if (field->type == FieldString)
+            {
+                if (strLen == 0 || (field->dbfType == 'D' && strLen >= 8 && !strncmp(str,"00000000",8)))
+                    continue;
+                attrDict->setString(field->name,std::string(str,strLen));
+            } else {
+                if (strLen == 0 || str[0] == '*')
+                    continue;
+                char buf[256];
+                memcpy(buf,str,strLen);
+                buf[strLen] = 0;
+                const double val = atof(buf);
+                if (field->type == FieldInt)
+                    attrDict->setInt(field->name,(int)val);
+                else
+                    attrDict->setDouble(field->name,val);
+            }
+        }
+    }
+
+    // Let the user know what index this is
+    attrDict->setInt("wgshapefileidx", which);
+
+    return theShape;
+}
+
+bool ShapeReader::readObjects(const std::vector<unsigned int> &records,const StringSet *filterAttrs,ShapeSet &shapes)
+{
+    if (!shp)
+        return false;
+
+    if (!mapFiles())
+    {
+        // Shapelib isn't thread safe, so this one's serial
+        for (const auto which : records)
+            if (auto shape = getObjectByIndex(which,filterAttrs))
+                shapes.insert(shape);
+        return true;
+    }
+
+    // Sort out the attribute filter once, rather than per record
+    std::vector<const DBFField *> fields;
+    for (const auto &field : dbfFields)
+        if (field.type != FieldSkip && (!filterAttrs || filterAttrs->find(field.name) != filterAttrs->end()))
+            fields.push_back(&field);
+
+    // Batches of records get decoded together on the pool
+    static constexpr size_t BatchSize = 256;
+    const size_t numBatches = (records.size() + BatchSize - 1) / BatchSize;
+    std::vector<std::vector<VectorShapeRef> > batchShapes(numBatches);
+    const auto decodeBatch = [&](size_t batch)
+    {
+        const size_t end = std::min(records.size(),(batch+1)*BatchSize);
+        auto &theseShapes = batchShapes[batch];
+        theseShapes.reserve(end - batch*BatchSize);
+        for (size_t ii=batch*BatchSize;ii<end;ii++)
+            if (auto shape = decodeRecord(records[ii],fields))
+                theseShapes.push_back(std::move(shape));
+    };
+    if (pool && numBatches > 1)
+        pool->parallelFor(numBatches,decodeBatch);
+    else
+        for (size_t ii=0;ii<numBatches;ii++)
+            decodeBatch(ii);
+
+    shapes.reserve(shapes.size() + records.size());
+    for (const auto &theseShapes : batchShapes)
+        shapes.insert(theseShapes.begin(),theseShapes.end());
+
+    return true;
+}
+
+VectorObjectRef ShapeReader::readArea(const Mbr &mbr,const StringSet *filterAttrs)
+{
+    std::vector<unsigned int> records;
+    query(mbr,records);
+
+    auto vecObj = std::make_shared<VectorObject>();
+    if (!readObjects(records,filterAttrs,vecObj->shapes))
+        return VectorObjectRef();
+
+    // The index is a little generous, check against the geometry we actually decoded
+    for (auto it = vecObj->shapes.begin(); it != vecObj->shapes.end(); )
+    {
+        const GeoMbr geoMbr = (*it)->calcGeoMbr();
+        if (Mbr(geoMbr.ll(),geoMbr.ur()).overlaps(mbr))
+            ++it;
+        else
+            it = vecObj->shapes.erase(it);
+    }
+
+    return vecObj;
+}
+
 }
@@ -19,6 +19,8 @@
 #import "SphericalMercator.h"
 #import "GlobeMath.h"
 
+using namespace Eigen;
+
 namespace WhirlyKit
 {
 
@@ -127,6 +129,52 @@ Point3d SphericalMercatorCoordSystem::geocentricToLocal(Point3d geocPt) const
     return {localPt.x(),localPt.y(),geoCoordPlus.z()};
 }
 
+void SphericalMercatorCoordSystem::localToGeographicBatch(const Point3d *in,Point2d *out,size_t count) const
+{
+    if (count == 0)
+        return;
+    const Map<const Array3Xd> src(in->data(),3,(Index)count);
+    Map<Array2Xd> dst(out->data(),2,(Index)count);
+    dst.row(0) = src.row(0) + originLon;
+    dst.row(1) = src.row(1).sinh().atan();
+}
+
+void SphericalMercatorCoordSystem::geographicToLocalBatch(const Point2d *in,Point3d *out,size_t count) const
+{
+    if (count == 0)
+        return;
+    const Map<const Array2Xd> src(in->data(),2,(Index)count);
+    Map<Array3Xd> dst(out->data(),3,(Index)count);
+    const ArrayXd lat = src.row(1).transpose().max(-PoleLimit).min(PoleLimit);
+    dst.row(0) = src.row(0) - originLon;
+    dst.row(1) = ((1.0 + lat.sin()) / lat.cos()).log().transpose();
+    dst.row(2).setZero();
+}
+
+void SphericalMercatorCoordSystem::localToGeocentricBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    if (count == 0)
+        return;
+    // Geographic in place, keeping the z, then on to geocentric
+    const Map<const Array3Xd> src(in->data(),3,(Index)count);
+    Map<Array3Xd> dst(out->data(),3,(Index)count);
+    dst.row(0) = src.row(0) + originLon;
+    dst.row(1) = src.row(1).sinh().atan();
+    dst.row(2) = src.row(2);
+    GeoCoordSystem::LocalToGeocentric(out,out,count);
+}
+
+void SphericalMercatorCoordSystem::geocentricToLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    if (count == 0)
+        return;
+    GeoCoordSystem::GeocentricToLocal(in,out,count);
+    Map<Array3Xd> dst(out->data(),3,(Index)count);
+    const ArrayXd lat = dst.row(1).transpose().max(-PoleLimit).min(PoleLimit);
+    dst.row(0) -= originLon;
+    dst.row(1) = ((1.0 + lat.sin()) / lat.cos()).log().transpose();
+}
+
 bool SphericalMercatorCoordSystem::isSameAs(const CoordSystem *coordSys) const
 {
     const auto other = dynamic_cast<const SphericalMercatorCoordSystem *>(coordSys);
@@ -197,4 +245,23 @@ WhirlyKit::Point3d SphericalMercatorDisplayAdapter::displayToLocal(WhirlyKit::Po
     return localPt;
 }
 
+void SphericalMercatorDisplayAdapter::localToDisplayBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    const double orgX = org.x(), orgY = org.y();
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = Point3d(in[ii].x()-orgX,in[ii].y()-orgY,in[ii].z());
+}
+
+void SphericalMercatorDisplayAdapter::displayToLocalBatch(const Point3d *in,Point3d *out,size_t count) const
+{
+    const double orgX = org.x(), orgY = org.y();
+    for (size_t ii=0;ii<count;ii++)
+        out[ii] = Point3d(in[ii].x()+orgX,in[ii].y()+orgY,in[ii].z());
+}
+
+void SphericalMercatorDisplayAdapter::normalForLocalBatch(const Point3d *,Point3d *out,size_t count) const
+{
+    std::fill(out,out+count,Point3d(0,0,1));
+}
+
 }
@@ -24,35 +24,143 @@ namespace WhirlyKit {
 
 StringIndexer StringIndexer::instance;
 
-StringIndexer::StringIndexer() : stringToIdent(500)
+StringIndexer::Table::Table(size_t size) :
+    mask(size-1),
+    slots(new std::atomic<const Entry *>[size])
 {
-    identToString.reserve(500);
+    for (size_t ii=0;ii<size;ii++)
+        slots[ii].store(nullptr,std::memory_order_relaxed);
+}
+
+StringIndexer::StringIndexer() :
+    table(nullptr),
+    numStrings(0)
+{
+    tables.emplace_back(new Table(1024));
+    table.store(tables.back().get(),std::memory_order_release);
+    for (auto &segment : segments)
+        segment = nullptr;
+    entries.reserve(500);
+}
+
+void StringIndexer::segmentForID(StringIdentity strID,int &segment,size_t &offset)
+{
+    // Segment N starts at FirstSegmentSize * (2^N - 1)
+    const size_t scaled = strID / FirstSegmentSize + 1;
+    segment = 0;
+    while ((scaled >> (segment+1)) != 0)
+        segment++;
+    offset = strID - FirstSegmentSize * (((size_t)1 << segment) - 1);
+}
+
+const StringIndexer::Entry *StringIndexer::find(const std::string &str,size_t hash) const
+{
+    const Table *theTable = table.load(std::memory_order_acquire);
+    for (size_t which = hash & theTable->mask;;which = (which + 1) & theTable->mask)
+    {
+        const Entry *entry = theTable->slots[which].load(std::memory_order_acquire);
+        if (!entry)
+            return nullptr;
+        if (entry->hash == hash && entry->str == str)
+            return entry;
+    }
+}
+
+StringIdentity StringIndexer::add(const std::string &str,size_t hash)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Someone may have beaten us to it
+    if (const Entry *entry = find(str,hash))
+        return entry->strID;
+
+    const StringIdentity strID = numStrings.load(std::memory_order_relaxed);
+    entries.emplace_back(new Entry(str,hash,strID));
+    const Entry *newEntry = entries.back().get();
+
+    // Put it in the ID array first, so anyone who finds it by name can look it up by ID
+    int segment;
+    size_t offset;
+    segmentForID(strID,segment,offset);
+    if (segment >= MaxSegments)
+    {
+        // Not going to happen, but don't scribble on memory if it does
+        abort();
+    }
+    if (!segments[segment])
+    {
+        const size_t segSize = FirstSegmentSize << segment;
+        segmentStorage.emplace_back(new std::atomic<const Entry *>[segSize]);
+        segments[segment] = segmentStorage.back().get();
+    }
+    segments[segment][offset].store(newEntry,std::memory_order_relaxed);
+    numStrings.store(strID+1,std::memory_order_release);
+
+    // Grow the table if it's getting full.  Readers may still be looking at the old one, so it sticks around.
+    Table *theTable = table.load(std::memory_order_relaxed);
+    if ((strID+1) * 2 > theTable->mask + 1)
+    {
+        auto newTable = std::make_unique<Table>((theTable->mask + 1) * 2);
+        for (const auto &entry : entries)
+        {
+            size_t which = entry->hash & newTable->mask;
+            while (newTable->slots[which].load(std::memory_order_relaxed))
+                which = (which + 1) & newTable->mask;
+            newTable->slots[which].store(entry.get(),std::memory_order_relaxed);
+        }
+        tables.push_back(std::move(newTable));
+        table.store(tables.back().get(),std::memory_order_release);
+    }
+    else
+    {
+        size_t which = hash & theTable->mask;
+        while (theTable->slots[which].load(std::memory_order_relaxed))
+            which = (which + 1) & theTable->mask;
+        theTable->slots[which].store(newEntry,std::memory_order_release);
+    }
+
+    return strID;
 }
 
 StringIdentity StringIndexer::getStringID(const std::string &str)
 {
     StringIndexer &index = getInstance();
 
-    // todo: upgradeable shared mutex would be perfect here
-    std::lock_guard<std::mutex> lock(index.mutex);
+    const size_t hash = std::hash<std::string>()(str);
+    if (const Entry *entry = index.find(str,hash))
+        return entry->strID;
+
+    return index.add(str,hash);
+}
 
-    const auto it = index.stringToIdent.find(str);
-    if (it != index.stringToIdent.end())
-        return it->second;
+bool StringIndexer::findStringID(const std::string &str,StringIdentity &strID)
+{
+    const StringIndexer &index = getInstance();
 
-    const int strID = index.identToString.size();
-    index.identToString.push_back(str);
-    index.stringToIdent[str] = strID;
-    return strID;
+    if (const Entry *entry = index.find(str,std::hash<std::string>()(str)))
+    {
+        strID = entry->strID;
+        return true;
+    }
+    return false;
+}
+
+StringIdentity StringIndexer::getNumStrings()
+{
+    return getInstance().numStrings.load(std::memory_order_acquire);
 }
 
 std::string StringIndexer::getString(StringIdentity strID)
 {
     const StringIndexer &index = getInstance();
 
-    std::lock_guard<std::mutex> lock(index.mutex);
+    if (strID >= index.numStrings.load(std::memory_order_acquire))
+        return std::string();
 
-    return (strID < index.identToString.size()) ? index.identToString[strID] : std::string();
+    int segment;
+    size_t offset;
+    segmentForID(strID,segment,offset);
+    return index.segments[segment][offset].load(std::memory_order_relaxed)->str;
 }
  
 // Note: This is from OpenGL.  Doesn't hold anymore on iOS
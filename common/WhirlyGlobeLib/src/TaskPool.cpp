@@ -0,0 +1,258 @@
+/*  TaskPool.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import "TaskPool.h"
+#import <algorithm>
+
+namespace WhirlyKit
+{
+
+// The pool this thread works for, if any, and the info its attach function made
+static thread_local const TaskPool *workerPool = nullptr;
+static thread_local PlatformThreadInfo *workerInfo = nullptr;
+
+TaskPool::TaskPool(int numThreads) :
+    nextWorker(0),
+    queued(0),
+    stopping(false)
+{
+    startWorkers(numThreads);
+}
+
+TaskPool::TaskPool(int numThreads,AttachFunction inAttach,DetachFunction inDetach) :
+    attach(std::move(inAttach)),
+    detach(std::move(inDetach)),
+    nextWorker(0),
+    queued(0),
+    stopping(false)
+{
+    startWorkers(numThreads);
+}
+
+void TaskPool::startWorkers(int numThreads)
+{
+    workers.reserve(std::max(numThreads,0));
+    for (int ii=0;ii<numThreads;ii++)
+    {
+        workers.emplace_back(new Worker());
+    }
+    // Start them up once the queues all exist, since they steal from each other
+    for (int ii=0;ii<numThreads;ii++)
+    {
+        workers[ii]->thread = std::thread(&TaskPool::workerMain,this,ii);
+    }
+}
+
+TaskPool::~TaskPool()
+{
+    {
+        std::lock_guard<std::mutex> guardLock(sleepLock);
+        stopping = true;
+    }
+    sleepCond.notify_all();
+
+    for (auto &worker : workers)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+}
+
+void TaskPool::run(std::vector<Task> &tasks)
+{
+    if (tasks.empty())
+    {
+        return;
+    }
+
+    // Nobody to help, so just do it here
+    if (workers.empty() || tasks.size() == 1)
+    {
+        for (auto &task : tasks)
+        {
+            task();
+        }
+        return;
+    }
+
+    Batch batch;
+    batch.remaining = (int)tasks.size();
+
+    // Spread the work over the worker queues
+    for (auto &task : tasks)
+    {
+        Worker *worker = workers[nextWorker++ % workers.size()].get();
+        std::lock_guard<std::mutex> guardLock(worker->lock);
+        worker->tasks.push_back(QueuedTask{std::move(task),&batch});
+    }
+    {
+        std::lock_guard<std::mutex> guardLock(sleepLock);
+        queued += (int)tasks.size();
+    }
+    sleepCond.notify_all();
+
+    // Help out until there's nothing left to take
+    QueuedTask task;
+    while (batch.remaining > 0 && stealTask(-1,task))
+    {
+        runTask(task);
+    }
+
+    // Wait for the stragglers.  We have to take the lock at least once so the
+    //  last worker is done with the batch before it goes out of scope.
+    std::unique_lock<std::mutex> batchLock(batch.lock);
+    batch.cond.wait(batchLock,[&batch]{ return batch.remaining == 0; });
+
+    if (batch.error)
+    {
+        std::rethrow_exception(batch.error);
+    }
+}
+
+void TaskPool::parallelFor(size_t count,const std::function<void(size_t)> &func,size_t batchSize)
+{
+    batchSize = std::max(batchSize,(size_t)1);
+
+    std::vector<Task> tasks;
+    tasks.reserve((count + batchSize - 1) / batchSize);
+    for (size_t start=0;start<count;start+=batchSize)
+    {
+        const size_t end = std::min(start+batchSize,count);
+        tasks.emplace_back([&func,start,end]{
+            for (size_t ii=start;ii<end;ii++)
+            {
+                func(ii);
+            }
+        });
+    }
+
+    run(tasks);
+}
+
+PlatformThreadInfo *TaskPool::getThreadInfo(PlatformThreadInfo *callerInst) const
+{
+    return (workerPool == this && attach) ? workerInfo : callerInst;
+}
+
+TaskPoolRef TaskPool::sharedPool()
+{
+    // Leave a core for whoever is calling
+    static TaskPoolRef pool = std::make_shared<TaskPool>(
+            std::max((int)std::thread::hardware_concurrency() - 1,0));
+    return pool;
+}
+
+void TaskPool::workerMain(int which)
+{
+    workerPool = this;
+    workerInfo = attach ? attach() : nullptr;
+
+    while (true)
+    {
+        QueuedTask task;
+        if (popTask(which,task) || stealTask(which,task))
+        {
+            runTask(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(sleepLock);
+        sleepCond.wait(lock,[this]{ return stopping || queued > 0; });
+        if (stopping && queued == 0)
+        {
+            break;
+        }
+    }
+
+    if (detach)
+    {
+        detach(workerInfo);
+    }
+    workerInfo = nullptr;
+    workerPool = nullptr;
+}
+
+bool TaskPool::popTask(int which,QueuedTask &task)
+{
+    Worker *worker = workers[which].get();
+    std::lock_guard<std::mutex> guardLock(worker->lock);
+    if (worker->tasks.empty())
+    {
+        return false;
+    }
+
+    task = std::move(worker->tasks.front());
+    worker->tasks.pop_front();
+    queued--;
+    return true;
+}
+
+bool TaskPool::stealTask(int which,QueuedTask &task)
+{
+    const int numWorkers = (int)workers.size();
+    for (int ii=1;ii<=numWorkers;ii++)
+    {
+        const int victim = (which + ii + numWorkers) % numWorkers;
+        if (victim == which)
+        {
+            continue;
+        }
+
+        Worker *worker = workers[victim].get();
+        std::lock_guard<std::mutex> guardLock(worker->lock);
+        if (!worker->tasks.empty())
+        {
+            task = std::move(worker->tasks.back());
+            worker->tasks.pop_back();
+            queued--;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void TaskPool::runTask(QueuedTask &task)
+{
+    // Hang on to the exception for the waiter, we still have to count this one as done
+    std::exception_ptr error;
+    try
+    {
+        task.task();
+    }
+    catch (...)
+    {
+        error = std::current_exception();
+    }
+
+    // Count down under the lock so the waiter can't see zero and leave early
+    Batch *batch = task.batch;
+    std::lock_guard<std::mutex> guardLock(batch->lock);
+    if (error && !batch->error)
+    {
+        batch->error = error;
+    }
+    if (--batch->remaining == 0)
+    {
+        batch->cond.notify_all();
+    }
+}
+
+}
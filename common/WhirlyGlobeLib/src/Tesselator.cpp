@@ -25,39 +25,375 @@ using namespace Eigen;
 namespace WhirlyKit
 {
     
-//static float PolyScale = 1e14;
-    
-typedef struct
+static const float PolyScale2 = 1e6;
+
+// Outer rings with more points than this that aren't convex go to libtess
+static constexpr int MaxEarClipPoints = 64;
+
+// Hands out memory to libtess from a few big blocks and frees it all at once.
+// That's much cheaper than the malloc/free for every little mesh piece.
+class TessArena
+{
+public:
+    void *alloc(size_t size)
+    {
+        // Keep track of the size for realloc
+        const size_t total = ((size + sizeof(Header) + Alignment - 1) / Alignment) * Alignment;
+        if (curBlock >= blocks.size() || blockUsed + total > blocks[curBlock].size)
+        {
+            nextBlock(total);
+        }
+        auto *header = (Header *)(blocks[curBlock].data.get() + blockUsed);
+        header->size = size;
+        blockUsed += total;
+        return header + 1;
+    }
+
+    void *realloc(void *ptr,size_t size)
+    {
+        void *newPtr = alloc(size);
+        if (ptr)
+        {
+            const auto *header = (Header *)ptr - 1;
+            memcpy(newPtr,ptr,std::min(header->size,size));
+        }
+        return newPtr;
+    }
+
+    // Everything handed out is gone after this
+    void reset()
+    {
+        // Don't hang on to a lot of memory because of one big polygon
+        size_t total = 0;
+        for (unsigned int ii=0;ii<blocks.size();ii++)
+        {
+            total += blocks[ii].size;
+            if (total > MaxKeep)
+            {
+                blocks.resize(ii);
+                break;
+            }
+        }
+        curBlock = 0;
+        blockUsed = 0;
+    }
+
+protected:
+    static constexpr size_t Alignment = 16;
+    static constexpr size_t BlockSize = 256*1024;
+    static constexpr size_t MaxKeep = 4*1024*1024;
+
+    struct alignas(16) Header
+    {
+        size_t size;
+    };
+    struct Block
+    {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    void nextBlock(size_t minSize)
+    {
+        if (curBlock < blocks.size())
+            curBlock++;
+        // Reuse the next block if it's big enough, otherwise put a new one there
+        if (curBlock >= blocks.size() || blocks[curBlock].size < minSize)
+        {
+            const size_t size = std::max(minSize,BlockSize);
+            Block block { std::unique_ptr<char[]>(new char[size]), size };
+            if (curBlock >= blocks.size())
+                blocks.push_back(std::move(block));
+            else
+                blocks[curBlock] = std::move(block);
+        }
+        blockUsed = 0;
+    }
+
+    std::vector<Block> blocks;
+    size_t curBlock = 0;
+    size_t blockUsed = 0;
+};
+
+static void* arenaAlloc(void* userData, unsigned int size)
 {
-    Point3fVector pts;
-    std::vector<std::vector<int>> tris;
-//    std::vector<int> vertIDs;
-    bool newVert;
-} TriangulationInfo;
+    return ((TessArena *)userData)->alloc(size);
+}
 
-static void* stdAlloc(void* userData, unsigned int size)
+static void* arenaRealloc(void* userData, void* ptr, unsigned int size)
 {
-  TESS_NOTUSED(userData);
-  return malloc(size);
+    return ((TessArena *)userData)->realloc(ptr,size);
 }
 
-static void stdFree(void* userData, void* ptr)
+static void arenaFree(void* userData, void* ptr)
 {
-  TESS_NOTUSED(userData);
-  free(ptr);
+    TESS_NOTUSED(userData);
+    TESS_NOTUSED(ptr);
 }
 
+// Scratch space for tesselating, one per thread
+struct TessScratch
+{
+    TessArena arena;
+    std::vector<Point2d> pts;
+    std::vector<int> next,prev;
+    std::vector<char> reflex;
+    std::vector<int> tris;
+    std::vector<TESSreal> tessRing;
+};
+static thread_local TessScratch tessScratch;
 
-static const float PolyScale2 = 1e6;
-    
 void TesselateRing(const WhirlyKit::VectorRing &ring,VectorTrianglesRef tris)
 {
     std::vector<VectorRing> rings(1);
     rings[0] = ring;
     TesselateLoops(rings, tris);
 }
-    
+
+// Copy a ring, skipping the closing point and repeated points the way we do for libtess
+static void CleanRing(const VectorRing &ring,std::vector<Point2d> &pts)
+{
+    pts.clear();
+    pts.reserve(ring.size());
+    for (unsigned int ii=0;ii<ring.size();ii++)
+    {
+        const Point2f &pt = ring[ii];
+        if (ii==ring.size()-1 && pt.x() == ring[0].x() && pt.y() == ring[0].y())
+            continue;
+        if (ii > 0)
+        {
+            const Point2f &prevPt = ring[ii-1];
+            if (pt.x() == prevPt.x() && pt.y() == prevPt.y())
+                continue;
+        }
+        pts.emplace_back(pt.x(),pt.y());
+    }
+}
+
+static inline double Cross(const Point2d &a,const Point2d &b,const Point2d &c)
+{
+    return (b.x()-a.x())*(c.y()-a.y()) - (b.y()-a.y())*(c.x()-a.x());
+}
+
+// Proper or touching intersection between segments ab and cd
+static bool SegmentsTouch(const Point2d &a,const Point2d &b,const Point2d &c,const Point2d &d)
+{
+    const double d1 = Cross(c,d,a), d2 = Cross(c,d,b);
+    const double d3 = Cross(a,b,c), d4 = Cross(a,b,d);
+    if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) &&
+        ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0)))
+        return true;
+    const auto onSeg = [](const Point2d &p,const Point2d &q,const Point2d &r)
+    {
+        return std::min(p.x(),q.x()) <= r.x() && r.x() <= std::max(p.x(),q.x()) &&
+               std::min(p.y(),q.y()) <= r.y() && r.y() <= std::max(p.y(),q.y());
+    };
+    return (d1 == 0 && onSeg(c,d,a)) || (d2 == 0 && onSeg(c,d,b)) ||
+           (d3 == 0 && onSeg(a,b,c)) || (d4 == 0 && onSeg(a,b,d));
+}
+
+// Fan out a convex ring, or ear clip a small simple one.
+// Fills in triangles as indices into pts, wound the same way as the ring like libtess does.
+// Returns false if the ring needs the general tesselator.
+static bool TriangulateSimple(TessScratch &scratch)
+{
+    auto &pts = scratch.pts;
+    auto &tris = scratch.tris;
+    tris.clear();
+
+    // Drop points that are exactly in line with their neighbors.  They add nothing to the area.
+    for (bool removed = true; removed && pts.size() >= 3; )
+    {
+        removed = false;
+        for (size_t ii=0;ii<pts.size() && pts.size() >= 3;)
+        {
+            const size_t n = pts.size();
+            if (Cross(pts[(ii+n-1)%n],pts[ii],pts[(ii+1)%n]) == 0.0)
+            {
+                pts.erase(pts.begin()+ii);
+                removed = true;
+            }
+            else
+                ii++;
+        }
+    }
+    const int n = (int)pts.size();
+    if (n < 3)
+        return true;
+
+    // Which way does it go and is it convex
+    double area = 0.0;
+    int numLeft = 0, numRight = 0;
+    double turn = 0.0;
+    for (int ii=0;ii<n;ii++)
+    {
+        const Point2d &a = pts[(ii+n-1)%n], &b = pts[ii], &c = pts[(ii+1)%n];
+        area += b.x()*c.y() - c.x()*b.y();
+        const double cross = Cross(a,b,c);
+        if (cross > 0) numLeft++; else numRight++;
+        turn += atan2(cross,(b-a).dot(c-b));
+    }
+    const bool ccw = area > 0.0;
+
+    // Convex and only goes around once, so it's a fan
+    if ((numLeft == 0 || numRight == 0) && std::abs(std::abs(turn) - 2*M_PI) < 1e-6)
+    {
+        tris.reserve(3*(n-2));
+        for (int ii=1;ii<n-1;ii++)
+        {
+            tris.push_back(0);
+            tris.push_back(ii);
+            tris.push_back(ii+1);
+        }
+        return true;
+    }
+
+    if (n > MaxEarClipPoints)
+        return false;
+
+    // Ear clipping only works on simple polygons
+    for (int ii=0;ii<n;ii++)
+    {
+        const Point2d &a = pts[ii], &b = pts[(ii+1)%n];
+        for (int jj=ii+2;jj<n;jj++)
+        {
+            if (ii == 0 && jj == n-1)
+                continue;
+            if (SegmentsTouch(a,b,pts[jj],pts[(jj+1)%n]))
+                return false;
+        }
+    }
+
+    // Walk it counter clockwise
+    auto &next = scratch.next;
+    auto &prev = scratch.prev;
+    auto &reflex = scratch.reflex;
+    next.resize(n);
+    prev.resize(n);
+    reflex.resize(n);
+    for (int ii=0;ii<n;ii++)
+    {
+        next[ii] = ccw ? (ii+1)%n : (ii+n-1)%n;
+        prev[ii] = ccw ? (ii+n-1)%n : (ii+1)%n;
+    }
+    const auto isReflex = [&](int which)
+    {
+        return Cross(pts[prev[which]],pts[which],pts[next[which]]) <= 0.0;
+    };
+    for (int ii=0;ii<n;ii++)
+        reflex[ii] = isReflex(ii);
+
+    tris.reserve(3*(n-2));
+    int cur = 0;
+    int left = n;
+    int sinceLastEar = 0;
+    while (left > 3)
+    {
+        const int p = prev[cur], nx = next[cur];
+        bool isEar = !reflex[cur];
+        if (isEar)
+        {
+            // No other reflex point can be in or on the triangle
+            const Point2d &a = pts[p], &b = pts[cur], &c = pts[nx];
+            for (int ii=next[nx];ii!=p;ii=next[ii])
+            {
+                if (!reflex[ii])
+                    continue;
+                const Point2d &q = pts[ii];
+                if (q == a || q == b || q == c)
+                    continue;
+                if (Cross(a,b,q) >= 0 && Cross(b,c,q) >= 0 && Cross(c,a,q) >= 0)
+                {
+                    isEar = false;
+                    break;
+                }
+            }
+        }
+        if (isEar)
+        {
+            tris.push_back(p);
+            tris.push_back(cur);
+            tris.push_back(nx);
+            next[p] = nx;
+            prev[nx] = p;
+            left--;
+            reflex[p] = isReflex(p);
+            reflex[nx] = isReflex(nx);
+            cur = nx;
+            sinceLastEar = 0;
+        }
+        else
+        {
+            cur = nx;
+            // Went all the way around without finding one, so let libtess sort it out
+            if (++sinceLastEar > left)
+                return false;
+        }
+    }
+    tris.push_back(prev[cur]);
+    tris.push_back(cur);
+    tris.push_back(next[cur]);
+
+    // Those all came out counter clockwise
+    if (!ccw)
+    {
+        for (size_t ii=0;ii<tris.size();ii+=3)
+            std::swap(tris[ii+1],tris[ii+2]);
+    }
+
+    return true;
+}
+
 void TesselateLoops(const std::vector<VectorRing> &loops,VectorTrianglesRef tris)
+{
+    if (loops.size() < 1)
+        return;
+    if (loops[0].size() < 1)
+        return;
+
+    TessScratch &scratch = tessScratch;
+
+    // Most polygons are a single ring and most of those are simple
+    bool simple = true;
+    for (unsigned int li=1;li<loops.size();li++)
+    {
+        // Holes with less than three distinct points don't count
+        CleanRing(loops[li],scratch.pts);
+        if (scratch.pts.size() >= 3)
+        {
+            simple = false;
+            break;
+        }
+    }
+    if (simple)
+    {
+        CleanRing(loops[0],scratch.pts);
+        if (TriangulateSimple(scratch))
+        {
+            const auto &pts = scratch.pts;
+            const auto &triIdx = scratch.tris;
+            tris->pts.reserve(tris->pts.size() + triIdx.size());
+            tris->tris.reserve(tris->tris.size() + triIdx.size() / 3);
+            for (size_t ii=0;ii<triIdx.size();ii+=3)
+            {
+                VectorTriangles::Triangle triOut;
+                const int startPoint = (int)(tris->pts.size());
+                for (int jj=0;jj<3;jj++)
+                {
+                    const Point2d &pt = pts[triIdx[ii+jj]];
+                    tris->pts.push_back(Point3f(pt.x(),pt.y(),0.0));
+                    triOut.pts[jj] = jj + startPoint;
+                }
+                tris->tris.push_back(triOut);
+            }
+            return;
+        }
+    }
+
+    TesselateLoopsGeneral(loops,tris);
+}
+
+void TesselateLoopsGeneral(const std::vector<VectorRing> &loops,VectorTrianglesRef tris)
 {
     if (loops.size() < 1)
         return;
@@ -67,13 +403,21 @@ void TesselateLoops(const std::vector<VectorRing> &loops,VectorTrianglesRef tris
     static const int vertexSize = 2;
     static const int stride = sizeof(TESSreal) * vertexSize;
     static const int verticesPerTriangle = 3;
-  
-    TESSalloc ma;
 
-    ma.memalloc = stdAlloc;
-    ma.memfree = stdFree;
-    ma.extraVertices = 256; // realloc not provided, allow 256 extra vertic
+    TessScratch &scratch = tessScratch;
+    TessArena &arena = scratch.arena;
+    arena.reset();
 
+    TESSalloc ma;
+    memset(&ma, 0, sizeof(ma));
+    ma.memalloc = arenaAlloc;
+    ma.memrealloc = arenaRealloc;
+    ma.memfree = arenaFree;
+    ma.userData = &arena;
+    ma.extraVertices = 256;
+
+    // libtess keeps pools in the tesselator that point into the arena, so it's made fresh each time.
+    // It all comes out of the arena, so that's cheap, and there's nothing to delete.
     TESStesselator *tess = tessNewTess(&ma);
     
     Point2f org = (loops[0])[0];
@@ -81,7 +425,8 @@ void TesselateLoops(const std::vector<VectorRing> &loops,VectorTrianglesRef tris
     {
         
         const VectorRing &ring = loops[li];
-        std::vector<TESSreal> tessRing;
+        std::vector<TESSreal> &tessRing = scratch.tessRing;
+        tessRing.clear();
         for (unsigned int ii=0;ii<ring.size();ii++)
         {
             const Point2f &pt = ring[ii];
@@ -134,8 +479,6 @@ void TesselateLoops(const std::vector<VectorRing> &loops,VectorTrianglesRef tris
        
         tris->tris.push_back(triOut);
     }
- 
-    tessDeleteTess(tess);
     
     // Convert to triangles
     //    printf("  ");
@@ -0,0 +1,282 @@
+/*  TraceEvents.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <chrono>
+#import <cstdio>
+#import "TraceEvents.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+TraceThreadBuffer::TraceThreadBuffer(unsigned int threadID,size_t capacity) :
+    threadID(threadID), events(std::max(capacity,(size_t)1))
+{
+}
+
+void TraceThreadBuffer::record(const TraceName *name,TraceEvent::Type type,uint64_t start,uint64_t dur,int64_t value)
+{
+    // Only the owning thread writes, so claim the slot, fill it in, then publish it.
+    // A reader that sees any of the new fields will also see the claim and drop the slot.
+    const uint64_t which = claimed.load(std::memory_order_relaxed);
+    claimed.store(which+1,std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    TraceEvent &event = events[which % events.size()];
+    event.name.store(name,std::memory_order_relaxed);
+    event.type.store(type,std::memory_order_relaxed);
+    event.start.store(start,std::memory_order_relaxed);
+    event.dur.store(dur,std::memory_order_relaxed);
+    event.value.store(value,std::memory_order_relaxed);
+
+    written.store(which+1,std::memory_order_release);
+}
+
+// Hands the calling thread's buffer back when the thread exits
+struct TraceThreadHolder
+{
+    ~TraceThreadHolder()
+    {
+        if (buffer)
+            TraceRecorder::get().releaseBuffer(buffer);
+    }
+
+    TraceThreadBuffer *buffer = nullptr;
+};
+
+static thread_local TraceThreadHolder traceThreadHolder;
+
+TraceRecorder &TraceRecorder::get()
+{
+    // Never destroyed so threads exiting during shutdown can still hand back their buffers
+    static TraceRecorder *recorder = new TraceRecorder();
+    return *recorder;
+}
+
+uint64_t TraceRecorder::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+TraceThreadBuffer *TraceRecorder::threadBuffer()
+{
+    if (traceThreadHolder.buffer)
+        return traceThreadHolder.buffer;
+
+    std::lock_guard<std::mutex> lock(mutex);
+
+    // Reuse a buffer from a thread that's gone, otherwise make a new one
+    TraceThreadBuffer *buffer = nullptr;
+    for (const auto &oldBuffer : buffers)
+    {
+        if (!oldBuffer->inUse.load(std::memory_order_relaxed))
+        {
+            oldBuffer->inUse.store(true,std::memory_order_relaxed);
+            // The old thread's events would otherwise show up under the new one
+            oldBuffer->cleared.store(oldBuffer->claimed.load(std::memory_order_relaxed),std::memory_order_relaxed);
+            oldBuffer->threadName.clear();
+            buffer = oldBuffer.get();
+            break;
+        }
+    }
+    if (!buffer)
+    {
+        buffers.push_back(std::make_shared<TraceThreadBuffer>((unsigned int)buffers.size()+1,eventsPerThread));
+        buffer = buffers.back().get();
+    }
+
+    traceThreadHolder.buffer = buffer;
+    return buffer;
+}
+
+void TraceRecorder::releaseBuffer(TraceThreadBuffer *buffer)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer->inUse.store(false,std::memory_order_relaxed);
+}
+
+void TraceRecorder::setEventsPerThread(size_t num)
+{
+    // New buffers are sized under the lock
+    std::lock_guard<std::mutex> lock(mutex);
+    eventsPerThread = num;
+}
+
+void TraceRecorder::setThreadName(const std::string &name)
+{
+    TraceThreadBuffer *buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(mutex);
+    buffer->threadName = name;
+}
+
+void TraceRecorder::complete(const TraceName *name,uint64_t start,uint64_t end)
+{
+    threadBuffer()->record(name,TraceEvent::Complete,start,end-start,0);
+}
+
+void TraceRecorder::instant(const TraceName *name)
+{
+    threadBuffer()->record(name,TraceEvent::Instant,now(),0,0);
+}
+
+void TraceRecorder::counter(const TraceName *name,int64_t value)
+{
+    threadBuffer()->record(name,TraceEvent::Counter,now(),0,value);
+}
+
+void TraceRecorder::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &buffer : buffers)
+        buffer->cleared.store(buffer->claimed.load(std::memory_order_relaxed),std::memory_order_relaxed);
+}
+
+// Names are literals and shouldn't need this, but thread names come from anywhere
+static void AppendJSONString(std::string &out,const char *str)
+{
+    out += '"';
+    for (const char *c = str; *c; c++)
+    {
+        switch (*c)
+        {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if ((unsigned char)*c < 0x20)
+                {
+                    char esc[8];
+                    snprintf(esc,sizeof(esc),"\\u%04x",(unsigned int)*c);
+                    out += esc;
+                }
+                else
+                    out += *c;
+                break;
+        }
+    }
+    out += '"';
+}
+
+std::string TraceRecorder::exportChromeJSON() const
+{
+    std::string out;
+    out.reserve(1<<16);
+    out += "{\"traceEvents\":[";
+    bool first = true;
+    char buf[256];
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto &buffer : buffers)
+    {
+        if (!buffer->threadName.empty())
+        {
+            out += first ? "\n" : ",\n";
+            first = false;
+            snprintf(buf,sizeof(buf),"{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":",buffer->threadID);
+            out += buf;
+            AppendJSONString(out,buffer->threadName.c_str());
+            out += "}}";
+        }
+
+        // Copy out what's there, then throw away anything the writer may have overwritten while we did
+        const uint64_t capacity = buffer->events.size();
+        const uint64_t end = buffer->written.load(std::memory_order_acquire);
+        const uint64_t begin = std::max(end > capacity ? end - capacity : 0,
+                                        buffer->cleared.load(std::memory_order_relaxed));
+        if (begin >= end)
+            continue;
+
+        struct Copy
+        {
+            const TraceName *name;
+            int type;
+            uint64_t start,dur;
+            int64_t value;
+        };
+        std::vector<Copy> copies;
+        copies.reserve(end-begin);
+        for (uint64_t which = begin; which < end; which++)
+        {
+            const TraceEvent &event = buffer->events[which % capacity];
+            copies.push_back(Copy{event.name.load(std::memory_order_relaxed),
+                                  event.type.load(std::memory_order_relaxed),
+                                  event.start.load(std::memory_order_relaxed),
+                                  event.dur.load(std::memory_order_relaxed),
+                                  event.value.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const uint64_t claimed = buffer->claimed.load(std::memory_order_relaxed);
+        const uint64_t firstValid = claimed > capacity ? claimed - capacity : 0;
+
+        for (uint64_t which = std::max(begin,firstValid); which < end; which++)
+        {
+            const Copy &copy = copies[which-begin];
+            if (!copy.name)
+                continue;
+
+            out += first ? "\n" : ",\n";
+            first = false;
+            out += "{\"name\":";
+            AppendJSONString(out,copy.name->name);
+            out += ",\"cat\":";
+            AppendJSONString(out,copy.name->category ? copy.name->category : "");
+            // Chrome wants microseconds
+            const double ts = copy.start / 1000.0;
+            switch (copy.type)
+            {
+                case TraceEvent::Complete:
+                    snprintf(buf,sizeof(buf),",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%u}",
+                             ts,copy.dur / 1000.0,buffer->threadID);
+                    break;
+                case TraceEvent::Instant:
+                    snprintf(buf,sizeof(buf),",\"ph\":\"i\",\"s\":\"t\",\"ts\":%.3f,\"pid\":1,\"tid\":%u}",
+                             ts,buffer->threadID);
+                    break;
+                case TraceEvent::Counter:
+                default:
+                    snprintf(buf,sizeof(buf),",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%u,\"args\":{\"value\":%lld}}",
+                             ts,buffer->threadID,(long long)copy.value);
+                    break;
+            }
+            out += buf;
+        }
+    }
+    out += "\n]}\n";
+
+    return out;
+}
+
+bool TraceRecorder::writeChromeJSON(const std::string &fileName) const
+{
+    const std::string json = exportChromeJSON();
+
+    FILE *fp = fopen(fileName.c_str(),"w");
+    if (!fp)
+    {
+        wkLogLevel(Warn,"TraceRecorder: Unable to open %s for writing",fileName.c_str());
+        return false;
+    }
+    const bool ok = fwrite(json.data(),1,json.size(),fp) == json.size();
+    fclose(fp);
+
+    return ok;
+}
+
+}
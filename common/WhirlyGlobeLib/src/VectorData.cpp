@@ -18,9 +18,10 @@
 
 #import <string>
 #import "VectorData.h"
+#import "GeoJSONStreamParser.h"
 #import "ShapeReader.h"
+#import "VectorFeatureStore.h"
 #import "WhirlyKitLog.h"
-#import "libjson.h"
 
 namespace WhirlyKit
 {
@@ -552,649 +553,42 @@ void VectorPoints::initGeoMbr()
     geoMbr.addGeoCoords(pts);
 }
  
-#if 0
-typedef enum {FileVecPoints=20,FileVecLinear,FileVecAreal,FileVecMesh} VectorIdentType;
-
 bool VectorWriteFile(const std::string &fileName,ShapeSet &shapes)
 {
-    FILE *fp = fopen(fileName.c_str(),"w");
-    if (!fp)
-        return false;
-    
-    try {
-        int numFeatures = (int)shapes.size();
-        if (fwrite(&numFeatures,sizeof(int),1, fp) != 1)
-            throw 1;
-        
-        for (ShapeSet::iterator it = shapes.begin(); it != shapes.end(); ++it)
-        {
-            VectorShapeRef shape = *it;
-            
-            // They all have a dictionary
-            MutableDictionaryRef dict = shape->getAttrDict();
-            MutableRawData dictData;
-            dict->asRawData(&dictData);
-            int dataLen = (int)dictData.getLen();
-            if (fwrite(&dataLen,sizeof(int),1,fp) != 1)
-                throw 1;
-            if (dataLen > 0)
-                if (fwrite(dictData.getRawData(),dataLen,1,fp) != 1)
-                    throw 1;
-            
-            VectorPointsRef pts = std::dynamic_pointer_cast<VectorPoints>(shape);
-            VectorLinearRef lin = std::dynamic_pointer_cast<VectorLinear>(shape);
-            VectorArealRef ar = std::dynamic_pointer_cast<VectorAreal>(shape);
-            VectorTrianglesRef mesh = std::dynamic_pointer_cast<VectorTriangles>(shape);
-            if (pts.get())
-            {
-                unsigned short dataType = FileVecPoints;
-                if (fwrite(&dataType,sizeof(short),1,fp) != 1)
-                    throw 1;
-                
-                unsigned int numPts = (int)pts->pts.size();
-                if (fwrite(&numPts,sizeof(unsigned int),1,fp) != 1)
-                    throw 1;
-                if (fwrite(&pts->pts[0],2*sizeof(float),numPts,fp) != numPts)
-                    throw 1;
-            } else if (lin.get())
-            {
-                unsigned short dataType = FileVecLinear;
-                if (fwrite(&dataType,sizeof(short),1,fp) != 1)
-                    throw 1;
-                
-                unsigned int numPts = (unsigned int)lin->pts.size();
-                if (fwrite(&numPts,sizeof(unsigned int),1,fp) != 1)
-                    throw 1;
-                if (fwrite(&lin->pts[0],2*sizeof(float),numPts,fp) != numPts)
-                    throw 1;
-                
-            } else if (ar.get())
-            {
-                unsigned short dataType = FileVecAreal;
-                if (fwrite(&dataType,sizeof(short),1,fp) != 1)
-                    throw 1;
-                
-                unsigned int numLoops = (unsigned int)ar->loops.size();
-                if (fwrite(&numLoops,sizeof(int),1,fp) != 1)
-                    throw 1;
-                for (unsigned int ii=0;ii<numLoops;ii++)
-                {
-                    VectorRing &ring = ar->loops[ii];
-                    unsigned int numPts = (unsigned int)ring.size();
-                    if (fwrite(&numPts,sizeof(unsigned int),1,fp) != 1)
-                        throw 1;
-                    if (fwrite(&ring[0],2*sizeof(float),numPts,fp) != numPts)
-                        throw 1;
-                }
-                
-            } else if (mesh.get())
-            {
-                unsigned short dataType = FileVecMesh;
-                if (fwrite(&dataType,sizeof(short),1,fp) != 1)
-                    throw 1;
-                
-                unsigned int numPts = (unsigned int)mesh->pts.size();
-                if (fwrite(&numPts,sizeof(unsigned int),1,fp) != 1)
-                    throw 1;
-                if (fwrite(&mesh->pts[0],3*sizeof(float),numPts,fp) != numPts)
-                    throw 1;
-                
-                unsigned int numTri = (unsigned int)mesh->tris.size();
-                if (fwrite(&numTri,sizeof(unsigned int),1,fp) != 1)
-                    throw 1;
-                if (fwrite(&mesh->tris[0],3*sizeof(unsigned int),numTri,fp) != numTri)
-                    throw 1;
-            } else {
-                //                NSLog(@"Tried to write unknown object in VectorWriteFile");
-                throw 1;
-            }
-        }
-    }
-    catch (...)
-    {
-        fclose(fp);
-        return false;
-    }
-    
-    fclose(fp);
-    return true;
+    return VectorFeatureStoreWrite(fileName,shapes);
 }
 
 bool VectorReadFile(const std::string &fileName,ShapeSet &shapes)
 {
-    FILE *fp = fopen(fileName.c_str(),"r");
-    if (!fp)
-        return false;
-    
-    try {
-        int numFeatures;
-        if (fread(&numFeatures, sizeof(int), 1, fp) != 1)
-            throw 1;
-        
-        for (unsigned int ii=0;ii<numFeatures;ii++)
-        {
-            // Dictionary first
-            int dataLen;
-            if (fread(&dataLen, sizeof(int), 1, fp) != 1)
-                throw 1;
-            Dictionary *dict = NULL;
-            if (dataLen > 0)
-            {
-                RawDataWrapper *rawData = RawDataFromFile(fp, dataLen);
-                if (!rawData)
-                    throw 1;
-                dict = new Dictionary(rawData);
-                delete rawData;
-            }
-            
-            // Now for the type
-            unsigned short dataType;
-            if (fread(&dataType,sizeof(unsigned short),1,fp) != 1)
-                throw 1;
-            
-            switch (dataType)
-            {
-                case FileVecPoints:
-                {
-                    VectorPointsRef pts(VectorPoints::createPoints());
-                    if (dict)
-                        pts->setAttrDict(*dict);
-                    
-                    unsigned int numPts;
-                    if (fread(&numPts,sizeof(unsigned int),1,fp) != 1)
-                        throw 1;
-                    pts->pts.resize(numPts);
-                    if (fread(&pts->pts[0],2*sizeof(float),numPts,fp) != numPts)
-                        throw 1;
-                    
-                    pts->initGeoMbr();
-                    shapes.insert(pts);
-                }
-                    break;
-                case FileVecLinear:
-                {
-                    VectorLinearRef lin(VectorLinear::createLinear());
-                    if (dict)
-                        lin->setAttrDict(*dict);
-                    
-                    unsigned int numPts;
-                    if (fread(&numPts,sizeof(unsigned int),1,fp) != 1)
-                        throw 1;
-                    lin->pts.resize(numPts);
-                    if (fread(&lin->pts[0],2*sizeof(float),numPts,fp) != numPts)
-                        throw 1;
-                    
-                    lin->initGeoMbr();
-                    shapes.insert(lin);
-                }
-                    break;
-                case FileVecAreal:
-                {
-                    VectorArealRef ar(VectorAreal::createAreal());
-                    if (dict)
-                        ar->setAttrDict(*dict);
-                    
-                    unsigned int numLoops;
-                    if (fread(&numLoops,sizeof(unsigned int),1,fp) != 1)
-                        throw 1;
-                    ar->loops.resize(numLoops);
-                    
-                    for (unsigned int ii=0;ii<numLoops;ii++)
-                    {
-                        VectorRing &ring = ar->loops[ii];
-                        unsigned int numPts;
-                        if (fread(&numPts,sizeof(unsigned int),1,fp) != 1)
-                            throw 1;
-                        ring.resize(numPts);
-                        if (fread(&ring[0],2*sizeof(float),numPts,fp) != numPts)
-                            throw 1;
-                    }
-                    
-                    ar->initGeoMbr();
-                    shapes.insert(ar);
-                }
-                    break;
-                case FileVecMesh:
-                {
-                    VectorTrianglesRef mesh(VectorTriangles::createTriangles());
-                    if (dict)
-                        mesh->setAttrDict(*dict);
-                    
-                    unsigned int numPts;
-                    if (fread(&numPts,sizeof(unsigned int),1,fp) != 1)
-                        throw 1;
-                    mesh->pts.resize(numPts);
-                    if (fread(&mesh->pts[0],3*sizeof(float),numPts,fp) != numPts)
-                        throw 1;
-                    
-                    unsigned int numTri;
-                    if (fread(&numTri,sizeof(unsigned int),1,fp) != 1)
-                        throw 1;
-                    mesh->tris.resize(numTri);
-                    if (fread(&mesh->tris[0],3*sizeof(unsigned int),numTri,fp) != numTri)
-                        throw 1;
-                    
-                    mesh->initGeoMbr();
-                    shapes.insert(mesh);
-                }
-                    break;
-                default:
-                    //                    NSLog(@"Unknown data type in VectorReadFile()");
-                    throw 1;
-                    break;
-            }
-            
-            if (dict)
-                delete dict;
-        }
-    }
-    catch (...)
-    {
-        fclose(fp);
+    const auto store = VectorFeatureStore::open(fileName);
+    if (!store)
         return false;
-    }
-    
-    fclose(fp);
-    return true;
-}
-#endif
-
-using namespace libjson;
 
-// Parse properties out of a node
-static bool VectorParseProperties(JSONNode node,const MutableDictionaryRef &dict)
-{
-    for (JSONNode::const_iterator it = node.begin();
-         it != node.end(); ++it)
-    {
-        json_string name = it->name();
-        if (!name.empty())
-        {
-            switch (it->type())
-            {
-                case JSON_STRING:
-                {
-                    json_string val = it->as_string();
-                    dict->setString(name,val);
-                }
-                    break;
-                case JSON_NUMBER:
-                {
-                    double val = it->as_float();
-                    dict->setDouble(name, val);
-                }
-                    break;
-                case JSON_BOOL:
-                {
-                    bool val = it->as_bool();
-                    dict->setInt(name, (int)val);
-                }
-                    break;
-            }
-        }
-    }
-    
+    store->getShapes(shapes);
     return true;
 }
-    
-// Parse coordinate list out of a node
-bool VectorParseCoordinates(JSONNode node,VectorRing &pts, bool subCall=false)
-{
-    for (JSONNode::const_iterator it = node.begin();
-         it != node.end(); ++it)
-    {
-        if (it->type() == JSON_ARRAY)
-        {
-            if (!VectorParseCoordinates(*it, pts, true))
-                return false;
-            continue;
-        }
-        
-        // We're expecting two numbers here
-        if (it->type() == JSON_NUMBER)
-        {
-            if (node.size() < 2)
-                return false;
-            
-            const auto lon = (float)it->as_float();  ++it;
-            const auto lat = (float)it->as_float();
-            pts.push_back(GeoCoord::CoordFromDegrees(lon,lat));
-            
-            // There might be a Z value or even other junk.  We just want the first two coordinates
-            //  in this particular case.
-            if (subCall)
-                return true;
-            
-            continue;
-        }
-        
-        // Got something unexpected
-        return false;
-    }
-    
-    return true;
-}
-
-// Parse geometry out of a node
-bool VectorParseGeometry(JSONNode node,ShapeSet &shapes)
-{
-    // Let's look for type and coordinates
-    JSONNode::const_iterator typeIt = node.end();
-    JSONNode::const_iterator coordIt = node.end();
-    JSONNode::const_iterator geomCollectIt = node.end();
-    for (JSONNode::const_iterator it = node.begin();
-         it != node.end(); ++it)
-    {
-        if (!it->name().compare("type"))
-            typeIt = it;
-        else if (!it->name().compare("coordinates"))
-            coordIt = it;
-        else if (!it->name().compare("geometries"))
-            geomCollectIt = it;
-    }
-    
-    if (typeIt == node.end())
-        return false;
-    
-    json_string type = typeIt->as_string();
-    if (!type.compare("Point"))
-    {
-        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
-            return false;
-
-        VectorPointsRef pts = VectorPoints::createPoints();
-        if (!VectorParseCoordinates(*coordIt,pts->pts))
-            return false;
-        pts->initGeoMbr();
-        shapes.insert(pts);
-        
-        return true;
-    } else if (!type.compare("LineString"))
-    {
-        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
-            return false;
-        
-        VectorLinearRef lin = VectorLinear::createLinear();
-        if (!VectorParseCoordinates(*coordIt,lin->pts))
-            return false;
-        lin->initGeoMbr();
-        shapes.insert(lin);
 
-        return true;
-    } else if (!type.compare("Polygon"))
-    {
-        // This should be an array of array of coordinates
-        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
-            return false;
-        VectorArealRef ar = VectorAreal::createAreal();
-        int numLoops = 0;
-        for (JSONNode::const_iterator coordEntryIt = coordIt->begin();
-             coordEntryIt != coordIt->end(); ++coordEntryIt, numLoops++)
-        {
-            if (coordEntryIt->type() != JSON_ARRAY)
-                return false;
-        
-            ar->loops.resize(numLoops+1);
-            if (!VectorParseCoordinates(*coordEntryIt,ar->loops[numLoops]))
-                return false;
-        }
-        
-        ar->initGeoMbr();
-        shapes.insert(ar);
-        
-        return true;
-    } else if (!type.compare("MultiPoint"))
-    {
-        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
-            return false;
-        
-        VectorPointsRef pts = VectorPoints::createPoints();
-        if (!VectorParseCoordinates(*coordIt,pts->pts))
-            return false;
-        pts->initGeoMbr();
-        shapes.insert(pts);
-        
-        return true;        
-    } else if (!type.compare("MultiLineString"))
-    {
-        // This should be an array of array of coordinates
-        if (coordIt == node.end() || coordIt->type() != JSON_ARRAY)
-            return false;
-        for (JSONNode::const_iterator coordEntryIt = coordIt->begin();
-             coordEntryIt != coordIt->end(); ++coordEntryIt)
-        {
-            if (coordEntryIt->type() != JSON_ARRAY)
-                return false;
-            
-            VectorLinearRef lin = VectorLinear::createLinear();
-            if (!VectorParseCoordinates(*coordEntryIt, lin->pts))
-                return false;
-            lin->initGeoMbr();
-            shapes.insert(lin);
-        }
-        
-        return true;
-    } else if (!type.compare("MultiPolygon"))
-    {
-        // This should be an array of array of coordinates
-        if (coordIt == node.end() ||  coordIt->type() != JSON_ARRAY)
-            return false;
 
-        for (JSONNode::const_iterator polyIt = coordIt->begin();
-             polyIt != coordIt->end(); ++polyIt)
-        {
-            VectorArealRef ar = VectorAreal::createAreal();
-            int numLoops = 0;
-            for (JSONNode::const_iterator coordEntryIt = polyIt->begin();
-                 coordEntryIt != polyIt->end(); ++coordEntryIt, numLoops++)
-            {
-                if (coordEntryIt->type() != JSON_ARRAY)
-                    return false;
-                
-                ar->loops.resize(numLoops+1);
-                if (!VectorParseCoordinates(*coordEntryIt,ar->loops[numLoops]))
-                    return false;
-            }
-            
-            ar->initGeoMbr();
-            shapes.insert(ar);
-        }
-        
-        return true;        
-    } else if (!type.compare("GeometryCollection"))
-    {
-        if (geomCollectIt == node.end() || geomCollectIt->type() != JSON_ARRAY)
-            return false;
-        for (JSONNode::const_iterator geomIt = geomCollectIt->begin();
-             geomIt != geomCollectIt->end(); ++geomIt)
-            if (!VectorParseGeometry(*geomIt,shapes))
-                return false;
-        
-        return true;
-    }
-    
-    return false;
-}
-    
-// Parse a single feature
-bool VectorParseFeature(JSONNode node,ShapeSet &shapes)
-{
-    JSONNode::const_iterator typeIt = node.end();
-    JSONNode::const_iterator geomIt = node.end();
-    JSONNode::const_iterator propIt = node.end();
-    
-    for (JSONNode::const_iterator it = node.begin();
-         it != node.end(); ++it)
-    {
-        if (!it->name().compare("type"))
-            typeIt = it;
-        else if (!it->name().compare("geometry"))
-            geomIt = it;
-        else if (!it->name().compare("properties"))
-            propIt = it;
-    }
-    if (geomIt == node.end())
-        return false;
-    
-    // Parse the geometry
-    ShapeSet newShapes;
-    if (!VectorParseGeometry(*geomIt, newShapes))
-        return false;
-
-    // Properties are optional
-    if (propIt != node.end()) {
-        MutableDictionaryRef properties = MutableDictionaryMake();
-        VectorParseProperties(*propIt, properties);
-        // Apply the properties to the geometry
-        for (const auto & newShape : newShapes)
-            newShape->setAttrDict(properties);
-    }
-    
-    shapes.insert(newShapes.begin(), newShapes.end());
-    return true;
-}
-
-// Parse an array of features
-bool VectorParseFeatures(JSONNode node,ShapeSet &shapes)
-{
-    for (JSONNode::const_iterator it = node.begin();it != node.end(); ++it) {
-        // Not sure what this would be
-        if (it->type() != JSON_NODE)
-            return false;
-        if (!VectorParseFeature(*it, shapes)) {
-            return false;
-        }
-    }
-    
-    return true;
-}
-
-// Recursively parse a feature collection
-bool VectorParseTopNode(JSONNode node,ShapeSet &shapes,JSONNode &crs)
-{
-    JSONNode::const_iterator typeIt = node.end();
-    JSONNode::const_iterator featIt = node.end();
-    
-    for (JSONNode::const_iterator it = node.begin();
-         it != node.end(); ++it)
-    {
-        if (!it->name().compare("type"))
-            typeIt = it;
-        else if (!it->name().compare("features"))
-            featIt = it;
-        else if (!it->name().compare("crs"))
-            crs = *it;
-    }
-    if (typeIt == node.end())
-        return false;
-    
-    json_string type;
-    type = typeIt->as_string();
-    if (!type.compare("FeatureCollection"))
-    {
-        // Expecting a features node
-        if (featIt == node.end() || featIt->type() != JSON_ARRAY)
-            return false;
-        return VectorParseFeatures(*featIt,shapes);
-    } else if (!type.compare("Feature"))
-    {
-        return VectorParseFeature(node,shapes);
-    } else {
-        // Only last try to do raw geometry
-        return VectorParseGeometry(node, shapes);
-    }
-
-    return false;
-}
-
-// Parse the name out of a CRS in a GeoJSON file
-bool VectorParseGeoJSONCRS(JSONNode node,std::string &crsName)
-{
-    JSONNode::const_iterator typeIt = node.end();
-    JSONNode::const_iterator propIt = node.end();
-    
-    for (JSONNode::const_iterator it = node.begin();
-         it != node.end(); ++it)
-    {
-        if (!it->name().compare("type"))
-            typeIt = it;
-        else if (!it->name().compare("properties"))
-            propIt = it;
-    }
-    if (typeIt == node.end())
-        return false;
-    
-    json_string type;
-    type = typeIt->as_string();
-    if (!type.compare("name"))
-    {
-        // Expecting a features node
-        if (propIt == node.end() || propIt->type() != JSON_NODE)
-            return false;
-        
-        for (JSONNode::const_iterator it = propIt->begin(); it != propIt->end(); ++it)
-        {
-            if (!it->name().compare("name"))
-            {
-                if (it->type() != JSON_STRING)
-                    return false;
-                crsName = it->as_string();
-                return true;
-            }
-        }
-    } else
-        return false;
-    
-    return false;
-}
-    
-// Parse a set of features out of GeoJSON, using libjson
+// Parse a set of features out of GeoJSON, without building a JSON tree first
 bool VectorParseGeoJSON(ShapeSet &shapes,const std::string &str,std::string &crs)
 {
-    json_string json = str;
-    JSONNode topNode = libjson::parse(json);
-
-    JSONNode crsNode;
-    if (!VectorParseTopNode(topNode,shapes,crsNode))
+    GeoJSONStreamParser parser([&](const VectorObjectRef &batch)
     {
-//        NSLog(@"Failed to parse JSON in VectorParseGeoJSON");
+        shapes.insert(batch->shapes.begin(),batch->shapes.end());
+        return true;
+    });
+    if (!parser.parse(str))
         return false;
-    }
 
-    std::string crsName;
-    if (VectorParseGeoJSONCRS(crsNode,crsName))
-    {
-        if (!crsName.empty())
-            crs = crsName;
-    }
-    
+    if (!parser.getCRS().empty())
+        crs = parser.getCRS();
+
     return true;
 }
     
 bool VectorParseGeoJSONAssembly(const std::string &str,std::map<std::string,ShapeSet> &shapes)
 {
-    json_string json = str;
-    
-    JSONNode topNode = libjson::parse(json);
-    JSONNode crsNode;
-
-    for (JSONNode::iterator nodeIt = topNode.begin();
-         nodeIt != topNode.end(); ++nodeIt)
-    {
-        if (nodeIt->type() == JSON_NODE)
-        {
-            ShapeSet theseShapes;
-            if (VectorParseTopNode(*nodeIt,theseShapes,crsNode))
-            {
-                json_string name = nodeIt->name();
-                std::string nameStr = to_std_string(name);
-                shapes[nameStr] = theseShapes;
-            } else
-                return false;
-        }
-    }
-    
-    return true;
+    return GeoJSONStreamParser::ParseAssembly(str.data(),str.size(),shapes);
 }
 
 //#define LOW_LEVEL_UNIT_TESTS
@@ -0,0 +1,785 @@
+/*  VectorFeatureStore.cpp
+ *  WhirlyGlobeLib
+ *
+ *  Created by agent on 10/16/26.
+ *  Copyright 2011-2022 mousebird consulting
+ *
+ *  Licensed under the Apache License, Version 2.0 (the "License");
+ *  you may not use this file except in compliance with the License.
+ *  You may obtain a copy of the License at
+ *  http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *  Unless required by applicable law or agreed to in writing, software
+ *  distributed under the License is distributed on an "AS IS" BASIS,
+ *  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *  See the License for the specific language governing permissions and
+ *  limitations under the License.
+ */
+
+#import <algorithm>
+#import <cfloat>
+#import <climits>
+#import <cstdio>
+#import <cstring>
+#import <unordered_map>
+#import "VectorFeatureStore.h"
+#import "WhirlyKitLog.h"
+
+namespace WhirlyKit
+{
+
+static const char FileMagic[4] = {'W','K','F','S'};
+// Reads back differently on a machine with the other byte order
+static constexpr uint32_t ByteOrderMark = 0x01020304;
+// Children per node in the spatial index
+static constexpr uint32_t IndexNodeSize = 16;
+
+static_assert(sizeof(VectorFeatureStore::Attr) == 16,"Attr is written as is");
+static_assert(sizeof(VectorFeatureStore::Header) % 8 == 0,"Sections after the header start aligned");
+static_assert(sizeof(Point2f) == 2*sizeof(float),"Points are read in place");
+static_assert(sizeof(VectorTriangles::Triangle) == 3*sizeof(int),"Triangles are read in place");
+
+// Size and alignment of each section, from the counts in the header
+static void SectionSizes(const VectorFeatureStore::Header &header,uint64_t sizes[],uint64_t aligns[])
+{
+    typedef VectorFeatureStore VFS;
+    const uint64_t numFeat = header.numFeatures;
+    sizes[VFS::SectFeatTypes] = numFeat;                               aligns[VFS::SectFeatTypes] = 1;
+    sizes[VFS::SectFeatParts] = (numFeat+1)*sizeof(uint32_t);          aligns[VFS::SectFeatParts] = 4;
+    sizes[VFS::SectFeatTris] = (numFeat+1)*sizeof(uint32_t);           aligns[VFS::SectFeatTris] = 4;
+    sizes[VFS::SectFeatAttrs] = (numFeat+1)*sizeof(uint32_t);          aligns[VFS::SectFeatAttrs] = 4;
+    sizes[VFS::SectPartPoints] = ((uint64_t)header.numParts+1)*sizeof(uint32_t);     aligns[VFS::SectPartPoints] = 4;
+    sizes[VFS::SectPoints] = (uint64_t)header.numPoints*sizeof(Point2f);             aligns[VFS::SectPoints] = 4;
+    sizes[VFS::SectHeights] = (uint64_t)header.numHeights*sizeof(float);             aligns[VFS::SectHeights] = 4;
+    sizes[VFS::SectTris] = (uint64_t)header.numTris*sizeof(VectorTriangles::Triangle); aligns[VFS::SectTris] = 4;
+    sizes[VFS::SectAttrs] = (uint64_t)header.numAttrs*sizeof(VFS::Attr);             aligns[VFS::SectAttrs] = 8;
+    sizes[VFS::SectStringOffsets] = ((uint64_t)header.numStrings+1)*sizeof(uint32_t); aligns[VFS::SectStringOffsets] = 4;
+    sizes[VFS::SectStringData] = header.stringBytes;                                 aligns[VFS::SectStringData] = 1;
+    sizes[VFS::SectIndex] = (uint64_t)header.numIndexBoxes*4*sizeof(float);          aligns[VFS::SectIndex] = 4;
+}
+
+// Where each level of the spatial index starts.  The last entry is the total number of boxes.
+static void IndexLevelStarts(uint32_t numFeatures,uint32_t nodeSize,std::vector<uint32_t> &starts)
+{
+    starts.clear();
+    uint32_t total = 0;
+    if (numFeatures > 0)
+    {
+        uint32_t count = numFeatures;
+        while (true)
+        {
+            starts.push_back(total);
+            total += count;
+            if (count == 1)
+                break;
+            count = (count + nodeSize - 1) / nodeSize;
+        }
+    }
+    starts.push_back(total);
+}
+
+// Check an offset array starts at zero, never goes backwards and ends at the given count
+static bool ValidOffsets(const uint32_t *offsets,uint32_t num,uint32_t total)
+{
+    if (offsets[0] != 0 || offsets[num] != total)
+        return false;
+    for (uint32_t ii=0;ii<num;ii++)
+        if (offsets[ii] > offsets[ii+1])
+            return false;
+    return true;
+}
+
+VectorFeatureStore::VectorFeatureStore(RawDataRef data) :
+    data(std::move(data))
+{
+}
+
+VectorFeatureStoreRef VectorFeatureStore::open(const std::string &fileName)
+{
+    const auto mapped = RawDataMapFile(fileName);
+    if (!mapped)
+        return nullptr;
+
+    auto store = open(mapped);
+    if (!store)
+        wkLogLevel(Warn,"VectorFeatureStore: %s isn't a feature store we can read",fileName.c_str());
+    return store;
+}
+
+VectorFeatureStoreRef VectorFeatureStore::open(RawDataRef data)
+{
+    if (!data)
+        return nullptr;
+
+    VectorFeatureStoreRef store(new VectorFeatureStore(std::move(data)));
+    return store->setup() ? store : nullptr;
+}
+
+bool VectorFeatureStore::setup()
+{
+    const unsigned char *base = data->getRawData();
+    const uint64_t len = data->getLen();
+    if (!base || len < sizeof(Header) || ((uintptr_t)base % 8) != 0)
+        return false;
+
+    header = reinterpret_cast<const Header *>(base);
+    if (memcmp(header->magic,FileMagic,sizeof(FileMagic)) != 0 ||
+        header->version != FileVersion || header->byteOrder != ByteOrderMark)
+        return false;
+    if (header->numHeights != 0 && header->numHeights != header->numPoints)
+        return false;
+    if (header->numKeys > header->numStrings || header->nodeSize < 2)
+        return false;
+
+    // Every section has to fit and be aligned for what's in it
+    uint64_t sizes[NumSections],aligns[NumSections];
+    SectionSizes(*header,sizes,aligns);
+    for (int ii=0;ii<NumSections;ii++)
+    {
+        const uint64_t offset = header->sections[ii];
+        if (offset < sizeof(Header) || offset % aligns[ii] != 0 || offset > len || sizes[ii] > len - offset)
+            return false;
+    }
+
+    featTypes = base + header->sections[SectFeatTypes];
+    featParts = reinterpret_cast<const uint32_t *>(base + header->sections[SectFeatParts]);
+    featTris = reinterpret_cast<const uint32_t *>(base + header->sections[SectFeatTris]);
+    featAttrs = reinterpret_cast<const uint32_t *>(base + header->sections[SectFeatAttrs]);
+    partPoints = reinterpret_cast<const uint32_t *>(base + header->sections[SectPartPoints]);
+    points = reinterpret_cast<const Point2f *>(base + header->sections[SectPoints]);
+    heights = header->numHeights ? reinterpret_cast<const float *>(base + header->sections[SectHeights]) : nullptr;
+    tris = reinterpret_cast<const VectorTriangles::Triangle *>(base + header->sections[SectTris]);
+    attrs = reinterpret_cast<const Attr *>(base + header->sections[SectAttrs]);
+    stringOffsets = reinterpret_cast<const uint32_t *>(base + header->sections[SectStringOffsets]);
+    stringData = reinterpret_cast<const char *>(base + header->sections[SectStringData]);
+    indexBoxes = reinterpret_cast<const float *>(base + header->sections[SectIndex]);
+
+    // The offsets get used without checks from here on, so check them now
+    const uint32_t numFeat = header->numFeatures;
+    if (!ValidOffsets(featParts,numFeat,header->numParts) ||
+        !ValidOffsets(featTris,numFeat,header->numTris) ||
+        !ValidOffsets(featAttrs,numFeat,header->numAttrs) ||
+        !ValidOffsets(partPoints,header->numParts,header->numPoints) ||
+        !ValidOffsets(stringOffsets,header->numStrings,header->stringBytes))
+        return false;
+
+    for (uint32_t ii=0;ii<numFeat;ii++)
+    {
+        switch (featTypes[ii])
+        {
+            case FeaturePoints:
+            case FeatureLinear:
+                if (getNumParts(ii) != 1 || featTris[ii] != featTris[ii+1])
+                    return false;
+                break;
+            case FeatureAreal:
+                if (featTris[ii] != featTris[ii+1])
+                    return false;
+                break;
+            case FeatureTriangles:
+            {
+                if (getNumParts(ii) != 1 || !heights)
+                    return false;
+                const uint32_t numPts = partPoints[featParts[ii]+1] - partPoints[featParts[ii]];
+                for (uint32_t ti=featTris[ii];ti<featTris[ii+1];ti++)
+                    for (int which : tris[ti].pts)
+                        if (which < 0 || (uint32_t)which >= numPts)
+                            return false;
+            }
+                break;
+            default:
+                return false;
+        }
+    }
+
+    for (uint32_t ii=0;ii<header->numAttrs;ii++)
+    {
+        const Attr &attr = attrs[ii];
+        if (attr.key >= header->numKeys)
+            return false;
+        if (attr.type == DictTypeString && attr.val.strVal >= header->numStrings)
+            return false;
+    }
+
+    IndexLevelStarts(numFeat,header->nodeSize,levelStarts);
+    if (levelStarts.size()-1 != header->numIndexLevels || levelStarts.back() != header->numIndexBoxes)
+        return false;
+
+    std::vector<std::string> keys;
+    keys.reserve(header->numKeys);
+    for (uint32_t ii=0;ii<header->numKeys;ii++)
+        keys.push_back(getString(ii));
+    keyTable = std::make_shared<DictionaryKeyTable>(keys);
+
+    return true;
+}
+
+std::string VectorFeatureStore::getString(uint32_t which) const
+{
+    return std::string(stringData + stringOffsets[which],stringOffsets[which+1] - stringOffsets[which]);
+}
+
+Mbr VectorFeatureStore::getBounds() const
+{
+    return Mbr(Point2f(header->bounds[0],header->bounds[1]),Point2f(header->bounds[2],header->bounds[3]));
+}
+
+Mbr VectorFeatureStore::getBounds(unsigned int which) const
+{
+    // Features with no points have an inverted box, which comes back invalid
+    const float *box = &indexBoxes[4*which];
+    if (box[0] > box[2])
+        return Mbr();
+    return Mbr(Point2f(box[0],box[1]),Point2f(box[2],box[3]));
+}
+
+const Point2f *VectorFeatureStore::getPoints(unsigned int which,unsigned int part,unsigned int &numPts) const
+{
+    const uint32_t partIdx = featParts[which] + part;
+    numPts = partPoints[partIdx+1] - partPoints[partIdx];
+    return points + partPoints[partIdx];
+}
+
+const float *VectorFeatureStore::getHeights(unsigned int which,unsigned int part) const
+{
+    if (!heights || getType(which) != FeatureTriangles)
+        return nullptr;
+    return heights + partPoints[featParts[which] + part];
+}
+
+const VectorTriangles::Triangle *VectorFeatureStore::getTriangles(unsigned int which,unsigned int &numTris) const
+{
+    numTris = featTris[which+1] - featTris[which];
+    return tris + featTris[which];
+}
+
+MutableDictionaryRef VectorFeatureStore::makeAttributes(unsigned int which,const StringSet *filter) const
+{
+    auto dict = std::make_shared<FlatDictionaryC>(keyTable);
+    for (uint32_t ii=featAttrs[which];ii<featAttrs[which+1];ii++)
+    {
+        const Attr &attr = attrs[ii];
+        const std::string &name = keyTable->getKey((int)attr.key);
+        if (filter && filter->find(name) == filter->end())
+            continue;
+
+        switch (attr.type)
+        {
+            case DictTypeInt:
+                dict->setInt(name,(int)attr.val.iVal);
+                break;
+            case DictTypeInt64:
+                dict->setInt64(name,attr.val.iVal);
+                break;
+            case DictTypeIdentity:
+                dict->setIdentifiable(name,(SimpleIdentity)attr.val.iVal);
+                break;
+            case DictTypeDouble:
+                dict->setDouble(name,attr.val.dVal);
+                break;
+            case DictTypeString:
+                dict->setString(name,getString(attr.val.strVal));
+                break;
+            default:
+                break;
+        }
+    }
+    return dict;
+}
+
+void VectorFeatureStore::query(const Mbr &mbr,std::vector<unsigned int> &features) const
+{
+    const size_t numLevels = levelStarts.size()-1;
+    if (numLevels == 0 || !mbr.valid())
+        return;
+
+    const size_t startSize = features.size();
+    const Point2f &ll = mbr.ll(), &ur = mbr.ur();
+
+    // Level and box within that level
+    std::vector<std::pair<uint32_t,uint32_t>> stack;
+    stack.emplace_back((uint32_t)numLevels-1,0);
+    while (!stack.empty())
+    {
+        const auto node = stack.back();
+        stack.pop_back();
+
+        const float *box = &indexBoxes[4*(levelStarts[node.first] + node.second)];
+        if (box[0] > ur.x() || box[2] < ll.x() || box[1] > ur.y() || box[3] < ll.y())
+            continue;
+
+        if (node.first == 0)
+        {
+            features.push_back(node.second);
+        }
+        else
+        {
+            const uint32_t childLevel = node.first-1;
+            const uint32_t levelSize = levelStarts[childLevel+1] - levelStarts[childLevel];
+            const uint32_t childStart = node.second * header->nodeSize;
+            const uint32_t childEnd = std::min(childStart + header->nodeSize,levelSize);
+            for (uint32_t child=childStart;child<childEnd;child++)
+                stack.emplace_back(childLevel,child);
+        }
+    }
+
+    std::sort(features.begin()+startSize,features.end());
+}
+
+VectorShapeRef VectorFeatureStore::makeShape(unsigned int which,const StringSet *filter) const
+{
+    VectorShapeRef shape;
+    unsigned int numPts = 0;
+    switch (getType(which))
+    {
+        case FeaturePoints:
+        {
+            auto pts = VectorPoints::createPoints();
+            const Point2f *src = getPoints(which,0,numPts);
+            pts->pts.assign(src,src+numPts);
+            pts->initGeoMbr();
+            shape = pts;
+        }
+            break;
+        case FeatureLinear:
+        {
+            auto lin = VectorLinear::createLinear();
+            const Point2f *src = getPoints(which,0,numPts);
+            lin->pts.assign(src,src+numPts);
+            lin->initGeoMbr();
+            shape = lin;
+        }
+            break;
+        case FeatureAreal:
+        {
+            auto ar = VectorAreal::createAreal();
+            const unsigned int numParts = getNumParts(which);
+            ar->loops.resize(numParts);
+            for (unsigned int part=0;part<numParts;part++)
+            {
+                const Point2f *src = getPoints(which,part,numPts);
+                ar->loops[part].assign(src,src+numPts);
+            }
+            ar->initGeoMbr();
+            shape = ar;
+        }
+            break;
+        case FeatureTriangles:
+        {
+            auto mesh = VectorTriangles::createTriangles();
+            const Point2f *src = getPoints(which,0,numPts);
+            const float *srcZ = getHeights(which,0);
+            mesh->pts.reserve(numPts);
+            for (unsigned int ii=0;ii<numPts;ii++)
+                mesh->pts.emplace_back(src[ii].x(),src[ii].y(),srcZ[ii]);
+            unsigned int numTris = 0;
+            const VectorTriangles::Triangle *srcTris = getTriangles(which,numTris);
+            mesh->tris.assign(srcTris,srcTris+numTris);
+            mesh->initGeoMbr();
+            shape = mesh;
+        }
+            break;
+        default:
+            return nullptr;
+    }
+
+    shape->setAttrDict(makeAttributes(which,filter));
+    return shape;
+}
+
+void VectorFeatureStore::getShapes(ShapeSet &shapes) const
+{
+    shapes.reserve(shapes.size() + getNumFeatures());
+    for (unsigned int ii=0;ii<getNumFeatures();ii++)
+        if (auto shape = makeShape(ii))
+            shapes.insert(shape);
+}
+
+void VectorFeatureStore::getShapes(const Mbr &mbr,ShapeSet &shapes) const
+{
+    std::vector<unsigned int> features;
+    query(mbr,features);
+    shapes.reserve(shapes.size() + features.size());
+    for (const auto which : features)
+        if (auto shape = makeShape(which))
+            shapes.insert(shape);
+}
+
+VectorObjectRef VectorFeatureStore::makeVectorObject(const Mbr &mbr) const
+{
+    auto vecObj = std::make_shared<VectorObject>();
+    getShapes(mbr,vecObj->shapes);
+    return vecObj;
+}
+
+namespace
+{
+
+// Distance along a Hilbert curve through a 65536 x 65536 grid
+uint32_t HilbertIndex(uint32_t x,uint32_t y)
+{
+    static constexpr uint32_t n = 1U<<16;
+    uint32_t d = 0;
+    for (uint32_t s=n/2;s>0;s/=2)
+    {
+        const uint32_t rx = (x & s) ? 1 : 0;
+        const uint32_t ry = (y & s) ? 1 : 0;
+        d += s * s * ((3 * rx) ^ ry);
+        if (ry == 0)
+        {
+            if (rx == 1)
+            {
+                x = n-1 - x;
+                y = n-1 - y;
+            }
+            std::swap(x,y);
+        }
+    }
+    return d;
+}
+
+// Every string goes in once
+class StringTableBuilder
+{
+public:
+    uint32_t add(const std::string &str)
+    {
+        const auto it = index.find(str);
+        if (it != index.end())
+            return it->second;
+        const auto which = (uint32_t)strings.size();
+        index[str] = which;
+        strings.push_back(str);
+        return which;
+    }
+
+    std::vector<std::string> strings;
+    std::unordered_map<std::string,uint32_t> index;
+};
+
+struct WriteFeature
+{
+    VectorShapeRef shape;
+    VectorFeatureStore::FeatureType type;
+    Mbr mbr;
+    uint32_t order;
+};
+
+}
+
+bool VectorFeatureStoreWrite(const std::string &fileName,const ShapeSet &shapes)
+{
+    typedef VectorFeatureStore VFS;
+
+    // Work out what everything is and where it is
+    std::vector<WriteFeature> features;
+    features.reserve(shapes.size());
+    StringTableBuilder strings;
+    Mbr totalMbr;
+    bool hasMesh = false;
+    for (const auto &shape : shapes)
+    {
+        WriteFeature feat;
+        feat.shape = shape;
+        if (const auto pts = dynamic_cast<VectorPoints *>(shape.get()))
+        {
+            feat.type = VFS::FeaturePoints;
+            feat.mbr.addPoints(pts->pts);
+        }
+        else if (const auto lin = dynamic_cast<VectorLinear *>(shape.get()))
+        {
+            feat.type = VFS::FeatureLinear;
+            feat.mbr.addPoints(lin->pts);
+        }
+        else if (const auto ar = dynamic_cast<VectorAreal *>(shape.get()))
+        {
+            feat.type = VFS::FeatureAreal;
+            for (const auto &loop : ar->loops)
+                feat.mbr.addPoints(loop);
+        }
+        else if (const auto mesh = dynamic_cast<VectorTriangles *>(shape.get()))
+        {
+            feat.type = VFS::FeatureTriangles;
+            for (const auto &pt : mesh->pts)
+                feat.mbr.addPoint(Point2f(pt.x(),pt.y()));
+            hasMesh = true;
+        }
+        else
+        {
+            wkLogLevel(Warn,"VectorFeatureStoreWrite: Unsupported shape type");
+            return false;
+        }
+
+        if (feat.mbr.valid())
+        {
+            totalMbr.addPoint(feat.mbr.ll());
+            totalMbr.addPoint(feat.mbr.ur());
+        }
+
+        // Names go first in the string table
+        if (const auto &dict = shape->getAttrDictRef())
+            for (const auto &key : dict->getKeys())
+                strings.add(key);
+
+        features.push_back(feat);
+    }
+    const auto numKeys = (uint32_t)strings.strings.size();
+
+    // Sort along a Hilbert curve so nearby features end up together in the file and the index
+    const Point2f span = totalMbr.valid() ? Point2f(totalMbr.ur() - totalMbr.ll()) : Point2f(0,0);
+    for (auto &feat : features)
+    {
+        if (!feat.mbr.valid())
+        {
+            feat.order = UINT32_MAX;
+            continue;
+        }
+        const Point2f center = (feat.mbr.ll() + feat.mbr.ur()) / 2.0f;
+        const auto cellX = (uint32_t)(span.x() > 0.0 ? (center.x() - totalMbr.ll().x()) / span.x() * 65535.0 : 0.0);
+        const auto cellY = (uint32_t)(span.y() > 0.0 ? (center.y() - totalMbr.ll().y()) / span.y() * 65535.0 : 0.0);
+        feat.order = HilbertIndex(cellX,cellY);
+    }
+    std::stable_sort(features.begin(),features.end(),
+                     [](const WriteFeature &a,const WriteFeature &b) { return a.order < b.order; });
+
+    // Fill in the columns
+    std::vector<uint8_t> featTypes;
+    std::vector<uint32_t> featParts(1,0),featTris(1,0),featAttrs(1,0),partPoints(1,0);
+    Point2fVector points;
+    std::vector<float> heights;
+    std::vector<VectorTriangles::Triangle> tris;
+    std::vector<VFS::Attr> attrs;
+    std::vector<float> indexBoxes;
+    featTypes.reserve(features.size());
+    indexBoxes.reserve(4*features.size());
+    int numDropped = 0;
+
+    const auto addPart = [&](const Point2f *pts,size_t numPts)
+    {
+        points.insert(points.end(),pts,pts+numPts);
+        if (hasMesh)
+            heights.resize(points.size(),0.0);
+        partPoints.push_back((uint32_t)points.size());
+    };
+
+    for (const auto &feat : features)
+    {
+        featTypes.push_back(feat.type);
+        switch (feat.type)
+        {
+            case VFS::FeaturePoints:
+            {
+                const auto &pts = static_cast<VectorPoints *>(feat.shape.get())->pts;
+                addPart(pts.data(),pts.size());
+            }
+                break;
+            case VFS::FeatureLinear:
+            {
+                const auto &pts = static_cast<VectorLinear *>(feat.shape.get())->pts;
+                addPart(pts.data(),pts.size());
+            }
+                break;
+            case VFS::FeatureAreal:
+                for (const auto &loop : static_cast<VectorAreal *>(feat.shape.get())->loops)
+                    addPart(loop.data(),loop.size());
+                break;
+            case VFS::FeatureTriangles:
+            {
+                const auto mesh = static_cast<VectorTriangles *>(feat.shape.get());
+                const size_t firstPt = points.size();
+                for (const auto &pt : mesh->pts)
+                {
+                    points.emplace_back(pt.x(),pt.y());
+                    heights.push_back(pt.z());
+                }
+                partPoints.push_back((uint32_t)points.size());
+                for (const auto &tri : mesh->tris)
+                    for (int which : tri.pts)
+                        if (which < 0 || (size_t)which >= points.size() - firstPt)
+                        {
+                            wkLogLevel(Warn,"VectorFeatureStoreWrite: Triangle refers to a missing point");
+                            return false;
+                        }
+                tris.insert(tris.end(),mesh->tris.begin(),mesh->tris.end());
+            }
+                break;
+            default:
+                break;
+        }
+        featParts.push_back((uint32_t)partPoints.size()-1);
+        featTris.push_back((uint32_t)tris.size());
+
+        if (const auto &dict = feat.shape->getAttrDictRef())
+        {
+            for (const auto &key : dict->getKeys())
+            {
+                VFS::Attr attr;
+                memset(&attr,0,sizeof(attr));
+                attr.key = strings.add(key);
+                attr.type = dict->getType(key);
+                switch (attr.type)
+                {
+                    case DictTypeInt:
+                        attr.val.iVal = dict->getInt(key);
+                        break;
+                    case DictTypeInt64:
+                        attr.val.iVal = dict->getInt64(key);
+                        break;
+                    case DictTypeIdentity:
+                        attr.val.iVal = (int64_t)dict->getIdentity(key);
+                        break;
+                    case DictTypeDouble:
+                        attr.val.dVal = dict->getDouble(key);
+                        break;
+                    case DictTypeString:
+                        attr.val.strVal = strings.add(dict->getString(key));
+                        break;
+                    default:
+                        numDropped++;
+                        continue;
+                }
+                attrs.push_back(attr);
+            }
+        }
+        featAttrs.push_back((uint32_t)attrs.size());
+
+        if (feat.mbr.valid())
+            indexBoxes.insert(indexBoxes.end(),{feat.mbr.ll().x(),feat.mbr.ll().y(),feat.mbr.ur().x(),feat.mbr.ur().y()});
+        else
+            indexBoxes.insert(indexBoxes.end(),{FLT_MAX,FLT_MAX,-FLT_MAX,-FLT_MAX});
+    }
+    if (numDropped > 0)
+        wkLogLevel(Warn,"VectorFeatureStoreWrite: Dropped %d attributes that weren't numbers or strings",numDropped);
+
+    if (points.size() > UINT32_MAX || attrs.size() > UINT32_MAX || tris.size() > UINT32_MAX)
+    {
+        wkLogLevel(Warn,"VectorFeatureStoreWrite: Too much data for one file");
+        return false;
+    }
+
+    // Build the index levels on top of the features, each box covering nodeSize below it
+    std::vector<uint32_t> levelStarts;
+    IndexLevelStarts((uint32_t)features.size(),IndexNodeSize,levelStarts);
+    indexBoxes.resize(4*levelStarts.back());
+    for (size_t level=1;level+1<levelStarts.size();level++)
+    {
+        const uint32_t childStart = levelStarts[level-1], childCount = levelStarts[level] - childStart;
+        for (uint32_t which=0;which<levelStarts[level+1]-levelStarts[level];which++)
+        {
+            float *box = &indexBoxes[4*(levelStarts[level]+which)];
+            box[0] = box[1] = FLT_MAX;
+            box[2] = box[3] = -FLT_MAX;
+            const uint32_t start = which * IndexNodeSize, end = std::min(start + IndexNodeSize,childCount);
+            for (uint32_t child=start;child<end;child++)
+            {
+                const float *childBox = &indexBoxes[4*(childStart+child)];
+                box[0] = std::min(box[0],childBox[0]);
+                box[1] = std::min(box[1],childBox[1]);
+                box[2] = std::max(box[2],childBox[2]);
+                box[3] = std::max(box[3],childBox[3]);
+            }
+        }
+    }
+
+    // Strings, names first
+    std::vector<uint32_t> stringOffsets(1,0);
+    std::string stringData;
+    for (const auto &str : strings.strings)
+    {
+        stringData += str;
+        stringOffsets.push_back((uint32_t)stringData.size());
+    }
+
+    VFS::Header header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,FileMagic,sizeof(FileMagic));
+    header.version = VFS::FileVersion;
+    header.byteOrder = ByteOrderMark;
+    header.numFeatures = (uint32_t)features.size();
+    header.numParts = (uint32_t)partPoints.size()-1;
+    header.numPoints = (uint32_t)points.size();
+    header.numHeights = (uint32_t)heights.size();
+    header.numTris = (uint32_t)tris.size();
+    header.numAttrs = (uint32_t)attrs.size();
+    header.numStrings = (uint32_t)strings.strings.size();
+    header.numKeys = numKeys;
+    header.stringBytes = (uint32_t)stringData.size();
+    header.nodeSize = IndexNodeSize;
+    header.numIndexLevels = (uint32_t)levelStarts.size()-1;
+    header.numIndexBoxes = levelStarts.back();
+    if (totalMbr.valid())
+    {
+        header.bounds[0] = totalMbr.ll().x();  header.bounds[1] = totalMbr.ll().y();
+        header.bounds[2] = totalMbr.ur().x();  header.bounds[3] = totalMbr.ur().y();
+    }
+
+    const void *sectData[VFS::NumSections] = {
+        featTypes.data(), featParts.data(), featTris.data(), featAttrs.data(), partPoints.data(),
+        points.data(), heights.data(), tris.data(), attrs.data(), stringOffsets.data(),
+        stringData.data(), indexBoxes.data() };
+    uint64_t sizes[VFS::NumSections],aligns[VFS::NumSections];
+    SectionSizes(header,sizes,aligns);
+
+    // Everything starts on an 8 byte boundary
+    uint64_t pos = sizeof(header);
+    for (int ii=0;ii<VFS::NumSections;ii++)
+    {
+        pos = (pos + 7) & ~(uint64_t)7;
+        header.sections[ii] = pos;
+        pos += sizes[ii];
+    }
+    if (pos > UINT_MAX)
+    {
+        wkLogLevel(Warn,"VectorFeatureStoreWrite: Too much data for one file");
+        return false;
+    }
+
+    FILE *fp = fopen(fileName.c_str(),"wb");
+    if (!fp)
+        return false;
+
+    static const char padding[8] = {0};
+    bool ok = fwrite(&header,sizeof(header),1,fp) == 1;
+    pos = sizeof(header);
+    for (int ii=0;ii<VFS::NumSections && ok;ii++)
+    {
+        const uint64_t pad = header.sections[ii] - pos;
+        if (pad > 0)
+            ok = fwrite(padding,pad,1,fp) == 1;
+        if (ok && sizes[ii] > 0)
+            ok = fwrite(sectData[ii],sizes[ii],1,fp) == 1;
+        pos = header.sections[ii] + sizes[ii];
+    }
+
+    if (fclose(fp) != 0)
+        ok = false;
+    if (!ok)
+        wkLogLevel(Warn,"VectorFeatureStoreWrite: Failed to write %s",fileName.c_str());
+    return ok;
+}
+
+VectorFeatureStoreReader::VectorFeatureStoreReader(VectorFeatureStoreRef store) :
+    store(std::move(store)), next(0)
+{
+}
+
+VectorShapeRef VectorFeatureStoreReader::getNextObject(const StringSet *filter)
+{
+    if (!store || next >= store->getNumFeatures())
+        return nullptr;
+    return store->makeShape(next++,filter);
+}
+
+unsigned int VectorFeatureStoreReader::getNumObjects()
+{
+    return store ? store->getNumFeatures() : 0;
+}
+
+VectorShapeRef VectorFeatureStoreReader::getObjectByIndex(unsigned int vecIndex,const StringSet *filter)
+{
+    if (!store || vecIndex >= store->getNumFeatures())
+        return nullptr;
+    return store->makeShape(vecIndex,filter);
+}
+
+}
@@ -101,6 +101,44 @@ void VectorSceneRep::clear(ChangeSet &changes)
     drawIDs.clear();
 }
 
+/* Converts a run of geographic points to display coordinates and normals.
+   This goes through the coordinate system a batch at a time rather than a point at a time.
+ */
+class VectorPointConverter
+{
+public:
+    template <typename TPoints>
+    void convert(const TPoints &pts,const Point2d &geoCenter,bool localCoords,
+                 const CoordSystem *coordSys,const CoordSystemDisplayAdapter *coordAdapter)
+    {
+        const size_t numPts = pts.size();
+        geoPts.resize(numPts);
+        localPts.resize(numPts);
+        dispPts.resize(numPts);
+        normPts.resize(numPts);
+        for (size_t ii=0;ii<numPts;ii++)
+        {
+            geoPts[ii] = Point2d(pts[ii].x()+geoCenter.x(),pts[ii].y()+geoCenter.y());
+        }
+        if (localCoords)
+        {
+            for (size_t ii=0;ii<numPts;ii++)
+            {
+                localPts[ii] = Pad(geoPts[ii]);
+            }
+        }
+        else
+        {
+            coordSys->geographicToLocalBatch(geoPts.data(),localPts.data(),numPts);
+        }
+        coordAdapter->normalForLocalBatch(localPts.data(),normPts.data(),numPts);
+        coordAdapter->localToDisplayBatch(localPts.data(),dispPts.data(),numPts);
+    }
+
+    Point2dVector geoPts;
+    Point3dVector localPts,dispPts,normPts;
+};
+
 /* Drawable Builder
  Used to construct drawables with multiple shapes in them.
  Eventually, we'll move this out to be a more generic object.
@@ -169,17 +207,16 @@ public:
             drawable->setOpacityExpression(vecInfo->opacityExp);
         }
         drawMbr.addPoints(pts);
-        
+
+        // Convert to real world coordinates all at once
+        conv.convert(pts,geoCenter,localCoords,coordSys,coordAdapter);
+
         Point3f prevPt,prevNorm,firstPt,firstNorm;
         for (unsigned int jj=0;jj<pts.size();jj++)
         {
-            // Convert to real world coordinates and offset from the globe
-            const Point2f &geoPt = pts[jj];
-            const Point2d geoCoordD(geoPt.x()+geoCenter.x(),geoPt.y()+geoCenter.y());
-            const Point3d localPt = localCoords ? Pad(geoCoordD) : coordSys->geographicToLocal(geoCoordD);
-            const Point3d norm3d = coordAdapter->normalForLocal(localPt);
-            const Point3f norm = norm3d.cast<float>();
-            const Point3d pt3d = coordAdapter->localToDisplay(localPt) - center;
+            // Offset from the globe
+            const Point3f norm = conv.normPts[jj].cast<float>();
+            const Point3d pt3d = conv.dispPts[jj] - center;
             const Point3f pt = pt3d.cast<float>();
             
             // Add to drawable
@@ -272,6 +309,8 @@ protected:
     Point2d geoCenter;
     bool centerValid;
     const GeometryType primType;
+    // Scratch space for converting coordinates
+    VectorPointConverter conv;
 };
 
 /* Drawable Builder (Triangle version)
@@ -410,6 +449,9 @@ public:
             }
         }
         
+        // Convert all the vertices to real world coordinates at once
+        conv.convert(mesh.pts,geoCenter,localCoords,coordSys,coordAdapter);
+
         for (size_t ir=0;ir<mesh.tris.size();ir++)
         {
             constexpr int triCount = 1;
@@ -419,6 +461,7 @@ public:
             {
                 continue;
             }
+            const int *triPts = mesh.tris[ir].pts;
 
             // Decide if we'll appending to an existing drawable or create a new one
             if (!drawable ||
@@ -470,18 +513,15 @@ public:
             if (doTexCoords)
             {
                 TexCoord minCoord(MAXFLOAT,MAXFLOAT);
-                int i = 0;
-                for (const auto &geoPt : pts)
+                for (int i=0;i<ptCount;i++)
                 {
-                    const Point2d geoCoordD = geoPt.cast<double>() + geoCenter;
-
-                    auto &texCoord = texCoords[i++];
+                    const Point2f &geoPt = pts[i];
+                    auto &texCoord = texCoords[i];
                     switch (vecInfo->texProj)
                     {
                         case TextureProjectionTanPlane:
                         {
-                            const Point3d locPt = localCoords ? Pad(geoCoordD) : coordSys->geographicToLocal(geoCoordD);
-                            const Point3d displayPt = coordAdapter->localToDisplay(locPt) - center;
+                            const Point3d displayPt = conv.dispPts[triPts[i]] - center;
                             const Point3d dir = displayPt - planeOrg;
                             const Point3d comp(dir.dot(planeX),dir.dot(planeY),dir.dot(planeUp));
                             texCoord = Slice(comp).cast<float>().cwiseProduct(vecInfo->texScale);
@@ -514,13 +554,10 @@ public:
             // Add the points
             for (unsigned int jj=0;jj<ptCount;jj++)
             {
-                // Convert to real world coordinates and offset from the globe
-                const Point2f &geoPt = pts[jj];
-                const Point2d geoCoordD = geoPt.cast<double>() + geoCenter;
-                const Point3d localPt = localCoords ? Pad(geoCoordD) : coordSys->geographicToLocal(geoCoordD);
-                const Point3d norm3d = coordAdapter->normalForLocal(localPt);
+                // Offset from the globe
+                const Point3d &norm3d = conv.normPts[triPts[jj]];
                 const Point3f norm(norm3d.x(),norm3d.y(),norm3d.z());
-                const Point3d pt3d = coordAdapter->localToDisplay(localPt) - center;
+                const Point3d pt3d = conv.dispPts[triPts[jj]] - center;
                 const Point3f pt = pt3d.cast<float>();
                 
                 drawable->addPoint(pt);
@@ -594,6 +631,8 @@ protected:
     bool centerValid;
     BasicDrawableBuilderRef drawable;
     const VectorInfo *vecInfo;
+    // Scratch space for converting coordinates
+    VectorPointConverter conv;
 };
 
 VectorManager::~VectorManager()
@@ -100,13 +100,13 @@ bool VectorObject::fromShapeFile(const std::string &fileName)
     if (!shapeReader.isValid())
         return false;
     
-    const unsigned numObj = shapeReader.getNumObjects();
-    shapes.reserve(shapes.size() + numObj);
-    for (unsigned int ii=0;ii<numObj;ii++) {
-        shapes.insert(shapeReader.getObjectByIndex(ii, nullptr));
+    std::vector<unsigned int> records(shapeReader.getNumObjects());
+    for (unsigned int ii=0;ii<records.size();ii++) {
+        records[ii] = ii;
     }
-    
-    return true;
+    shapeReader.setPool(TaskPool::sharedPool());
+
+    return shapeReader.readObjects(records, nullptr, shapes);
 }
 
 MutableDictionaryRef VectorObject::getAttributes() const
@@ -960,42 +960,56 @@ std::string VectorObject::log() const
     
 void VectorObject::reproject(CoordSystem *inSystem,double scale,CoordSystem *outSystem)
 {
+    // Each run of points goes through the coordinate systems in one batch
+    Point3dVector convPts;
+    const auto convert2f = [&](Point2fVector &pts,double outScale)
+    {
+        convPts.resize(pts.size());
+        for (size_t ii=0;ii<pts.size();ii++)
+        {
+            convPts[ii] = Point3d(pts[ii].x()*scale,pts[ii].y()*scale,0.0);
+        }
+        CoordSystemConvert3d(inSystem, outSystem, convPts.data(), convPts.data(), convPts.size());
+        for (size_t ii=0;ii<pts.size();ii++)
+        {
+            pts[ii] = Point2f(convPts[ii].x()*outScale,convPts[ii].y()*outScale);
+        }
+    };
+
     for (const auto &shapeRef : shapes)
     {
         const auto shape = shapeRef.get();
         if (const auto points = dynamic_cast<VectorPoints*>(shape))
         {
-            for (Point2f &pt : points->pts)
-            {
-                const Point3f outPt = CoordSystemConvert(inSystem, outSystem, Point3f(pt.x()*scale,pt.y()*scale,0.0));
-                pt.x() = outPt.x();  pt.y() = outPt.y();
-            }
+            convert2f(points->pts, 1.0);
             points->calcGeoMbr();
         } else if (const auto lin = dynamic_cast<VectorLinear*>(shape)) {
-            for (Point2f &pt : lin->pts)
-            {
-                const Point3f outPt = CoordSystemConvert(inSystem, outSystem, Point3f(pt.x()*scale,pt.y()*scale,0.0));
-                pt.x() = outPt.x();  pt.y() = outPt.y();
-            }
+            convert2f(lin->pts, 1.0);
             lin->calcGeoMbr();
         } else if (const auto lin3d = dynamic_cast<VectorLinear3d*>(shape)) {
             for (Point3d &pt : lin3d->pts)
             {
-                const Point3d outPt = CoordSystemConvert3d(inSystem, outSystem, pt * scale);
-                pt = outPt;
+                pt *= scale;
             }
+            CoordSystemConvert3d(inSystem, outSystem, lin3d->pts.data(), lin3d->pts.data(), lin3d->pts.size());
             lin3d->calcGeoMbr();
         } else if (const auto ar = dynamic_cast<VectorAreal*>(shape)) {
             for (auto &loop : ar->loops)
-                for (Point2f &pt : loop) {
-                    const Point3f outPt = CoordSystemConvert(inSystem, outSystem, Point3f(pt.x()*scale,pt.y()*scale,0.0));
-                    pt.x() = outPt.x() * 180 / M_PI;  pt.y() = outPt.y() * 180 / M_PI;
-                }
+            {
+                convert2f(loop, 180 / M_PI);
+            }
             ar->calcGeoMbr();
         } else if (const auto tri = dynamic_cast<VectorTriangles*>(shape)) {
-            for (Point3f &pt : tri->pts)
+            convPts.resize(tri->pts.size());
+            for (size_t ii=0;ii<tri->pts.size();ii++)
+            {
+                const Point3f &pt = tri->pts[ii];
+                convPts[ii] = Point3d(pt.x()*scale,pt.y()*scale,pt.z());
+            }
+            CoordSystemConvert3d(inSystem, outSystem, convPts.data(), convPts.data(), convPts.size());
+            for (size_t ii=0;ii<tri->pts.size();ii++)
             {
-                pt = CoordSystemConvert(inSystem, outSystem, Point3f(pt.x()*scale,pt.y()*scale,pt.z()));
+                tri->pts[ii] = convPts[ii].cast<float>();
             }
             tri->calcGeoMbr();
         }
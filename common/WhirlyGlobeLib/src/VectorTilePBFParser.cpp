@@ -38,6 +38,25 @@ namespace {
     const std::string layerNameKey("layer_name");       //NOLINT
     const std::string geometryTypeKey("geometry_type"); //NOLINT
     const std::string layerOrderKey("layer_order");     //NOLINT
+
+    // The same keys as IDs, for the lookups that don't use strings
+    struct SyntheticKeyIDs
+    {
+        SyntheticKeyIDs() :
+            layerName(StringIndexer::getStringID(layerNameKey)),
+            geometryType(StringIndexer::getStringID(geometryTypeKey)),
+            layerOrder(StringIndexer::getStringID(layerOrderKey))
+        {
+        }
+        const StringIdentity layerName;
+        const StringIdentity geometryType;
+        const StringIdentity layerOrder;
+    };
+    const SyntheticKeyIDs &syntheticKeyIDs()
+    {
+        static const SyntheticKeyIDs ids;
+        return ids;
+    }
 }
 
 const vector_tile_Tile_Layer VectorTilePBFParser::_defaultLayer = {
@@ -202,6 +221,9 @@ bool VectorTilePBFParser::layerDecode(pb_istream_t *stream, const pb_field_iter_
         return true;
     }
 
+    // In lazy mode the features all share the layer's tables
+    const auto layerAttrs = _lazyAttributes ? makeLayerAttributes(layerName) : VectorTileLayerAttributesRef();
+
     size_t prevTagIndex = 0;
     size_t prevGeomIndex = 0;
     for (auto const &feature : _features)
@@ -212,12 +234,23 @@ bool VectorTilePBFParser::layerDecode(pb_istream_t *stream, const pb_field_iter_
             return false;
         }
 
-        auto attributes = std::make_shared<MutableDictionaryC>();
-        attributes->setString(layerNameKey, layerName);
-        attributes->setInt(geometryTypeKey, (int)feature.geomType);
-        attributes->setInt(layerOrderKey, (int)_layerCount);
+        MutableDictionaryRef attributes;
+        bool tagsOk;
+        if (layerAttrs)
+        {
+            tagsOk = processTags(nullptr, prevTagIndex, prevGeomIndex, feature);
+            attributes = std::make_shared<VectorTileFeatureDictionary>(layerAttrs, prevTagIndex, feature.tagIndex, (int)feature.geomType);
+        }
+        else
+        {
+            auto dict = std::make_shared<MutableDictionaryC>();
+            dict->setString(layerNameKey, layerName);
+            dict->setInt(geometryTypeKey, (int)feature.geomType);
+            dict->setInt(layerOrderKey, (int)_layerCount);
 
-        const bool tagsOk = processTags(attributes, prevTagIndex, prevGeomIndex, feature);
+            tagsOk = processTags(dict.get(), prevTagIndex, prevGeomIndex, feature);
+            attributes = std::move(dict);
+        }
         //const auto curTagIndex = prevTagIndex;
         const auto curGeomIndex = prevGeomIndex;
         const auto curGeomCount = feature.geomIndex - prevGeomIndex;
@@ -231,7 +264,7 @@ bool VectorTilePBFParser::layerDecode(pb_istream_t *stream, const pb_field_iter_
         }
 
         SimpleIDUSet styleIDs(featureStyleHeuristic());
-        if (!checkStyles(styleIDs, attributes, layerName))
+        if (!checkStyles(styleIDs, *attributes, layerName))
         {
             // Skip this feature
             _skippedFeatureCount += 1;
@@ -338,7 +371,8 @@ bool VectorTilePBFParser::featureDecode(pb_istream_t *stream, const pb_field_ite
     return true;
 }
 
-bool VectorTilePBFParser::processTags(const MutableDictionaryCRef &attributes, size_t tagIdx, size_t geomIdx, const Feature &feature)
+// Copy the tags into the dictionary, or just check them if it's null
+bool VectorTilePBFParser::processTags(MutableDictionaryC *attributes, size_t tagIdx, size_t geomIdx, const Feature &feature)
 {
     const auto tagCount = feature.tagIndex - tagIdx;
     if (tagCount % 2 != 0)
@@ -362,10 +396,18 @@ bool VectorTilePBFParser::processTags(const MutableDictionaryCRef &attributes, s
             continue;
         }
 
+        const auto &value = _layerValues[valueIndex];
+        if (!attributes) {
+            if (value.type == SmallValue::SmallValNone) {
+                _unknownValueTypes += 1;
+                wkLogLevel(Warn, "VectorTilePBFParser: Invalid Value Type %d", value.type);
+            }
+            continue;
+        }
+
         // TODO: We don't really need transient string allocations here
         const auto skey = std::string(key);
 
-        const auto &value = _layerValues[valueIndex];
         switch (value.type) {
             case SmallValue::SmallValString: attributes->setString(skey, std::string(value.stringValue)); break;
             case SmallValue::SmallValFloat:  attributes->setDouble(skey, value.floatValue); break;
@@ -385,7 +427,7 @@ bool VectorTilePBFParser::processTags(const MutableDictionaryCRef &attributes, s
     return true;
 }
 
-bool VectorTilePBFParser::checkStyles(SimpleIDUSet& styleIDs, const MutableDictionaryCRef &attributes, const std::string &layerName)
+bool VectorTilePBFParser::checkStyles(SimpleIDUSet& styleIDs, const Dictionary &attributes, const std::string &layerName)
 {
     // Ask for the styles that correspond to this feature
     // If there are none, we can skip this.
@@ -393,7 +435,7 @@ bool VectorTilePBFParser::checkStyles(SimpleIDUSet& styleIDs, const MutableDicti
     // Do a quick inclusion check
     if (!_uuidName.empty())
     {
-        std::string uuidVal = attributes->getString(_uuidName); // TODO: extra string copy
+        std::string uuidVal = attributes.getString(_uuidName); // TODO: extra string copy
         if (_uuidValues.find(uuidVal) == _uuidValues.end())
         {
             // Skip this feature
@@ -402,7 +444,7 @@ bool VectorTilePBFParser::checkStyles(SimpleIDUSet& styleIDs, const MutableDicti
     }
     
     // TODO: populate a reused vector?
-    const auto styles = _styleDelegate->stylesForFeature(_styleInst, *attributes, _tileData->ident, layerName);
+    const auto styles = _styleDelegate->stylesForFeature(_styleInst, attributes, _tileData->ident, layerName);
     for (const auto &style : styles)
     {
         styleIDs.insert(style->getUuid(_styleInst));
@@ -411,6 +453,48 @@ bool VectorTilePBFParser::checkStyles(SimpleIDUSet& styleIDs, const MutableDicti
     return (!styleIDs.empty() || _parseAll);
 }
 
+VectorTileLayerAttributesRef VectorTilePBFParser::makeLayerAttributes(const std::string &layerName) const
+{
+    auto attrs = std::make_shared<VectorTileLayerAttributes>();
+    attrs->layerName = layerName;
+    attrs->layerOrder = (int)_layerCount;
+    attrs->tags = _featureTags;
+
+    // Take the limit first, anything added after that might not be in keyIDs
+    attrs->keyIDLimit = StringIndexer::getNumStrings();
+    attrs->keys.reserve(_layerKeys.size());
+    attrs->keyIDs.reserve(_layerKeys.size());
+    for (const auto &key : _layerKeys)
+    {
+        attrs->keys.emplace_back(key);
+        StringIdentity keyID = VectorTileLayerAttributes::NoKeyID;
+        StringIndexer::findStringID(attrs->keys.back(),keyID);
+        attrs->keyIDs.push_back(keyID);
+    }
+
+    // Same conversions processTags does
+    attrs->values.resize(_layerValues.size());
+    for (size_t ii = 0; ii < _layerValues.size(); ii++)
+    {
+        const auto &value = _layerValues[ii];
+        auto &attrVal = attrs->values[ii];
+        switch (value.type) {
+            case SmallValue::SmallValString: attrVal.type = DictTypeString; attrVal.stringVal = std::string(value.stringValue); break;
+            case SmallValue::SmallValFloat:  attrVal.type = DictTypeDouble; attrVal.doubleVal = value.floatValue; break;
+            case SmallValue::SmallValDouble: attrVal.type = DictTypeDouble; attrVal.doubleVal = value.doubleValue; break;
+            case SmallValue::SmallValInt:    attrVal.type = DictTypeInt;    attrVal.intVal = (int)value.intValue; break;
+            case SmallValue::SmallValUInt:   attrVal.type = DictTypeInt;    attrVal.intVal = (int)value.uintValue; break;
+            case SmallValue::SmallValSInt:   attrVal.type = DictTypeInt;    attrVal.intVal = (int)value.sintValue; break;
+            case SmallValue::SmallValBool:   attrVal.type = DictTypeInt;    attrVal.intVal = (int)value.boolValue; break;
+            default:
+            case SmallValue::SmallValNone:
+                break;
+        }
+    }
+
+    return attrs;
+}
+
 void VectorTilePBFParser::parseLineString(const uint32_t *geometry, size_t geomCount, ShapeSet& shapes) const
 {
     double x = 0;
@@ -725,5 +809,385 @@ bool VectorTilePBFParser::intVecDecode(pb_istream_t *stream, const pb_field_iter
     return true;
 }
 
-}   // namespace WhirlyKit
+void VectorTileLayerAttributes::fillDictionary(MutableDictionaryC &dict, uint32_t tagStart, uint32_t tagEnd, int geomType) const
+{
+    dict.setString(layerNameKey, layerName);
+    dict.setInt(geometryTypeKey, geomType);
+    dict.setInt(layerOrderKey, layerOrder);
+
+    for (uint32_t m = tagStart; m + 1 < tagEnd; m += 2)
+    {
+        const auto keyIndex = tags[m];
+        const auto valueIndex = tags[m + 1];
+        if (keyIndex >= keys.size() || valueIndex >= values.size() || keys[keyIndex].empty())
+        {
+            continue;
+        }
+
+        const auto &key = keys[keyIndex];
+        const auto &value = values[valueIndex];
+        switch (value.type) {
+            case DictTypeString: dict.setString(key, value.stringVal); break;
+            case DictTypeDouble: dict.setDouble(key, value.doubleVal); break;
+            case DictTypeInt:    dict.setInt(key, value.intVal); break;
+            default: break;
+        }
+    }
+}
+
+VectorTileFeatureDictionary::VectorTileFeatureDictionary(VectorTileLayerAttributesRef layer, uint32_t tagStart,
+                                                         uint32_t tagEnd, int geomType)
+    : layer(std::move(layer))
+    , tagStart(tagStart)
+    , tagEnd(tagEnd)
+    , geomType(geomType)
+{
+}
+
+// Shared by the lookups by name and by ID.
+// which picks out one of the keys we tack on (0 for none), keyMatch checks the layer's keys.
+template <typename KeyMatch>
+static bool findLayerValue(const VectorTileLayerAttributes &layer, uint32_t tagStart, uint32_t tagEnd, int geomType,
+                           int which, const KeyMatch &keyMatch, VectorTileFeatureDictionary::ValueRef &val)
+{
+    // Start with the ones we tack on to every feature, the tags go in after them
+    bool found = false;
+    switch (which)
+    {
+        case 1:
+            val.type = DictTypeString;
+            val.stringVal = &layer.layerName;
+            found = true;
+            break;
+        case 2:
+        case 3:
+            val.type = DictTypeInt;
+            val.intVal = (which == 2) ? geomType : layer.layerOrder;
+            found = true;
+            break;
+        default:
+            break;
+    }
+
+    // Keep going on a match, the last one wins like it would in a regular dictionary.
+    // That also drops a key that shows up again with a different type, unless it's a string.
+    const auto &tags = layer.tags;
+    for (uint32_t m = tagStart; m + 1 < tagEnd; m += 2)
+    {
+        const auto keyIndex = tags[m];
+        const auto valueIndex = tags[m + 1];
+        if (keyIndex >= layer.keys.size() || valueIndex >= layer.values.size() || !keyMatch(keyIndex))
+        {
+            continue;
+        }
+
+        const auto &value = layer.values[valueIndex];
+        if (found && value.type != DictTypeNone && value.type != DictTypeString && value.type != val.type)
+        {
+            found = false;
+        }
+        else if (value.type != DictTypeNone)
+        {
+            val.type = value.type;
+            val.intVal = value.intVal;
+            val.doubleVal = value.doubleVal;
+            val.stringVal = &value.stringVal;
+            found = true;
+        }
+    }
+
+    return found;
+}
+
+bool VectorTileFeatureDictionary::findValue(const std::string &name, ValueRef &val) const
+{
+    const int which = (name == layerNameKey) ? 1 : (name == geometryTypeKey) ? 2 : (name == layerOrderKey) ? 3 : 0;
+    const auto &keys = layer->keys;
+    return findLayerValue(*layer, tagStart, tagEnd, geomType, which,
+                          [&keys,&name](uint32_t keyIndex) { return keys[keyIndex] == name; }, val);
+}
+
+bool VectorTileFeatureDictionary::findValueByID(StringIdentity keyID, ValueRef &val) const
+{
+    // The key was new to the indexer after this layer was parsed
+    if (keyID >= layer->keyIDLimit)
+    {
+        return findValue(StringIndexer::getString(keyID), val);
+    }
+
+    const auto &ids = syntheticKeyIDs();
+    const int which = (keyID == ids.layerName) ? 1 : (keyID == ids.geometryType) ? 2 : (keyID == ids.layerOrder) ? 3 : 0;
+    const auto &keyIDs = layer->keyIDs;
+    return findLayerValue(*layer, tagStart, tagEnd, geomType, which,
+                          [&keyIDs,keyID](uint32_t keyIndex) { return keyIndex < keyIDs.size() && keyIDs[keyIndex] == keyID; }, val);
+}
+
+MutableDictionaryC &VectorTileFeatureDictionary::materialize()
+{
+    if (!dict)
+    {
+        dict = std::make_shared<MutableDictionaryC>();
+        layer->fillDictionary(*dict, tagStart, tagEnd, geomType);
+    }
+    return *dict;
+}
+
+int VectorTileFeatureDictionary::count() const
+{
+    return dict ? dict->count() : (int)getKeys().size();
+}
+
+bool VectorTileFeatureDictionary::hasField(const std::string &name) const
+{
+    if (dict)
+        return dict->hasField(name);
+    ValueRef val;
+    return findValue(name, val);
+}
+
+DictionaryType VectorTileFeatureDictionary::getType(const std::string &name) const
+{
+    if (dict)
+        return dict->getType(name);
+    ValueRef val;
+    return findValue(name, val) ? val.type : DictTypeNone;
+}
+
+int VectorTileFeatureDictionary::getInt(const std::string &name, int defVal) const
+{
+    if (dict)
+        return dict->getInt(name, defVal);
+    ValueRef val;
+    if (!findValue(name, val))
+        return defVal;
+
+    switch (val.type) {
+        case DictTypeInt:    return val.intVal;
+        case DictTypeDouble: return (int)val.doubleVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to int", val.type);
+            return defVal;
+    }
+}
+
+int64_t VectorTileFeatureDictionary::getInt64(const std::string &name, int64_t defVal) const
+{
+    if (dict)
+        return dict->getInt64(name, defVal);
+    ValueRef val;
+    if (!findValue(name, val))
+        return defVal;
+
+    switch (val.type) {
+        case DictTypeInt:    return val.intVal;
+        case DictTypeDouble: return (int64_t)val.doubleVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to int64", val.type);
+            return defVal;
+    }
+}
+
+SimpleIdentity VectorTileFeatureDictionary::getIdentity(const std::string &name) const
+{
+    if (dict)
+        return dict->getIdentity(name);
+    ValueRef val;
+    if (!findValue(name, val))
+        return EmptyIdentity;
+
+    switch (val.type) {
+        case DictTypeInt:    return val.intVal;
+        case DictTypeDouble: return (SimpleIdentity)val.doubleVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to identity", val.type);
+            return EmptyIdentity;
+    }
+}
+
+bool VectorTileFeatureDictionary::getBool(const std::string &name, bool defVal) const
+{
+    if (dict)
+        return dict->getBool(name, defVal);
+    ValueRef val;
+    if (!findValue(name, val))
+        return defVal;
+
+    if (val.type == DictTypeInt)
+        return val.intVal != 0;
+    wkLogLevel(Warn, "Unsupported conversion from type %d to bool", val.type);
+    return defVal;
+}
+
+RGBAColor VectorTileFeatureDictionary::getColor(const std::string &name, const RGBAColor &defVal) const
+{
+    if (dict)
+        return dict->getColor(name, defVal);
+    ValueRef val;
+    if (!findValue(name, val))
+        return defVal;
+
+    switch (val.type) {
+        case DictTypeString:
+        {
+            // We're looking for #RRGGBBAA, #RRGGBB, #RGBA, or #RGB
+            const std::string &str = *val.stringVal;
+            if (str.length() < 4 || str[0] != '#')
+                return defVal;
+            return parseColor(&str.c_str()[1], defVal);
+        }
+        case DictTypeInt:
+            return ARGBtoRGBAColor(val.intVal);
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to color", val.type);
+            return defVal;
+    }
+}
+
+double VectorTileFeatureDictionary::getDouble(const std::string &name, double defVal) const
+{
+    if (dict)
+        return dict->getDouble(name, defVal);
+    ValueRef val;
+    if (!findValue(name, val))
+        return defVal;
+
+    switch (val.type) {
+        case DictTypeInt:    return val.intVal;
+        case DictTypeDouble: return val.doubleVal;
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to double", val.type);
+            return defVal;
+    }
+}
+
+std::string VectorTileFeatureDictionary::getString(const std::string &name) const
+{
+    return getString(name, std::string());
+}
+
+std::string VectorTileFeatureDictionary::getString(const std::string &name, const std::string &defVal) const
+{
+    if (dict)
+        return dict->getString(name, defVal);
+    ValueRef val;
+    if (!findValue(name, val))
+        return defVal;
+
+    switch (val.type) {
+        case DictTypeString: return *val.stringVal;
+        case DictTypeInt:    return std::to_string(val.intVal);
+        case DictTypeDouble: return std::to_string(val.doubleVal);
+        default:
+            wkLogLevel(Warn, "Unsupported conversion from type %d to string", val.type);
+            return defVal;
+    }
+}
+
+DictionaryRef VectorTileFeatureDictionary::getDict(const std::string &name) const
+{
+    // Vector tiles don't have nested dictionaries, but someone could have added one
+    return dict ? dict->getDict(name) : DictionaryRef();
+}
+
+DictionaryEntryRef VectorTileFeatureDictionary::getEntry(const std::string &name) const
+{
+    if (dict)
+        return dict->getEntry(name);
+    ValueRef val;
+    if (!findValue(name, val))
+        return DictionaryEntryRef();
+
+    switch (val.type) {
+        case DictTypeString: return std::make_shared<DictionaryEntryCString>(*val.stringVal);
+        case DictTypeInt:    return std::make_shared<DictionaryEntryCBasic>(val.intVal);
+        case DictTypeDouble: return std::make_shared<DictionaryEntryCBasic>(val.doubleVal);
+        default:             return DictionaryEntryRef();
+    }
+}
+
+std::vector<DictionaryEntryRef> VectorTileFeatureDictionary::getArray(const std::string &name) const
+{
+    return dict ? dict->getArray(name) : std::vector<DictionaryEntryRef>();
+}
 
+std::vector<std::string> VectorTileFeatureDictionary::getKeys() const
+{
+    if (dict)
+        return dict->getKeys();
+
+    std::vector<std::string> keys;
+    for (const auto &key : { layerNameKey, geometryTypeKey, layerOrderKey })
+    {
+        ValueRef val;
+        if (findValue(key, val))
+        {
+            keys.push_back(key);
+        }
+    }
+    for (uint32_t m = tagStart; m + 1 < tagEnd; m += 2)
+    {
+        const auto keyIndex = layer->tags[m];
+        const auto valueIndex = layer->tags[m + 1];
+        if (keyIndex >= layer->keys.size() || valueIndex >= layer->values.size() ||
+            layer->keys[keyIndex].empty() || layer->values[valueIndex].type == DictTypeNone)
+        {
+            continue;
+        }
+
+        ValueRef val;
+        const auto &key = layer->keys[keyIndex];
+        if (std::find(keys.begin(), keys.end(), key) == keys.end() && findValue(key, val))
+        {
+            keys.push_back(key);
+        }
+    }
+    return keys;
+}
+
+MutableDictionaryRef VectorTileFeatureDictionary::copy() const
+{
+    // Until it's modified, a copy can share the layer tables too
+    return dict ? dict->copy() : std::make_shared<VectorTileFeatureDictionary>(layer,tagStart,tagEnd,geomType);
+}
+
+void VectorTileFeatureDictionary::clear()
+{
+    dict = std::make_shared<MutableDictionaryC>();
+}
+
+void VectorTileFeatureDictionary::removeField(const std::string &name)
+{
+    materialize().removeField(name);
+}
+
+void VectorTileFeatureDictionary::setInt(const std::string &name, int val)
+{
+    materialize().setInt(name, val);
+}
+
+void VectorTileFeatureDictionary::setInt64(const std::string &name, int64_t val)
+{
+    materialize().setInt64(name, val);
+}
+
+void VectorTileFeatureDictionary::setIdentifiable(const std::string &name, SimpleIdentity val)
+{
+    materialize().setIdentifiable(name, val);
+}
+
+void VectorTileFeatureDictionary::setDouble(const std::string &name, double val)
+{
+    materialize().setDouble(name, val);
+}
+
+void VectorTileFeatureDictionary::setString(const std::string &name, const std::string &val)
+{
+    materialize().setString(name, val);
+}
+
+void VectorTileFeatureDictionary::addEntries(const Dictionary *other)
+{
+    materialize().addEntries(other);
+}
+
+}   // namespace WhirlyKit
@@ -25,8 +25,92 @@ using namespace Eigen;
 namespace WhirlyKit
 {
     
+int VertexAttributeTypeSize(BDAttributeDataType dataType)
+{
+    switch (dataType)
+    {
+        case BDFloat4Type:
+            return 4*4;
+        case BDFloat3Type:
+            return 4*3;
+        case BDFloat2Type:
+            return 4*2;
+        case BDChar4Type:
+            return sizeof(unsigned char)*4;
+        case BDFloatType:
+            return 4;
+        case BDIntType:
+            return 4;
+        case BDInt64Type:
+            return 8;
+        case BDDataTypeMax:
+            return 0;
+    }
+    return 0;
+}
+
+void *VertexAttributeArena::alloc(size_t bytes)
+{
+    bytes = (bytes + Alignment - 1) & ~(Alignment - 1);
+    if (bytes >= LargeAllocSize)
+    {
+        largeBlocks.emplace_back(std::unique_ptr<char[]>(new char[bytes]),bytes);
+        allocated += bytes;
+        return largeBlocks.back().first.get();
+    }
+
+    if (!blockStart || blockUsed + bytes > blockSize)
+    {
+        // Blocks get bigger as we go, so a big drawable doesn't need lots of them
+        blockSize = std::max(bytes,std::min(std::max(MinBlockSize,allocated),MaxBlockSize));
+        blocks.emplace_back(new char[blockSize]);
+        blockStart = blocks.back().get();
+        blockUsed = 0;
+        allocated += blockSize;
+    }
+    last = blockStart + blockUsed;
+    blockUsed += bytes;
+    return last;
+}
+
+void *VertexAttributeArena::realloc(void *ptr,size_t oldBytes,size_t newBytes)
+{
+    if (!ptr)
+    {
+        return alloc(newBytes);
+    }
+
+    // The most recent allocation can just take more of the block
+    if (ptr == last)
+    {
+        const size_t start = last - blockStart;
+        const size_t needed = (newBytes + Alignment - 1) & ~(Alignment - 1);
+        if (start + needed <= blockSize)
+        {
+            blockUsed = start + needed;
+            return ptr;
+        }
+    }
+
+    void *newPtr = alloc(newBytes);
+    memcpy(newPtr,ptr,oldBytes);
+
+    // Big ones can be handed back right away
+    for (auto it = largeBlocks.rbegin(); it != largeBlocks.rend(); ++it)
+    {
+        if (it->first.get() == ptr)
+        {
+            allocated -= it->second;
+            largeBlocks.erase(std::next(it).base());
+            break;
+        }
+    }
+
+    return newPtr;
+}
+
 VertexAttribute::VertexAttribute(BDAttributeDataType dataType,int slot,StringIdentity nameID)
-: dataType(dataType), nameID(nameID), data(NULL), slot(slot)
+: dataType(dataType), nameID(nameID), slot(slot)
 {
     defaultData.vec3[0] = 0.0;
     defaultData.vec3[1] = 0.0;
@@ -40,10 +124,20 @@ VertexAttribute::~VertexAttribute()
 }
 
 VertexAttribute::VertexAttribute(const VertexAttribute &that)
-: dataType(that.dataType), nameID(that.nameID), data(nullptr), defaultData(that.defaultData), slot(that.slot)
+: dataType(that.dataType), nameID(that.nameID), defaultData(that.defaultData), slot(that.slot)
 {
 }
 
+VertexAttribute::VertexAttribute(VertexAttribute &&that) noexcept
+: dataType(that.dataType), nameID(that.nameID), defaultData(that.defaultData), slot(that.slot),
+  bytes(that.bytes), count(that.count), capacity(that.capacity),
+  arena(std::move(that.arena)), heapBytes(std::move(that.heapBytes))
+{
+    that.bytes = nullptr;
+    that.count = 0;
+    that.capacity = 0;
+}
+
 VertexAttribute VertexAttribute::templateCopy() const
 {
     VertexAttribute newAttr(*this);
@@ -81,234 +175,48 @@ void VertexAttribute::setDefaultFloat(float val)
     defaultData.floatVal = val;
 }
 
-void VertexAttribute::addColor(const RGBAColor &color)
-{
-    if (dataType != BDChar4Type)
-        return;
-    
-    if (!data)
-        data = new std::vector<RGBAColor>();
-    std::vector<RGBAColor> *colors = (std::vector<RGBAColor> *)data;
-    (*colors).push_back(color);
-}
-
-void VertexAttribute::addVector2f(const Eigen::Vector2f &vec)
-{
-    if (dataType != BDFloat2Type)
-        return;
-    
-    if (!data)
-        data = new std::vector<Vector2f>();
-    std::vector<Vector2f> *vecs = (std::vector<Vector2f> *)data;
-    (*vecs).push_back(vec);
-}
-
-void VertexAttribute::addVector3f(const Eigen::Vector3f &vec)
+void VertexAttribute::grow(int minCapacity)
 {
-    if (dataType != BDFloat3Type)
-        return;
-    
-    if (!data)
-        data = new std::vector<Vector3f>();
-    std::vector<Vector3f> *vecs = (std::vector<Vector3f> *)data;
-    (*vecs).push_back(vec);
-}
-
-void VertexAttribute::addVector4f(const Eigen::Vector4f &vec)
-{
-    if (dataType != BDFloat4Type)
-        return;
-    
-    if (!data)
-        data = new std::vector<Vector4f>();
-    std::vector<Vector4f> *vecs = (std::vector<Vector4f> *)data;
-    (*vecs).push_back(vec);
+    setCapacity(std::max(minCapacity,std::max(capacity*2,16)));
 }
 
-void VertexAttribute::addFloat(float val)
+void VertexAttribute::setCapacity(int newCapacity)
 {
-    if (dataType != BDFloatType)
-        return;
-    
-    if (!data)
-        data = new std::vector<float>();
-    std::vector<float> *floats = (std::vector<float> *)data;
-    (*floats).push_back(val);
-}
-
-void VertexAttribute::addInt(int val)
-{
-    if (dataType != BDIntType)
-        return;
-    
-    if (!data)
-        data = new std::vector<int>();
-    std::vector<int> *ints = (std::vector<int> *)data;
-    (*ints).push_back(val);
-}
-
-void VertexAttribute::addInt64(int64_t val)
-{
-    if (dataType != BDInt64Type)
-        return;
-    
-    if (!data)
-        data = new std::vector<int64_t>();
-    std::vector<int64_t> *ints = (std::vector<int64_t> *)data;
-    (*ints).push_back(val);
+    const size_t elemSize = size();
+    if (arena)
+    {
+        bytes = (char *)arena->realloc(bytes,count*elemSize,newCapacity*elemSize);
+        heapBytes.reset();
+    }
+    else
+    {
+        std::unique_ptr<char[]> newBytes(new char[newCapacity*elemSize]);
+        if (count > 0)
+            memcpy(newBytes.get(),bytes,count*elemSize);
+        heapBytes = std::move(newBytes);
+        bytes = heapBytes.get();
+    }
+    capacity = newCapacity;
 }
 
 /// Reserve size in the data array
 void VertexAttribute::reserve(int size)
 {
-    switch (dataType)
-    {
-        case BDFloat4Type:
-        {
-            if (!data)
-                data = new std::vector<Vector4f>();
-            std::vector<Vector4f> *vecs = (std::vector<Vector4f> *)data;
-            vecs->reserve(size);
-        }
-            break;
-        case BDFloat3Type:
-        {
-            if (!data)
-                data = new std::vector<Vector3f>();
-            std::vector<Vector3f> *vecs = (std::vector<Vector3f> *)data;
-            vecs->reserve(size);
-        }
-            break;
-        case BDFloat2Type:
-        {
-            if (!data)
-                data = new std::vector<Vector2f>();
-            std::vector<Vector2f> *vecs = (std::vector<Vector2f> *)data;
-            vecs->reserve(size);
-        }
-            break;
-        case BDChar4Type:
-        {
-            if (!data)
-                data = new std::vector<RGBAColor>();
-            std::vector<RGBAColor> *colors = (std::vector<RGBAColor> *)data;
-            colors->reserve(size);
-        }
-            break;
-        case BDFloatType:
-        {
-            if (!data)
-                data = new std::vector<float>();
-            std::vector<float> *floats = (std::vector<float> *)data;
-            floats->reserve(size);
-        }
-            break;
-        case BDIntType:
-        {
-            if (!data)
-                data = new std::vector<int>();
-            std::vector<int> *ints = (std::vector<int> *)data;
-            ints->reserve(size);
-        }
-            break;
-        case BDInt64Type:
-        {
-            if (!data)
-                data = new std::vector<int64_t>();
-            std::vector<int64_t> *ints = (std::vector<int64_t> *)data;
-            ints->reserve(size);
-        }
-            break;
-        case BDDataTypeMax:
-            break;
-    }
+    // Reserve asks for exactly this much, so don't round up
+    if (dataType != BDDataTypeMax && size > capacity)
+        setCapacity(size);
 }
 
 /// Number of elements in our array
 int VertexAttribute::numElements() const
 {
-    if (!data)
-        return 0;
-    
-    switch (dataType)
-    {
-        case BDFloat4Type:
-        {
-            std::vector<Vector4f> *vecs = (std::vector<Vector4f> *)data;
-            return (int)vecs->size();
-        }
-            break;
-        case BDFloat3Type:
-        {
-            std::vector<Vector3f> *vecs = (std::vector<Vector3f> *)data;
-            return (int)vecs->size();
-        }
-            break;
-        case BDFloat2Type:
-        {
-            std::vector<Vector2f> *vecs = (std::vector<Vector2f> *)data;
-            return (int)vecs->size();
-        }
-            break;
-        case BDChar4Type:
-        {
-            std::vector<RGBAColor> *colors = (std::vector<RGBAColor> *)data;
-            return (int)colors->size();
-        }
-            break;
-        case BDFloatType:
-        {
-            std::vector<float> *floats = (std::vector<float> *)data;
-            return (int)floats->size();
-        }
-            break;
-        case BDIntType:
-        {
-            std::vector<int> *ints = (std::vector<int> *)data;
-            return (int)ints->size();
-        }
-            break;
-        case BDInt64Type:
-        {
-            std::vector<int64_t> *ints = (std::vector<int64_t> *)data;
-            return (int)ints->size();
-        }
-        case BDDataTypeMax:
-            return 0;
-            break;
-    }
+    return count;
 }
 
 /// Return the size of a single element
 int VertexAttribute::size() const
 {
-    switch (dataType)
-    {
-        case BDFloat4Type:
-            return 4*4;
-            break;
-        case BDFloat3Type:
-            return 4*3;
-            break;
-        case BDFloat2Type:
-            return 4*2;
-            break;
-        case BDChar4Type:
-            return sizeof(unsigned char)*4;
-            break;
-        case BDFloatType:
-            return 4;
-            break;
-        case BDIntType:
-            return 4;
-            break;
-        case BDInt64Type:
-            return 8;
-            break;
-        case BDDataTypeMax:
-            return 0;
-            break;
-    }
+    return VertexAttributeTypeSize(dataType);
 }
 
 SingleVertexAttributeInfo::SingleVertexAttributeInfo()
@@ -323,33 +231,7 @@ SingleVertexAttributeInfo::SingleVertexAttributeInfo(StringIdentity nameID,int s
 
 int SingleVertexAttributeInfo::size() const
 {
-    switch (type)
-    {
-        case BDFloat4Type:
-            return 4*4;
-            break;
-        case BDFloat3Type:
-            return 4*3;
-            break;
-        case BDFloat2Type:
-            return 4*2;
-            break;
-        case BDChar4Type:
-            return sizeof(unsigned char)*4;
-            break;
-        case BDFloatType:
-            return 4;
-            break;
-        case BDIntType:
-            return 4;
-            break;
-        case BDInt64Type:
-            return 8;
-            break;
-        case BDDataTypeMax:
-            return 0;
-            break;
-    }
+    return VertexAttributeTypeSize(type);
 }
 
 SingleVertexAttribute::SingleVertexAttribute()
@@ -408,112 +290,21 @@ SingleVertexAttribute::SingleVertexAttribute(StringIdentity nameID,int slot,floa
 /// Clean out the data array
 void VertexAttribute::clear()
 {
-    if (data)
-    {
-        switch (dataType)
-        {
-            case BDFloat4Type:
-            {
-                std::vector<Vector4f> *vecs = (std::vector<Vector4f> *)data;
-                delete vecs;
-            }
-                break;
-            case BDFloat3Type:
-            {
-                std::vector<Vector3f> *vecs = (std::vector<Vector3f> *)data;
-                delete vecs;
-            }
-                break;
-            case BDFloat2Type:
-            {
-                std::vector<Vector2f> *vecs = (std::vector<Vector2f> *)data;
-                delete vecs;
-            }
-                break;
-            case BDChar4Type:
-            {
-                std::vector<RGBAColor> *colors = (std::vector<RGBAColor> *)data;
-                delete colors;
-            }
-                break;
-            case BDFloatType:
-            {
-                std::vector<float> *floats = (std::vector<float> *)data;
-                delete floats;
-            }
-                break;
-            case BDIntType:
-            {
-                std::vector<int> *ints = (std::vector<int> *)data;
-                delete ints;
-            }
-                break;
-            case BDInt64Type:
-            {
-                std::vector<int64_t> *ints = (std::vector<int64_t> *)data;
-                delete ints;
-            }
-                break;
-            case BDDataTypeMax:
-                break;
-        }
-    }
-    data = NULL;
+    bytes = nullptr;
+    count = 0;
+    capacity = 0;
+    heapBytes.reset();
+    // The arena memory goes when everyone's done with it
+    arena.reset();
 }
 
 /// Return a pointer to the given element
 void *VertexAttribute::addressForElement(int which)
 {
-    switch (dataType)
-    {
-        case BDFloat4Type:
-        {
-            std::vector<Vector4f> *vecs = (std::vector<Vector4f> *)data;
-            return &(*vecs)[which];;
-        }
-            break;
-        case BDFloat3Type:
-        {
-            std::vector<Vector3f> *vecs = (std::vector<Vector3f> *)data;
-            return &(*vecs)[which];;
-        }
-            break;
-        case BDFloat2Type:
-        {
-            std::vector<Vector2f> *vecs = (std::vector<Vector2f> *)data;
-            return &(*vecs)[which];
-        }
-            break;
-        case BDChar4Type:
-        {
-            std::vector<RGBAColor> *colors = (std::vector<RGBAColor> *)data;
-            return &(*colors)[which];
-        }
-            break;
-        case BDFloatType:
-        {
-            std::vector<float> *floats = (std::vector<float> *)data;
-            return &(*floats)[which];
-        }
-            break;
-        case BDIntType:
-        {
-            std::vector<int> *ints = (std::vector<int> *)data;
-            return &(*ints)[which];
-        }
-            break;
-        case BDInt64Type:
-        {
-            std::vector<int64_t> *ints = (std::vector<int64_t> *)data;
-            return &(*ints)[which];
-        }
-            break;
-        case BDDataTypeMax:
-            return NULL;
-            break;
-    }
-    
-    return NULL;
+    if (!bytes)
+        return nullptr;
+
+    return bytes + (size_t)which * size();
 }
 
 void VertexAttributeSetConvert(const SingleVertexAttributeSet &attrSet,SingleVertexAttributeInfoSet &infoSet)
@@ -144,6 +144,7 @@ std::string WideVectorInfo::toString() const
        << "subdivEps"   << subdivEps << "\n"
        << "miterLimit"  << miterLimit << "\n"
        << "closeAreals" << closeAreals << "\n"
+       << "colorOverride=" << colorOverride << "\n"
        << "implType="   << implType << "\n"
        << "coordType="  << coordType << "\n"
        << "joinType="   << joinType << "\n"
@@ -1132,7 +1133,7 @@ SimpleIdentity WideVectorManager::addVectors(const std::vector<VectorShapeRef> &
     GeoMbr geoMbr;
     for (const auto &shape : shapes)
     {
-        if (!doColors && shape->getAttrDictRef()->hasField(colorStr))
+        if (!doColors && vecInfo.colorOverride && shape->getAttrDictRef()->hasField(colorStr))
         {
             doColors = true;
         }
@@ -1168,7 +1169,7 @@ SimpleIdentity WideVectorManager::addVectors(const std::vector<VectorShapeRef> &
     {
         const auto &attrs = shape->getAttrDictRef();
 
-        if (attrs->hasField(colorStr))
+        if (doColors && attrs->hasField(colorStr))
         {
             builder.setColor(attrs->getColor(colorStr, vecInfo.color));
         }
@@ -116,6 +116,10 @@ public:
     double calculateTextWidth(PlatformThreadInfo *_Nullable threadInfo,
                               const LabelInfoRef &labelInfo,
                               const std::string &testStr) override;
+
+    /// UIFont and NSAttributedString are fine off the main thread, each label info is new,
+    ///  and the selection objects are locked, so tiles can build their styles in parallel
+    virtual bool platformIsThreadSafe() const override { return true; }
     
     /// Add a sprite sheet
     void addSprites(MapboxVectorStyleSpritesRef newSprites,MaplyTexture *_Nonnull tex);
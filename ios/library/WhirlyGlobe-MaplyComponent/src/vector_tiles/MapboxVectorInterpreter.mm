@@ -95,6 +95,8 @@ static int BackImageWidth = 16, BackImageHeight = 16;
     imageTileParser = std::make_shared<MapboxVectorTileParser>(nullptr,imageStyle);
     imageTileParser->setLocalCoords();
     vecTileParser = std::make_shared<MapboxVectorTileParser>(nullptr,vecStyle);
+    // The styles decide which of them can use it
+    vecTileParser->setBuildPool(TaskPool::sharedPool());
     
     return self;
 }
@@ -113,6 +115,8 @@ static int BackImageWidth = 16, BackImageHeight = 16;
         vecStyle = std::make_shared<VectorStyleDelegateWrapper>(inViewC,inVectorStyle);
 
     vecTileParser = std::make_shared<MapboxVectorTileParser>(nullptr,vecStyle);
+    // The styles decide which of them can use it
+    vecTileParser->setBuildPool(TaskPool::sharedPool());
 
     return self;
 }
@@ -717,11 +717,9 @@ VectorStyleDelegateWrapper::stylesForFeature(PlatformThreadInfo *inst,
         dict = dictRef->dict;
     } else if (const auto dictRef = dynamic_cast<const iosMutableDictionary*>(&attrs)) {
         dict = dictRef->dict;
-    } else if (const auto dictRef = dynamic_cast<const MutableDictionaryC*>(&attrs)) {
-        dict = [NSMutableDictionary fromDictionaryCPointer:dictRef];
-    } else if (dict) {
-        wkLogLevel(Warn, "unsupported dictionary implementation");
-        return std::vector<VectorStyleImplRef>();
+    } else {
+        // Anything else, such as the lazy vector tile features, is copied through the generic interface
+        dict = [NSMutableDictionary fromDictionaryCPointer:&attrs];
     }
     
     const MaplyTileID theTileID = { tileID.x, tileID.y, tileID.level };
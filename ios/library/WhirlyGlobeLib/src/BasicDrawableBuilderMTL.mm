@@ -64,6 +64,7 @@ BasicDrawableBuilderMTL::~BasicDrawableBuilderMTL()
 int BasicDrawableBuilderMTL::addAttribute(BDAttributeDataType dataType,StringIdentity nameID,int slot,int numThings)
 {
     VertexAttribute *attr = new VertexAttributeMTL(dataType,nameID);
+    attr->setArena(attrArena);
     attr->slot = slot;
     if (numThings > 0)
         attr->reserve(numThings);
@@ -102,9 +103,7 @@ BasicDrawableRef BasicDrawableBuilderMTL::getDrawable()
         int ptsIndex = addAttribute(BDFloat3Type, a_PositionNameID);
         VertexAttributeMTL *ptsAttr = (VertexAttributeMTL *)basicDraw->vertexAttributes[ptsIndex];
         ptsAttr->slot = WhirlyKitShader::WKSVertexPositionAttribute;
-        ptsAttr->reserve(points.size());
-        for (const auto &pt : points)
-            ptsAttr->addVector3f(pt);
+        ptsAttr->append(points);
         draw->tris = tris;
         
         // Expression uniforms, if we have those